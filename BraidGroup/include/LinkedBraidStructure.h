@@ -3,20 +3,27 @@
 #ifndef CRAG_LINKED_BRAID_STRUCTURE_H
 #define CRAG_LINKED_BRAID_STRUCTURE_H
 
+#include <cstdint>
 #include <list>
-#include <map>
 #include <ostream>
-#include <set>
-#include <tuple>
+#include <utility>
 #include <vector>
 
 #include "Word.h"
 
+//! Crossing of a LinkedBraidStructure.
+/*!
+  Nodes live in a contiguous slab owned by the structure and refer to each other by their indices in the slab,
+  NONE stands for a missing neighbour.
+ */
 struct BraidNode {
 public:
+  using index = int32_t;
+  static constexpr index NONE = -1;
+
   BraidNode(
-      int64_t num = 0, bool tp = true, BraidNode* l = nullptr, BraidNode* a = nullptr, BraidNode* r = nullptr,
-      BraidNode* bl = nullptr, BraidNode* b = nullptr, BraidNode* br = nullptr)
+      bool tp = true, index l = NONE, index a = NONE, index r = NONE, index bl = NONE, index b = NONE,
+      index br = NONE)
       : left(l)
       , ahead(a)
       , right(r)
@@ -24,30 +31,29 @@ public:
       , back(b)
       , back_right(br)
       , type(tp)
-      , link(nullptr)
-      , weight(0)
-      , theNumber(num) {}
+      , visited(false)
+      , stamp(0)
+      , theNumber(0) {}
 
 public:
-  BraidNode* left;
-  BraidNode* ahead;
-  BraidNode* right;
+  index left;
+  index ahead;
+  index right;
 
-  BraidNode* back_left;
-  BraidNode* back;
-  BraidNode* back_right;
+  index back_left;
+  index back;
+  index back_right;
 
   // shows whether a crossing positive or negative
   bool type;
 
-  // auxiliary member, used in LinkedBraidStructure copy constructor and in
-  // translateIntoWord
-  mutable BraidNode* link;
+  // auxiliary member, used in translateIntoWord
+  mutable bool visited;
 
-  // auxiliary member, used in remove Handle functions
-  mutable int64_t weight;
+  // auxiliary member, identifies the current entry of the node in the handle queue (0 if none)
+  uint64_t stamp;
 
-  // a unique number associated with the node in a LBS
+  // a unique number associated with the node in a LBS, increases with the time of creation
   int64_t theNumber;
 };
 
@@ -86,18 +92,25 @@ struct LinkedBraidStructureTransform {
 
   bool type;
 
+  // the slot of the node in the structure
   int64_t theNumber;
   int64_t thePosition;
+
+  // BraidNode::theNumber of an erased node, it gets it back when the transform is undone
+  int64_t theCreationNumber = 0;
 };
 
+//! Linked structure of the crossings of a braid word used to remove Dehornoy handles.
+/*!
+  The crossings are stored in a slab of BraidNode and linked by indices, so copies of a structure are plain copies
+  of vectors. The memory of erased nodes, of the slab and of the auxiliary handle queue is reused by later
+  operations, in particular by assign().
+ */
 class LinkedBraidStructure {
 public:
   LinkedBraidStructure(size_t N);
   LinkedBraidStructure(size_t N, const Word& w);
 
-  LinkedBraidStructure(const LinkedBraidStructure& LBS);
-  LinkedBraidStructure& operator=(const LinkedBraidStructure& LBS);
-
 public:
   // function check if the braid-word represented by *this is shortlex smaller
   // than the one given by lbs, usually the computation of the words is not
@@ -105,11 +118,14 @@ public:
   bool operator<(const LinkedBraidStructure& lbs) const;
 
   size_t size() const {
-    return the_nodes_.size();
+    return nodes_.size() - free_nodes_.size();
   }
 
   void clear();
 
+  //! Replaces the braid by the word w with N generators keeping the allocated memory.
+  void assign(size_t N, const Word& w);
+
   LinkedBraidStructureTransform push_back(int g);
   LinkedBraidStructureTransform push_front(int g);
 
@@ -122,39 +138,54 @@ public:
   void undo(const LinkedBraidStructureTransform& lbst);
 
 private:
-  using NODE = std::tuple<int64_t, int64_t, BraidNode*>;
+  using index = BraidNode::index;
+  static constexpr index NONE = BraidNode::NONE;
+
+  //! Handle queue entry: position, number and index of a node and the stamp of the node when it was queued
+  struct QueueEntry {
+    int64_t pos;
+    int64_t number;
+    index node;
+    uint64_t stamp;
+
+    bool operator>(const QueueEntry& e) const {
+      return pos != e.pos ? pos > e.pos : number > e.number;
+    }
+  };
 
-  struct NodeCompare {
-    using int64_triple = std::tuple<int64_t, int64_t, int64_t>;
+  BraidNode& node(index i) {
+    return nodes_[i];
+  }
 
-    bool operator()(const NODE& lhs, const NODE& rhs) const {
-      return std::less<int64_triple>()(toInt64Triple_(lhs), toInt64Triple_(rhs));
-    }
+  const BraidNode& node(index i) const {
+    return nodes_[i];
+  }
 
-    int64_triple toInt64Triple_(const NODE& n) const {
-      return std::make_tuple(std::get<0>(n), std::get<1>(n), std::get<2>(n)->theNumber);
-    }
-  };
+  index allocateNode(const BraidNode& bn);
 
-  using node_set = std::set<NODE, NodeCompare>;
+  LinkedBraidStructureTransform make_EraseTransform(index bn, int64_t pos) const;
+  LinkedBraidStructureTransform make_AddTransform(index bn, int64_t pos) const;
+  LinkedBraidStructureTransform make_ChangeType(index bn, int64_t pos) const;
 
-  LinkedBraidStructureTransform make_EraseTransform(BraidNode* bn, int64_t pos) const;
-  LinkedBraidStructureTransform make_AddTransform(BraidNode* bn, int64_t pos) const;
-  LinkedBraidStructureTransform make_ChangeType(BraidNode* bn, int64_t pos) const;
+  int64_t checkIfStartsLeftHandle(int64_t pos, index bn) const;
+  int64_t checkIfStartsRightHandle(int64_t pos, index bn) const;
 
-  int64_t checkIfStartsLeftHandle(int64_t pos, BraidNode* bn);
-  int64_t checkIfStartsRightHandle(int64_t pos, BraidNode* bn);
+  void removeLeftHandle(int64_t pos, index n1, std::list<LinkedBraidStructureTransform>* lst);
+  void removeRightHandle(int64_t pos, index n1, std::list<LinkedBraidStructureTransform>* lst);
 
-  void removeLeftHandle(NODE node, node_set& to_check, std::list<LinkedBraidStructureTransform>* lst);
-  void removeRightHandle(NODE node, node_set& to_check, std::list<LinkedBraidStructureTransform>* lst);
+  // The nodes starting handles are processed in the order of (weight, position, number). The queue consists of
+  // buckets of min-heaps indexed by weight. Entries are invalidated lazily by the stamp of the node.
+  void clearQueue();
+  void enqueue(int64_t pos, index bn, int64_t weight);
+  bool dequeue(QueueEntry& entry);
 
-  LinkedBraidStructureTransform removeNode(BraidNode* bn, int64_t pos);
+  LinkedBraidStructureTransform removeNode(index bn, int64_t pos);
 
-  BraidNode* insertBackRight(BraidNode* bn, int64_t pos, bool type);
-  BraidNode* insertBackLeft(BraidNode* bn, int64_t pos, bool type);
-  BraidNode* insert(const LinkedBraidStructureTransform& lbst);
+  index insertBackRight(index bn, int64_t pos, bool type);
+  index insertBackLeft(index bn, int64_t pos, bool type);
+  index insert(const LinkedBraidStructureTransform& lbst);
 
-  void processTree(int al, BraidNode* node, Word& result) const;
+  void processTree(int al, index node, Word& result) const;
 
   void clearLinks() const;
 
@@ -162,12 +193,20 @@ private:
   //! Number of generators!!!
   size_t the_index_;
 
-  std::vector<BraidNode*> front_nodes_;
-  std::vector<BraidNode*> back_nodes_;
+  std::vector<index> front_nodes_;
+  std::vector<index> back_nodes_;
+
+  std::vector<BraidNode> nodes_;
+  std::vector<index> free_nodes_;
+
+  int64_t max_node_number_ = 0;
 
-  std::map<int64_t, BraidNode> the_nodes_;
+  std::vector<std::vector<QueueEntry>> queue_;
+  size_t queue_min_weight_ = 0;
+  uint64_t queue_stamp_ = 0;
 
-  int64_t max_node_number_;
+  // nodes to check after a handle removal
+  std::vector<std::pair<int64_t, index>> to_check_;
 };
 
 //! Compares two braids using LinkedBraidStructure.
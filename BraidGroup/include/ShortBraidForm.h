@@ -12,6 +12,8 @@ class LinkedBraidStructure;
 Word shortenBraid(int N, const Word &w);
 //! Attempt to reduce |w| using Dehornoy handle free form (for longer words)
 Word shortenBraid2(int n, const Word &w);
+//! Applies shortenBraid2 to every word, the words are processed concurrently
+vector<Word> shortenBraids(int n, const vector<Word> &words);
 //! Compute normal form for w and then shorten the result
 Word shortBraidForm( int N , const Word& w );
 
@@ -17,6 +17,7 @@
 #include "tuples.h"
 #include "Permutation.h"
 #include "braid_group.h"
+#include "summit_set.h"
 
 using namespace std;
 
@@ -52,7 +53,7 @@ class ThLeftNormalForm
     The second component specifies the power of the half twist.
     The third  component specifies the list  of braid permutations.
   */
-  typedef triple< int , int , list< Permutation > > NF;
+  typedef triple< int , int , vector< Permutation > > NF;
   
   /////////////////////////////////////////////////////////
   //                                                     //
@@ -85,7 +86,7 @@ class ThLeftNormalForm
     There is no check that the pair (p,d) defines a correct normal form representation.
     If you are not sure if (p,d) is correct apply static function adjustDecomposition first.
   */
-  ThLeftNormalForm( int rank , int p , const list< Permutation >& d ) : 
+  ThLeftNormalForm( int rank , int p , const vector< Permutation >& d ) : 
     theRank( rank ),
     theOmegaPower( p ) ,
     theDecomposition( d ) { }
@@ -176,10 +177,7 @@ public:
   
 
   //! Multiply a normal form by the other on the right
-  ThLeftNormalForm& operator *= ( const ThLeftNormalForm& rep ) {
-    *this = multiply( rep );
-    return *this;
-  }
+  ThLeftNormalForm& operator *= ( const ThLeftNormalForm& rep );
 
   
   //! Cast operator (returns a representation of a normal form)
@@ -203,7 +201,7 @@ public:
   //! Get half-twist power.
   inline int getPower( ) const { return theOmegaPower; }
   //! Get a list of permutations.
-  inline const list< Permutation >& getDecomposition( ) const { return theDecomposition; }
+  inline const vector< Permutation >& getDecomposition( ) const { return theDecomposition; }
   
   
   //! Check if a normal form is trivial
@@ -222,6 +220,22 @@ public:
   
   ThLeftNormalForm inverse( ) const;
   ThLeftNormalForm multiply( const ThLeftNormalForm& rep ) const;
+
+
+  //! Multiply a normal form by a permutation braid on the right.
+  /*!
+    Only the tail of the decomposition affected by the multiplication is recomputed,
+    so a multiplication by k permutation braids costs O(k*|tail|) instead of a recomputation of the whole form.
+   */
+  void appendSimple( const Permutation& s );
+
+
+  //! Multiply a normal form by a generator \f$x_{|g|}^{\pm 1}\f$ (g is indexed from 1) on the right.
+  /*!
+    A negative generator \f$x_i^{-1} = (x_i^{-1} \Delta) \Delta^{-1}\f$ flips all the permutations of the decomposition,
+    so the constructor from a word flips them once at the end.
+   */
+  void appendGenerator( int g );
   
   
   //! Computes a word represented by a normal form.
@@ -235,7 +249,10 @@ public:
   Word getReducedWord2() const;
 
 
-  static void adjustDecomposition( int rank , int& power , list<Permutation>& decomp );
+  static void adjustDecomposition( int rank , int& power , vector<Permutation>& decomp );
+
+  //! Multiply a normal form presentation (power,decomp) by a permutation braid s on the right.
+  static void appendSimple( int rank , int& power , vector<Permutation>& decomp , const Permutation& s );
   
   void adjust( ) { adjustDecomposition( theRank , theOmegaPower , theDecomposition ); }
   
@@ -314,6 +331,18 @@ public:
     Procedure constructs USS for 2 braids until finds intersections.
   */
   pair< bool , ThLeftNormalForm > areConjugate_uss( const ThLeftNormalForm& nf , int time_sec_bound=999999 ) const;
+
+
+  //! Returns true if braids are conjugate.
+  /*!
+    The ultra summit sets are kept in hash-indexed sets and are expanded frontier by frontier,
+    the elements of a frontier are processed concurrently. If the check stops because of the limits
+    in options then the result is false, see the flags of statistics.
+    @return a pair (R,C), where R is true if braids are conjugate, and C is a conjugator: nf = C (*this) C^{-1}
+  */
+  pair< bool , ThLeftNormalForm > areConjugate_uss( const ThLeftNormalForm& nf ,
+						  const crag::braidgroup::SummitSetOptions& options ,
+						  crag::braidgroup::SummitSetStatistics* statistics=nullptr ) const;
   
   
   /////////////////////////////////////////////////////////
@@ -324,21 +353,20 @@ public:
 
  private:
 
-  //! (Aux, USS)
-  pair< bool , ThLeftNormalForm > 
-    ussConstructionIteration( map< ThLeftNormalForm , pair< ThLeftNormalForm , int > >& uss_new1 , 
-			      map< ThLeftNormalForm , pair< ThLeftNormalForm , int > >& uss_checked1 , 
-			      const map< ThLeftNormalForm , pair< ThLeftNormalForm , int > >& uss_new2 , 
-			      const map< ThLeftNormalForm , pair< ThLeftNormalForm , int > >& uss_checked2 ) const;
+  typedef crag::braidgroup::SummitSet< ThLeftNormalForm > USS;
+
+  //! (Aux, USS) Cycling orbit of an USS element (triples (R,C,P), where R = C^{-1} A C for the braid A and P is the period)
+  vector< triple< ThLeftNormalForm , ThLeftNormalForm , int > > getTrajectory( const ThLeftNormalForm& conjugator ) const;
+
 
+  //! (Aux, USS) Expand the frontier of uss1, the elements of the frontier are processed concurrently.
+  static pair< bool , ThLeftNormalForm > ussExpandFrontier( USS& uss1 , const USS& uss2 , size_t& expanded );
 
-  //! (Aux, USS)
-  pair< bool , ThLeftNormalForm > 
-    ussAddTrajectory( const ThLeftNormalForm& new_elt , const ThLeftNormalForm& new_conjugator , 
-		      map< ThLeftNormalForm , pair< ThLeftNormalForm , int > >& uss_new1 , 
-		      map< ThLeftNormalForm , pair< ThLeftNormalForm , int > >& uss_checked1 , 
-		      const map< ThLeftNormalForm , pair< ThLeftNormalForm , int > >& uss_new2 , 
-		      const map< ThLeftNormalForm , pair< ThLeftNormalForm , int > >& uss_checked2 ) const;
+
+  //! (Aux, USS) Add a trajectory to uss1, stops and returns a conjugator if an element belongs to uss2.
+  static pair< bool , ThLeftNormalForm > 
+    ussAddTrajectory( const vector< triple< ThLeftNormalForm , ThLeftNormalForm , int > >& trajectory , 
+		      USS& uss1 , const USS& uss2 );
 
   
   /////////////////////////////////////////////////////////
@@ -351,7 +379,7 @@ public:
   
   inline void setPower( int p )
     { theOmegaPower = p; }
-  inline void setDecomposition( const list< Permutation >& d )
+  inline void setDecomposition( const vector< Permutation >& d )
     { theDecomposition = d; }
 
   /////////////////////////////////////////////////////////
@@ -444,8 +472,12 @@ public:
  private:
 
   enum transformationResult { TWO_MULTIPLIERS , ONE_MULTIPLIER , NO_CHANGE };
+  //! Make the pair (p1,p2) left-weighted, ONE_MULTIPLIER means that p2 became trivial
   static transformationResult transform ( int theIndex , Permutation& p1 , Permutation& p2 );
 
+  //! Conjugate all the permutations of the decomposition by \f$\Delta\f$
+  static void flip( vector<Permutation>& decomp );
+
   static void reverse( NF& pr );
 
   /////////////////////////////////////////////////////////
@@ -463,7 +495,7 @@ public:
   int theOmegaPower;
 
   //! Sequence of permutations.
-  list< Permutation > theDecomposition;
+  vector< Permutation > theDecomposition;
   
 };
 
@@ -16,6 +16,7 @@
 #include "tuples.h"
 #include "Permutation.h"
 #include "braid_group.h"
+#include "summit_set.h"
 
 using namespace std;
 
@@ -48,7 +49,7 @@ public:
     The second component specifies the power of the half twist.
     The third  component specifies the list  of braid permutations.
   */
-  typedef triple< int , int , list< Permutation > > NF;
+  typedef triple< int , int , vector< Permutation > > NF;
   
   /////////////////////////////////////////////////////////
   //                                                     //
@@ -74,7 +75,7 @@ public:
     There is no check that the pair (p,d) defines a correct normal form representation.
     If you are not sure if (p,d) is correct apply static function adjustDecomposition first.
   */
-  ThRightNormalForm( int rank , int p , const list< Permutation >& d ) : 
+  ThRightNormalForm( int rank , int p , const vector< Permutation >& d ) : 
     theRank( rank ),
     theOmegaPower( p ) ,
     theDecomposition( d ) { }
@@ -192,7 +193,7 @@ public:
   //! Get half-twist power.
   inline int getPower( ) const { return theOmegaPower; }
   //! Get a list of permutations.
-  inline const list< Permutation >& getDecomposition( ) const { return theDecomposition; }
+  inline const vector< Permutation >& getDecomposition( ) const { return theDecomposition; }
   
 
   //! Check if a normal form is trivial
@@ -242,13 +243,24 @@ public:
     @return - a pair (R,C), where R is a boolean value (true if braids are conjugate, false otherwise), and C is a conjugator (if braids conjugate)
    */
   pair< bool , ThRightNormalForm > areConjugate( const ThRightNormalForm& rep ) const;
+
+
+  //! Check whether two braids are conjugate
+  /*!
+    The super summit sets are kept in hash-indexed sets and are expanded frontier by frontier,
+    the elements of a frontier are processed concurrently. If the check stops because of the limits
+    in options then the result is false, see the flags of statistics.
+   */
+  pair< bool , ThRightNormalForm > areConjugate( const ThRightNormalForm& rep ,
+						 const crag::braidgroup::SummitSetOptions& options ,
+						 crag::braidgroup::SummitSetStatistics* statistics=nullptr ) const;
   
 
   //! Adjust a normal form
   /*!
     Use this function if the triple of arguments does not satisfy "greedy conditions".
    */
-  static void adjustDecomposition( int rank , int& power , list<Permutation>& decomp );
+  static void adjustDecomposition( int rank , int& power , vector<Permutation>& decomp );
 
   //! Adjust a normal form
   /*!
@@ -422,7 +434,7 @@ public:
   //! Set a power of a half-twist.
   inline void setPower( int p ) { theOmegaPower = p; }
   //! Set a decomposition of a normal form (without any check of "greedy conditions"). 
-  inline void setDecomposition( const list< Permutation >& d ) { theDecomposition = d; }
+  inline void setDecomposition( const vector< Permutation >& d ) { theDecomposition = d; }
   
   /////////////////////////////////////////////////////////
   //                                                     //
@@ -445,11 +457,10 @@ private:
   static transformationResult transform ( int theIndex , Permutation& p1 , Permutation& p2 );
   
 
-  //! I think function processes a vertex in a Super Summit Set graph.
-  pair< bool , ThRightNormalForm > sssConstructionIteration( map< ThRightNormalForm , ThRightNormalForm >& sss_new1 ,
-							     map< ThRightNormalForm , ThRightNormalForm >& sss_checked1 ,
-							     const map< ThRightNormalForm , ThRightNormalForm >& sss_new2 ,
-							     const map< ThRightNormalForm , ThRightNormalForm >& sss_checked2 ) const;
+  typedef crag::braidgroup::SummitSet< ThRightNormalForm > SSS;
+
+  //! Expand the frontier of sss1 (vertices of a Super Summit Set graph), the elements of the frontier are processed concurrently.
+  static pair< bool , ThRightNormalForm > sssExpandFrontier( SSS& sss1 , const SSS& sss2 , size_t& expanded );
   
   /////////////////////////////////////////////////////////
   //                                                     //
@@ -466,7 +477,7 @@ private:
   int theOmegaPower;
 
   //! Sequence of permutations.
-  list< Permutation > theDecomposition;
+  vector< Permutation > theDecomposition;
   
 };
 
@@ -3,6 +3,7 @@
 #ifndef CRAG_COLORED_BURAU_H
 #define CRAG_COLORED_BURAU_H
 
+#include <limits>
 #include <ostream>
 #include <sstream>
 #include <string>
@@ -11,8 +12,10 @@
 
 #include "FiniteField.h"
 #include "Permutation.h"
+#include "SmallFiniteField.h"
 #include "Word.h"
 #include "matrix.h"
+#include "parallel.h"
 #include "polynomial.h"
 
 namespace crag {
@@ -90,31 +93,17 @@ Monomial<T, ExponentType> permute(const Monomial<T, ExponentType>& m, const Perm
   return permute(m.coef(), m.term(), p);
 }
 
-template <typename T, typename ExponentType, typename TermCompare>
-MonomialSum<T, ExponentType, TermCompare>
-permute(const MonomialSum<T, ExponentType, TermCompare>& polynomial, const Permutation& p) {
+template <typename T, typename ExponentType>
+MonomialSum<T, ExponentType> permute(const MonomialSum<T, ExponentType>& polynomial, const Permutation& p) {
   if (polynomial.dimension() != p.size()) {
     throw std::invalid_argument("Dimensions of the polynomial and the permutation don't match.");
   }
 
-  if (polynomial.isZero()) {
-    return polynomial;
-  }
-
-  auto it = polynomial.begin();
-
-  MonomialSum<T, ExponentType, TermCompare> result(permute(it->second, it->first, p));
-
-  while (++it != polynomial.end()) {
-    result += permute(it->second, it->first, p);
-  }
-
-  return result;
+  return polynomial.permuteVariables(p);
 }
 
-template <typename T, typename ExponentType, typename TermCompare>
-Matrix<MonomialSum<T, ExponentType, TermCompare>>
-permute(Matrix<MonomialSum<T, ExponentType, TermCompare>> m, const Permutation& p) {
+template <typename T, typename ExponentType>
+Matrix<MonomialSum<T, ExponentType>> permute(Matrix<MonomialSum<T, ExponentType>> m, const Permutation& p) {
   for (size_t i = 0; i < m.size1(); ++i) {
     for (size_t j = 0; j < m.size2(); ++j) {
       m(i, j) = permute(m(i, j), p);
@@ -279,12 +268,12 @@ CBElement<T> CBImageSlow(size_t n, const Word& w) {
   return result;
 }
 
-template <typename T, typename ExponentType, typename TermCompare>
-Matrix<T> evaluate(const Matrix<MonomialSum<T, ExponentType, TermCompare>>& m, const std::vector<T>& values);
+template <typename T, typename ExponentType>
+Matrix<T> evaluate(const Matrix<MonomialSum<T, ExponentType>>& m, const std::vector<T>& values);
 
-template <typename Ideal, typename ExponentType, typename TermCompare>
+template <typename Ideal, typename ExponentType>
 Matrix<FieldElement<Ideal>> evaluate(
-    const Matrix<MonomialSum<FieldElement<Ideal>, ExponentType, TermCompare>>& m,
+    const Matrix<MonomialSum<FieldElement<Ideal>, ExponentType>>& m,
     const std::vector<FieldElement<Ideal>>& values) {
   Matrix<FieldElement<Ideal>> result(std::make_pair(m.size1(), m.size2()));
 
@@ -297,6 +286,9 @@ Matrix<FieldElement<Ideal>> evaluate(
   return result;
 }
 
+template <typename T>
+class PackedCBProjectionElement;
+
 //! Represents an element of a finite set of pairs (M, sigma) parametrized by t-values (tau_1,...,tau_n) \in T^n,
 //! where M is an (n, n) matrix over ring T, and sigma is a permutation of size n.
 //! Colored Burau group corresponding to B_n acts on this set, and this action is called E-multiplication.
@@ -363,7 +355,44 @@ public:
   //! E-multiplication by a braid word w, performs multiplication iteratively for each generator of w,
   //! so it doesn't compute the image of w in colored Burau group.
   //! Multiplication by each generator is optimized to modify only 3 columns of the original matrix.
+  //! Over fields with at most 256 elements long words are processed by PackedCBProjectionElement.
   CBProjectionElement& operator*=(const Word& w) {
+    multiply_(w, std::integral_constant<bool, finitefield::SmallFieldEncoding<T>::is_small>());
+    return *this;
+  }
+
+  std::string toString() const;
+
+  bool operator==(const CBProjectionElement& other) const {
+    return (t_values_ == other.t_values_) && (matrix_ == other.matrix_) && (permutation_ == other.permutation_);
+  }
+
+  bool operator!=(const CBProjectionElement& other) const {
+    return !(*this == other);
+  }
+
+private:
+  std::vector<T> t_values_;
+  matrix_t matrix_;
+  Permutation permutation_;
+
+  void multiply_(const Word& w, std::false_type) {
+    multiplyGeneric_(w);
+  }
+
+  void multiply_(const Word& w, std::true_type) {
+    // packing and unpacking the matrix costs about as much as E-multiplication by n generators
+    if (w.length() < n()) {
+      multiplyGeneric_(w);
+      return;
+    }
+
+    PackedCBProjectionElement<T> packed(*this);
+    packed *= w;
+    packed.unpack(*this);
+  }
+
+  void multiplyGeneric_(const Word& w) {
     const auto n = this->n();
 
     for (const auto i : w) {
@@ -399,24 +428,143 @@ public:
 
       permutation_.change(index - 1, index);
     }
+  }
+
+  friend class PackedCBProjectionElement<T>;
+};
+
+//! CBProjectionElement over a field with at most 256 elements (see finitefield::SmallField) in packed form.
+//! Field elements are replaced by their byte codes and the matrix is stored column-major in a contiguous buffer,
+//! so E-multiplication by a generator is a pass over three contiguous columns with table lookups.
+//! The result of unpacking is identical to the one computed by the generic CBProjectionElement arithmetic.
+template <typename T>
+class PackedCBProjectionElement {
+public:
+  explicit PackedCBProjectionElement(const CBProjectionElement<T>& element)
+      : field_(finitefield::SmallField<T>::instance())
+      , n_(element.n())
+      , minus_t_(n_)
+      , minus_t_inverse_(n_)
+      , columns_(n_ * n_)
+      , permutation_(element.permutation()) {
+    for (size_t i = 0; i < n_; ++i) {
+      const auto t = field_.encode(element.tValues()[i]);
+
+      minus_t_[i] = field_.neg(t);
+      // zero t-values are only reported when their inverses are used, as the generic implementation does
+      minus_t_inverse_[i] = (t == 0) ? 0 : field_.neg(field_.inv(t));
+    }
+
+    for (size_t i = 0; i < n_; ++i) {
+      for (size_t j = 0; j < n_; ++j) {
+        columns_[j * n_ + i] = field_.encode(element.matrix()(i, j));
+      }
+    }
+  }
+
+  size_t n() const {
+    return n_;
+  }
+
+  const Permutation& permutation() const {
+    return permutation_;
+  }
+
+  //! Byte code of the (i, j) entry of the matrix.
+  uint8_t code(size_t i, size_t j) const {
+    return columns_[j * n_ + i];
+  }
+
+  //! E-multiplication by a braid word w, see CBProjectionElement::operator*=(const Word&).
+  PackedCBProjectionElement& operator*=(const Word& w) {
+    for (const auto i : w) {
+      const size_t index = std::abs(i);
+
+      if ((index < 1) || (index + 1 > n_)) {
+        throw std::invalid_argument("Cannot perform E-multiplication by w, generator's index is out of range.");
+      }
+
+      uint8_t* prev = (index > 1) ? column_(index - 2) : nullptr;
+      uint8_t* left = column_(index - 1);
+      uint8_t* right = column_(index);
+
+      // every loop below goes over a contiguous column, so the compiler is free to vectorize additions
+      if (i > 0) {
+        const auto minus_t = field_.mulRow(minus_t_[permutation_[index - 1]]);
+
+        for (size_t j = 0; j < n_; ++j) {
+          right[j] = field_.add(right[j], left[j]);
+        }
+
+        for (size_t j = 0; j < n_; ++j) {
+          left[j] = minus_t[left[j]];
+        }
+
+        if (prev) {
+          for (size_t j = 0; j < n_; ++j) {
+            prev[j] = field_.sub(prev[j], left[j]);
+          }
+        }
+      } else {
+        const auto t_index = permutation_[index];
+
+        if (minus_t_inverse_[t_index] == 0) {
+          throw std::logic_error("Division by zero");
+        }
+
+        const auto minus_t_inverse = field_.mulRow(minus_t_inverse_[t_index]);
+
+        if (prev) {
+          for (size_t j = 0; j < n_; ++j) {
+            prev[j] = field_.add(prev[j], left[j]);
+          }
+        }
+
+        for (size_t j = 0; j < n_; ++j) {
+          left[j] = minus_t_inverse[left[j]];
+        }
+
+        for (size_t j = 0; j < n_; ++j) {
+          right[j] = field_.sub(right[j], left[j]);
+        }
+      }
+
+      permutation_.change(index - 1, index);
+    }
 
     return *this;
   }
 
-  std::string toString() const;
+  //! Writes the matrix and the permutation back to element, which must have the same t-values.
+  void unpack(CBProjectionElement<T>& element) const {
+    for (size_t i = 0; i < n_; ++i) {
+      for (size_t j = 0; j < n_; ++j) {
+        element.matrix_(i, j) = field_.decode(code(i, j));
+      }
+    }
 
-  bool operator==(const CBProjectionElement& other) const {
-    return (t_values_ == other.t_values_) && (matrix_ == other.matrix_) && (permutation_ == other.permutation_);
+    element.permutation_ = permutation_;
   }
 
-  bool operator!=(const CBProjectionElement& other) const {
+  bool operator==(const PackedCBProjectionElement& other) const {
+    return (columns_ == other.columns_) && (permutation_ == other.permutation_);
+  }
+
+  bool operator!=(const PackedCBProjectionElement& other) const {
     return !(*this == other);
   }
 
 private:
-  std::vector<T> t_values_;
-  matrix_t matrix_;
+  const finitefield::SmallField<T>& field_;
+  size_t n_;
+  std::vector<uint8_t> minus_t_;
+  std::vector<uint8_t> minus_t_inverse_;
+  std::vector<uint8_t> columns_;
   Permutation permutation_;
+
+  uint8_t* column_(size_t j) {
+    return &columns_[j * n_];
+  }
 };
 
 template <typename T>
@@ -471,6 +619,369 @@ CBProjectionElement<T> project(const Word& w, std::vector<T> t_values) {
   CBProjectionElement<T> result(std::move(t_values));
   return result *= w;
 }
+
+namespace details {
+template <typename T>
+std::vector<CBProjectionElement<T>>
+project(const std::vector<Word>& words, const CBProjectionElement<T>& unit, std::false_type) {
+  std::vector<CBProjectionElement<T>> result;
+  result.reserve(words.size());
+
+  for (const auto& w : words) {
+    result.push_back(unit * w);
+  }
+
+  return result;
+}
+
+template <typename T>
+std::vector<CBProjectionElement<T>>
+project(const std::vector<Word>& words, const CBProjectionElement<T>& unit, std::true_type) {
+  const PackedCBProjectionElement<T> packed_unit(unit);
+
+  std::vector<CBProjectionElement<T>> result(words.size(), unit);
+
+  for (size_t k = 0; k < words.size(); ++k) {
+    auto packed = packed_unit;
+    packed *= words[k];
+    packed.unpack(result[k]);
+  }
+
+  return result;
+}
+} // namespace details
+
+//! Acts on the trivial pair (E, id) by each of the words using provided t-values.
+//! Over fields with at most 256 elements the packed form of the trivial pair is shared by all words.
+template <typename T>
+std::vector<CBProjectionElement<T>> project(const std::vector<Word>& words, std::vector<T> t_values) {
+  const CBProjectionElement<T> unit(std::move(t_values));
+
+  return details::project(
+      words, unit, std::integral_constant<bool, finitefield::SmallFieldEncoding<T>::is_small>());
+}
+
+//! Bounds of the exponents of the variables t_1, ..., t_n in the entries of the matrix of a colored Burau element.
+struct ExponentBounds {
+  std::vector<int> min;
+  std::vector<int> max;
+
+  //! Bounds of the unit, all exponents are zero
+  explicit ExponentBounds(size_t n)
+      : min(n, 0)
+      , max(n, 0) {}
+
+  //! The largest number of exponents a variable can take, i.e. the number of points per variable interpolation needs
+  size_t width() const;
+};
+
+//! Updates the bounds and the permutation p of a colored Burau element multiplied by w.
+//! A letter x_i multiplies a column by t_{p(i)} and x_i^{-1} by t_{p(i+1)}^{-1}, so every letter changes one bound.
+void updateExponentBounds(ExponentBounds& bounds, Permutation& p, const Word& w);
+
+//! Returns the number of t-values per variable which suffices to recover CBImage(n, w) by interpolation, the bounds
+//! are computed for the letters of w as they are, without free reduction.
+size_t interpolationPointsCount(size_t n, const Word& w);
+
+//! Colored Burau element represented by its values on the grid X^n of t-values, where X is a set of distinct non-zero
+//! elements of a field T. The value at a point is the matrix evaluated at the point, i.e. the matrix of the projection
+//! of the element, so multiplication by words is E-multiplication over the field at every point, and the products
+//! are pointwise. The polynomial matrix is recovered by interpolation only on demand, it requires
+//! |X| >= exponentBounds().width(). The grid has |X|^n points, so this is practical for small n only.
+template <typename T>
+class CBEvaluationElement {
+public:
+  using matrix_t = Matrix<T>;
+
+  //! Constructs the unit on the grid points^n
+  CBEvaluationElement(size_t n, std::vector<T> points)
+      : n_(n)
+      , points_(std::move(points))
+      , permutation_(n)
+      , bounds_(n) {
+    if (n_ < 2) {
+      throw std::invalid_argument("Require at least 2 t-values.");
+    }
+
+    for (size_t i = 0; i < points_.size(); ++i) {
+      if (points_[i] == T(0)) {
+        throw std::invalid_argument("Evaluation points must be non-zero.");
+      }
+
+      for (size_t j = 0; j < i; ++j) {
+        if (points_[i] == points_[j]) {
+          throw std::invalid_argument("Evaluation points must be distinct.");
+        }
+      }
+    }
+
+    if (points_.empty()) {
+      throw std::invalid_argument("Require at least 1 evaluation point.");
+    }
+
+    size_t grid_size = 1;
+    for (size_t i = 0; i < n_; ++i) {
+      if (grid_size > std::numeric_limits<size_t>::max() / points_.size()) {
+        throw std::invalid_argument("The grid of evaluation points is too large.");
+      }
+
+      grid_size *= points_.size();
+    }
+
+    values_.assign(grid_size, matrix::unit<T>(n_));
+  }
+
+  size_t n() const {
+    return n_;
+  }
+
+  const std::vector<T>& points() const {
+    return points_;
+  }
+
+  const Permutation& permutation() const {
+    return permutation_;
+  }
+
+  const ExponentBounds& exponentBounds() const {
+    return bounds_;
+  }
+
+  //! The number of points of the grid
+  size_t size() const {
+    return values_.size();
+  }
+
+  //! Returns the k-th point of the grid, its i-th coordinate is points()[(k / |X|^(n - 1 - i)) % |X|]
+  std::vector<T> point(size_t k) const {
+    std::vector<T> result(n_, points_[0]);
+
+    for (size_t i = n_; i-- > 0;) {
+      result[i] = points_[k % points_.size()];
+      k /= points_.size();
+    }
+
+    return result;
+  }
+
+  //! The matrix evaluated at point(k)
+  const matrix_t& value(size_t k) const {
+    return values_[k];
+  }
+
+  //! The projection of the element at point(k), see CBProjectionElement
+  CBProjectionElement<T> projection(size_t k) const {
+    return CBProjectionElement<T>(point(k), values_[k], permutation_);
+  }
+
+  //! E-multiplication by w at every point of the grid, the points are processed in parallel
+  CBEvaluationElement& operator*=(const Word& w) {
+    // also checks the letters before any value is changed
+    auto bounds = bounds_;
+    auto permutation = permutation_;
+    updateExponentBounds(bounds, permutation, w);
+
+    parallel::forEach(values_.size(), [&](size_t k) {
+      auto projection = this->projection(k);
+      projection *= w;
+      values_[k] = projection.matrix();
+    });
+
+    bounds_ = std::move(bounds);
+    permutation_ = std::move(permutation);
+
+    return *this;
+  }
+
+  //! Multiplies by an element on the same grid.
+  //! The value of the permuted matrix of other (see CBElement::operator*=) at a point is the value of other at the
+  //! point with permuted coordinates, which belongs to the grid too.
+  CBEvaluationElement& operator*=(const CBEvaluationElement& other) {
+    if ((n_ != other.n_) || (points_ != other.points_)) {
+      throw std::invalid_argument("Elements are evaluated on different grids.");
+    }
+
+    if (&other == this) {
+      const auto copy = other;
+      return (*this) *= copy;
+    }
+
+    const auto m = points_.size();
+    const auto permutedIndex = [&](size_t k) {
+      std::vector<size_t> coordinates(n_);
+      for (size_t i = n_; i-- > 0;) {
+        coordinates[i] = k % m;
+        k /= m;
+      }
+
+      size_t permuted = 0;
+      for (size_t j = 0; j < n_; ++j) {
+        permuted = permuted * m + coordinates[permutation_[j]];
+      }
+
+      return permuted;
+    };
+
+    parallel::forEach(values_.size(), [&](size_t k) { values_[k] *= other.values_[permutedIndex(k)]; });
+
+    for (size_t j = 0; j < n_; ++j) {
+      bounds_.min[permutation_[j]] += other.bounds_.min[j];
+      bounds_.max[permutation_[j]] += other.bounds_.max[j];
+    }
+
+    // change order of permutations' product since out operator* is not the canonical product
+    permutation_ = other.permutation_ * permutation_;
+
+    return *this;
+  }
+
+  //! Checks if the grid has enough points to recover the polynomial matrix
+  bool isInterpolable() const {
+    return bounds_.width() <= points_.size();
+  }
+
+  //! Recovers the colored Burau element by interpolation, the entries of the matrix are computed in parallel.
+  //! Throws std::logic_error if the grid doesn't have enough points.
+  CBElement<T> interpolate() const;
+
+private:
+  size_t n_;
+  std::vector<T> points_;
+  std::vector<matrix_t> values_;
+  Permutation permutation_;
+  ExponentBounds bounds_;
+
+  //! Returns the inverse of the Vandermonde matrix (x_a^e) of the points
+  std::vector<std::vector<T>> inverseVandermonde_() const;
+};
+
+template <typename T>
+std::vector<std::vector<T>> CBEvaluationElement<T>::inverseVandermonde_() const {
+  const auto m = points_.size();
+
+  // Gauss-Jordan elimination of (V | E), V is invertible since the points are distinct
+  std::vector<std::vector<T>> a(m, std::vector<T>(2 * m, T(0)));
+  for (size_t r = 0; r < m; ++r) {
+    T power(1);
+    for (size_t e = 0; e < m; ++e) {
+      a[r][e] = power;
+      power *= points_[r];
+    }
+    a[r][m + r] = T(1);
+  }
+
+  for (size_t c = 0; c < m; ++c) {
+    size_t pivot = c;
+    while (a[pivot][c] == T(0)) {
+      ++pivot;
+    }
+    std::swap(a[c], a[pivot]);
+
+    const auto inverse = a[c][c].inverse();
+    for (auto& x : a[c]) {
+      x *= inverse;
+    }
+
+    for (size_t r = 0; r < m; ++r) {
+      if ((r == c) || (a[r][c] == T(0))) {
+        continue;
+      }
+
+      const auto factor = a[r][c];
+      for (size_t j = c; j < 2 * m; ++j) {
+        a[r][j] -= factor * a[c][j];
+      }
+    }
+  }
+
+  std::vector<std::vector<T>> result(m);
+  for (size_t r = 0; r < m; ++r) {
+    result[r].assign(a[r].begin() + m, a[r].end());
+  }
+
+  return result;
+}
+
+template <typename T>
+CBElement<T> CBEvaluationElement<T>::interpolate() const {
+  if (!isInterpolable()) {
+    throw std::logic_error("Not enough evaluation points to interpolate the colored Burau element.");
+  }
+
+  const auto m = points_.size();
+  const auto inverse_vandermonde = inverseVandermonde_();
+
+  // coefficients along the variable i are inverse_vandermonde * (values divided by x^min_i)
+  std::vector<std::vector<std::vector<T>>> transforms(n_, inverse_vandermonde);
+  for (size_t i = 0; i < n_; ++i) {
+    for (size_t a = 0; a < m; ++a) {
+      const auto scale = finitefield::pwr(points_[a], -bounds_.min[i]);
+
+      for (size_t e = 0; e < m; ++e) {
+        transforms[i][e][a] *= scale;
+      }
+    }
+  }
+
+  const LaurentPolynomial<T> zero(n_);
+  Matrix<LaurentPolynomial<T>> result(n_, zero);
+
+  parallel::forEach(n_ * n_, [&](size_t entry) {
+    const auto row = entry / n_;
+    const auto column = entry % n_;
+
+    std::vector<T> coefs(values_.size(), T(0));
+    for (size_t k = 0; k < values_.size(); ++k) {
+      coefs[k] = values_[k](row, column);
+    }
+
+    // the transform of a variable is applied to all lines of the grid along it
+    std::vector<T> line(m, T(0));
+    size_t stride = values_.size();
+
+    for (size_t i = 0; i < n_; ++i) {
+      stride /= m;
+
+      for (size_t base = 0; base < coefs.size(); ++base) {
+        if ((base / stride) % m != 0) {
+          continue;
+        }
+
+        for (size_t e = 0; e < m; ++e) {
+          line[e] = T(0);
+
+          for (size_t a = 0; a < m; ++a) {
+            line[e] += transforms[i][e][a] * coefs[base + a * stride];
+          }
+        }
+
+        for (size_t e = 0; e < m; ++e) {
+          coefs[base + e * stride] = line[e];
+        }
+      }
+    }
+
+    // grid indices go in the lexicographic order of exponents, so the terms are appended in the increasing order
+    auto& polynomial = result(row, column);
+    typename LaurentPolynomial<T>::term_t term(n_, 0);
+
+    for (size_t k = 0; k < coefs.size(); ++k) {
+      if (coefs[k] == T(0)) {
+        continue;
+      }
+
+      auto index = k;
+      for (size_t i = n_; i-- > 0;) {
+        term[i] = bounds_.min[i] + static_cast<int>(index % m);
+        index /= m;
+      }
+
+      polynomial += Monomial<T, typename LaurentPolynomial<T>::exponent_t>(coefs[k], term);
+    }
+  });
+
+  return CBElement<T>(std::move(result), permutation_);
+}
 } // namespace coloredburau
 } // namespace crag
 
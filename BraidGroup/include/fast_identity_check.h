@@ -3,6 +3,10 @@
 #ifndef CRAG_FAST_IDENTITY_CHECK_H
 #define CRAG_FAST_IDENTITY_CHECK_H
 
+#include <map>
+#include <type_traits>
+#include <vector>
+
 #include <boost/functional/hash.hpp>
 
 #include "colored_burau.h"
@@ -88,13 +92,21 @@ public:
     std::vector<braid_hash_t> hashes;
     hashes.reserve(words.size());
 
-    for (const auto& w : words) {
-      hashes.push_back((*this)(w));
+    for (const auto& projection : coloredburau::project(words, t_values)) {
+      hashes.push_back(std::hash<coloredburau::CBProjectionElement<T>>()(projection));
     }
 
     return boost::hash_value(hashes);
   }
 
+  size_t n() const {
+    return n_;
+  }
+
+  const std::vector<T>& tValues() const {
+    return t_values;
+  }
+
 private:
   size_t n_;
   std::vector<T> t_values;
@@ -116,6 +128,141 @@ private:
     return generateTValues_(n, g);
   }
 };
+
+//! BraidHasher which reuses the work done for the previously hashed words.
+/*!
+  The projections of prefixes of hashed words are cached in a trie at checkpoints placed every checkpoint_step
+  letters. Hashing a word which shares a long prefix with a word hashed before (for instance, w * g after w)
+  starts from the deepest cached checkpoint. The hash values are the same as the ones of the BraidHasher with
+  the same t-values. When the trie reaches max_checkpoints nodes it is cleared.
+  The cache is modified by hashing, so an instance must not be used by several threads at once.
+ */
+template <typename T>
+class IncrementalBraidHasher {
+public:
+  using braid_hash_t = typename BraidHasher<T>::braid_hash_t;
+
+  explicit IncrementalBraidHasher(size_t n)
+      : IncrementalBraidHasher(BraidHasher<T>(n)) {}
+
+  IncrementalBraidHasher(size_t n, size_t seed)
+      : IncrementalBraidHasher(BraidHasher<T>(n, seed)) {}
+
+  //! Hashes braids as hasher does.
+  explicit IncrementalBraidHasher(
+      const BraidHasher<T>& hasher, size_t checkpoint_step = 64, size_t max_checkpoints = 1 << 14)
+      : unit_(hasher.tValues())
+      , step_(checkpoint_step)
+      , max_checkpoints_(max_checkpoints) {
+    if (step_ == 0 || max_checkpoints_ == 0) {
+      throw std::invalid_argument("Checkpoint step and the maximal number of checkpoints must be positive.");
+    }
+
+    clear();
+  }
+
+  braid_hash_t operator()(const Word& w) {
+    return std::hash<coloredburau::CBProjectionElement<T>>()(project_(w));
+  }
+
+  //! Hashes a tuple of words in one pass, the result is the same as BraidHasher::operator()(const vector<Word>&).
+  braid_hash_t operator()(const std::vector<Word>& words) {
+    std::vector<braid_hash_t> hashes;
+    hashes.reserve(words.size());
+
+    for (const auto& w : words) {
+      hashes.push_back((*this)(w));
+    }
+
+    return boost::hash_value(hashes);
+  }
+
+  //! Number of cached checkpoints (including the one for the empty word).
+  size_t checkpoints() const {
+    return nodes_.size();
+  }
+
+  void clear() {
+    nodes_.clear();
+    nodes_.push_back(Node{toState_(unit_, is_small()), {}});
+  }
+
+private:
+  using is_small = std::integral_constant<bool, finitefield::SmallFieldEncoding<T>::is_small>;
+  using state_t = typename std::conditional<
+      is_small::value, coloredburau::PackedCBProjectionElement<T>, coloredburau::CBProjectionElement<T>>::type;
+
+  //! State after the letters on the path from the root, the children are indexed by the next checkpoint_step letters.
+  struct Node {
+    state_t state;
+    std::map<std::vector<int>, size_t> children;
+  };
+
+  coloredburau::CBProjectionElement<T> unit_;
+  size_t step_;
+  size_t max_checkpoints_;
+  std::vector<Node> nodes_;
+
+  coloredburau::CBProjectionElement<T> project_(const Word& w) {
+    if (nodes_.size() >= max_checkpoints_) {
+      clear();
+    }
+
+    const std::vector<int> letters(w.begin(), w.end());
+
+    // 1. find the deepest cached checkpoint
+    size_t node = 0;
+    size_t pos = 0;
+    std::vector<int> block;
+
+    for (; pos + step_ <= letters.size(); pos += step_) {
+      block.assign(letters.begin() + pos, letters.begin() + pos + step_);
+
+      const auto child = nodes_[node].children.find(block);
+      if (child == nodes_[node].children.end()) {
+        break;
+      }
+
+      node = child->second;
+    }
+
+    // 2. multiply by the remaining letters adding new checkpoints
+    auto state = nodes_[node].state;
+
+    for (; pos + step_ <= letters.size(); pos += step_) {
+      block.assign(letters.begin() + pos, letters.begin() + pos + step_);
+      state *= Word(block);
+
+      if (nodes_.size() < max_checkpoints_) {
+        nodes_[node].children.emplace(block, nodes_.size());
+        node = nodes_.size();
+        nodes_.push_back(Node{state, {}});
+      }
+    }
+
+    state *= Word(std::vector<int>(letters.begin() + pos, letters.end()));
+
+    return fromState_(state, is_small());
+  }
+
+  static state_t toState_(const coloredburau::CBProjectionElement<T>& element, std::true_type) {
+    return state_t(element);
+  }
+
+  static state_t toState_(const coloredburau::CBProjectionElement<T>& element, std::false_type) {
+    return element;
+  }
+
+  coloredburau::CBProjectionElement<T> fromState_(const state_t& state, std::true_type) const {
+    auto result = unit_;
+    state.unpack(result);
+    return result;
+  }
+
+  coloredburau::CBProjectionElement<T> fromState_(const state_t& state, std::false_type) const {
+    return state;
+  }
+};
 } // namespace braidgroup
 } // namespace crag
 
@@ -0,0 +1,174 @@
+#pragma once
+
+#ifndef CRAG_SUMMIT_SET_H
+#define CRAG_SUMMIT_SET_H
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "Permutation.h"
+
+namespace crag {
+namespace braidgroup {
+
+//! Progress of the summit sets construction in a conjugacy check
+struct SummitSetStatistics {
+  //! Number of elements in the summit sets of the first and the second braid
+  size_t size1 = 0;
+  size_t size2 = 0;
+
+  //! Number of elements conjugated by their simple conjugators
+  size_t expanded = 0;
+
+  //! Number of expanded frontiers
+  size_t levels = 0;
+
+  bool size_limit_reached = false;
+  bool time_limit_reached = false;
+
+  std::chrono::milliseconds time = std::chrono::milliseconds(0);
+};
+
+//! Options of the summit sets construction in a conjugacy check
+struct SummitSetOptions {
+  //! If true, the summit sets of both braids are expanded until they meet (the smaller one first),
+  //! otherwise the summit set of the first braid is expanded until it contains the representative of the second one.
+  bool bidirectional = true;
+
+  //! Maximal number of elements in a summit set, 0 means no limit.
+  //! The check stops without an answer when a summit set reaches the limit.
+  size_t max_size = 0;
+
+  //! The check stops without an answer after the time bound.
+  int time_sec_bound = 999999;
+
+  //! Invoked after every expanded frontier
+  std::function<void(const SummitSetStatistics&)> progress;
+};
+
+//! Hash-indexed summit set (super summit set or ultra summit set) of a braid.
+/*!
+  Normal forms are stored as compact keys, see encode(). Every element keeps its conjugator
+  (the element is \f$C^{-1} A C\f$ for the braid A) and the period of its cycling orbit (0 if not used).
+  The elements are expanded frontier by frontier: takeFrontier() returns the elements inserted since the last call.
+  @tparam NormalForm ThLeftNormalForm or ThRightNormalForm
+ */
+template <typename NormalForm>
+class SummitSet {
+public:
+  struct Entry {
+    NormalForm conjugator;
+    int period;
+  };
+
+  SummitSet(int rank, size_t max_size)
+      : rank_(rank)
+      , max_size_(max_size) {
+    if (rank <= 0 || rank > UINT16_MAX) {
+      throw std::invalid_argument("Rank of a summit set is out of range.");
+    }
+  }
+
+  //! Compact key of a normal form: the power of \f$\Delta\f$ followed by the images of the permutations,
+  //! one byte per image if the rank is at most 256 and two bytes otherwise.
+  std::string encode(const NormalForm& nf) const {
+    const auto& decomposition = nf.getDecomposition();
+    const int power = nf.getPower();
+
+    std::string key;
+    key.reserve(sizeof(power) + decomposition.size() * rank_ * imageBytes_());
+    key.append(reinterpret_cast<const char*>(&power), sizeof(power));
+
+    for (const auto& p : decomposition) {
+      for (int i = 0; i < rank_; ++i) {
+        const int image = p[i];
+        key.push_back(static_cast<char>(image & 0xff));
+        if (imageBytes_() == 2) {
+          key.push_back(static_cast<char>(image >> 8));
+        }
+      }
+    }
+
+    return key;
+  }
+
+  NormalForm decode(const std::string& key) const {
+    int power;
+    key.copy(reinterpret_cast<char*>(&power), sizeof(power));
+
+    const size_t bytes = rank_ * imageBytes_();
+    std::vector<Permutation> decomposition;
+    decomposition.reserve((key.size() - sizeof(power)) / bytes);
+
+    std::vector<int> images(rank_);
+    for (size_t pos = sizeof(power); pos < key.size(); pos += bytes) {
+      for (int i = 0; i < rank_; ++i) {
+        const auto low = static_cast<unsigned char>(key[pos + i * imageBytes_()]);
+        images[i] = imageBytes_() == 2 ? low | (static_cast<unsigned char>(key[pos + 2 * i + 1]) << 8) : low;
+      }
+      decomposition.emplace_back(images);
+    }
+
+    return NormalForm(rank_, power, decomposition);
+  }
+
+  //! Returns the entry of the element or nullptr. Safe to call concurrently while the set is not modified.
+  const Entry* find(const NormalForm& nf) const {
+    auto entry = entries_.find(encode(nf));
+    return entry == entries_.end() ? nullptr : &entry->second;
+  }
+
+  //! Inserts a new element into the set and the frontier, returns false if the element is already in the set.
+  bool insert(const NormalForm& nf, const NormalForm& conjugator, int period = 0) {
+    auto key = encode(nf);
+    if (!entries_.emplace(key, Entry{conjugator, period}).second) {
+      return false;
+    }
+    frontier_.push_back(std::move(key));
+    return true;
+  }
+
+  //! Returns the elements inserted since the last call together with their entries.
+  std::vector<std::pair<NormalForm, Entry>> takeFrontier() {
+    std::vector<std::pair<NormalForm, Entry>> result;
+    result.reserve(frontier_.size());
+    for (const auto& key : frontier_) {
+      result.emplace_back(decode(key), entries_.at(key));
+    }
+    frontier_.clear();
+    return result;
+  }
+
+  size_t size() const {
+    return entries_.size();
+  }
+
+  size_t frontierSize() const {
+    return frontier_.size();
+  }
+
+  //! Check if the set reached the maximal size
+  bool full() const {
+    return max_size_ != 0 && entries_.size() >= max_size_;
+  }
+
+private:
+  int rank_;
+  size_t max_size_;
+  std::unordered_map<std::string, Entry> entries_;
+  std::vector<std::string> frontier_;
+
+  size_t imageBytes_() const {
+    return rank_ <= 256 ? 1 : 2;
+  }
+};
+} // namespace braidgroup
+} // namespace crag
+
+#endif // CRAG_SUMMIT_SET_H
@@ -0,0 +1,153 @@
+//! Benchmarks of the braid group hot paths for several ranks, every family is fitted against the word length.
+//!
+//! Inputs are generated from fixed seeds, so the JSON reports of two builds are comparable:
+//!     benchmark_braid_group --benchmark_out=braid_group.json --benchmark_out_format=json
+//! (or `make BraidGroup_bench`), then compare the files with tools/compare.py of Google Benchmark.
+
+#include <random>
+
+#include <benchmark/benchmark.h>
+
+#include "DehornoyForm.h"
+#include "ShortBraidForm.h"
+#include "ThLeftNormalForm.h"
+#include "ThRightNormalForm.h"
+#include "braid_group.h"
+#include "colored_burau.h"
+#include "fast_identity_check.h"
+#include "random_word.h"
+
+using crag::braidgroup::BraidGroup;
+using crag::braidgroup::FastIdentityChecker;
+
+using FF = crag::finitefield::ZZ<199>;
+using crag::coloredburau::CBElement;
+using crag::coloredburau::CBImage;
+
+static Word randomBraidWord(size_t n, size_t length, size_t seed) {
+  std::mt19937 g(seed);
+  return crag::random::randomWord(n - 1, length, g);
+}
+
+static void BM_LeftNormalForm(benchmark::State& state, size_t n) {
+  const BraidGroup G(n);
+  const auto w = randomBraidWord(n, state.range(0), 0);
+
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(ThLeftNormalForm(G, w));
+  }
+
+  state.SetComplexityN(state.range(0));
+}
+
+static void BM_RightNormalForm(benchmark::State& state, size_t n) {
+  const BraidGroup G(n);
+  const auto w = randomBraidWord(n, state.range(0), 0);
+
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(ThRightNormalForm(G, w));
+  }
+
+  state.SetComplexityN(state.range(0));
+}
+
+//! Conjugacy of a random braid and its conjugate by a random braid of the same length.
+static void BM_AreConjugate(benchmark::State& state, size_t n) {
+  const BraidGroup G(n);
+  const ThRightNormalForm a(G, randomBraidWord(n, state.range(0), 0));
+  const ThRightNormalForm c(G, randomBraidWord(n, state.range(0), 1));
+  const auto b = c * a * -c;
+
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(a.areConjugate(b));
+  }
+
+  state.SetComplexityN(state.range(0));
+}
+
+static void BM_ShortenBraid2(benchmark::State& state, size_t n) {
+  const auto w = randomBraidWord(n, state.range(0), 0);
+
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(shortenBraid2(n, w));
+  }
+
+  state.SetComplexityN(state.range(0));
+}
+
+static void BM_DehornoyForm(benchmark::State& state, size_t n) {
+  const auto w = randomBraidWord(n, state.range(0), 0);
+
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(DehornoyForm(n, w).getDehornoyForm());
+  }
+
+  state.SetComplexityN(state.range(0));
+}
+
+//! The whole word is projected whether the braid is trivial or not.
+static void BM_IsNonTrivial(benchmark::State& state, size_t n) {
+  const FastIdentityChecker<FF> checker(n, 0);
+  const auto w = randomBraidWord(n, state.range(0), 0);
+
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(checker.isNonTrivial(w));
+  }
+
+  state.SetComplexityN(state.range(0));
+}
+
+//! Image of a braid word in the colored Burau group, the generators are applied one by one.
+static void BM_CBImage(benchmark::State& state, size_t n) {
+  const auto w = randomBraidWord(n, state.range(0), 0);
+
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(CBImage<FF>(n, w));
+  }
+
+  state.SetComplexityN(state.range(0));
+}
+
+//! Product of the colored Burau images of two braid words of a half of the length each.
+static void BM_CBElementProduct(benchmark::State& state, size_t n) {
+  const auto a = CBImage<FF>(n, randomBraidWord(n, state.range(0) / 2, 0));
+  const auto b = CBImage<FF>(n, randomBraidWord(n, state.range(0) / 2, 1));
+
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(a * b);
+  }
+
+  state.SetComplexityN(state.range(0));
+}
+
+#define BRAID_BENCHMARK(name, rank, from, to) \
+  BENCHMARK_CAPTURE(name, n##rank, rank)->RangeMultiplier(10)->Range(from, to)->Complexity()->Unit(benchmark::kMicrosecond)
+
+#define BRAID_BENCHMARK_RANKS(name, from, to) \
+  BRAID_BENCHMARK(name, 4, from, to);         \
+  BRAID_BENCHMARK(name, 8, from, to);         \
+  BRAID_BENCHMARK(name, 16, from, to)
+
+// quadratic in the length, a single word of length 10^5 takes minutes
+BRAID_BENCHMARK_RANKS(BM_LeftNormalForm, 100, 10000);
+BRAID_BENCHMARK_RANKS(BM_RightNormalForm, 100, 10000);
+BRAID_BENCHMARK_RANKS(BM_ShortenBraid2, 100, 10000);
+BRAID_BENCHMARK_RANKS(BM_DehornoyForm, 100, 10000);
+
+BRAID_BENCHMARK_RANKS(BM_IsNonTrivial, 100, 100000);
+
+// polynomials of the colored Burau images grow exponentially with the length, e.g. for n = 4 the longest of them has
+// about 5 * 10^3 terms at length 100 and 4 * 10^5 at length 300, so longer words are impractical
+#define CB_BENCHMARK(name, rank, from, to) \
+  BENCHMARK_CAPTURE(name, n##rank, rank)->RangeMultiplier(2)->Range(from, to)->Complexity()->Unit(benchmark::kMicrosecond)
+
+CB_BENCHMARK(BM_CBImage, 4, 100, 300);
+CB_BENCHMARK(BM_CBImage, 8, 50, 150);
+CB_BENCHMARK(BM_CBElementProduct, 4, 50, 128);
+CB_BENCHMARK(BM_CBElementProduct, 8, 50, 100);
+
+// the super summit set grows exponentially with the rank and the length, only small inputs are feasible
+BENCHMARK_CAPTURE(BM_AreConjugate, n4, 4)->RangeMultiplier(2)->Range(8, 64)->Complexity()->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(BM_AreConjugate, n8, 8)->RangeMultiplier(2)->Range(8, 32)->Complexity()->Unit(benchmark::kMicrosecond);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,77 @@
+#include <random>
+
+#include <benchmark/benchmark.h>
+
+#include "fast_identity_check.h"
+#include "random_word.h"
+
+using FF = crag::finitefield::ZZ<7>;
+
+using crag::braidgroup::BraidHasher;
+using crag::braidgroup::IncrementalBraidHasher;
+
+//! Hashes w * g for a fixed word w and varying one-letter words g, as the enumeration of conjugates does.
+template <typename Hasher>
+static void hashExtensions(benchmark::State& state, Hasher& hasher) {
+  const size_t n = 16;
+  std::mt19937 g(0);
+
+  const auto w = crag::random::randomWord(n - 1, state.range(0), g);
+  const auto letters = crag::random::randomWord(n - 1, 1000, g);
+
+  auto letter = letters.begin();
+
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(hasher(w * Word(*letter)));
+
+    if (++letter == letters.end()) {
+      letter = letters.begin();
+    }
+  }
+}
+
+static void BM_HashExtensions(benchmark::State& state) {
+  const BraidHasher<FF> hasher(16);
+  hashExtensions(state, hasher);
+}
+
+static void BM_IncrementalHashExtensions(benchmark::State& state) {
+  IncrementalBraidHasher<FF> hasher(16);
+  hashExtensions(state, hasher);
+}
+
+//! Hashes tuples of unrelated random words, so no prefix is shared.
+template <typename Hasher>
+static void hashTuples(benchmark::State& state, Hasher& hasher) {
+  const size_t n = 16;
+  std::mt19937 g(0);
+
+  std::vector<std::vector<Word>> tuples(64);
+  for (auto& tuple : tuples) {
+    for (size_t i = 0; i < 4; ++i) {
+      tuple.push_back(crag::random::randomWord(n - 1, state.range(0), g));
+    }
+  }
+
+  size_t i = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(hasher(tuples[i++ % tuples.size()]));
+  }
+}
+
+static void BM_HashTuples(benchmark::State& state) {
+  const BraidHasher<FF> hasher(16);
+  hashTuples(state, hasher);
+}
+
+static void BM_IncrementalHashTuples(benchmark::State& state) {
+  IncrementalBraidHasher<FF> hasher(16);
+  hashTuples(state, hasher);
+}
+
+BENCHMARK(BM_HashExtensions)->RangeMultiplier(4)->Range(64, 4096);
+BENCHMARK(BM_IncrementalHashExtensions)->RangeMultiplier(4)->Range(64, 4096);
+BENCHMARK(BM_HashTuples)->RangeMultiplier(4)->Range(64, 4096);
+BENCHMARK(BM_IncrementalHashTuples)->RangeMultiplier(4)->Range(64, 4096);
+
+BENCHMARK_MAIN();
@@ -691,8 +691,8 @@ void test_nf( )
     Word w = Word::randomWord( rank-1 , 100 );
     NF nf  = NF( B , w );
     
-    list< Permutation > D = nf.getDecomposition( );
-    for( list< Permutation >::const_iterator d_it=D.begin() ; d_it!=D.end( ) ; ) {
+    vector< Permutation > D = nf.getDecomposition( );
+    for( vector< Permutation >::const_iterator d_it=D.begin() ; d_it!=D.end( ) ; ) {
       Permutation d1 = *(d_it++);
       if( d_it==D.end( ) )
 	break;
@@ -2,27 +2,36 @@
 
 #include "LinkedBraidStructure.h"
 
+#include <algorithm>
+#include <functional>
+
+constexpr BraidNode::index BraidNode::NONE;
+constexpr LinkedBraidStructure::index LinkedBraidStructure::NONE;
+
 std::ostream& operator<<(std::ostream& os, const BraidNode& bn) {
-  os << &bn << "{ " << bn.type << "| " << bn.left << ", " << bn.ahead << ", " << bn.right << ", " << bn.back_left
-     << ", " << bn.back << ", " << bn.back_right << " }";
+  os << "{ " << bn.type << "| " << bn.left << ", " << bn.ahead << ", " << bn.right << ", " << bn.back_left << ", "
+     << bn.back << ", " << bn.back_right << " }";
 
   return os;
 }
 
-LinkedBraidStructureTransform LinkedBraidStructure::make_EraseTransform(BraidNode* bn, int64_t pos) const {
-  return LinkedBraidStructureTransform(
-      bn->theNumber, pos, LinkedBraidStructureTransform::ERASED, bn->type, bn->left ? bn->left->theNumber : -1,
-      bn->ahead ? bn->ahead->theNumber : -1, bn->right ? bn->right->theNumber : -1,
-      bn->back_left ? bn->back_left->theNumber : -1, bn->back ? bn->back->theNumber : -1,
-      bn->back_right ? bn->back_right->theNumber : -1);
+LinkedBraidStructureTransform LinkedBraidStructure::make_EraseTransform(index bn, int64_t pos) const {
+  const BraidNode& n = node(bn);
+
+  LinkedBraidStructureTransform result(
+      bn, pos, LinkedBraidStructureTransform::ERASED, n.type, n.left, n.ahead, n.right, n.back_left, n.back,
+      n.back_right);
+  result.theCreationNumber = n.theNumber;
+
+  return result;
 }
 
-LinkedBraidStructureTransform LinkedBraidStructure::make_AddTransform(BraidNode* bn, int64_t pos) const {
-  return LinkedBraidStructureTransform(bn->theNumber, pos, LinkedBraidStructureTransform::ADDED, bn->type);
+LinkedBraidStructureTransform LinkedBraidStructure::make_AddTransform(index bn, int64_t pos) const {
+  return LinkedBraidStructureTransform(bn, pos, LinkedBraidStructureTransform::ADDED, node(bn).type);
 }
 
-LinkedBraidStructureTransform LinkedBraidStructure::make_ChangeType(BraidNode* bn, int64_t pos) const {
-  return LinkedBraidStructureTransform(bn->theNumber, pos, LinkedBraidStructureTransform::CHANGE_TYPE, bn->type);
+LinkedBraidStructureTransform LinkedBraidStructure::make_ChangeType(index bn, int64_t pos) const {
+  return LinkedBraidStructureTransform(bn, pos, LinkedBraidStructureTransform::CHANGE_TYPE, node(bn).type);
 }
 
 bool LinkedBraidStructure::operator<(const LinkedBraidStructure& lbs) const {
@@ -46,285 +55,231 @@ bool LinkedBraidStructure::operator<(const LinkedBraidStructure& lbs) const {
 }
 
 LinkedBraidStructure::LinkedBraidStructure(size_t N)
-    : max_node_number_(0)
-    , the_index_(N)
-    , back_nodes_(std::vector<BraidNode*>(N, nullptr))
-    , front_nodes_(std::vector<BraidNode*>(N, nullptr)) {}
+    : the_index_(N)
+    , front_nodes_(N, NONE)
+    , back_nodes_(N, NONE) {}
 
 LinkedBraidStructure::LinkedBraidStructure(size_t N, const Word& w)
-    : max_node_number_(0)
-    , the_index_(N)
-    , back_nodes_(std::vector<BraidNode*>(N, nullptr))
-    , front_nodes_(std::vector<BraidNode*>(N, nullptr)) {
+    : LinkedBraidStructure(N) {
+  nodes_.reserve(w.length());
+
   for (auto w_it = w.begin(); w_it != w.end(); ++w_it) {
     push_back(*w_it);
   }
 }
 
-LinkedBraidStructure& LinkedBraidStructure::operator=(const LinkedBraidStructure& LBS) {
-  // cout << "   #" << endl;
-
-  the_index_ = LBS.the_index_;
-  the_nodes_ = LBS.the_nodes_;
-  max_node_number_ = LBS.max_node_number_;
-  back_nodes_ = LBS.back_nodes_;
-  front_nodes_ = LBS.front_nodes_;
+void LinkedBraidStructure::assign(size_t N, const Word& w) {
+  the_index_ = N;
+  clear();
 
-  auto n_it1 = LBS.the_nodes_.begin();
-  auto n_it2 = the_nodes_.begin();
+  nodes_.reserve(w.length());
 
-  for (; n_it1 != LBS.the_nodes_.end(); ++n_it1, ++n_it2) {
-    (*n_it1).second.link = &(*n_it2).second;
+  for (auto w_it = w.begin(); w_it != w.end(); ++w_it) {
+    push_back(*w_it);
   }
+}
 
-  n_it2 = the_nodes_.begin();
-
-  for (; n_it2 != the_nodes_.end(); ++n_it2) {
-    BraidNode& cur = (*n_it2).second;
-
-    if (cur.left) {
-      cur.left = cur.left->link;
-    }
-
-    if (cur.ahead) {
-      cur.ahead = cur.ahead->link;
-    }
-
-    if (cur.right) {
-      cur.right = cur.right->link;
-    }
-
-    if (cur.back_left) {
-      cur.back_left = cur.back_left->link;
-    }
-
-    if (cur.back) {
-      cur.back = cur.back->link;
-    }
-
-    if (cur.back_right) {
-      cur.back_right = cur.back_right->link;
-    }
-  }
+LinkedBraidStructure::index LinkedBraidStructure::allocateNode(const BraidNode& bn) {
+  index result;
 
-  for (size_t i = 0; i < the_index_; ++i) {
-    if (back_nodes_[i]) {
-      back_nodes_[i] = back_nodes_[i]->link;
-    }
-
-    if (front_nodes_[i]) {
-      front_nodes_[i] = front_nodes_[i]->link;
-    }
+  if (free_nodes_.empty()) {
+    result = static_cast<index>(nodes_.size());
+    nodes_.push_back(bn);
+  } else {
+    result = free_nodes_.back();
+    free_nodes_.pop_back();
+    nodes_[result] = bn;
   }
 
-  LBS.clearLinks();
+  nodes_[result].theNumber = max_node_number_++;
 
-  return *this;
+  return result;
 }
 
-LinkedBraidStructure::LinkedBraidStructure(const LinkedBraidStructure& LBS)
-    : the_index_(LBS.the_index_)
-    , the_nodes_(LBS.the_nodes_)
-    , max_node_number_(LBS.max_node_number_)
-    , back_nodes_(LBS.back_nodes_)
-    , front_nodes_(LBS.front_nodes_) {
-  // cout << "   &" << endl;
-  auto n_it1 = LBS.the_nodes_.begin();
-  auto n_it2 = the_nodes_.begin();
-
-  for (; n_it1 != LBS.the_nodes_.end(); ++n_it1, ++n_it2) {
-    (*n_it1).second.link = &(*n_it2).second;
-  }
-
-  n_it2 = the_nodes_.begin();
+LinkedBraidStructureTransform LinkedBraidStructure::push_back(int g) {
+  int ag = std::abs(g);
+  index left = (ag > 1) ? back_nodes_[ag - 2] : NONE;
+  index ahead = back_nodes_[ag - 1];
+  index right = (ag < the_index_) ? back_nodes_[ag] : NONE;
 
-  for (; n_it2 != the_nodes_.end(); ++n_it2) {
-    BraidNode& cur = (*n_it2).second;
+  const index new_node = allocateNode(BraidNode(g > 0));
+  BraidNode& newNode = node(new_node);
 
-    if (cur.left) {
-      cur.left = cur.left->link;
-    }
+  newNode.ahead = ahead;
 
-    if (cur.ahead) {
-      cur.ahead = cur.ahead->link;
-    }
+  if (ahead != NONE) {
+    node(ahead).back = new_node;
+  }
 
-    if (cur.right) {
-      cur.right = cur.right->link;
-    }
+  if (ahead == NONE || node(ahead).back_left != NONE) {
+    newNode.left = left;
 
-    if (cur.back_left) {
-      cur.back_left = cur.back_left->link;
+    if (left != NONE) {
+      node(left).back_right = new_node;
     }
+  }
 
-    if (cur.back) {
-      cur.back = cur.back->link;
-    }
+  if (ahead == NONE || node(ahead).back_right != NONE) {
+    newNode.right = right;
 
-    if (cur.back_right) {
-      cur.back_right = cur.back_right->link;
+    if (right != NONE) {
+      node(right).back_left = new_node;
     }
   }
 
-  for (size_t i = 0; i < the_index_; ++i) {
-    if (back_nodes_[i]) {
-      back_nodes_[i] = back_nodes_[i]->link;
-    }
-
-    if (front_nodes_[i]) {
-      front_nodes_[i] = front_nodes_[i]->link;
-    }
+  if (front_nodes_[ag - 1] == NONE) {
+    front_nodes_[ag - 1] = new_node;
   }
 
-  LBS.clearLinks();
+  back_nodes_[ag - 1] = new_node;
+
+  return make_AddTransform(new_node, ag - 1);
 }
 
-LinkedBraidStructureTransform LinkedBraidStructure::push_back(int g) {
+LinkedBraidStructureTransform LinkedBraidStructure::push_front(int g) {
   int ag = std::abs(g);
-  BraidNode* left = (ag > 1) ? back_nodes_[ag - 2] : nullptr;
-  BraidNode* ahead = back_nodes_[ag - 1];
-  BraidNode* right = (ag < the_index_) ? back_nodes_[ag] : nullptr;
 
-  BraidNode& newNode = the_nodes_[max_node_number_] = BraidNode(max_node_number_, g > 0);
+  index left = (ag > 1) ? front_nodes_[ag - 2] : NONE;
+  index ahead = front_nodes_[ag - 1];
+  index right = (ag < the_index_) ? front_nodes_[ag] : NONE;
 
-  max_node_number_++;
+  const index new_node = allocateNode(BraidNode(g > 0));
+  BraidNode& newNode = node(new_node);
 
-  newNode.ahead = ahead;
+  newNode.back = ahead;
 
-  if (ahead) {
-    ahead->back = &newNode;
+  if (ahead != NONE) {
+    node(ahead).ahead = new_node;
   }
 
-  if (!ahead || ahead && ahead->back_left) {
-    newNode.left = left;
+  if (ahead == NONE || node(ahead).left != NONE) {
+    newNode.back_left = left;
 
-    if (left) {
-      left->back_right = &newNode;
+    if (left != NONE) {
+      node(left).right = new_node;
     }
   }
 
-  if (!ahead || ahead && ahead->back_right) {
-    newNode.right = right;
+  if (ahead == NONE || node(ahead).right != NONE) {
+    newNode.back_right = right;
 
-    if (right) {
-      right->back_left = &newNode;
+    if (right != NONE) {
+      node(right).left = new_node;
     }
   }
 
-  if (!front_nodes_[ag - 1]) {
-    front_nodes_[ag - 1] = &newNode;
+  if (back_nodes_[ag - 1] == NONE) {
+    back_nodes_[ag - 1] = new_node;
   }
 
-  back_nodes_[ag - 1] = &newNode;
+  front_nodes_[ag - 1] = new_node;
 
-  return make_AddTransform(&newNode, ag - 1);
+  return make_AddTransform(new_node, ag - 1);
 }
 
-LinkedBraidStructureTransform LinkedBraidStructure::push_front(int g) {
-  int ag = std::abs(g);
+void LinkedBraidStructure::clearQueue() {
+  for (auto& bucket : queue_) {
+    bucket.clear();
+  }
 
-  BraidNode* left = (ag > 1) ? front_nodes_[ag - 2] : 0;
-  BraidNode* ahead = front_nodes_[ag - 1];
-  BraidNode* right = (ag < the_index_) ? front_nodes_[ag] : 0;
+  queue_min_weight_ = 0;
+}
 
-  BraidNode& newNode = the_nodes_[max_node_number_] = BraidNode(max_node_number_, g > 0);
+void LinkedBraidStructure::enqueue(int64_t pos, index bn, int64_t weight) {
+  const auto w = static_cast<size_t>(weight);
 
-  max_node_number_++;
+  if (queue_.size() <= w) {
+    queue_.resize(w + 1);
+  }
 
-  newNode.back = ahead;
+  node(bn).stamp = ++queue_stamp_;
 
-  if (ahead) {
-    ahead->ahead = &newNode;
-  }
+  auto& bucket = queue_[w];
+  bucket.push_back(QueueEntry{pos, node(bn).theNumber, bn, queue_stamp_});
+  std::push_heap(bucket.begin(), bucket.end(), std::greater<QueueEntry>());
 
-  if (!ahead || ahead && ahead->left) {
-    newNode.back_left = left;
+  queue_min_weight_ = std::min(queue_min_weight_, w);
+}
 
-    if (left) {
-      left->right = &newNode;
-    }
-  }
+bool LinkedBraidStructure::dequeue(QueueEntry& entry) {
+  for (; queue_min_weight_ < queue_.size(); ++queue_min_weight_) {
+    auto& bucket = queue_[queue_min_weight_];
 
-  if (!ahead || ahead && ahead->right) {
-    newNode.back_right = right;
+    while (!bucket.empty()) {
+      std::pop_heap(bucket.begin(), bucket.end(), std::greater<QueueEntry>());
+      entry = bucket.back();
+      bucket.pop_back();
 
-    if (right) {
-      right->left = &newNode;
+      // skip the entries of removed nodes and the outdated entries of requeued nodes
+      if (node(entry.node).stamp == entry.stamp) {
+        node(entry.node).stamp = 0;
+        return true;
+      }
     }
   }
 
-  if (!back_nodes_[ag - 1]) {
-    back_nodes_[ag - 1] = &newNode;
-  }
-
-  front_nodes_[ag - 1] = &newNode;
-
-  return make_AddTransform(&newNode, ag - 1);
+  return false;
 }
 
 void LinkedBraidStructure::removeLeftHandles(list<LinkedBraidStructureTransform>* result) {
-  // set of nodes to check (1st value = number of uppercrossings, 2nd value =
-  // -position in the Linked Structure)
-  node_set to_check;
+  // queue of nodes to check (1st value = number of uppercrossings, 2nd value =
+  // position in the Linked Structure)
+  clearQueue();
 
   // form the initial set of nodes to check (all nodes from the Linked
   // Structure)
   for (size_t i = 0; i < the_index_; ++i) {
-    for (BraidNode* c = front_nodes_[i]; c != back_nodes_[i]; c = c->back) {
+    for (index c = front_nodes_[i]; c != back_nodes_[i]; c = node(c).back) {
       const auto weight = checkIfStartsLeftHandle(i, c);
 
       if (weight != -1) {
-        c->weight = weight;
-        to_check.insert(NODE(weight, i, c));
+        enqueue(i, c, weight);
       }
     }
   }
 
   // check the nodes one by one starting from the rightmost
-  for (; !to_check.empty();) {
-    // a. choose the node and remove it from to_check
-    NODE cur_node = *to_check.begin();
-    to_check.erase(to_check.begin());
-
-    // b. remove the handle
-    const auto weight = checkIfStartsLeftHandle(std::get<1>(cur_node), std::get<2>(cur_node));
+  for (QueueEntry cur_node; dequeue(cur_node);) {
+    // remove the handle
+    const auto weight = checkIfStartsLeftHandle(cur_node.pos, cur_node.node);
 
     if (weight != -1) {
-      removeLeftHandle(cur_node, to_check, result);
+      removeLeftHandle(cur_node.pos, cur_node.node, result);
     }
   }
 }
 
-int64_t LinkedBraidStructure::checkIfStartsLeftHandle(int64_t pos, BraidNode* bn) {
-  BraidNode* back = bn->back;
+int64_t LinkedBraidStructure::checkIfStartsLeftHandle(int64_t pos, index bn) const {
+  const BraidNode& n = node(bn);
+  index back = n.back;
 
   // if there is no more x_i
-  if (!back) {
+  if (back == NONE) {
     return -1;
   }
 
   // if there is an obstacle for handle
-  if (bn->back_right) {
+  if (n.back_right != NONE) {
     return -1;
   }
 
   // if crossings have the same orientation
-  if (bn->type == back->type) {
+  if (n.type == node(back).type) {
     return -1;
   }
 
   // compute the number of upper crossings
-  BraidNode* l1 = bn->back_left;
-  BraidNode* l2 = back->left;
+  index l1 = n.back_left;
+  index l2 = node(back).left;
 
   int64_t counter = 0;
   bool crossingType;
 
-  for (; l1; l1 = l1->back) {
+  for (; l1 != NONE; l1 = node(l1).back) {
     if (counter == 0) {
-      crossingType = l1->type;
+      crossingType = node(l1).type;
     } else {
-      if (crossingType != l1->type) {
+      if (crossingType != node(l1).type) {
         return -1;
       }
     }
@@ -339,61 +294,42 @@ int64_t LinkedBraidStructure::checkIfStartsLeftHandle(int64_t pos, BraidNode* bn
   return counter;
 }
 
-namespace {
-struct PairCmp {
-  using pair_t = std::pair<int64_t, BraidNode*>;
-  using int64_pair = std::pair<int64_t, int64_t>;
-
-  bool operator()(const pair_t& lhs, const pair_t& rhs) const {
-    return std::less<int64_pair>()(toInt64Pair(lhs), toInt64Pair(rhs));
-  }
-
-  int64_pair toInt64Pair(const pair_t& p) const {
-    return std::make_pair(p.first, p.second->theNumber);
-  }
-};
-} // namespace
-
-void LinkedBraidStructure::removeLeftHandle(
-    NODE node, node_set& to_check, std::list<LinkedBraidStructureTransform>* lst) {
-  const auto pos = std::get<1>(node);
-
-  BraidNode* n1 = std::get<2>(node);
-  BraidNode* n2 = n1->back;
+void LinkedBraidStructure::removeLeftHandle(int64_t pos, index n1, std::list<LinkedBraidStructureTransform>* lst) {
+  index n2 = node(n1).back;
 
-  bool type = n1->type;
+  bool type = node(n1).type;
 
-  BraidNode* l1 = n1->back_left;
-  BraidNode* l2 = n2->left;
+  index l1 = node(n1).back_left;
+  index l2 = node(n2).left;
 
   // Removal of a handle can introduce new handles. Here we store some nodes to
   // check. A few will be added later.
-  std::set<std::pair<int64_t, BraidNode*>, PairCmp> to_check2;
+  to_check_.clear();
 
-  if (n1->ahead) {
-    to_check2.insert(std::make_pair(pos, n1->ahead));
+  if (node(n1).ahead != NONE) {
+    to_check_.emplace_back(pos, node(n1).ahead);
   }
 
-  if (n1->left) {
-    to_check2.insert(std::make_pair(pos - 1, n1->left));
+  if (node(n1).left != NONE) {
+    to_check_.emplace_back(pos - 1, node(n1).left);
   }
 
-  for (BraidNode* cn = n1; cn; cn = cn->ahead) {
-    if (!cn->right) {
+  for (index cn = n1; cn != NONE; cn = node(cn).ahead) {
+    if (node(cn).right == NONE) {
       continue;
     }
 
-    to_check2.insert(std::make_pair(pos + 1, cn->right));
+    to_check_.emplace_back(pos + 1, node(cn).right);
 
     break;
   }
 
   // A. process left nodes
 
-  for (; l1;) {
-    BraidNode* l3 = l1->back;
-    BraidNode* new_node = insertBackRight(l1, pos, l1->type);
-    BraidNode* new_node2 = insertBackLeft(new_node, pos - 1, type);
+  for (; l1 != NONE;) {
+    index l3 = node(l1).back;
+    index new_node = insertBackRight(l1, pos, node(l1).type);
+    index new_node2 = insertBackLeft(new_node, pos - 1, type);
 
     if (lst) {
       lst->push_back(make_AddTransform(new_node, pos));
@@ -401,21 +337,18 @@ void LinkedBraidStructure::removeLeftHandle(
       lst->push_back(make_ChangeType(l1, pos));
     }
 
-    l1->type = !type;
-    to_check2.insert(std::make_pair(pos - 1, new_node2));
+    node(l1).type = !type;
+    to_check_.emplace_back(pos - 1, new_node2);
 
     if (l1 == l2) {
-      to_check2.insert(std::make_pair(pos, new_node));
+      to_check_.emplace_back(pos, new_node);
       break;
     }
 
     l1 = l3;
   }
 
-  // B. Remove "boundary" crossings that formed a handle.
-  to_check.erase(NODE(n1->weight, pos, n1));
-  to_check.erase(NODE(n2->weight, pos, n2));
-
+  // B. Remove "boundary" crossings that formed a handle (their entries in the queue become outdated).
   if (lst) {
     lst->push_back(removeNode(n1, pos));
     lst->push_back(removeNode(n2, pos));
@@ -425,85 +358,75 @@ void LinkedBraidStructure::removeLeftHandle(
   }
 
   // Check if new handles were introduced.
-  for (auto c_it = to_check2.begin(); c_it != to_check2.end(); ++c_it) {
-    const auto pos = c_it->first;
-    BraidNode* bn = c_it->second;
-
-    const auto weight = checkIfStartsLeftHandle(pos, bn);
+  for (const auto& c : to_check_) {
+    const auto weight = checkIfStartsLeftHandle(c.first, c.second);
 
     if (weight != -1) {
-      // remove old version
-      to_check.erase(NODE(bn->weight, pos, bn));
-      // add a new
-      bn->weight = weight;
-      to_check.insert(NODE(weight, pos, bn));
+      // replaces the old version
+      enqueue(c.first, c.second, weight);
     }
   }
 }
 
 void LinkedBraidStructure::removeRightHandles(list<LinkedBraidStructureTransform>* result) {
-  // set of nodes to check (1st value = number of uppercrossings, 2nd value =
+  // queue of nodes to check (1st value = number of uppercrossings, 2nd value =
   // position in the Linked Structure)
-  node_set to_check;
+  clearQueue();
 
   // form the initial set of nodes to check (all nodes from the Linked
   // Structure)
   for (size_t i = 0; i < the_index_; ++i) {
-    for (BraidNode* c = front_nodes_[i]; c != back_nodes_[i]; c = c->back) {
+    for (index c = front_nodes_[i]; c != back_nodes_[i]; c = node(c).back) {
       const auto weight = checkIfStartsRightHandle(i, c);
 
       if (weight != -1) {
-        c->weight = weight;
-        to_check.insert(NODE(weight, i, c));
+        enqueue(i, c, weight);
       }
     }
   }
 
   // check the nodes one by one starting from the rightmost
-  for (; !to_check.empty();) {
-    // choose the node and remove it from to_check
-    NODE cur_node = *to_check.begin();
-    to_check.erase(to_check.begin());
-
-    // b. remove the handle
-    const auto weight = checkIfStartsRightHandle(std::get<1>(cur_node), std::get<2>(cur_node));
+  for (QueueEntry cur_node; dequeue(cur_node);) {
+    // remove the handle
+    const auto weight = checkIfStartsRightHandle(cur_node.pos, cur_node.node);
 
     if (weight != -1) {
-      removeRightHandle(cur_node, to_check, result);
+      removeRightHandle(cur_node.pos, cur_node.node, result);
     }
   }
 }
 
-int64_t LinkedBraidStructure::checkIfStartsRightHandle(int64_t pos, BraidNode* bn) {
-  BraidNode* back = bn->back;
+int64_t LinkedBraidStructure::checkIfStartsRightHandle(int64_t pos, index bn) const {
+  const BraidNode& n = node(bn);
+  index back = n.back;
 
   // if there is no more x_i
-  if (!back) {
+  if (back == NONE) {
     return -1;
   }
 
   // if there is an obstacle for handle
-  if (bn->back_left) {
+  if (n.back_left != NONE) {
     return -1;
   }
 
   // if crossings have the same orientation
-  if (bn->type == back->type) {
+  if (n.type == node(back).type) {
     return -1;
   }
 
   // compute the number of upper crossings
-  BraidNode* l1 = bn->back_right;
-  BraidNode* l2 = back->right;
+  index l1 = n.back_right;
+  index l2 = node(back).right;
 
   int64_t counter = 0;
   bool crossingType;
 
-  for (; l1; l1 = l1->back) {
+  for (; l1 != NONE; l1 = node(l1).back) {
     if (counter == 0) {
-      crossingType = l1->type;
+      crossingType = node(l1).type;
     } else {
-      if (crossingType != l1->type) {
+      if (crossingType != node(l1).type) {
         return -1;
       }
     }
@@ -518,45 +441,41 @@ int64_t LinkedBraidStructure::checkIfStartsRightHandle(int64_t pos, BraidNode* b
   return counter;
 }
 
-void LinkedBraidStructure::removeRightHandle(NODE node, node_set& to_check, list<LinkedBraidStructureTransform>* lst) {
-  const auto pos = std::get<1>(node);
-
-  BraidNode* n1 = std::get<2>(node);
-  BraidNode* n2 = n1->back;
+void LinkedBraidStructure::removeRightHandle(int64_t pos, index n1, list<LinkedBraidStructureTransform>* lst) {
+  index n2 = node(n1).back;
 
-  bool type = n1->type;
+  bool type = node(n1).type;
 
-  BraidNode* r1 = n1->back_right;
-  BraidNode* r2 = n2->right;
+  index r1 = node(n1).back_right;
+  index r2 = node(n2).right;
 
   // Removal of a handle can introduce new handles. Here we store some nodes to
   // check. A few will be added later.
-  std::set<std::pair<int64_t, BraidNode*>, PairCmp> to_check2;
+  to_check_.clear();
 
-  if (n1->ahead) {
-    to_check2.insert(std::make_pair(pos, n1->ahead));
+  if (node(n1).ahead != NONE) {
+    to_check_.emplace_back(pos, node(n1).ahead);
   }
 
-  if (n1->right) {
-    to_check2.insert(std::make_pair(pos + 1, n1->right));
+  if (node(n1).right != NONE) {
+    to_check_.emplace_back(pos + 1, node(n1).right);
   }
 
-  for (BraidNode* cn = n1; cn; cn = cn->ahead) {
-    if (!cn->left) {
+  for (index cn = n1; cn != NONE; cn = node(cn).ahead) {
+    if (node(cn).left == NONE) {
       continue;
     }
 
-    to_check2.insert(std::make_pair(pos - 1, cn->left));
+    to_check_.emplace_back(pos - 1, node(cn).left);
 
     break;
   }
 
   // B. process right nodes
-  for (; r1;) {
-    // cout << "Process right node" << endl;
-    BraidNode* r3 = r1->back;
-    BraidNode* new_node = insertBackLeft(r1, pos, r1->type);
-    BraidNode* new_node2 = insertBackRight(new_node, pos + 1, type);
+  for (; r1 != NONE;) {
+    index r3 = node(r1).back;
+    index new_node = insertBackLeft(r1, pos, node(r1).type);
+    index new_node2 = insertBackRight(new_node, pos + 1, type);
 
     if (lst) {
       lst->push_back(make_AddTransform(new_node, pos));
@@ -564,22 +483,19 @@ void LinkedBraidStructure::removeRightHandle(NODE node, node_set& to_check, list
       lst->push_back(make_ChangeType(r1, pos));
     }
 
-    r1->type = !type;
+    node(r1).type = !type;
 
-    to_check2.insert(std::make_pair(pos + 1, new_node2));
+    to_check_.emplace_back(pos + 1, new_node2);
 
     if (r1 == r2) {
-      to_check2.insert(std::make_pair(pos, new_node));
+      to_check_.emplace_back(pos, new_node);
       break;
     }
 
     r1 = r3;
   }
 
-  // B. Remove "boundary" crossings that formed a handle.
-  to_check.erase(NODE(n1->weight, pos, n1));
-  to_check.erase(NODE(n2->weight, pos, n2));
-
+  // B. Remove "boundary" crossings that formed a handle (their entries in the queue become outdated).
   if (lst) {
     lst->push_back(removeNode(n1, pos));
     lst->push_back(removeNode(n2, pos));
@@ -589,327 +505,334 @@ void LinkedBraidStructure::removeRightHandle(NODE node, node_set& to_check, list
   }
 
   // Check if new handles were introduced.
-  for (auto c_it = to_check2.begin(); c_it != to_check2.end(); ++c_it) {
-    const auto pos = c_it->first;
-    BraidNode* bn = c_it->second;
-
-    const auto weight = checkIfStartsRightHandle(pos, bn);
+  for (const auto& c : to_check_) {
+    const auto weight = checkIfStartsRightHandle(c.first, c.second);
 
     if (weight != -1) {
-      // remove old version
-      to_check.erase(NODE(bn->weight, pos, bn));
-      // add a new
-      bn->weight = weight;
-      to_check.insert(NODE(weight, pos, bn));
+      // replaces the old version
+      enqueue(c.first, c.second, weight);
     }
   }
 }
 
-LinkedBraidStructureTransform LinkedBraidStructure::removeNode(BraidNode* bn, int64_t pos) {
+LinkedBraidStructureTransform LinkedBraidStructure::removeNode(index bn, int64_t pos) {
   LinkedBraidStructureTransform result = make_EraseTransform(bn, pos);
 
+  // the neighbours are modified below, the node itself is not
+  const BraidNode n = node(bn);
+
   // A. process left
-  if (bn->left) {
-    bn->left->back_right = bn->back_left ? nullptr : bn->back;
+  if (n.left != NONE) {
+    node(n.left).back_right = n.back_left != NONE ? NONE : n.back;
   }
 
   // B. process ahead
-  if (bn->ahead) {
-    bn->ahead->back = bn->back;
+  if (n.ahead != NONE) {
+    BraidNode& ahead = node(n.ahead);
+    ahead.back = n.back;
 
-    if (!bn->ahead->back_left) {
-      bn->ahead->back_left = bn->back_left;
+    if (ahead.back_left == NONE) {
+      ahead.back_left = n.back_left;
     }
 
-    if (!bn->ahead->back_right) {
-      bn->ahead->back_right = bn->back_right;
+    if (ahead.back_right == NONE) {
+      ahead.back_right = n.back_right;
     }
   }
 
   // C. process right
-  if (bn->right) {
-    bn->right->back_left = bn->back_right ? nullptr : bn->back;
+  if (n.right != NONE) {
+    node(n.right).back_left = n.back_right != NONE ? NONE : n.back;
   }
 
   // D. process back_left
-  if (bn->back_left) {
-    bn->back_left->right = bn->left ? nullptr : bn->ahead;
+  if (n.back_left != NONE) {
+    node(n.back_left).right = n.left != NONE ? NONE : n.ahead;
   }
 
   // E. process back
-  if (bn->back) {
-    bn->back->ahead = bn->ahead;
+  if (n.back != NONE) {
+    BraidNode& back = node(n.back);
+    back.ahead = n.ahead;
 
-    if (!bn->back->left) {
-      bn->back->left = bn->left;
+    if (back.left == NONE) {
+      back.left = n.left;
     }
 
-    if (!bn->back->right) {
-      bn->back->right = bn->right;
+    if (back.right == NONE) {
+      back.right = n.right;
     }
   }
 
   // F. process back_right
-  if (bn->back_right) {
-    bn->back_right->left = bn->right ? nullptr : bn->ahead;
+  if (n.back_right != NONE) {
+    node(n.back_right).left = n.right != NONE ? NONE : n.ahead;
   }
 
   // G. process front_nodes_ and back_nodes_
   if (front_nodes_[pos] == bn) {
-    front_nodes_[pos] = bn->back;
+    front_nodes_[pos] = n.back;
   }
 
   if (back_nodes_[pos] == bn) {
-    back_nodes_[pos] = bn->ahead;
+    back_nodes_[pos] = n.ahead;
   }
 
-  // H. finally delet the memory allocated for the node
-  the_nodes_.erase(bn->theNumber);
+  // H. finally release the slot of the node
+  node(bn).stamp = 0;
+  free_nodes_.push_back(bn);
 
   return result;
 }
 
-BraidNode* LinkedBraidStructure::insertBackLeft(BraidNode* bn, int64_t pos, bool type) {
+LinkedBraidStructure::index LinkedBraidStructure::insertBackLeft(index bn, int64_t pos, bool type) {
   // A. determine the "main" nodes around the new node
-  BraidNode* back = bn->back;
+  index back = node(bn).back;
 
-  BraidNode* left = nullptr;
+  index left = NONE;
 
-  for (BraidNode* c = bn; c != nullptr && !left; c = c->ahead) {
-    if (c->left) {
-      left = c->left;
+  for (index c = bn; c != NONE && left == NONE; c = node(c).ahead) {
+    if (node(c).left != NONE) {
+      left = node(c).left;
     }
   }
 
-  BraidNode* back_left = nullptr;
+  index back_left = NONE;
 
-  for (BraidNode* c = bn; c != nullptr && !back_left; c = c->back) {
-    if (c->back_left) {
-      back_left = c->back_left;
+  for (index c = bn; c != NONE && back_left == NONE; c = node(c).back) {
+    if (node(c).back_left != NONE) {
+      back_left = node(c).back_left;
     }
   }
 
-  BraidNode* left_back_left;
+  index left_back_left;
 
-  if (left) {
-    left_back_left = left->back_left;
-  } else if (back_left) {
-    if (!back_left->left) {
-      left_back_left = nullptr;
+  if (left != NONE) {
+    left_back_left = node(left).back_left;
+  } else if (back_left != NONE) {
+    if (node(back_left).left == NONE) {
+      left_back_left = NONE;
     } else {
-      left_back_left = pos > 0 ? front_nodes_[pos - 1] : nullptr;
+      left_back_left = pos > 0 ? front_nodes_[pos - 1] : NONE;
     }
   } else {
-    left_back_left = pos > 0 ? front_nodes_[pos - 1] : nullptr;
+    left_back_left = pos > 0 ? front_nodes_[pos - 1] : NONE;
   }
 
-  BraidNode* back_left_right;
+  index back_left_right;
 
-  if (back_left) {
-    back_left_right = back_left->right != bn ? bn->back : nullptr;
+  if (back_left != NONE) {
+    back_left_right = node(back_left).right != bn ? node(bn).back : NONE;
   } else {
     back_left_right = back;
   }
 
   // B. create a new node and link it to other nodes
-  BraidNode& newNode = the_nodes_[max_node_number_] =
-      BraidNode(max_node_number_, type, nullptr, left, bn, left_back_left, back_left, back_left_right);
+  const index new_node = allocateNode(BraidNode(type, NONE, left, bn, left_back_left, back_left, back_left_right));
 
-  max_node_number_++;
+  node(bn).back_left = new_node;
 
-  bn->back_left = &newNode;
-
-  if (left) {
-    left->back = &newNode;
-    left->back_left = nullptr;
+  if (left != NONE) {
+    node(left).back = new_node;
+    node(left).back_left = NONE;
   }
 
-  if (back_left) {
-    back_left->ahead = &newNode;
-    back_left->right = back_left->right == bn ? nullptr : back_left->right;
+  if (back_left != NONE) {
+    node(back_left).ahead = new_node;
+    node(back_left).right = node(back_left).right == bn ? NONE : node(back_left).right;
   }
 
-  if (left_back_left) {
-    left_back_left->right = &newNode;
+  if (left_back_left != NONE) {
+    node(left_back_left).right = new_node;
   }
 
-  if (back_left_right) {
-    back_left_right->left = &newNode;
+  if (back_left_right != NONE) {
+    node(back_left_right).left = new_node;
   }
 
-  if (!newNode.back) {
-    back_nodes_[pos] = &newNode;
+  if (node(new_node).back == NONE) {
+    back_nodes_[pos] = new_node;
   }
 
-  if (!newNode.ahead) {
-    front_nodes_[pos] = &newNode;
+  if (node(new_node).ahead == NONE) {
+    front_nodes_[pos] = new_node;
   }
 
-  return &newNode;
+  return new_node;
 }
 
-BraidNode* LinkedBraidStructure::insertBackRight(BraidNode* bn, int64_t pos, bool type) {
+LinkedBraidStructure::index LinkedBraidStructure::insertBackRight(index bn, int64_t pos, bool type) {
   // A. determine the "main" nodes around the new node
-  BraidNode* back = bn->back;
+  index back = node(bn).back;
 
-  BraidNode* right = nullptr;
+  index right = NONE;
 
-  for (BraidNode* c = bn; c != nullptr && !right; c = c->ahead) {
-    if (c->right) {
-      right = c->right;
+  for (index c = bn; c != NONE && right == NONE; c = node(c).ahead) {
+    if (node(c).right != NONE) {
+      right = node(c).right;
     }
   }
 
-  BraidNode* back_right = nullptr;
+  index back_right = NONE;
 
-  for (BraidNode* c = bn; c != nullptr && !back_right; c = c->back) {
-    if (c->back_right) {
-      back_right = c->back_right;
+  for (index c = bn; c != NONE && back_right == NONE; c = node(c).back) {
+    if (node(c).back_right != NONE) {
+      back_right = node(c).back_right;
     }
   }
 
-  BraidNode* right_back_right;
+  index right_back_right;
 
-  if (right) {
-    right_back_right = right->back_right;
-  } else if (back_right) {
-    if (!back_right->right) {
-      right_back_right = nullptr;
+  if (right != NONE) {
+    right_back_right = node(right).back_right;
+  } else if (back_right != NONE) {
+    if (node(back_right).right == NONE) {
+      right_back_right = NONE;
     } else {
-      right_back_right = (pos + 1 < the_index_) ? front_nodes_[pos + 1] : nullptr;
+      right_back_right = (pos + 1 < the_index_) ? front_nodes_[pos + 1] : NONE;
     }
   } else {
-    right_back_right = (pos + 1 < the_index_) ? front_nodes_[pos + 1] : nullptr;
+    right_back_right = (pos + 1 < the_index_) ? front_nodes_[pos + 1] : NONE;
   }
 
-  BraidNode* back_right_left;
-  if (back_right) {
-    back_right_left = back_right->left != bn ? bn->back : nullptr;
+  index back_right_left;
+  if (back_right != NONE) {
+    back_right_left = node(back_right).left != bn ? node(bn).back : NONE;
   } else {
     back_right_left = back;
   }
 
   // B. create a new node and link it to other nodes
-  BraidNode& newNode = the_nodes_[max_node_number_] =
-      BraidNode(max_node_number_, type, bn, right, nullptr, back_right_left, back_right, right_back_right);
-
-  max_node_number_++;
+  const index new_node = allocateNode(BraidNode(type, bn, right, NONE, back_right_left, back_right, right_back_right));
 
-  bn->back_right = &newNode;
+  node(bn).back_right = new_node;
 
-  if (right) {
-    right->back = &newNode;
-    right->back_right = nullptr;
+  if (right != NONE) {
+    node(right).back = new_node;
+    node(right).back_right = NONE;
   }
 
-  if (back_right) {
-    back_right->ahead = &newNode;
-    back_right->left = back_right->left == bn ? nullptr : back_right->left;
+  if (back_right != NONE) {
+    node(back_right).ahead = new_node;
+    node(back_right).left = node(back_right).left == bn ? NONE : node(back_right).left;
   }
 
-  if (back_right_left) {
-    back_right_left->right = &newNode;
+  if (back_right_left != NONE) {
+    node(back_right_left).right = new_node;
   }
 
-  if (right_back_right) {
-    right_back_right->left = &newNode;
+  if (right_back_right != NONE) {
+    node(right_back_right).left = new_node;
   }
 
   // update back_nodes_ and front_nodes_
-  if (!newNode.back) {
-    back_nodes_[pos] = &newNode;
+  if (node(new_node).back == NONE) {
+    back_nodes_[pos] = new_node;
   }
 
-  if (!newNode.ahead) {
-    front_nodes_[pos] = &newNode;
+  if (node(new_node).ahead == NONE) {
+    front_nodes_[pos] = new_node;
   }
 
-  return &newNode;
+  return new_node;
 }
 
-BraidNode* LinkedBraidStructure::insert(const LinkedBraidStructureTransform& lbst) {
-  BraidNode& newNode = the_nodes_[lbst.theNumber] = BraidNode(
-      lbst.theNumber, lbst.type, lbst.left == -1 ? nullptr : &the_nodes_[lbst.left],
-      lbst.ahead == -1 ? nullptr : &the_nodes_[lbst.ahead], lbst.right == -1 ? nullptr : &the_nodes_[lbst.right],
-      lbst.back_left == -1 ? nullptr : &the_nodes_[lbst.back_left], lbst.back == -1 ? nullptr : &the_nodes_[lbst.back],
-      lbst.back_right == -1 ? nullptr : &the_nodes_[lbst.back_right]);
+LinkedBraidStructure::index LinkedBraidStructure::insert(const LinkedBraidStructureTransform& lbst) {
+  // the node gets back its slot, which is free at this moment
+  const auto new_node = static_cast<index>(lbst.theNumber);
+
+  if (new_node >= nodes_.size()) {
+    for (auto i = static_cast<index>(nodes_.size()); i < new_node; ++i) {
+      free_nodes_.push_back(i);
+    }
+    nodes_.resize(new_node + 1);
+  } else {
+    free_nodes_.erase(std::find(free_nodes_.begin(), free_nodes_.end(), new_node));
+  }
+
+  BraidNode& newNode = node(new_node) = BraidNode(
+      lbst.type, static_cast<index>(lbst.left), static_cast<index>(lbst.ahead), static_cast<index>(lbst.right),
+      static_cast<index>(lbst.back_left), static_cast<index>(lbst.back), static_cast<index>(lbst.back_right));
+  newNode.theNumber = lbst.theCreationNumber;
 
   // A. determine the "main" nodes around the new node
-  if (newNode.left) {
-    newNode.left->back_right = &newNode;
+  if (newNode.left != NONE) {
+    node(newNode.left).back_right = new_node;
   }
 
-  if (newNode.ahead) {
-    newNode.ahead->back = &newNode;
+  if (newNode.ahead != NONE) {
+    node(newNode.ahead).back = new_node;
 
-    if (!newNode.left) {
-      newNode.ahead->back_left = nullptr;
+    if (newNode.left == NONE) {
+      node(newNode.ahead).back_left = NONE;
     }
 
-    if (!newNode.right) {
-      newNode.ahead->back_right = nullptr;
+    if (newNode.right == NONE) {
+      node(newNode.ahead).back_right = NONE;
     }
   }
 
-  if (newNode.right) {
-    newNode.right->back_left = &newNode;
+  if (newNode.right != NONE) {
+    node(newNode.right).back_left = new_node;
   }
 
-  if (newNode.back_left) {
-    newNode.back_left->right = &newNode;
+  if (newNode.back_left != NONE) {
+    node(newNode.back_left).right = new_node;
   }
 
-  if (newNode.back) {
-    newNode.back->ahead = &newNode;
+  if (newNode.back != NONE) {
+    node(newNode.back).ahead = new_node;
 
-    if (!newNode.back_left) {
-      newNode.back->left = nullptr;
+    if (newNode.back_left == NONE) {
+      node(newNode.back).left = NONE;
     }
 
-    if (!newNode.back_right) {
-      newNode.back->right = nullptr;
+    if (newNode.back_right == NONE) {
+      node(newNode.back).right = NONE;
     }
   }
 
-  if (newNode.back_right) {
-    newNode.back_right->left = &newNode;
+  if (newNode.back_right != NONE) {
+    node(newNode.back_right).left = new_node;
   }
 
   // B. update back_nodes_ and front_nodes_
-  if (!newNode.back) {
-    back_nodes_[lbst.thePosition] = &newNode;
+  if (newNode.back == NONE) {
+    back_nodes_[lbst.thePosition] = new_node;
   }
 
-  if (!newNode.ahead) {
-    front_nodes_[lbst.thePosition] = &newNode;
+  if (newNode.ahead == NONE) {
+    front_nodes_[lbst.thePosition] = new_node;
   }
 
-  return &newNode;
+  return new_node;
 }
 
-void LinkedBraidStructure::processTree(int al, BraidNode* node, Word& result) const {
-  if (node->back_left && !node->back_left->link) {
-    processTree(al - 1, node->back_left, result);
+void LinkedBraidStructure::processTree(int al, index nd, Word& result) const {
+  const BraidNode& n = node(nd);
+
+  if (n.back_left != NONE && !node(n.back_left).visited) {
+    processTree(al - 1, n.back_left, result);
   }
 
-  if (node->back_right && !node->back_right->link) {
-    processTree(al + 1, node->back_right, result);
+  if (n.back_right != NONE && !node(n.back_right).visited) {
+    processTree(al + 1, n.back_right, result);
   }
 
-  if (node->back && !node->back->link) {
-    processTree(al, node->back, result);
+  if (n.back != NONE && !node(n.back).visited) {
+    processTree(al, n.back, result);
   }
 
-  result.push_front(node->type ? al : -al);
+  result.push_front(n.type ? al : -al);
 
-  node->link = node;
+  n.visited = true;
 }
 
 Word LinkedBraidStructure::translateIntoWord() const {
   Word result;
 
   for (size_t i = 0; i < the_index_; ++i) {
-    if (front_nodes_[i] && !front_nodes_[i]->link) {
+    if (front_nodes_[i] != NONE && !node(front_nodes_[i]).visited) {
       processTree(i + 1, front_nodes_[i], result);
     }
   }
@@ -920,18 +843,17 @@ Word LinkedBraidStructure::translateIntoWord() const {
 }
 
 void LinkedBraidStructure::clearLinks() const {
-  auto n_it = the_nodes_.begin();
-
-  for (; n_it != the_nodes_.end(); ++n_it) {
-    (*n_it).second.link = nullptr;
+  for (const auto& n : nodes_) {
+    n.visited = false;
   }
 }
 
 void LinkedBraidStructure::clear() {
-  the_nodes_.clear();
+  nodes_.clear();
+  free_nodes_.clear();
 
-  front_nodes_ = std::vector<BraidNode*>(the_index_, nullptr);
-  back_nodes_ = std::vector<BraidNode*>(the_index_, nullptr);
+  front_nodes_.assign(the_index_, NONE);
+  back_nodes_.assign(the_index_, NONE);
 }
 
 void LinkedBraidStructure::undo(const std::list<LinkedBraidStructureTransform>& lbst_seq) {
@@ -944,11 +866,11 @@ void LinkedBraidStructure::undo(const std::list<LinkedBraidStructureTransform>&
 
 void LinkedBraidStructure::undo(const LinkedBraidStructureTransform& lbst) {
   if (lbst.theTransform == LinkedBraidStructureTransform::ADDED) {
-    removeNode(&the_nodes_[lbst.theNumber], lbst.thePosition);
+    removeNode(static_cast<index>(lbst.theNumber), lbst.thePosition);
   } else if (lbst.theTransform == LinkedBraidStructureTransform::ERASED) {
     insert(lbst);
   } else if (lbst.theTransform == LinkedBraidStructureTransform::CHANGE_TYPE) {
-    the_nodes_[lbst.theNumber].type = lbst.type;
+    node(static_cast<index>(lbst.theNumber)).type = lbst.type;
   }
 }
 
@@ -4,6 +4,7 @@
 #include "LinkedBraidStructure.h"
 #include "ThRightNormalForm.h"
 #include "braid_group.h"
+#include "parallel.h"
 
 LinkedBraidStructure shortenLBS(LinkedBraidStructure& lbs) {
   LinkedBraidStructure result = lbs;
@@ -32,8 +33,12 @@ Word garsideDehornoy(int N, const Word& w) {
 }
 
 Word shortenBraid(int N, const Word& w) {
-  LinkedBraidStructure df(N - 1, w);
-  LinkedBraidStructure result = df;
+  // The structures are reused by the subsequent calls in the same thread, so their memory is allocated only once
+  thread_local LinkedBraidStructure df(0);
+  thread_local LinkedBraidStructure result(0);
+
+  df.assign(N - 1, w);
+  result = df;
 
   for (int i = 0; i < 4; ++i) {
     if (i % 2 == 0) {
@@ -90,6 +95,14 @@ Word shortenBraid2(int n, const Word& w) {
   return result_word;
 }
 
+std::vector<Word> shortenBraids(int n, const std::vector<Word>& words) {
+  std::vector<Word> result(words.size());
+
+  crag::parallel::forEach(words.size(), [&](size_t i) { result[i] = shortenBraid2(n, words[i]); });
+
+  return result;
+}
+
 Word shortBraidForm(int N, const Word& w) {
   crag::braidgroup::BraidGroup B(N);
   ThRightNormalForm NF(B, w);
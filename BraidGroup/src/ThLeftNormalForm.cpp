@@ -8,19 +8,22 @@
 
 
 #include <algorithm>
+#include <stdexcept>
 #include "ThLeftNormalForm.h"
 #include "ThRightNormalForm.h"
 #include "braid_group.h"
 #include "Word.h"
+#include "parallel.h"
+#include <chrono>
 #include <time.h>
 
 
 ostream& operator << ( ostream& os, const ThLeftNormalForm& rep )
 {
-  const list< Permutation >& decomposition = rep.getDecomposition( );
+  const vector< Permutation >& decomposition = rep.getDecomposition( );
   
   os << "Power = " << rep.getPower( ) << endl;
-  list< Permutation >::const_iterator it = decomposition.begin( );
+  vector< Permutation >::const_iterator it = decomposition.begin( );
   for( ; it!=decomposition.end( ) ; ++it )
     os << (*it) << endl;
   os << "Rank = "  << rep.getRank ( ) << endl;
@@ -42,8 +45,8 @@ ThLeftNormalForm::operator ThRightNormalForm( ) const
     return nf;
   }
   
-  list< Permutation > D;
-  for( list< Permutation >::const_iterator d_it=theDecomposition.begin( ) ; d_it!=theDecomposition.end( ) ; ++d_it )
+  vector< Permutation > D;
+  for( vector< Permutation >::const_iterator d_it=theDecomposition.begin( ) ; d_it!=theDecomposition.end( ) ; ++d_it )
     D.push_back( (*d_it).flip( ) );
   
   ThRightNormalForm nf( theRank , theOmegaPower , D );
@@ -72,18 +75,45 @@ bool ThLeftNormalForm::operator==( const ThLeftNormalForm& rep ) const
 
 
 ThLeftNormalForm::ThLeftNormalForm( const crag::braidgroup::BraidGroup& G , const Word& w ) :
-  theRank( G.getRank( ) )
+  theRank( G.getRank( ) ) ,
+  theOmegaPower( 0 )
 {
-  Word reversed_w;
-  for( Word::const_iterator w_it=w.begin( ) ; w_it!=w.end( ) ; ++w_it )
-    reversed_w.push_front( *w_it );
-  ThRightNormalForm F( G , reversed_w );
-  
-  NF pr ( theRank , F.getPower() , F.getDecomposition( ) );
-  reverse( pr );
-  
-  theOmegaPower = pr.second;
-  theDecomposition = pr.third;
+  const Permutation omega = Permutation::getHalfTwistPermutation( theRank );
+
+  // A negative block is processed as s^{-1} = (s^{-1} \Delta) \Delta^{-1}. Moving \Delta^{-1}
+  // to the left flips the permutations, so the decomposition is kept flipped if "flipped" is true,
+  // and the permutations are flipped once at the end.
+  bool flipped = false;
+
+  // The letters of a block of the same sign are collected into a permutation braid s.
+  // For a positive block curMult is s^{-1}, for a negative one curMult is s.
+  Permutation curMult( theRank );
+  bool negative = false;
+
+  auto appendBlock = [&] ( ) {
+    if( curMult.isTrivial( ) )
+      return;
+    Permutation s = negative ? -curMult * omega : -curMult;
+    appendSimple( theRank , theOmegaPower , theDecomposition , flipped ? s.flip( ) : s );
+    if( negative ) {
+      --theOmegaPower;
+      flipped = !flipped;
+    }
+    curMult = Permutation( theRank );
+  };
+
+  for( Word::const_iterator w_it=w.begin( ) ; w_it!=w.end( ) ; ++w_it ) {
+    const int gen = abs( *w_it );
+    if( ( *w_it<0 )!=negative || curMult[gen-1]>curMult[gen] ) {
+      appendBlock( );
+      negative = *w_it<0;
+    }
+    curMult.change( gen-1 , gen );
+  }
+  appendBlock( );
+
+  if( flipped )
+    flip( theDecomposition );
 }
 
 
@@ -94,10 +124,11 @@ ThLeftNormalForm::ThLeftNormalForm( const crag::braidgroup::BraidGroup& G , cons
 
 void ThLeftNormalForm::reverse( ThLeftNormalForm::NF& pr )
 {
-  list<Permutation> rev_list;
-  list<Permutation>::iterator it = pr.third.begin( );
-  for( ; it!=pr.third.end( ) ; ++it )
-    rev_list.push_front( -*it );
+  vector<Permutation> rev_list;
+  rev_list.reserve( pr.third.size( ) );
+  vector<Permutation>::reverse_iterator it = pr.third.rbegin( );
+  for( ; it!=pr.third.rend( ) ; ++it )
+    rev_list.push_back( -*it );
   pr.third = rev_list;
 }
 
@@ -107,7 +138,7 @@ void ThLeftNormalForm::reverse( ThLeftNormalForm::NF& pr )
 //---------------------------------------------------------------------------//
 
 
-void ThLeftNormalForm::adjustDecomposition( int rank , int& power , list<Permutation>& decomp )
+void ThLeftNormalForm::adjustDecomposition( int rank , int& power , vector<Permutation>& decomp )
 {
   NF pr( rank , power , decomp );
   reverse( pr );
@@ -117,6 +148,104 @@ void ThLeftNormalForm::adjustDecomposition( int rank , int& power , list<Permuta
   decomp = pr.third;
 }
 
+//---------------------------------------------------------------------------//
+//------------------------------ appendSimple -------------------------------//
+//---------------------------------------------------------------------------//
+
+
+void ThLeftNormalForm::appendSimple( int rank , int& power , vector<Permutation>& decomp , const Permutation& s )
+{
+  if( s.isTrivial( ) )
+    return;
+
+  const Permutation omega = Permutation::getHalfTwistPermutation( rank );
+
+  // X \Delta = \Delta \tau(X)
+  if( s==omega ) {
+    flip( decomp );
+    ++power;
+    return;
+  }
+
+  // make the pairs left-weighted from the right to the left while they change
+  decomp.push_back( s );
+  for( size_t i=decomp.size( )-1 ; i>0 ; --i ) {
+    transformationResult tr_res = transform( rank , decomp[i-1] , decomp[i] );
+    if( tr_res==NO_CHANGE )
+      break;
+    // only the last permutation can be absorbed
+    if( tr_res==ONE_MULTIPLIER )
+      decomp.pop_back( );
+  }
+
+  // the half twists can appear at the beginning only
+  size_t omegas = 0;
+  for( ; omegas<decomp.size( ) && decomp[omegas]==omega ; ++omegas )
+    ;
+  if( omegas>0 ) {
+    power += omegas;
+    decomp.erase( decomp.begin( ) , decomp.begin( )+omegas );
+  }
+}
+
+
+void ThLeftNormalForm::appendSimple( const Permutation& s )
+{
+  appendSimple( theRank , theOmegaPower , theDecomposition , s );
+}
+
+
+void ThLeftNormalForm::appendGenerator( int g )
+{
+  if( g==0 || abs( g )>=theRank )
+    throw invalid_argument( "Generator is out of range." );
+
+  Permutation s( theRank );
+  s.change( abs( g )-1 , abs( g ) );
+  if( g>0 ) {
+    appendSimple( theRank , theOmegaPower , theDecomposition , s );
+    return;
+  }
+
+  // x^{-1} = (x^{-1} \Delta) \Delta^{-1} and X \Delta^{-1} = \Delta^{-1} \tau(X)
+  appendSimple( theRank , theOmegaPower , theDecomposition , s * Permutation::getHalfTwistPermutation( theRank ) );
+  flip( theDecomposition );
+  --theOmegaPower;
+}
+
+
+//---------------------------------------------------------------------------//
+//------------------------------- transform ---------------------------------//
+//---------------------------------------------------------------------------//
+
+
+// finds the longest head of p2 
+// that can be multiplied by p1 on the right
+ThLeftNormalForm::transformationResult
+ThLeftNormalForm::transform( int theRank , Permutation& p1 , Permutation& p2 )
+{
+  transformationResult res = TWO_MULTIPLIERS;
+  const Permutation omega = Permutation::getHalfTwistPermutation( theRank );
+
+  Permutation p3 = ( -p1 * omega ).LeftGCD( p2 );
+  if( p3==p2 )
+    res = ONE_MULTIPLIER;
+  if( p3.isTrivial( ) )
+    res = NO_CHANGE;
+  p1 *= p3;
+  p2 = -p3 * p2;
+
+  return res;
+}
+
+
+void ThLeftNormalForm::flip( vector<Permutation>& decomp )
+{
+  for( vector<Permutation>::iterator it=decomp.begin( ) ; it!=decomp.end( ) ; ++it )
+    *it = (*it).flip( );
+}
+
+
 //---------------------------------------------------------------------------//
 //------------------------------- inverse -----------------------------------//
 //---------------------------------------------------------------------------//
@@ -140,18 +269,24 @@ ThLeftNormalForm ThLeftNormalForm::inverse( ) const
 
 ThLeftNormalForm ThLeftNormalForm::multiply( const ThLeftNormalForm& rep ) const
 {
-  NF pr1 = *this;
-  reverse( pr1 );
-  ThRightNormalForm rightNF1 = pr1;
+  ThLeftNormalForm result( *this );
+  result *= rep;
+  return result;
+}
 
-  NF pr2 = rep;
-  reverse( pr2 );
-  ThRightNormalForm rightNF2 = pr2;
-  
-  pr1 = rightNF2 * rightNF1;
-  reverse( pr1 );
-  
-  return pr1;
+
+ThLeftNormalForm& ThLeftNormalForm::operator *= ( const ThLeftNormalForm& rep )
+{
+  // \Delta^p X \Delta^q Y = \Delta^{p+q} \tau^q(X) Y, the permutations of Y are appended one by one
+  if( rep.theOmegaPower%2!=0 )
+    flip( theDecomposition );
+  theOmegaPower += rep.theOmegaPower;
+
+  theDecomposition.reserve( theDecomposition.size( )+rep.theDecomposition.size( ) );
+  for( vector< Permutation >::const_iterator it=rep.theDecomposition.begin( ) ; it!=rep.theDecomposition.end( ) ; ++it )
+    appendSimple( theRank , theOmegaPower , theDecomposition , *it );
+
+  return *this;
 }
 
 
@@ -265,7 +400,7 @@ pair< ThLeftNormalForm , ThLeftNormalForm > ThLeftNormalForm::cycle( ) const
   if( theOmegaPower%2!=0 )
     first = first.flip( );
   result.theDecomposition.push_back( first );
-  result.theDecomposition.pop_front( );
+  result.theDecomposition.erase( result.theDecomposition.begin( ) );
   result.adjust( );
   
   return pair< ThLeftNormalForm , ThLeftNormalForm >( result , ThLeftNormalForm(first) );
@@ -284,11 +419,11 @@ pair< ThLeftNormalForm , ThLeftNormalForm > ThLeftNormalForm::decycle( ) const
   
   ThLeftNormalForm result = *this;
   Permutation last = *(--theDecomposition.end( ));
+  result.theDecomposition.pop_back( );
   if( theOmegaPower%2==0 )
-    result.theDecomposition.push_front( last );
+    result.theDecomposition.insert( result.theDecomposition.begin( ) , last );
   else 
-    result.theDecomposition.push_front( last.flip( ) );
-  result.theDecomposition.pop_back( );
+    result.theDecomposition.insert( result.theDecomposition.begin( ) , last.flip( ) );
   result.adjust( );
   
   return pair< ThLeftNormalForm , ThLeftNormalForm >( result , -ThLeftNormalForm(last) );
@@ -491,7 +626,7 @@ Permutation ThLeftNormalForm::getPullback( const Permutation& s ) const
   B1 = Delta * -B1;
   Permutation b0 = -B1 * B1.LeftLCM( s.flip( ) );
 
-  for( list< Permutation >::const_iterator d_it=++theDecomposition.begin( ) ; d_it!=theDecomposition.end( ) ; ++d_it ) {
+  for( vector< Permutation >::const_iterator d_it=++theDecomposition.begin( ) ; d_it!=theDecomposition.end( ) ; ++d_it ) {
     const Permutation& B = *d_it;
     b1 = -B * B.LeftLCM( b1 );
   }
@@ -634,96 +769,112 @@ pair< Permutation , bool > ThLeftNormalForm::getSimpleUltraConjugator( int perio
 
 set< pair< Permutation , bool > > ThLeftNormalForm::getSimpleUltraConjugators( int period ) const
 {
-  set< pair< Permutation , bool > > result;
-  for( int i=0 ; i<theRank-1 ; ++i ) {
+  // the conjugators for different starting generators are computed concurrently
+  vector< pair< Permutation , bool > > conjugators( theRank>1 ? theRank-1 : 0 );
+  crag::parallel::forEach( conjugators.size( ) , [&] ( size_t i ) {
     Permutation start( theRank );
     start.change( i , i+1 );
-    result.insert( getSimpleUltraConjugator( period , start ) );
-  }
+    conjugators[i] = getSimpleUltraConjugator( period , start );
+  } );
   
-  return result;
+  return set< pair< Permutation , bool > >( conjugators.begin( ) , conjugators.end( ) );
 }
 
 
 //---------------------------------------------------------------------------//
-//---------------------------------- ussAdd ---------------------------------//
+//------------------------------- getTrajectory -----------------------------//
 //---------------------------------------------------------------------------//
 
 
-pair< bool , ThLeftNormalForm > 
-ThLeftNormalForm::ussAddTrajectory( const ThLeftNormalForm& new_elt , const ThLeftNormalForm& new_conj , 
-				    map< ThLeftNormalForm , pair< ThLeftNormalForm , int > >& uss_new1 , 
-				    map< ThLeftNormalForm , pair< ThLeftNormalForm , int > >& uss_checked1 , 
-				    const map< ThLeftNormalForm , pair< ThLeftNormalForm , int > >& uss_new2 , 
-				    const map< ThLeftNormalForm , pair< ThLeftNormalForm , int > >& uss_checked2 ) const
+vector< triple< ThLeftNormalForm , ThLeftNormalForm , int > > 
+ThLeftNormalForm::getTrajectory( const ThLeftNormalForm& conjugator ) const
 {
-  pair< bool , ThLeftNormalForm >  result;
-  
-  // Add the whole trajectory to already constructed part of USS
-  ThLeftNormalForm cur_res = new_elt;
-  ThLeftNormalForm new_conjugator = new_conj;
+  vector< triple< ThLeftNormalForm , ThLeftNormalForm , int > > result;
+
+  ThLeftNormalForm cur_res = *this;
+  ThLeftNormalForm cur_conjugator = conjugator;
   do {
-    
-    // a. Check if the new element belongs to the other USS. Stop if true.
-    map< ThLeftNormalForm , pair< ThLeftNormalForm , int > >::const_iterator uss_it = uss_new2.find( cur_res );
-    if( uss_it!=uss_new2.end( ) )
-      return pair< bool , ThLeftNormalForm >( true , (*uss_it).second.first * -new_conjugator );
-    
-    // b. Check if the new element belongs to the other USS. Stop if true.
-    uss_it = uss_checked2.find( cur_res );
-    if( uss_it!=uss_checked2.end( ) )
-      return pair< bool , ThLeftNormalForm >( true , (*uss_it).second.first * -new_conjugator );
-    
-    uss_new1[cur_res] = pair< ThLeftNormalForm , int >( new_conjugator , cur_res.computePeriod( ) );
-    
+    result.push_back( triple< ThLeftNormalForm , ThLeftNormalForm , int >( cur_res , cur_conjugator , 0 ) );
+
     pair< ThLeftNormalForm , ThLeftNormalForm > pr_res = cur_res.cycle( );
     cur_res = pr_res.first;
-    new_conjugator *= pr_res.second;
-  } while( cur_res!=new_elt );
-  
+    cur_conjugator *= pr_res.second;
+  } while( cur_res!=*this );
+
+  // all the elements of the orbit have the same period
+  for( size_t i=0 ; i<result.size( ) ; ++i )
+    result[i].third = result.size( );
+
   return result;
 }
 
+
 //---------------------------------------------------------------------------//
-//------------------------- sssConstructionIteration ------------------------//
+//---------------------------------- ussAdd ---------------------------------//
 //---------------------------------------------------------------------------//
 
 
 pair< bool , ThLeftNormalForm > 
-ThLeftNormalForm::ussConstructionIteration( map< ThLeftNormalForm , pair< ThLeftNormalForm , int > >& uss_new1 , 
-					    map< ThLeftNormalForm , pair< ThLeftNormalForm , int > >& uss_checked1 , 
-					    const map< ThLeftNormalForm , pair< ThLeftNormalForm , int > >& uss_new2 , 
-					    const map< ThLeftNormalForm , pair< ThLeftNormalForm , int > >& uss_checked2 ) const
+ThLeftNormalForm::ussAddTrajectory( const vector< triple< ThLeftNormalForm , ThLeftNormalForm , int > >& trajectory , 
+				    USS& uss1 , const USS& uss2 )
 {
-  const Permutation omega = Permutation::getHalfTwistPermutation( theRank );
-  
-  const pair< ThLeftNormalForm , pair< ThLeftNormalForm , int > > pr = *uss_new1.begin( );
-  uss_checked1[pr.first] = pr.second;
-  uss_new1.erase( uss_new1.begin( ) );
-  
-  // 1. compute the set of simple summit conjugators 
-  set< pair< Permutation , bool > > conj = pr.first.getSimpleUltraConjugators( pr.second.second );
-  for( set< pair< Permutation , bool > > ::iterator it=conj.begin( ) ; it!=conj.end( ) ; ++it ) {
-    
-    // Conjugate the current element
-    ThLeftNormalForm conj( (*it).first );
-    ThLeftNormalForm res = -conj * pr.first * conj;
-    
-    // Check if the element is new
-    if( uss_new1.find( res )!=uss_new1.end( ) ||
-      uss_checked1.find( res )!=uss_checked1.end( ) )
-      continue;
-    
-    // Compute new conjugator
-    ThLeftNormalForm new_conjugator = pr.second.first * conj;
-    
-    pair< bool , ThLeftNormalForm > traj_add_result = 
-      ussAddTrajectory( res , new_conjugator , uss_new1 , uss_checked1 , uss_new2 , uss_checked2 );
-    if( traj_add_result.first )
-      return traj_add_result;
+  for( size_t i=0 ; i<trajectory.size( ) ; ++i ) {
+    const ThLeftNormalForm& cur_res = trajectory[i].first;
+    const ThLeftNormalForm& new_conjugator = trajectory[i].second;
+
+    // Check if the new element belongs to the other USS. Stop if true.
+    const USS::Entry* entry = uss2.find( cur_res );
+    if( entry )
+      return pair< bool , ThLeftNormalForm >( true , entry->conjugator * -new_conjugator );
+
+    uss1.insert( cur_res , new_conjugator , trajectory[i].third );
   }
-  
-  return pair<bool,ThLeftNormalForm>( false , ThLeftNormalForm( theRank ) );
+
+  return pair< bool , ThLeftNormalForm >( false , ThLeftNormalForm( ) );
+}
+
+
+//---------------------------------------------------------------------------//
+//---------------------------- ussExpandFrontier ----------------------------//
+//---------------------------------------------------------------------------//
+
+
+pair< bool , ThLeftNormalForm > ThLeftNormalForm::ussExpandFrontier( USS& uss1 , const USS& uss2 , size_t& expanded )
+{
+  typedef vector< triple< ThLeftNormalForm , ThLeftNormalForm , int > > Trajectory;
+
+  const vector< pair< ThLeftNormalForm , USS::Entry > > frontier = uss1.takeFrontier( );
+  expanded += frontier.size( );
+
+  // 1. conjugate the elements by simple ultra conjugators and compute the trajectories of the new elements,
+  //    the sets are not modified here, so they are shared by the threads
+  vector< vector< Trajectory > > trajectories( frontier.size( ) );
+  crag::parallel::forEach( frontier.size( ) , [&] ( size_t i ) {
+    const ThLeftNormalForm& elt = frontier[i].first;
+    const USS::Entry& entry = frontier[i].second;
+
+    set< pair< Permutation , bool > > conj = elt.getSimpleUltraConjugators( entry.period );
+    for( set< pair< Permutation , bool > >::iterator it=conj.begin( ) ; it!=conj.end( ) ; ++it ) {
+      ThLeftNormalForm c( (*it).first );
+      ThLeftNormalForm res = -c * elt * c;
+      if( uss1.find( res ) )
+	continue;
+      trajectories[i].push_back( res.getTrajectory( entry.conjugator * c ) );
+    }
+  } );
+
+  // 2. add the trajectories (the same element can be found from several elements of the frontier)
+  for( size_t i=0 ; i<trajectories.size( ) ; ++i ) {
+    for( size_t j=0 ; j<trajectories[i].size( ) ; ++j ) {
+      if( uss1.full( ) )
+	return pair< bool , ThLeftNormalForm >( false , ThLeftNormalForm( ) );
+      pair< bool , ThLeftNormalForm > traj_add_result = ussAddTrajectory( trajectories[i][j] , uss1 , uss2 );
+      if( traj_add_result.first )
+	return traj_add_result;
+    }
+  }
+
+  return pair< bool , ThLeftNormalForm >( false , ThLeftNormalForm( ) );
 }
 
 
@@ -734,10 +885,25 @@ ThLeftNormalForm::ussConstructionIteration( map< ThLeftNormalForm , pair< ThLeft
 
 pair< bool , ThLeftNormalForm > ThLeftNormalForm::areConjugate_uss( const ThLeftNormalForm& rep , int time_sec_bound ) const
 {
+  crag::braidgroup::SummitSetOptions options;
+  options.time_sec_bound = time_sec_bound;
+  return areConjugate_uss( rep , options );
+}
+
+
+pair< bool , ThLeftNormalForm > ThLeftNormalForm::areConjugate_uss( const ThLeftNormalForm& rep , 
+								    const crag::braidgroup::SummitSetOptions& options , 
+								    crag::braidgroup::SummitSetStatistics* statistics ) const
+{
+  crag::braidgroup::SummitSetStatistics local_statistics;
+  if( !statistics )
+    statistics = &local_statistics;
+  *statistics = crag::braidgroup::SummitSetStatistics( );
+
   if( theRank!=rep.theRank )
     return pair< bool , ThLeftNormalForm >( false , ThLeftNormalForm( theRank ) );
   
-  int init_time = time(0);
+  const auto init_time = std::chrono::steady_clock::now( );
   
   // 1. find representative of SSS1
   triple< ThLeftNormalForm , ThLeftNormalForm , int > tr1 =     findUSSRepresentative( );
@@ -755,42 +921,44 @@ pair< bool , ThLeftNormalForm > ThLeftNormalForm::areConjugate_uss( const ThLeft
     return pair< bool , ThLeftNormalForm >( true , tr2.second * -tr1.second );
   
   // 3. construct ultra summit sets
-  map< ThLeftNormalForm , pair< ThLeftNormalForm , int > > uss_new1;
-  map< ThLeftNormalForm , pair< ThLeftNormalForm , int > > uss_checked1;
-  map< ThLeftNormalForm , pair< ThLeftNormalForm , int > > uss_new2;
-  map< ThLeftNormalForm , pair< ThLeftNormalForm , int > > uss_checked2;
-  
-  ussAddTrajectory( tr1.first , tr1.second , uss_new1 , uss_checked1 , uss_new2 , uss_checked2 );
-  pair< bool , ThLeftNormalForm > traj_add_result = 
-    ussAddTrajectory( tr2.first , tr2.second , uss_new2 , uss_checked2 , uss_new1 , uss_checked1 );
+  USS uss1( theRank , options.max_size );
+  USS uss2( theRank , options.max_size );
+  
+  ussAddTrajectory( tr1.first.getTrajectory( tr1.second ) , uss1 , uss2 );
+  pair< bool , ThLeftNormalForm > traj_add_result = ussAddTrajectory( tr2.first.getTrajectory( tr2.second ) , uss2 , uss1 );
   if( traj_add_result.first )
     return pair< bool , ThLeftNormalForm >( true , -traj_add_result.second );
 
-  // uss_new1[tr1.first] = pair< ThLeftNormalForm , int >( tr1.second , tr1.third );
-  // uss_new2[tr2.first] = pair< ThLeftNormalForm , int >( tr2.second , tr2.third );
+  // In the unidirectional mode only the first set is expanded, the second one is its trajectory
+  if( !options.bidirectional )
+    uss2.takeFrontier( );
+
+  while( uss1.frontierSize( ) && ( uss2.frontierSize( ) || !options.bidirectional ) ) {
+
+    // Expand the smaller set
+    const bool first = !options.bidirectional || uss1.size( )<=uss2.size( );
+    pair< bool , ThLeftNormalForm > pr = first ? 
+      ussExpandFrontier( uss1 , uss2 , statistics->expanded ) : 
+      ussExpandFrontier( uss2 , uss1 , statistics->expanded );
+
+    ++statistics->levels;
+    statistics->size1 = uss1.size( );
+    statistics->size2 = uss2.size( );
+    statistics->time = std::chrono::duration_cast< std::chrono::milliseconds >( std::chrono::steady_clock::now( )-init_time );
+    if( options.progress )
+      options.progress( *statistics );
 
-  for( int i=0 ; i<1000000 && uss_new1.size( ) && uss_new2.size( ) ; ++i ) {
+    if( pr.first )
+      return pair< bool , ThLeftNormalForm >( true , first ? pr.second : pr.second.inverse( ) );
 
-    // Check if we have time to proceed
-    int cur_time = time(0);
-    if( cur_time-init_time>time_sec_bound )
+    // Check if we have time and memory to proceed
+    if( uss1.full( ) || uss2.full( ) ) {
+      statistics->size_limit_reached = true;
       return pair< bool , ThLeftNormalForm >( false , ThLeftNormalForm( theRank ) );
-    
-    pair< bool , ThLeftNormalForm > pr = ussConstructionIteration( uss_new1 , uss_checked1 , uss_new2 , uss_checked2 );
-    if( pr.first ) {
-      // cout << "Size: " << uss_new1.size()+uss_checked1.size() << "  -  " << uss_new2.size()+uss_checked2.size() << endl;
-      return pair< bool , ThLeftNormalForm >( true , pr.second );
     }
-
-    // Check if we have time to proceed
-    cur_time = time(0);
-    if( cur_time-init_time>time_sec_bound )
+    if( statistics->time>std::chrono::seconds( options.time_sec_bound ) ) {
+      statistics->time_limit_reached = true;
       return pair< bool , ThLeftNormalForm >( false , ThLeftNormalForm( theRank ) );
-
-    pr = ussConstructionIteration( uss_new2 , uss_checked2 , uss_new1 , uss_checked1 );
-    if( pr.first ) {
-      // cout << "Size: " << uss_new1.size()+uss_checked1.size() << "  -  " << uss_new2.size()+uss_checked2.size() << endl;
-      return pair< bool , ThLeftNormalForm >( true , pr.second.inverse( ) );
     }
   }
   
@@ -808,11 +976,11 @@ ThLeftNormalForm ThLeftNormalForm::increaseRank( int N ) const
   if( N<=theRank )
     return *this;
   
-  list< Permutation > D1;
-  for( list< Permutation >::const_iterator d_it=theDecomposition.begin( ) ; d_it!=theDecomposition.end( ) ; ++d_it )
+  vector< Permutation > D1;
+  for( vector< Permutation >::const_iterator d_it=theDecomposition.begin( ) ; d_it!=theDecomposition.end( ) ; ++d_it )
     D1.push_back( (*d_it).increaseSize(N) );
   
-  list< Permutation > D2;
+  vector< Permutation > D2;
   for( int i=0 ; i<abs(theOmegaPower) ; ++i )
     D2.push_back( Permutation::getHalfTwistPermutation( theRank ).increaseSize(N) );
   
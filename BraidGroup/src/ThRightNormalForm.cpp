@@ -6,6 +6,7 @@
 // Revision History:
 //
 
+#include <algorithm>
 #include <cassert>
 #include <fstream>
 
@@ -16,10 +17,10 @@
 #include "Word.h"
 
 
-ostream& printOn( ostream& os , const list<Permutation>& lp  )
+ostream& printOn( ostream& os , const vector<Permutation>& lp  )
 {
   os << "(";
-  list<Permutation>::const_iterator lp_it = lp.begin( );
+  vector<Permutation>::const_iterator lp_it = lp.begin( );
   for( ; lp_it!=lp.end( ) ; ++lp_it ) {
     // os << (*lp_it) << " -> " << (*lp_it).geodesic( ).size( ) << endl;
     if( lp_it!=lp.begin( ) )
@@ -36,9 +37,9 @@ ostream& printOn( ostream& os , const list<Permutation>& lp  )
 
 ostream& operator << ( ostream& os, const ThRightNormalForm& rep )
 {
-  const list< Permutation >& decomposition = rep.getDecomposition( );
+  const vector< Permutation >& decomposition = rep.getDecomposition( );
   
-  list< Permutation >::const_iterator it = decomposition.begin( );
+  vector< Permutation >::const_iterator it = decomposition.begin( );
   for( ; it!=decomposition.end( ) ; ++it )
     os << *it << endl;
   
@@ -61,8 +62,8 @@ ThRightNormalForm::operator ThLeftNormalForm( ) const
     return nf;
   }
   
-  list< Permutation > D;
-  for( list< Permutation >::const_iterator d_it=theDecomposition.begin( ) ; d_it!=theDecomposition.end( ) ; ++d_it )
+  vector< Permutation > D;
+  for( vector< Permutation >::const_iterator d_it=theDecomposition.begin( ) ; d_it!=theDecomposition.end( ) ; ++d_it )
     D.push_back( (*d_it).flip( ) );
   
   ThLeftNormalForm nf( theRank , theOmegaPower , D );
@@ -80,6 +81,7 @@ ThRightNormalForm::ThRightNormalForm(const crag::braidgroup::BraidGroup &G, cons
   const Permutation omega = Permutation::getHalfTwistPermutation(theRank);
 
   // 1. compute permutation decomposition of a given braid word
+  // (the word is processed from the end, so the decomposition is collected in the reversed order)
   Permutation curMult(theRank);
   // bool trivialMult = true;
   for (Word::const_iterator w_it = w.end(); w_it != w.begin();) {
@@ -103,46 +105,47 @@ ThRightNormalForm::ThRightNormalForm(const crag::braidgroup::BraidGroup &G, cons
         int gen = *w_it3;
         // cout << " +++++ " << gen << endl;
         if (curMult[gen - 1] > curMult[gen]) {
-          theDecomposition.push_front(curMult);
+          theDecomposition.push_back(curMult);
           curMult = Permutation(theRank);
         }
         curMult.change(gen - 1, gen);
         // trivialMult = false;
       }
-      theDecomposition.push_front(curMult);
+      theDecomposition.push_back(curMult);
       curMult = Permutation(theRank);
       // trivialMult = true;
 
     } else {
 
       // process the negative block
-      list<Permutation> mult;
+      vector<Permutation> mult;
       for (Word::const_iterator w_it3 = w_it2; w_it3 != w_it; ++w_it3) {
 
         int gen = -*w_it3;
         // cout << " ------ " << gen << endl;
         if (curMult[gen - 1] > curMult[gen]) {
-          mult.push_front(curMult);
+          mult.push_back(curMult);
           curMult = Permutation(theRank);
         }
         curMult.change(gen - 1, gen);
         // trivialMult = false;
       }
-      mult.push_front(curMult);
+      mult.push_back(curMult);
       curMult = Permutation(theRank);
       // trivialMult = true;
 
-      list<Permutation>::iterator it = mult.begin();
-      for (; it != mult.end(); ++it) {
-        theDecomposition.push_front(omega);
+      vector<Permutation>::reverse_iterator it = mult.rbegin();
+      for (; it != mult.rend(); ++it) {
+        theDecomposition.push_back(omega);
         if (!((*it).inverse() * omega).isTrivial())
-          theDecomposition.push_front((*it).inverse() * omega);
+          theDecomposition.push_back((*it).inverse() * omega);
         theOmegaPower -= 2;
       }
     }
 
     w_it = w_it2;
   }
+  std::reverse(theDecomposition.begin(), theDecomposition.end());
 
   adjustDecomposition(theRank, theOmegaPower, theDecomposition);
 }
@@ -151,45 +154,44 @@ ThRightNormalForm::ThRightNormalForm(const crag::braidgroup::BraidGroup &G, cons
 //--------------------------- adjustDecomposition ---------------------------//
 //---------------------------------------------------------------------------//
 
-void ThRightNormalForm::adjustDecomposition(int rank, int &power, list<Permutation> &decomp) {
+void ThRightNormalForm::adjustDecomposition(int rank, int &power, vector<Permutation> &decomp) {
 
   const Permutation omega = Permutation::getHalfTwistPermutation(rank);
 
+  // the positions are indices, since erasing invalidates the iterators of a vector
   bool flip = false;
-  list<Permutation>::iterator it1 = decomp.begin();
-  for (; it1 != decomp.end(); ) {
+  size_t i1 = 0;
+  while (i1 < decomp.size()) {
 
     if (flip)
-      *it1 = omega * (*it1) * omega;
+      decomp[i1] = omega * decomp[i1] * omega;
 
-    list<Permutation>::iterator it2 = it1;
-    for (; it2 != decomp.begin(); it2--) {
-      list<Permutation>::iterator it3 = it2;
-      it3--;
+    size_t i2 = i1;
+    while (i2 > 0) {
+      const size_t i3 = i2 - 1;
 
-      transformationResult tr_res = transform( rank , *it3 , *it2 );
+      transformationResult tr_res = transform( rank , decomp[i3] , decomp[i2] );
       switch( tr_res ) {
       case ONE_MULTIPLIER:
-				if( it1==it2 )
-					it1 = it2 = decomp.erase( it3 );
-				else
-					it2 = decomp.erase( it3 );
-				it2++;
+				decomp.erase( decomp.begin( ) + i3 );
+				--i1;
+				i2 = i3;
 				break;
       case NO_CHANGE:
-				it2 = decomp.begin( );
-				it2++;
+				i2 = 0;
+				break;
+      default:
+				i2 = i3;
 				break;
       }
     }
 
-    if (*it1 == omega) {
+    if (decomp[i1] == omega) {
       power++;
-      it1 = decomp.erase(it1);
+      decomp.erase(decomp.begin() + i1);
       flip = !flip;
     } else {
-      if (it1 != decomp.end())
-        it1++;
+      ++i1;
     }
   }
 }
@@ -229,9 +231,9 @@ ThRightNormalForm::NF ThRightNormalForm::inverse() const {
 
   int power = -theOmegaPower - dec_size;
   const Permutation omega = Permutation::getHalfTwistPermutation(theRank);
-  list<Permutation> result;
+  vector<Permutation> result;
 
-  list<Permutation>::const_iterator it = theDecomposition.end();
+  vector<Permutation>::const_iterator it = theDecomposition.end();
   for (int i = 0; i < dec_size; ++i) {
     --it;
     if ((i % 2 == 0) == (theOmegaPower % 2 != 0))
@@ -256,11 +258,11 @@ ThRightNormalForm::multiply( const ThRightNormalForm& rep ) const
   // 1. shift omegas to the right
   int power = theOmegaPower + rep.theOmegaPower;
   
-  list< Permutation > blocks( theDecomposition );
+  vector< Permutation > blocks( theDecomposition );
   
   // 2. if power of the omega on the left is odd we must flip 
   //    permutations of the second form
-  list< Permutation >::const_iterator it = rep.theDecomposition.begin( );
+  vector< Permutation >::const_iterator it = rep.theDecomposition.begin( );
   if( theOmegaPower%2 ) {
     for( size_t t=0 ; t<rep.theDecomposition.size( ) ; ++t , ++it )
       blocks.push_back( omega * (*it) * omega );
@@ -285,7 +287,7 @@ Word ThRightNormalForm::getWord( ) const
   vector< int > decomposition;
   
   vector< int > geodesic;
-  list<Permutation>::const_iterator it = theDecomposition.begin( );
+  vector<Permutation>::const_iterator it = theDecomposition.begin( );
   for( ; it!=theDecomposition.end( ) ; ++it ) {
     geodesic = (*it).geodesic( );
     for( size_t j=0 ; j<geodesic.size( ) ; ++j )
@@ -319,8 +321,8 @@ Word ThRightNormalForm::getShortWord( ) const
 
   if( power<0 ) {
 
-    const list< Permutation >& decomp = getDecomposition( );
-    list<Permutation>:: const_iterator it = decomp.begin( );
+    const vector< Permutation >& decomp = getDecomposition( );
+    vector<Permutation>:: const_iterator it = decomp.begin( );
     for( int j=0 ; it!=decomp.end( ) ; ++it, ++j ) {
       int n = j - decomp.size( ) - power;
       if( n<0 ) {
@@ -412,9 +414,9 @@ ThRightNormalForm::computeCentralizer( ) const
       
       for( set<Permutation>::const_iterator conj_it = conjugators.begin( ) ; conj_it!=conjugators.end( ) ; ++conj_it ) {
 				
-	ThRightNormalForm r_mult( theRank , 0 , list<Permutation>( 1 , *conj_it ) );
+	ThRightNormalForm r_mult( theRank , 0 , vector<Permutation>( 1 , *conj_it ) );
 	if( *conj_it==omega )
-	  r_mult = ThRightNormalForm( theRank , 1 , list<Permutation>( 0 ) );
+	  r_mult = ThRightNormalForm( theRank , 1 , vector<Permutation>( 0 ) );
 	ThRightNormalForm new_el = -r_mult * cur_el * r_mult;
 	ThRightNormalForm new_conj = cur_conj * r_mult;
 
@@ -501,7 +503,7 @@ ThRightNormalForm::computeCentralizer( ) const
 
 ThRightNormalForm ThRightNormalForm::randomPositive( int rank , int decomp_length )
 {
-  list< Permutation > D;
+  vector< Permutation > D;
   for( int i=0 ; i<decomp_length ; ++i )
     D.push_back( Permutation::random( rank ) );
   ThRightNormalForm result( rank , 0 , D );
@@ -521,11 +523,11 @@ ThRightNormalForm ThRightNormalForm::increaseRank( int N ) const
   if( N<=theRank )
     return *this;
   
-  list< Permutation > D1;
-  for( list< Permutation >::const_iterator d_it=theDecomposition.begin( ) ; d_it!=theDecomposition.end( ) ; ++d_it )
+  vector< Permutation > D1;
+  for( vector< Permutation >::const_iterator d_it=theDecomposition.begin( ) ; d_it!=theDecomposition.end( ) ; ++d_it )
     D1.push_back( (*d_it).increaseSize(N) );
   
-  list< Permutation > D2;
+  vector< Permutation > D2;
   for( int i=0 ; i<abs(theOmegaPower) ; ++i )
     D2.push_back( Permutation::getHalfTwistPermutation( theRank ).increaseSize(N) );
   
@@ -141,9 +141,9 @@ map< vector< ThRightNormalForm > , ThRightNormalForm > processTuple( int rank ,
   for( set< Permutation >::const_iterator c_it=conjugators.begin( ) ; c_it!=conjugators.end( ) ; ++c_it ) {
     
     vector< ThRightNormalForm > new_tuple = tuple;
-    ThRightNormalForm conjugator( rank , 0 , list<Permutation>(1,*c_it) );
+    ThRightNormalForm conjugator( rank , 0 , vector<Permutation>(1,*c_it) );
     if( *c_it==omega )
-      conjugator = ThRightNormalForm( rank , 1 , list<Permutation>( ) );
+      conjugator = ThRightNormalForm( rank , 1 , vector<Permutation>( ) );
     
 
     for( int i=0 ; i<sz ; ++i )
@@ -169,7 +169,7 @@ pair< vector< ThRightNormalForm > , ThRightNormalForm > getSummitSetRepresentati
   
   map< vector< ThRightNormalForm > , ThRightNormalForm > C;  // checked
   map< vector< ThRightNormalForm > , ThRightNormalForm > N;  // new
-  N[elts] = ThRightNormalForm( rank , 0 , list<Permutation>( ) );
+  N[elts] = ThRightNormalForm( rank , 0 , vector<Permutation>( ) );
   
   int counter=0;
   for( ; !N.empty( ) && counter<100000 ; ++counter ) {
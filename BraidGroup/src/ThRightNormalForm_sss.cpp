@@ -7,7 +7,9 @@
 //
 
 #include "fstream"
+#include <chrono>
 #include "ShortBraidForm.h"
+#include "parallel.h"
 
 
 #include "ThRightNormalForm.h"
@@ -29,8 +31,8 @@ pair< ThRightNormalForm , ThRightNormalForm > ThRightNormalForm::cycle( ) const
   Permutation conj = *(--theDecomposition.end( ));
   if( theOmegaPower%2!=0 )
     conj = conj.flip( );
-  result.theDecomposition.push_front( conj );
   result.theDecomposition.pop_back( );
+  result.theDecomposition.insert( result.theDecomposition.begin( ) , conj );
   result.adjust( );
   
   return pair<NF,ThRightNormalForm> ( result , -ThRightNormalForm( conj ) );
@@ -53,7 +55,7 @@ pair< ThRightNormalForm , ThRightNormalForm > ThRightNormalForm::decycle( ) cons
     result.theDecomposition.push_back( conj.flip( ) );
   else
     result.theDecomposition.push_back( conj );
-  result.theDecomposition.pop_front( );
+  result.theDecomposition.erase( result.theDecomposition.begin( ) );
   result.adjust( );
 
   return pair< ThRightNormalForm , ThRightNormalForm > ( result , conj );
@@ -130,7 +132,7 @@ Permutation ThRightNormalForm::getSimpleConjugator( const Permutation& start ) c
   Permutation ic = theOmegaPower%2 ? omega * c * omega : c;
     
   Permutation v = c;
-  list< Permutation >::const_iterator it = theDecomposition.begin( );
+  vector< Permutation >::const_iterator it = theDecomposition.begin( );
   while( 1 ) {
       
     // move through permutations to the right
@@ -217,63 +219,62 @@ set< Permutation > ThRightNormalForm::getSimpleConjugators( ) const
 
 set< Permutation > ThRightNormalForm::getSimpleSummitConjugators( ) const
 {
-  set< Permutation > result;
-  for( int i=0 ; i<theRank-1 ; ++i ) {
+  // the conjugators for different starting generators are computed concurrently
+  vector< Permutation > conjugators( theRank>1 ? theRank-1 : 0 );
+  crag::parallel::forEach( conjugators.size( ) , [&] ( size_t i ) {
     Permutation c( theRank );
     c.change( i , i+1 );
-    result.insert( getSimpleSummitConjugator( c ) );
-  }
+    conjugators[i] = getSimpleSummitConjugator( c );
+  } );
+  set< Permutation > result( conjugators.begin( ) , conjugators.end( ) );
   return result;
 }
 
 
 //---------------------------------------------------------------------------//
-//------------------------- sssConstructionIteration ------------------------//
+//---------------------------- sssExpandFrontier ----------------------------//
 //---------------------------------------------------------------------------//
 
 
-pair< bool , ThRightNormalForm > 
-ThRightNormalForm::sssConstructionIteration( map< ThRightNormalForm , ThRightNormalForm >& sss_new1 , 
-					     map< ThRightNormalForm , ThRightNormalForm >& sss_checked1 , 
-					     const map< ThRightNormalForm , ThRightNormalForm >& sss_new2 , 
-					     const map< ThRightNormalForm , ThRightNormalForm >& sss_checked2 ) const
+pair< bool , ThRightNormalForm > ThRightNormalForm::sssExpandFrontier( SSS& sss1 , const SSS& sss2 , size_t& expanded )
 {
-  const Permutation omega = Permutation::getHalfTwistPermutation( theRank );
-
-  const pair< ThRightNormalForm , ThRightNormalForm > pr = *sss_new1.begin( );
-  sss_checked1[pr.first] = pr.second;
-  sss_new1.erase( sss_new1.begin( ) );
-
-  // 1. compute the set of simple summit conjugators 
-  set< Permutation > conj = pr.first.getSimpleSummitConjugators( );
-  for( set< Permutation >::iterator it=conj.begin( ) ; it!=conj.end( ) ; ++it ) {
-    
-    // Conjugate the current element
-    ThRightNormalForm conj( *it );
-    ThRightNormalForm res = -conj * pr.first * conj;
-    
-    // Check if the element is new
-    if( sss_new1.find( res )!=sss_new1.end( ) ||
-      sss_checked1.find( res )!=sss_checked1.end( ) )
-      continue;
-    
-    // Compute new conjugator
-    ThRightNormalForm new_conjugator = pr.second * conj;
-    
-    // a. Check if the new element belongs to the other SSS. Stop if true.
-    map< ThRightNormalForm , ThRightNormalForm >::const_iterator sss_it = sss_new2.find( res );
-    if( sss_it!=sss_new2.end( ) )
-      return pair< bool , ThRightNormalForm >( true , (*sss_it).second * -new_conjugator );
-    
-    // b. Check if the new element belongs to the other SSS. Stop if true.
-    sss_it = sss_checked2.find( res );
-    if( sss_it!=sss_checked2.end( ) )
-      return pair< bool , ThRightNormalForm >( true , (*sss_it).second * -new_conjugator );
-    
-    sss_new1[res] = new_conjugator;
+  const vector< pair< ThRightNormalForm , SSS::Entry > > frontier = sss1.takeFrontier( );
+  expanded += frontier.size( );
+
+  // 1. conjugate the elements by simple summit conjugators, 
+  //    the sets are not modified here, so they are shared by the threads
+  vector< vector< pair< ThRightNormalForm , ThRightNormalForm > > > conjugates( frontier.size( ) );
+  crag::parallel::forEach( frontier.size( ) , [&] ( size_t i ) {
+    const ThRightNormalForm& elt = frontier[i].first;
+
+    set< Permutation > conj = elt.getSimpleSummitConjugators( );
+    for( set< Permutation >::iterator it=conj.begin( ) ; it!=conj.end( ) ; ++it ) {
+      ThRightNormalForm c( *it );
+      ThRightNormalForm res = -c * elt * c;
+      if( sss1.find( res ) )
+	continue;
+      conjugates[i].push_back( pair< ThRightNormalForm , ThRightNormalForm >( res , frontier[i].second.conjugator * c ) );
+    }
+  } );
+
+  // 2. add the new elements (the same element can be found from several elements of the frontier)
+  for( size_t i=0 ; i<conjugates.size( ) ; ++i ) {
+    for( size_t j=0 ; j<conjugates[i].size( ) ; ++j ) {
+      const ThRightNormalForm& res = conjugates[i][j].first;
+      const ThRightNormalForm& new_conjugator = conjugates[i][j].second;
+
+      // Check if the new element belongs to the other SSS. Stop if true.
+      const SSS::Entry* entry = sss2.find( res );
+      if( entry )
+	return pair< bool , ThRightNormalForm >( true , entry->conjugator * -new_conjugator );
+
+      if( sss1.full( ) )
+	return pair< bool , ThRightNormalForm >( false , ThRightNormalForm( ) );
+      sss1.insert( res , new_conjugator );
+    }
   }
-  
-  return pair<bool,ThRightNormalForm>( false , ThRightNormalForm( theRank ) );
+
+  return pair< bool , ThRightNormalForm >( false , ThRightNormalForm( ) );
 }
 
 
@@ -284,9 +285,23 @@ ThRightNormalForm::sssConstructionIteration( map< ThRightNormalForm , ThRightNor
 
 pair< bool , ThRightNormalForm > ThRightNormalForm::areConjugate( const ThRightNormalForm& rep ) const
 {
+  return areConjugate( rep , crag::braidgroup::SummitSetOptions( ) );
+}
+
+
+pair< bool , ThRightNormalForm > ThRightNormalForm::areConjugate( const ThRightNormalForm& rep , 
+								  const crag::braidgroup::SummitSetOptions& options , 
+								  crag::braidgroup::SummitSetStatistics* statistics ) const
+{
+  crag::braidgroup::SummitSetStatistics local_statistics;
+  if( !statistics )
+    statistics = &local_statistics;
+  *statistics = crag::braidgroup::SummitSetStatistics( );
+
   if( theRank!=rep.theRank )
     return pair<bool,ThRightNormalForm>( false , ThRightNormalForm( theRank ) );
   
+  const auto init_time = std::chrono::steady_clock::now( );
   
   // 1. find representative of SSS1
   pair< ThRightNormalForm , ThRightNormalForm > pr1 =     findSSSRepresentative( );
@@ -313,25 +328,43 @@ pair< bool , ThRightNormalForm > ThRightNormalForm::areConjugate( const ThRightN
   
   
   // 3. construct super summit sets
-  map< ThRightNormalForm , ThRightNormalForm > sss_new1;
-  map< ThRightNormalForm , ThRightNormalForm > sss_checked1;
-  map< ThRightNormalForm , ThRightNormalForm > sss_new2;
-  map< ThRightNormalForm , ThRightNormalForm > sss_checked2;
-  
-  sss_new1[pr1.first] = pr1.second;
-  sss_new2[pr2.first] = pr2.second;
+  SSS sss1( theRank , options.max_size );
+  SSS sss2( theRank , options.max_size );
   
+  sss1.insert( pr1.first , pr1.second );
+  sss2.insert( pr2.first , pr2.second );
+
+  // In the unidirectional mode only the first set is expanded
+  if( !options.bidirectional )
+    sss2.takeFrontier( );
   
-  for( int i=0 ; i<1000000 && sss_new1.size( ) && sss_new2.size( ) ; ++i ) {
-    
-    pair< bool , ThRightNormalForm > pr = sssConstructionIteration( sss_new1 , sss_checked1 , sss_new2 , sss_checked2 );
-    if( pr.first )
-      return pair< bool , ThRightNormalForm >( true , pr.second );
+  while( sss1.frontierSize( ) && ( sss2.frontierSize( ) || !options.bidirectional ) ) {
+
+    // Expand the smaller set
+    const bool first = !options.bidirectional || sss1.size( )<=sss2.size( );
+    pair< bool , ThRightNormalForm > pr = first ? 
+      sssExpandFrontier( sss1 , sss2 , statistics->expanded ) : 
+      sssExpandFrontier( sss2 , sss1 , statistics->expanded );
+
+    ++statistics->levels;
+    statistics->size1 = sss1.size( );
+    statistics->size2 = sss2.size( );
+    statistics->time = std::chrono::duration_cast< std::chrono::milliseconds >( std::chrono::steady_clock::now( )-init_time );
+    if( options.progress )
+      options.progress( *statistics );
 
-    
-    pr = sssConstructionIteration( sss_new2 , sss_checked2 , sss_new1 , sss_checked1 );
     if( pr.first )
-      return pair< bool , ThRightNormalForm >( true , pr.second.inverse( ) );
+      return pair< bool , ThRightNormalForm >( true , first ? pr.second : ThRightNormalForm( pr.second.inverse( ) ) );
+
+    // Check if we have time and memory to proceed
+    if( sss1.full( ) || sss2.full( ) ) {
+      statistics->size_limit_reached = true;
+      return pair< bool , ThRightNormalForm >( false , ThRightNormalForm( theRank ) );
+    }
+    if( statistics->time>std::chrono::seconds( options.time_sec_bound ) ) {
+      statistics->time_limit_reached = true;
+      return pair< bool , ThRightNormalForm >( false , ThRightNormalForm( theRank ) );
+    }
   }
   
   return pair<bool,ThRightNormalForm>( false , ThRightNormalForm( theRank ) );
@@ -109,7 +109,7 @@ Permutation ThRightNormalForm::getPullback( const Permutation& s ) const
   Permutation s1 = -A1 * A1.LeftLCM( s );
 
   Permutation p = s;
-  for( list< Permutation >::const_iterator d_it=--theDecomposition.end( ) ; d_it!=theDecomposition.begin( ) ; ) {
+  for( vector< Permutation >::const_iterator d_it=--theDecomposition.end( ) ; d_it!=theDecomposition.begin( ) ; ) {
     Permutation A = *--d_it;
     transform( theRank , A , p );
     p = A;
@@ -18,5 +18,44 @@ Permutation permutation(size_t n, const Word& w) {
 
   return p;
 }
+
+size_t ExponentBounds::width() const {
+  size_t result = 1;
+
+  for (size_t i = 0; i < min.size(); ++i) {
+    result = std::max(result, static_cast<size_t>(max[i] - min[i] + 1));
+  }
+
+  return result;
+}
+
+void updateExponentBounds(ExponentBounds& bounds, Permutation& p, const Word& w) {
+  const auto n = p.size();
+
+  for (const auto i : w) {
+    const auto abs_i = static_cast<size_t>(std::abs(i));
+
+    if ((abs_i == 0) || (abs_i >= n)) {
+      throw std::invalid_argument("Index of a generator is out of range.");
+    }
+
+    if (i > 0) {
+      ++bounds.max[p[abs_i - 1]];
+    } else {
+      --bounds.min[p[abs_i]];
+    }
+
+    p.change(abs_i - 1, abs_i);
+  }
+}
+
+size_t interpolationPointsCount(size_t n, const Word& w) {
+  ExponentBounds bounds(n);
+  Permutation p(n);
+
+  updateExponentBounds(bounds, p, w);
+
+  return bounds.width();
+}
 }
 }
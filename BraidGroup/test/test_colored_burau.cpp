@@ -10,6 +10,7 @@ namespace coloredburau {
 namespace {
 
 using ZZ5 = finitefield::ZZ<5>;
+using GF32 = finitefield::FieldElement<finitefield::IdealGeneratedByPolynomial<finitefield::ZZ<2>, 1, 0, 1, 0, 0, 1>>;
 using GF256 =
     finitefield::FieldElement<finitefield::IdealGeneratedByPolynomial<finitefield::ZZ<2>, 1, 1, 0, 1, 1, 0, 0, 0, 1>>;
 
@@ -243,6 +244,131 @@ TEST(ColoredBurau, Hash) {
   }
 }
 
+template <typename T>
+void testPackedEMultiplication(size_t n) {
+  std::mt19937 g(0);
+
+  std::vector<T> t_values;
+
+  for (size_t i = 0; i < n; ++i) {
+    t_values.push_back(finitefield::generateNonZeroNonUnit<T>(g));
+  }
+
+  std::vector<Word> words;
+
+  for (size_t i = 0; i < 20; ++i) {
+    words.push_back(random::randomWord(n - 1, 100, 200, g));
+  }
+
+  const auto projections = project(words, t_values);
+
+  for (size_t i = 0; i < words.size(); ++i) {
+    // words shorter than n are E-multiplied by the generic implementation
+    CBProjectionElement<T> expected(t_values);
+
+    for (const auto letter : words[i]) {
+      expected *= Word(letter);
+    }
+
+    const auto packed = project(words[i], t_values);
+
+    EXPECT_EQ(expected, packed) << "case: i = " << i;
+    EXPECT_EQ(expected.toString(), packed.toString()) << "case: i = " << i;
+    EXPECT_EQ(expected, projections[i]) << "case: i = " << i;
+  }
+}
+
+TEST(ColoredBurau, PackedEMultiplication_zz5) {
+  testPackedEMultiplication<ZZ5>(8);
+}
+
+TEST(ColoredBurau, PackedEMultiplication_gf32) {
+  testPackedEMultiplication<GF32>(10);
+}
+
+TEST(ColoredBurau, PackedEMultiplication_gf256) {
+  testPackedEMultiplication<GF256>(16);
+}
+
+//! The first count non-zero elements of a field with at most 256 elements
+template <typename T>
+std::vector<T> evaluationPoints(size_t count) {
+  std::vector<T> result;
+
+  for (size_t code = 1; code <= count; ++code) {
+    result.push_back(finitefield::SmallFieldEncoding<T>::decode(static_cast<uint8_t>(code)));
+  }
+
+  return result;
+}
+
+template <typename T>
+void testEvaluationElement(size_t n, size_t length) {
+  std::mt19937 g(0);
+
+  for (size_t i = 0; i < 5; ++i) {
+    const auto w1 = random::randomWord(n - 1, length, g);
+    const auto w2 = random::randomWord(n - 1, length, g);
+
+    // the product w1 * w2 is freely reduced, so its bounds may be smaller than the ones of the product of elements
+    ExponentBounds bounds(n);
+    Permutation p(n);
+    updateExponentBounds(bounds, p, w1);
+    updateExponentBounds(bounds, p, w2);
+    const auto points = evaluationPoints<T>(bounds.width());
+
+    CBEvaluationElement<T> a(n, points);
+    a *= w1;
+
+    CBEvaluationElement<T> b(n, points);
+    b *= w2;
+
+    EXPECT_EQ(CBImage<T>(n, w1), a.interpolate()) << "case: i = " << i;
+
+    for (size_t k = 0; k < a.size(); k += 7) {
+      EXPECT_EQ(project(w1, a.point(k)), a.projection(k)) << "case: i = " << i << ", k = " << k;
+    }
+
+    a *= b;
+    EXPECT_EQ(CBImage<T>(n, w1 * w2), a.interpolate()) << "case: i = " << i;
+  }
+}
+
+TEST(ColoredBurau, EvaluationElement_zz5) {
+  // ZZ5 has only 4 non-zero elements, so the words are very short
+  testEvaluationElement<ZZ5>(3, 1);
+}
+
+TEST(ColoredBurau, EvaluationElement_gf32) {
+  testEvaluationElement<GF32>(3, 8);
+}
+
+TEST(ColoredBurau, EvaluationElement_gf256) {
+  testEvaluationElement<GF256>(4, 5);
+}
+
+TEST(ColoredBurau, EvaluationElementErrors) {
+  EXPECT_THROW(CBEvaluationElement<GF32>(3, {GF32(0), GF32(1)}), std::invalid_argument);
+  EXPECT_THROW(CBEvaluationElement<GF32>(3, {GF32(1), GF32(1)}), std::invalid_argument);
+
+  EXPECT_EQ(3, interpolationPointsCount(3, Word({1, 1, 1})));
+  EXPECT_EQ(2, interpolationPointsCount(3, Word({1, -2})));
+
+  CBEvaluationElement<GF32> a(3, evaluationPoints<GF32>(2));
+  EXPECT_THROW(a *= Word({3}), std::invalid_argument);
+  EXPECT_EQ(CBImage<GF32>(3, Word()), a.interpolate());
+
+  // x_1^2 has degree 1 in both t_1 and t_2, but x_1^3 has degree 2 in t_1
+  a *= Word({1, 1});
+  EXPECT_TRUE(a.isInterpolable());
+  a *= Word({1});
+  EXPECT_FALSE(a.isInterpolable());
+  EXPECT_THROW(a.interpolate(), std::logic_error);
+
+  CBEvaluationElement<GF32> b(3, evaluationPoints<GF32>(3));
+  EXPECT_THROW(a *= b, std::invalid_argument);
+}
+
 TEST(Permutation, Ex_01) {
   const size_t n = 16;
   std::mt19937_64 g(0);
@@ -86,6 +86,45 @@ TEST(FastIdCheck, HashVector) {
     EXPECT_EQ(h, hasher(other_words));
   }
 }
+
+template <typename FF>
+void checkIncrementalHash(size_t max_checkpoints) {
+  const size_t n = 8;
+
+  const BraidHasher<FF> hasher(n, 3);
+  IncrementalBraidHasher<FF> incremental_hasher(hasher, 4, max_checkpoints);
+
+  std::mt19937 g(0);
+
+  auto w = random::randomWord(n - 1, 30, 40, g);
+  EXPECT_EQ(hasher(w), incremental_hasher(w));
+
+  // appended letters and shared prefixes
+  for (size_t i = 0; i < 20; ++i) {
+    w *= random::randomWord(n - 1, 1, 3, g);
+    EXPECT_EQ(hasher(w), incremental_hasher(w));
+
+    const auto other_w = w.subword(0, w.length() / 2) * random::randomWord(n - 1, 5, 10, g);
+    EXPECT_EQ(hasher(other_w), incremental_hasher(other_w));
+  }
+
+  EXPECT_LE(incremental_hasher.checkpoints(), max_checkpoints);
+
+  const std::vector<Word> words = {w, Word(), random::randomWord(n - 1, 10, 20, g)};
+  EXPECT_EQ(hasher(words), incremental_hasher(words));
+}
+
+TEST(FastIdCheck, IncrementalHash) {
+  checkIncrementalHash<finitefield::ZZ<199>>(1 << 10);
+}
+
+TEST(FastIdCheck, IncrementalHashGenericField) {
+  checkIncrementalHash<finitefield::ZZ<1009>>(1 << 10);
+}
+
+TEST(FastIdCheck, IncrementalHashSmallCache) {
+  checkIncrementalHash<finitefield::ZZ<199>>(3);
+}
 } // namespace
 } // namespace braidgroup
 } // namespace crag
\ No newline at end of file
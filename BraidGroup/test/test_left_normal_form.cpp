@@ -0,0 +1,114 @@
+#include <gtest/gtest.h>
+
+#include <random>
+
+#include "ThLeftNormalForm.h"
+#include "ThRightNormalForm.h"
+
+#include "braid_group.h"
+#include "random_word.h"
+
+namespace crag {
+namespace braidgroup {
+namespace {
+
+ThLeftNormalForm fromRightNormalForm(const BraidGroup& G, const Word& w) {
+  return ThRightNormalForm(G, w).operator ThLeftNormalForm();
+}
+
+TEST(ThLeftNormalForm, Generators) {
+  const BraidGroup G(5);
+  const auto omega = Permutation::getHalfTwistPermutation(5);
+
+  const ThLeftNormalForm x2(G, "x2"_w);
+  EXPECT_EQ(0, x2.getPower());
+  ASSERT_EQ(1, x2.getDecomposition().size());
+  EXPECT_EQ(Permutation({0, 2, 1, 3, 4}), x2.getDecomposition()[0]);
+
+  const ThLeftNormalForm x2_inverse(G, "x2^-1"_w);
+  EXPECT_EQ(-1, x2_inverse.getPower());
+  ASSERT_EQ(1, x2_inverse.getDecomposition().size());
+  EXPECT_TRUE((x2 * x2_inverse).isTrivial());
+
+  const ThLeftNormalForm delta(G, Word(omega.geodesicWord()));
+  EXPECT_EQ(1, delta.getPower());
+  EXPECT_TRUE(delta.getDecomposition().empty());
+}
+
+TEST(ThLeftNormalForm, WordConstructor) {
+  std::mt19937 g(0);
+
+  for (int n : {3, 5, 8, 17}) {
+    const BraidGroup G(n);
+
+    for (int i = 0; i < 30; ++i) {
+      const auto w = random::randomWord(n - 1, 1, 60, g);
+      EXPECT_EQ(fromRightNormalForm(G, w), ThLeftNormalForm(G, w)) << w;
+    }
+  }
+}
+
+TEST(ThLeftNormalForm, AppendGenerator) {
+  std::mt19937 g(0);
+  const BraidGroup G(6);
+
+  for (int i = 0; i < 30; ++i) {
+    const auto w = random::randomWord(5, 1, 40, g);
+
+    ThLeftNormalForm nf(G.getRank());
+    for (const auto letter : w) {
+      nf.appendGenerator(letter);
+    }
+
+    EXPECT_EQ(ThLeftNormalForm(G, w), nf) << w;
+  }
+
+  ThLeftNormalForm nf(G.getRank());
+  EXPECT_THROW(nf.appendGenerator(0), std::invalid_argument);
+  EXPECT_THROW(nf.appendGenerator(-6), std::invalid_argument);
+}
+
+TEST(ThLeftNormalForm, AppendSimple) {
+  std::mt19937 g(0);
+  const BraidGroup G(7);
+  const auto omega = Permutation::getHalfTwistPermutation(7);
+
+  for (int i = 0; i < 30; ++i) {
+    const auto w = random::randomWord(6, 1, 40, g);
+    const auto p = Permutation::random(7);
+
+    ThLeftNormalForm nf(G, w);
+    nf.appendSimple(p);
+    EXPECT_EQ(ThLeftNormalForm(G, w * Word(p.geodesicWord())), nf) << w;
+
+    nf.appendSimple(omega);
+    EXPECT_EQ(ThLeftNormalForm(G, w * Word(p.geodesicWord()) * Word(omega.geodesicWord())), nf) << w;
+  }
+}
+
+TEST(ThLeftNormalForm, Multiply) {
+  std::mt19937 g(0);
+
+  for (int n : {4, 9}) {
+    const BraidGroup G(n);
+
+    for (int i = 0; i < 30; ++i) {
+      const auto u = random::randomWord(n - 1, 1, 50, g);
+      const auto v = random::randomWord(n - 1, 1, 50, g);
+      const ThLeftNormalForm a(G, u);
+      const ThLeftNormalForm b(G, v);
+
+      EXPECT_EQ(ThLeftNormalForm(G, u * v), a * b);
+      EXPECT_EQ(fromRightNormalForm(G, u * v), a * b);
+      EXPECT_TRUE((a * -a).isTrivial());
+
+      auto c = a;
+      c *= b;
+      EXPECT_EQ(a * b, c);
+    }
+  }
+}
+
+} // namespace
+} // namespace braidgroup
+} // namespace crag
@@ -46,5 +46,88 @@ TEST(LinkedBraidStructure, LongWords) {
     EXPECT_TRUE(areEqualBraids(n, w, w_short));
   }
 }
+
+TEST(LinkedBraidStructure, ShortenBraids) {
+  const size_t n = 8;
+
+  std::mt19937_64 g(0);
+
+  std::vector<Word> words;
+  for (size_t i = 0; i < 20; ++i) {
+    words.push_back(random::randomWord(n - 1, 50, 500, g));
+  }
+
+  const auto short_words = shortenBraids(n, words);
+
+  ASSERT_EQ(words.size(), short_words.size());
+  for (size_t i = 0; i < words.size(); ++i) {
+    EXPECT_EQ(shortenBraid2(n, words[i]), short_words[i]);
+    EXPECT_TRUE(areEqualBraids(n, words[i], short_words[i]));
+  }
+}
+
+TEST(LinkedBraidStructure, Undo) {
+  const size_t n = 8;
+
+  std::mt19937_64 g(0);
+
+  for (size_t i = 0; i < 20; ++i) {
+    const auto w = random::randomWord(n - 1, 50, 200, g);
+
+    LinkedBraidStructure lbs(n - 1, w);
+    std::list<LinkedBraidStructureTransform> history;
+    lbs.removeLeftHandles(&history);
+    lbs.removeRightHandles(&history);
+    lbs.undo(history);
+
+    EXPECT_EQ(w.length(), lbs.size());
+    EXPECT_TRUE(areEqualBraids(n, w, lbs.translateIntoWord()));
+  }
+}
+
+TEST(LinkedBraidStructure, UndoKeepsOrder) {
+  const size_t n = 8;
+
+  std::mt19937_64 g(0);
+
+  for (size_t i = 0; i < 20; ++i) {
+    const auto w = random::randomWord(n - 1, 50, 200, g);
+
+    // the restored nodes keep their numbers, so the handles are removed in the same order again
+    LinkedBraidStructure lbs(n - 1, w);
+    std::list<LinkedBraidStructureTransform> history;
+    lbs.removeLeftHandles(&history);
+    const auto reduced = lbs.translateIntoWord();
+    lbs.undo(history);
+
+    std::list<LinkedBraidStructureTransform> repeated_history;
+    lbs.removeLeftHandles(&repeated_history);
+    EXPECT_EQ(reduced, lbs.translateIntoWord());
+    ASSERT_EQ(history.size(), repeated_history.size());
+    EXPECT_TRUE(std::equal(
+        history.begin(), history.end(), repeated_history.begin(),
+        [](const LinkedBraidStructureTransform& a, const LinkedBraidStructureTransform& b) {
+          return a.theTransform == b.theTransform && a.theNumber == b.theNumber && a.thePosition == b.thePosition;
+        }));
+  }
+}
+
+TEST(LinkedBraidStructure, Assign) {
+  const size_t n = 8;
+
+  std::mt19937_64 g(0);
+
+  LinkedBraidStructure lbs(0);
+  for (size_t i = 0; i < 20; ++i) {
+    const auto w = random::randomWord(n - 1, 50, 200, g);
+
+    lbs.assign(n - 1, w);
+    EXPECT_EQ(w.length(), lbs.size());
+    EXPECT_EQ(LinkedBraidStructure(n - 1, w).translateIntoWord(), lbs.translateIntoWord());
+
+    lbs.removeLeftHandles();
+    EXPECT_TRUE(areEqualBraids(n, w, lbs.translateIntoWord()));
+  }
+}
 } // namespace
 } // namespace crag
@@ -0,0 +1,126 @@
+#include <gtest/gtest.h>
+
+#include <random>
+
+#include "ThLeftNormalForm.h"
+#include "ThRightNormalForm.h"
+#include "summit_set.h"
+
+#include "braid_group.h"
+#include "random_word.h"
+
+namespace crag {
+namespace braidgroup {
+namespace {
+
+TEST(SummitSet, EncodeDecode) {
+  std::mt19937 g(0);
+
+  for (int n : {3, 7, 300}) {
+    const BraidGroup G(n);
+    const SummitSet<ThLeftNormalForm> set(n, 0);
+
+    for (int i = 0; i < 10; ++i) {
+      const ThLeftNormalForm nf(G, random::randomWord(n - 1, 1, 30, g));
+      EXPECT_EQ(nf, set.decode(set.encode(nf)));
+    }
+  }
+}
+
+TEST(SummitSet, InsertAndFrontier) {
+  const BraidGroup G(4);
+  SummitSet<ThRightNormalForm> set(4, 2);
+
+  const ThRightNormalForm a(G, "x1 x2"_w);
+  const ThRightNormalForm b(G, "x2 x3^-1"_w);
+
+  EXPECT_TRUE(set.insert(a, ThRightNormalForm(4)));
+  EXPECT_FALSE(set.insert(a, ThRightNormalForm(4)));
+  EXPECT_FALSE(set.full());
+  EXPECT_TRUE(set.insert(b, a, 3));
+  EXPECT_TRUE(set.full());
+
+  ASSERT_NE(nullptr, set.find(b));
+  EXPECT_EQ(a, set.find(b)->conjugator);
+  EXPECT_EQ(3, set.find(b)->period);
+  EXPECT_EQ(nullptr, set.find(a * b));
+
+  EXPECT_EQ(2, set.takeFrontier().size());
+  EXPECT_EQ(0, set.frontierSize());
+  EXPECT_EQ(2, set.size());
+}
+
+TEST(SummitSet, InvalidRank) {
+  EXPECT_THROW(SummitSet<ThLeftNormalForm>(0, 0), std::invalid_argument);
+}
+
+class SummitSetConjugacy : public ::testing::TestWithParam<bool> {};
+
+TEST_P(SummitSetConjugacy, LeftNormalForm) {
+  std::mt19937 g(1);
+  const BraidGroup G(5);
+
+  SummitSetOptions options;
+  options.bidirectional = GetParam();
+
+  for (int i = 0; i < 10; ++i) {
+    const ThLeftNormalForm a(G, random::randomWord(4, 1, 20, g));
+    const ThLeftNormalForm r(G, random::randomWord(4, 1, 20, g));
+    const auto b = r * a * -r;
+
+    SummitSetStatistics statistics;
+    const auto result = a.areConjugate_uss(b, options, &statistics);
+    ASSERT_TRUE(result.first);
+    EXPECT_EQ(b, result.second * a * -result.second);
+    EXPECT_FALSE(statistics.size_limit_reached);
+    EXPECT_FALSE(statistics.time_limit_reached);
+  }
+}
+
+TEST_P(SummitSetConjugacy, RightNormalForm) {
+  std::mt19937 g(2);
+  const BraidGroup G(5);
+
+  SummitSetOptions options;
+  options.bidirectional = GetParam();
+
+  for (int i = 0; i < 10; ++i) {
+    const ThRightNormalForm a(G, random::randomWord(4, 1, 20, g));
+    const ThRightNormalForm r(G, random::randomWord(4, 1, 20, g));
+    const auto b = r * a * -r;
+
+    const auto result = a.areConjugate(b, options);
+    ASSERT_TRUE(result.first);
+    EXPECT_EQ(b, result.second * a * -result.second);
+  }
+}
+
+INSTANTIATE_TEST_CASE_P(Directions, SummitSetConjugacy, ::testing::Bool());
+
+TEST(SummitSet, SizeLimitAndProgress) {
+  const BraidGroup G(6);
+  // non-conjugate braids with the same infimum and supremum
+  const ThRightNormalForm a(G, "x1 x1 x3 x5^-1 x2 x4^-1"_w);
+  const ThRightNormalForm b(G, "x1 x3 x3 x5^-1 x2 x4^-1"_w);
+
+  SummitSetOptions options;
+  options.max_size = 10;
+  size_t calls = 0;
+  options.progress = [&calls](const SummitSetStatistics&) { ++calls; };
+
+  SummitSetStatistics statistics;
+  const auto result = a.areConjugate(b, options, &statistics);
+  EXPECT_FALSE(result.first);
+  EXPECT_TRUE(statistics.size_limit_reached);
+  EXPECT_EQ(statistics.levels, calls);
+  EXPECT_GT(calls, 0);
+
+  // without the limit the super summit sets are constructed completely
+  EXPECT_FALSE(a.areConjugate(b, SummitSetOptions(), &statistics).first);
+  EXPECT_FALSE(statistics.size_limit_reached);
+  EXPECT_GT(statistics.size1, options.max_size);
+}
+
+} // namespace
+} // namespace braidgroup
+} // namespace crag
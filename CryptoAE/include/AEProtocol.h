@@ -16,9 +16,12 @@
 
 #include "Word.h"
 #include "ThLeftNormalForm.h"
+#include <cstdint>
 #include <vector>
 #include <utility>
 
+#include <boost/align/aligned_allocator.hpp>
+
 using namespace std;
 
 class TTPTuple;
@@ -186,32 +189,51 @@ private:
 class MatrixFp
 {
 	public:
-		MatrixFp( int n, int p ): the_n( n ), the_p( p ) { init(); }
-		~MatrixFp() { clean(); }
-		MatrixFp( const MatrixFp& m );
-		MatrixFp& operator = (const MatrixFp& m);
+		//! Zero n x n matrix over Z_p, p must be in [2, 2^31).
+		MatrixFp( int n, int p );
+		
+		bool operator == ( const MatrixFp& m ) const { return the_n==m.the_n && the_p==m.the_p && theMatrix==m.theMatrix; }
+		bool operator != ( const MatrixFp& m ) const { return !( *this==m ); }
+		
+		MatrixFp operator + ( const MatrixFp& w ) const;
+		MatrixFp operator * ( const MatrixFp& w ) const;
+		MatrixFp scalar_mult( int l ) const;  
 		
-	  	inline MatrixFp operator + ( const MatrixFp& w ) const;
-	  	inline MatrixFp operator * ( const MatrixFp& w ) const;
-		inline MatrixFp scalar_mult( int l ) const;  
+		//! Computes the power by repeated squaring.
 		MatrixFp getPower( int e )const;
 		
+		//! Product of the matrices from left to right, computed with two buffers only.
+		static MatrixFp product( const vector< MatrixFp >& ms );
+		
+		//! Multiplies by the matrix of a colored Burau generator on the right, i.e., by the identity matrix
+		//! with entries (i,i) and (i,i-1) set to t. Only the columns i and i-1 change, so it takes O(n).
+		void multiplyByGenerator( int i, int t );
+		
 		static MatrixFp random( int n, int p );
 		static MatrixFp ID( int n, int p );		
 		
+		int get(int i,int j) const { 
+			return theMatrix[i*the_n+j];
+		} 
 		void set(int i,int j, int v) { 
-			theMatrix[i][j] = v;
+			theMatrix[i*the_n+j] = v;
 		} 
 	private:
 	
 	// METHODS
-		void init();
-		void clean();
+		//! res = a * b, res must be a different matrix of the same size
+		static void multiply( const MatrixFp& a, const MatrixFp& b, MatrixFp& res );
+		//! Barrett reduction of x modulo the_p
+		uint32_t reduce( uint64_t x ) const;
 	// DATA
 		int the_n;
 		int the_p;
-//		int** theMatrix;
-		vector< vector<int> > theMatrix;		
+		//! floor((2^64 - 1) / p)
+		uint64_t theBarrettFactor;
+		//! number of products of residues which can be summed up in a 64-bit accumulator
+		int theReductionPeriod;
+		//! entries in the row-major order, aligned for vector loads
+		vector< uint32_t , boost::alignment::aligned_allocator< uint32_t , 32 > > theMatrix;		
 };
 
 typedef pair<MatrixFp,Permutation> ProdElement;
@@ -233,13 +255,13 @@ class AEKeyExchange
 			int r = 10;
 			int m = 10;
 			int wl = 10;
-			generatePublicKey( theTTPTuple.WL , r , m , wl );
+			return generatePublicKey( theTTPTuple.WL , r , m , wl );
 		}
 		ProdElement bobPublicKey() {
 			int r = 10;
 			int m = 10;
 			int wl = 10;
-			generatePublicKey( theTTPTuple.WR , r , m , wl );
+			return generatePublicKey( theTTPTuple.WR , r , m , wl );
 		}
 
 
@@ -248,6 +270,8 @@ class AEKeyExchange
 	private:
 	
 		ProdElement starMult( const ProdElement& pe, const BurauGenerator& bg );
+		//! Applies the generators one by one, the matrix is updated in place.
+		ProdElement starMult( const ProdElement& pe, const vector< BurauGenerator >& bgs );
 		ProdElement generatePublicKey( const vector<Word>& v,  int r, int m, int wl );
 		
 		int the_n;
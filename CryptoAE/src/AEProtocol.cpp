@@ -430,42 +430,35 @@ bool TTPTuple::testTuples(int N, bool details) const {
 //
 //
 
-MatrixFp::MatrixFp( const MatrixFp& m  )
-{
-	if ( the_n != m.the_n )
-		msgs::error("MatrixFp( MatrixFp) : Matrices are of different size.");
-		
-	for ( int i=0;i<the_n;i++ )
-		for(int j=0;j<the_n;j++)
-			theMatrix[i][j] = m.theMatrix[i][j];
-			
-}
-
-MatrixFp& MatrixFp::operator = ( const MatrixFp& m )
+MatrixFp::MatrixFp( int n, int p ) : 
+  the_n( n ), 
+  the_p( p )
 {
+	if ( n<0 )
+		msgs::error("MatrixFp( n , p ) : Negative size of the matrix.");
+	if ( p<2 )
+		msgs::error("MatrixFp( n , p ) : The modulus has to be at least 2.");
 	
-	if ( the_n != m.the_n )
-		msgs::error("MatrixFp( MatrixFp) : Matrices are of different size.");
-		
-	for ( int i=0;i<the_n;i++ )
-		for(int j=0;j<the_n;j++)
-			theMatrix[i][j] = m.theMatrix[i][j];
-  return *this;
-}
-
-void MatrixFp::init()
-{
-	theMatrix = vector< vector<int> >(the_n,vector<int>(the_n,0));
-//	new int*[the_n];
-//	for (int i=0;i<the_n;i++){
-//		theMatrix[i] = new int[the_n];	
+	theBarrettFactor = UINT64_MAX / uint64_t( p );
+	
+	const uint64_t max_product = uint64_t( p-1 )*uint64_t( p-1 );
+	theReductionPeriod = int( std::min< uint64_t >( UINT64_MAX / max_product - 1 , INT32_MAX ) );
+	
+	theMatrix.assign( size_t( n )*n , 0 );
 }
 
-void MatrixFp::clean()
+uint32_t MatrixFp::reduce( uint64_t x ) const
 {
-//	for (int i=0;i<the_n;i++)
-//		delete [] theMatrix[i];
-//	delete [] theMatrix;
+#ifdef __SIZEOF_INT128__
+	// the quotient estimate is at most 2 less than the actual one
+	const uint64_t q = uint64_t( ( (unsigned __int128)x * theBarrettFactor ) >> 64 );
+	uint64_t r = x - q*uint64_t( the_p );
+	while ( r>=uint64_t( the_p ) )
+		r -= the_p;
+	return uint32_t( r );
+#else
+	return uint32_t( x % uint64_t( the_p ) );
+#endif
 }
 
 MatrixFp MatrixFp::random( int n, int p )
@@ -473,7 +466,7 @@ MatrixFp MatrixFp::random( int n, int p )
 	MatrixFp m(n,p);
 	for (int i=0;i<n;i++)
 		for (int j=0;j<n;j++)
-			m.theMatrix[i][j] = RandLib::ur.irand(0,p-1); // @am Change to satsify all conditions !!
+			m.set( i , j , RandLib::ur.irand(0,p-1) ); // @am Change to satsify all conditions !!
 	return m;
 }
 
@@ -481,52 +474,82 @@ MatrixFp MatrixFp::ID( int n, int p )
 {
 	MatrixFp m(n,p);
 	for (int i=0;i<n;i++)
-			m.theMatrix[i][i] = 1;
+			m.set( i , i , 1 );
 	return m;
 }
 
 
-MatrixFp MatrixFp::operator * ( const MatrixFp& m ) const
+void MatrixFp::multiply( const MatrixFp& a, const MatrixFp& b, MatrixFp& res )
 {
-	MatrixFp res(the_n,the_p);
+	const int n = a.the_n;
+	
+	// Row i of the result is accumulated as the sum of rows of b multiplied by a[i][k].
+	// The inner loop has no reduction and no dependency between iterations, so it is vectorized by the compiler.
+	vector< uint64_t , boost::alignment::aligned_allocator< uint64_t , 32 > > acc( n );
 	
-	if ( the_n != m.the_n )
+	for ( int i=0;i<n;i++ ) {
+		std::fill( acc.begin( ) , acc.end( ) , 0 );
+		const uint32_t* a_row = &a.theMatrix[i*n];
+		int terms = 0;
+		
+		for ( int k=0;k<n;k++ ) {
+			const uint64_t a_ik = a_row[k];
+			if ( a_ik==0 )
+				continue;
+			
+			if ( ++terms>a.theReductionPeriod ) {
+				for ( int j=0;j<n;j++ )
+					acc[j] = a.reduce( acc[j] );
+				terms = 1;
+			}
+			
+			const uint32_t* b_row = &b.theMatrix[k*n];
+			for ( int j=0;j<n;j++ )
+				acc[j] += a_ik*b_row[j];
+		}
+		
+		uint32_t* res_row = &res.theMatrix[i*n];
+		for ( int j=0;j<n;j++ )
+			res_row[j] = a.reduce( acc[j] );
+	}
+}
+
+
+MatrixFp MatrixFp::operator * ( const MatrixFp& m ) const
+{
+	if ( the_n != m.the_n || the_p != m.the_p )
 		msgs::error("MatrixFp * MatrixFp : Matrices are of different size.");
 
-	for (int i=0;i<the_n;i++)
-		for (int j=0;j<the_n;j++){
-			int  theSum = 0;
-			for (int k=0;k<the_n;k++)
-				theSum = (theSum + theMatrix[i][k]*m.theMatrix[k][j]) % the_p;
-			res.theMatrix[i][j] = theSum;
-		}
+	MatrixFp res(the_n,the_p);
+	multiply( *this , m , res );
 	return res;
 }
 
 
 MatrixFp MatrixFp::operator + ( const MatrixFp& m ) const
 {
-	if ( the_n != m.the_n )
-		msgs::error("MatrixFp * MatrixFp : Matrices are of different size.");
+	if ( the_n != m.the_n || the_p != m.the_p )
+		msgs::error("MatrixFp + MatrixFp : Matrices are of different size.");
 
 	MatrixFp res(the_n,the_p);
 
-	for (int i=0;i<the_n;i++)
-		for (int j=0;j<the_n;j++){
-			res.theMatrix[i][j] = (theMatrix[i][j] + m.theMatrix[i][j]) % the_p;
-		}
+	for ( size_t i=0;i<theMatrix.size();i++ ) {
+		const uint32_t sum = theMatrix[i] + m.theMatrix[i];
+		res.theMatrix[i] = sum>=uint32_t( the_p ) ? sum-the_p : sum;
+	}
 	return res;
 }
 
 MatrixFp MatrixFp::scalar_mult( int l ) const
 {
-
 	MatrixFp res(the_n,the_p);
+	
+	int ll = l%the_p;
+	if ( ll<0 )
+		ll += the_p;
 
-	for (int i=0;i<the_n;i++)
-		for (int j=0;j<the_n;j++){
-			res.theMatrix[i][j] = (theMatrix[i][j]*l) % the_p;
-		}
+	for ( size_t i=0;i<theMatrix.size();i++ )
+		res.theMatrix[i] = reduce( uint64_t( theMatrix[i] )*ll );
 	return res;
 }
 
@@ -534,13 +557,67 @@ MatrixFp MatrixFp::getPower( int e )const
 {
 	if (e<1)
 		msgs::error("MatrixFp::gegPower() : Power has to be positive");
+	
 	MatrixFp res( *this );
-	for (int i=0;i<e-1;i++)
-		res = res*(*this);
-		
+	MatrixFp square( *this );
+	MatrixFp tmp( the_n , the_p );
+	
+	// res = this^(highest bit of e), then for every next bit res = res^2 or res^2 * this
+	int bit = 30;
+	while ( !( e>>bit & 1 ) )
+		--bit;
+	
+	for ( --bit;bit>=0;--bit ) {
+		multiply( res , res , tmp );
+		if ( e>>bit & 1 ) {
+			multiply( tmp , *this , res );
+		} else {
+			std::swap( res.theMatrix , tmp.theMatrix );
+		}
+	}
+	
+	return res;
+}
+
+MatrixFp MatrixFp::product( const vector< MatrixFp >& ms )
+{
+	if ( ms.empty( ) )
+		msgs::error("MatrixFp::product() : The list of matrices is empty.");
+	
+	MatrixFp res( ms[0] );
+	MatrixFp tmp( res.the_n , res.the_p );
+	
+	for ( size_t i=1;i<ms.size();i++ ) {
+		if ( ms[i].the_n != res.the_n || ms[i].the_p != res.the_p )
+			msgs::error("MatrixFp::product() : Matrices are of different size.");
+		multiply( res , ms[i] , tmp );
+		std::swap( res.theMatrix , tmp.theMatrix );
+	}
+	
 	return res;
 }
 
+void MatrixFp::multiplyByGenerator( int i, int t )
+{
+	if ( i<0 || i>=the_n )
+		msgs::error("MatrixFp::multiplyByGenerator() : Index is out of range.");
+	
+	int tt = t%the_p;
+	if ( tt<0 )
+		tt += the_p;
+	
+	// column i becomes t * (column i), column i-1 gets t * (old column i) added
+	for ( int r=0;r<the_n;r++ ) {
+		uint32_t* row = &theMatrix[r*the_n];
+		const uint32_t m_ri = reduce( uint64_t( row[i] )*tt );
+		row[i] = m_ri;
+		if ( i>0 ) {
+			const uint32_t sum = row[i-1] + m_ri;
+			row[i-1] = sum>=uint32_t( the_p ) ? sum-the_p : sum;
+		}
+	}
+}
+
 //
 //
 //  AEKeyExchange
@@ -549,25 +626,27 @@ MatrixFp MatrixFp::getPower( int e )const
 
 ProdElement AEKeyExchange::starMult( const ProdElement& pe, const BurauGenerator& bg )
 {
-	// fix elements t_i in Fp to define homomorphism PI
+	return starMult( pe , vector< BurauGenerator >( 1 , bg ) );
+}
+
+ProdElement AEKeyExchange::starMult( const ProdElement& pe, const vector< BurauGenerator >& bgs )
+{
+	ProdElement res( pe );
 	vector<int>  T(the_n);
-	for (int i=0;i<the_n;i++)
-		T[i] = RandLib::ur.irand(0,the_p-1); //@am check if tis is correct
-		
-	// Compute the star operation
-	MatrixFp resM(the_n,the_p);
-	Permutation resP = pe.second*bg.second;
-	
-	MatrixFp evalMatrix(MatrixFp::ID(the_n,the_p));
-	// NOT SURE ABOUT INDICES
-	int t_val = T[pe.second[bg.first]]; // this together with next line is equal to \pi(s^x_i(t))
-	evalMatrix.set(bg.first,bg.first,t_val);
-	if( bg.first > 0)
-		evalMatrix.set(bg.first,bg.first-1,t_val);
 	
-	resM = pe.first*evalMatrix;
+	for ( const auto& bg : bgs ) {
+		// fix elements t_i in Fp to define homomorphism PI
+		for (int i=0;i<the_n;i++)
+			T[i] = RandLib::ur.irand(0,the_p-1); //@am check if tis is correct
+		
+		// Compute the star operation
+		// NOT SURE ABOUT INDICES
+		int t_val = T[res.second[bg.first]]; // this together with next line is equal to \pi(s^x_i(t))
+		res.first.multiplyByGenerator( bg.first , t_val );
+		res.second = res.second*bg.second;
+	}
 	
-	return ProdElement(resM,resP);
+	return res;
 }
 
 ProdElement AEKeyExchange::generatePublicKey( const vector<Word>& v, int r, int m, int wl )
@@ -601,17 +680,17 @@ ProdElement AEKeyExchange::generatePublicKey( const vector<Word>& v, int r, int
 		
 	// generate the public key
 	
-	ProdElement pubKey(N,Permutation());
+	vector< BurauGenerator > generators;
+	generators.reserve( wsAsOneWord.length( ) );
 	for (auto I=wsAsOneWord.begin();I!=wsAsOneWord.end();I++){
 		int wi = abs(*I)-1;
 		// @am not sure what to do with inverse. Pretend that all positive for now
 		Permutation p(the_n-1);  //@am check if n correct!!!
 		p.change(wi,wi+1);
-		BurauGenerator w_bg(wi,p);
-		pubKey = starMult(pubKey,w_bg);
+		generators.push_back( BurauGenerator(wi,p) );
 	}	
 	
-	return pubKey;
+	return starMult( ProdElement(N,Permutation()) , generators );
 }
 
 TTPTuple AEKeyExchange::generateTuples(const TTP_Conf &ttp_conf, const BSets &bs) {
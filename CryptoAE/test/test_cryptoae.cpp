@@ -5,6 +5,7 @@
 #include "braid_group.h"
 #include "ShortBraidForm.h"
 #include "LinkedBraidStructure.h"
+#include "RanlibCPP.h"
 
 namespace crag {
 namespace {
@@ -941,5 +942,92 @@ TEST(TestCryptoAE, IndexShift1) {
   EXPECT_TRUE(ttpLBA.reduce(N, BS, T, gens, 3600 * 2, cout, red_T));
 }
 
+MatrixFp naiveProduct(const MatrixFp& a, const MatrixFp& b, int n, int p) {
+  MatrixFp res(n, p);
+  for (int i = 0; i < n; ++i) {
+    for (int j = 0; j < n; ++j) {
+      long long sum = 0;
+      for (int k = 0; k < n; ++k) {
+        sum = (sum + (long long)a.get(i, k) * b.get(k, j)) % p;
+      }
+      res.set(i, j, sum);
+    }
+  }
+  return res;
+}
+
+class MatrixFpTest : public ::testing::TestWithParam<std::pair<int, int>> {};
+
+TEST_P(MatrixFpTest, Product) {
+  const int n = GetParam().first;
+  const int p = GetParam().second;
+  RandLib::ur.reset(1, 1);
+
+  for (int i = 0; i < 5; ++i) {
+    const auto a = MatrixFp::random(n, p);
+    const auto b = MatrixFp::random(n, p);
+    EXPECT_EQ(naiveProduct(a, b, n, p), a * b);
+    EXPECT_EQ(a, a * MatrixFp::ID(n, p));
+  }
+}
+
+TEST_P(MatrixFpTest, PowerAndProduct) {
+  const int n = GetParam().first;
+  const int p = GetParam().second;
+  RandLib::ur.reset(2, 2);
+
+  const auto a = MatrixFp::random(n, p);
+  auto expected = a;
+  for (int e = 1; e < 10; ++e) {
+    EXPECT_EQ(expected, a.getPower(e));
+    expected = expected * a;
+  }
+
+  const vector<MatrixFp> ms = {MatrixFp::random(n, p), MatrixFp::random(n, p), MatrixFp::random(n, p)};
+  EXPECT_EQ(ms[0] * ms[1] * ms[2], MatrixFp::product(ms));
+}
+
+TEST_P(MatrixFpTest, Generator) {
+  const int n = GetParam().first;
+  const int p = GetParam().second;
+  RandLib::ur.reset(3, 3);
+
+  for (int i = 0; i < n; ++i) {
+    const int t = RandLib::ur.irand(0, p - 1);
+    auto generator = MatrixFp::ID(n, p);
+    generator.set(i, i, t);
+    if (i > 0) {
+      generator.set(i, i - 1, t);
+    }
+
+    const auto a = MatrixFp::random(n, p);
+    auto b = a;
+    b.multiplyByGenerator(i, t);
+    EXPECT_EQ(a * generator, b);
+  }
+}
+
+TEST_P(MatrixFpTest, SumAndScalar) {
+  const int n = GetParam().first;
+  const int p = GetParam().second;
+  RandLib::ur.reset(4, 4);
+
+  const auto a = MatrixFp::random(n, p);
+  const auto b = MatrixFp::random(n, p);
+  const auto sum = a + b;
+  const auto scaled = a.scalar_mult(p - 1);
+  for (int i = 0; i < n; ++i) {
+    for (int j = 0; j < n; ++j) {
+      EXPECT_EQ(((long long)a.get(i, j) + b.get(i, j)) % p, sum.get(i, j));
+      EXPECT_EQ((long long)a.get(i, j) * (p - 1) % p, scaled.get(i, j));
+    }
+  }
+  EXPECT_EQ(MatrixFp(n, p), a + scaled);
+}
+
+INSTANTIATE_TEST_CASE_P(SizesAndPrimes, MatrixFpTest,
+                        ::testing::Values(std::make_pair(1, 2), std::make_pair(5, 7), std::make_pair(16, 257),
+                                          std::make_pair(33, 65521), std::make_pair(20, 2147483549)));
+
 } // namespace
 } // namespace crag
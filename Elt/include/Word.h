@@ -174,7 +174,7 @@ public:
     return impl_ptr_->toList();
   }
 
-  const std::vector<int>& toVector() const {
+  std::vector<int> toVector() const {
     return impl_ptr_->toVector();
   }
 
@@ -405,8 +405,12 @@ private:
   }
 
 private:
-  //! Clones the underlying word rep.
+  //! Clones the underlying word rep unless this word is its only owner.
   void clone_() {
+    if (impl_ptr_.use_count() == 1) {
+      return;
+    }
+
     WordRep copy = *impl_ptr_;
     impl_ptr_ = std::make_shared<WordRep>(std::move(copy));
   }
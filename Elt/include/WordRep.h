@@ -15,6 +15,8 @@
 
 //! Represents a group word.
 //! Usually a word is kept reduced, except for the cases when insert/replace functions are used.
+//! Letters are kept in a contiguous double-ended buffer: the word occupies [offset_, buffer_.size())
+//! and the slots before offset_ are headroom, so push_front/pop_front are amortized O(1).
 class WordRep {
 private:
   using storage_t = std::vector<int>;
@@ -56,19 +58,19 @@ public:
   const_reverse_iterator rend() const;
 
   int front() const {
-    return elements_.front();
+    return buffer_[offset_];
   }
 
   int& front() {
-    return elements_.front();
+    return buffer_[offset_];
   }
 
   int back() const {
-    return elements_.back();
+    return buffer_.back();
   }
 
   int& back() {
-    return elements_.back();
+    return buffer_.back();
   }
 
   // relational operators
@@ -109,15 +111,20 @@ public:
   bool contains(int gen) const;
 
   inline size_t length() const {
-    return elements_.size();
+    return buffer_.size() - offset_;
   }
 
   inline size_t size() const {
-    return elements_.size();
+    return buffer_.size() - offset_;
   }
 
   inline bool empty() const {
-    return elements_.empty();
+    return buffer_.size() == offset_;
+  }
+
+  //! The number of slots allocated for the letters and the headroom
+  inline size_t capacity() const {
+    return buffer_.capacity();
   }
 
   //! Counts exponent sum of x_{|gen|}
@@ -133,7 +140,8 @@ public:
 
   //! Make a word trivial
   inline void clear() {
-    elements_.clear();
+    buffer_.clear();
+    offset_ = 0;
   }
 
   //! Freely reduces this word.
@@ -212,7 +220,8 @@ public:
   }
 
   void pop_back() {
-    elements_.pop_back();
+    buffer_.pop_back();
+    reset_if_empty_();
   }
 
   void push_front(int g) {
@@ -220,15 +229,17 @@ public:
   }
 
   void pop_front() {
-    elements_.erase(elements_.begin());
+    ++offset_;
+    reset_if_empty_();
+    compact_();
   }
 
   std::list<int> toList() const {
-    return std::list<int>(elements_.begin(), elements_.end());
+    return std::list<int>(begin(), end());
   }
 
-  const std::vector<int>& toVector() const {
-    return elements_;
+  std::vector<int> toVector() const {
+    return std::vector<int>(begin(), end());
   }
 
 private:
@@ -246,17 +257,42 @@ private:
   }
 
   void validate_() const {
-    validate_(elements_.begin(), elements_.end());
+    validate_(begin(), end());
+  }
+
+  //! Drops the headroom once the word becomes empty, so that an empty word owns no stale slots.
+  void reset_if_empty_() {
+    if (empty()) {
+      clear();
+    }
   }
 
+  //! Moves the word back to MIN_FRONT_HEADROOM once the dead prefix outgrows it, so that repeated pop_front and
+  //! cyclic shifts keep the buffer O(size()). The move costs O(size()) and pays for at least size() dropped slots.
+  void compact_() {
+    if (offset_ > size() + MIN_FRONT_HEADROOM) {
+      compact_slow_();
+    }
+  }
+
+  void compact_slow_();
+
+  //! Makes sure that at least n letters can be prepended without reallocation.
+  void reserve_front_(size_t n);
+
   //! Multiply on the right and reduce
   void reduced_push_back_(int g);
 
   //! Multiply on the left and reduce
   void reduced_push_front_(int g);
 
-  // list of generators, negative integers represent inverses of positive integers
-  storage_t elements_;
+  //! Minimal headroom allocated in front of the word when it has to grow to the left.
+  static constexpr size_t MIN_FRONT_HEADROOM = 16;
+
+  // list of generators, negative integers represent inverses of positive integers,
+  // the word itself starts at offset_
+  storage_t buffer_;
+  size_t offset_ = 0;
 };
 
 template<class InputIterator>
@@ -272,7 +308,7 @@ template<class InputIterator>
 void WordRep::insert(size_t position, InputIterator begin, InputIterator end) {
   position = std::min(position, size());
 
-  auto it = elements_.begin();
+  auto it = this->begin();
   std::advance(it, position);
 
   insert(it, begin, end);
@@ -282,7 +318,7 @@ template<class InputIterator>
 void WordRep::insert(iterator position, InputIterator begin, InputIterator end) {
   validate_(begin, end);
 
-  elements_.insert(position, begin, end);
+  buffer_.insert(position, begin, end);
 }
 
 template<class InputIterator>
@@ -298,7 +334,7 @@ void WordRep::replace(size_t position, InputIterator b, InputIterator e) {
     throw std::invalid_argument("Bad position.");
   }
 
-  auto it = elements_.begin();
+  auto it = begin();
   std::advance(it, position);
 
   replace(it, b, e);
@@ -0,0 +1,155 @@
+#include <random>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "Word.h"
+
+// Reference implementations of the front operations on a plain std::vector layout.
+static void vectorPushFront(std::vector<int>& w, int g) {
+  if (!w.empty() && w.front() + g == 0) {
+    w.erase(w.begin());
+  } else {
+    w.insert(w.begin(), g);
+  }
+}
+
+static void vectorPushBack(std::vector<int>& w, int g) {
+  if (!w.empty() && w.back() + g == 0) {
+    w.pop_back();
+  } else {
+    w.push_back(g);
+  }
+}
+
+static std::vector<int> randomLetters(size_t length, int rank, std::mt19937& g) {
+  std::uniform_int_distribution<> d(1, rank);
+  std::bernoulli_distribution sign;
+
+  std::vector<int> result;
+  result.reserve(length);
+
+  while (result.size() < length) {
+    const int letter = sign(g) ? d(g) : -d(g);
+    vectorPushBack(result, letter);
+  }
+
+  return result;
+}
+
+static void BM_WordPushFront(benchmark::State& state) {
+  std::mt19937 g(1233);
+  const auto letters = randomLetters(state.range(0), 5, g);
+
+  while (state.KeepRunning()) {
+    Word w;
+
+    for (const auto l : letters) {
+      w.push_front(l);
+    }
+
+    benchmark::DoNotOptimize(w.size());
+  }
+
+  state.SetComplexityN(state.range(0));
+}
+
+static void BM_VectorPushFront(benchmark::State& state) {
+  std::mt19937 g(1233);
+  const auto letters = randomLetters(state.range(0), 5, g);
+
+  while (state.KeepRunning()) {
+    std::vector<int> w;
+
+    for (const auto l : letters) {
+      vectorPushFront(w, l);
+    }
+
+    benchmark::DoNotOptimize(w.size());
+  }
+
+  state.SetComplexityN(state.range(0));
+}
+
+//! Conjugates a word of length range(0) by one-letter words, as Walnut/Kayawood attacks do.
+static void BM_WordConjugation(benchmark::State& state) {
+  std::mt19937 g(1233);
+  const auto letters = randomLetters(state.range(0), 5, g);
+  const auto conjugators = randomLetters(1000, 5, g);
+
+  while (state.KeepRunning()) {
+    Word w(letters);
+
+    for (const auto c : conjugators) {
+      w ^= Word(c);
+    }
+
+    benchmark::DoNotOptimize(w.size());
+  }
+
+  state.SetComplexityN(state.range(0));
+}
+
+static void BM_VectorConjugation(benchmark::State& state) {
+  std::mt19937 g(1233);
+  const auto letters = randomLetters(state.range(0), 5, g);
+  const auto conjugators = randomLetters(1000, 5, g);
+
+  while (state.KeepRunning()) {
+    auto w = letters;
+
+    for (const auto c : conjugators) {
+      vectorPushFront(w, -c);
+      vectorPushBack(w, c);
+    }
+
+    benchmark::DoNotOptimize(w.size());
+  }
+
+  state.SetComplexityN(state.range(0));
+}
+
+static void BM_WordCyclicShift(benchmark::State& state) {
+  std::mt19937 g(1233);
+  const auto letters = randomLetters(state.range(0), 5, g);
+
+  while (state.KeepRunning()) {
+    Word w(letters);
+
+    for (int i = 0; i < 1000; ++i) {
+      w.cyclicRightShift();
+    }
+
+    benchmark::DoNotOptimize(w.size());
+  }
+
+  state.SetComplexityN(state.range(0));
+}
+
+static void BM_VectorCyclicShift(benchmark::State& state) {
+  std::mt19937 g(1233);
+  const auto letters = randomLetters(state.range(0), 5, g);
+
+  while (state.KeepRunning()) {
+    auto w = letters;
+
+    for (int i = 0; i < 1000; ++i) {
+      const int last = w.back();
+      w.pop_back();
+      vectorPushFront(w, last);
+    }
+
+    benchmark::DoNotOptimize(w.size());
+  }
+
+  state.SetComplexityN(state.range(0));
+}
+
+BENCHMARK(BM_WordPushFront)->RangeMultiplier(4)->Range(16, 1 << 16)->Complexity();
+BENCHMARK(BM_VectorPushFront)->RangeMultiplier(4)->Range(16, 1 << 16)->Complexity();
+BENCHMARK(BM_WordConjugation)->RangeMultiplier(4)->Range(16, 1 << 16)->Complexity();
+BENCHMARK(BM_VectorConjugation)->RangeMultiplier(4)->Range(16, 1 << 16)->Complexity();
+BENCHMARK(BM_WordCyclicShift)->RangeMultiplier(4)->Range(16, 1 << 16)->Complexity();
+BENCHMARK(BM_VectorCyclicShift)->RangeMultiplier(4)->Range(16, 1 << 16)->Complexity();
+
+BENCHMARK_MAIN();
@@ -12,15 +12,16 @@
 
 Word& Word::push_back(const Word& w) {
   clone_();
-
-  for (const auto g : w) {
-    impl_ptr_->push_back(g);
-  }
+  *impl_ptr_ *= *w.impl_ptr_;
 
   return *this;
 }
 
 Word& Word::push_front(const Word& w) {
+  if (this == &w) {
+    return push_front(w.clone());
+  }
+
   clone_();
 
   auto it = w.end();
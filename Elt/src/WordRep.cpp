@@ -10,26 +10,28 @@
 #include <cmath>
 #include <sstream>
 
+constexpr size_t WordRep::MIN_FRONT_HEADROOM;
+
 WordRep::WordRep(const std::list<int>& gens)
-  : elements_(gens.begin(), gens.end()) {
+  : buffer_(gens.begin(), gens.end()) {
   validate_();
   freelyReduce();
 }
 
 WordRep::WordRep(std::vector<int> gens)
-  : elements_(std::move(gens)) {
+  : buffer_(std::move(gens)) {
   validate_();
   freelyReduce();
 }
 
 
 WordRep::WordRep(int g)
-  : elements_({g}) {
+  : buffer_({g}) {
   validate_();
 }
 
 WordRep::WordRep(std::initializer_list<int> gens)
-  : elements_(gens) {
+  : buffer_(gens) {
   validate_();
   freelyReduce();
 }
@@ -43,35 +45,35 @@ std::string WordRep::toString() const {
 }
 
 WordRep::iterator WordRep::begin() {
-  return elements_.begin();
+  return buffer_.begin() + offset_;
 }
 
 WordRep::const_iterator WordRep::begin() const {
-  return elements_.begin();
+  return buffer_.begin() + offset_;
 }
 
 WordRep::iterator WordRep::end() {
-  return elements_.end();
+  return buffer_.end();
 }
 
 WordRep::const_iterator WordRep::end() const {
-  return elements_.end();
+  return buffer_.end();
 }
 
 WordRep::const_iterator WordRep::cbegin() const {
-  return elements_.cbegin();
+  return begin();
 }
 
 WordRep::const_iterator WordRep::cend() const {
-  return elements_.cend();
+  return end();
 }
 
 WordRep::const_reverse_iterator WordRep::rbegin() const {
-  return elements_.rbegin();
+  return const_reverse_iterator(end());
 }
 
 WordRep::const_reverse_iterator WordRep::rend() const {
-  return elements_.rend();
+  return const_reverse_iterator(begin());
 }
 
 WordRep& WordRep::operator^=(int power) {
@@ -87,17 +89,30 @@ WordRep& WordRep::operator^=(int power) {
 }
 
 WordRep& WordRep::operator^=(const WordRep& conjugator) {
-  auto result = conjugator.inverse();
-  result *= *this;
-  result *= conjugator;
+  if (this == &conjugator) {
+    // w^w = w
+    return *this;
+  }
+
+  // prepend conjugator^{-1} letter by letter, the headroom makes it O(|conjugator|)
+  reserve_front_(conjugator.size());
+
+  for (const auto g : conjugator) {
+    reduced_push_front_(-g);
+  }
 
-  elements_.swap(result.elements_);
+  *this *= conjugator;
 
   return *this;
 }
 
 WordRep& WordRep::operator*=(const WordRep& other) {
-  for (const auto g : other.elements_) {
+  if (this == &other) {
+    const auto copy = other;
+    return *this *= copy;
+  }
+
+  for (const auto g : other) {
     reduced_push_back_(g);
   }
 
@@ -107,27 +122,29 @@ WordRep& WordRep::operator*=(const WordRep& other) {
 bool WordRep::contains(int gen) const {
   validate_(gen);
 
-  return std::any_of(elements_.begin(), elements_.end(), [gen](int el) {
+  return std::any_of(begin(), end(), [gen](int el) {
     return std::abs(el) == std::abs(gen);
   });
 }
 
 void WordRep::cyclicLeftShift() {
-  if (elements_.size() < 2) {
+  if (size() < 2) {
     return;
   }
 
-  reduced_push_back_(elements_.front());
-  elements_.erase(elements_.begin());
+  const int g = front();
+  pop_front();
+  reduced_push_back_(g);
 }
 
 void WordRep::cyclicRightShift() {
-  if (elements_.size() < 2) {
+  if (size() < 2) {
     return;
   }
 
-  reduced_push_front_(elements_.back());
-  elements_.pop_back();
+  const int g = back();
+  pop_back();
+  reduced_push_front_(g);
 }
 
 
@@ -142,7 +159,7 @@ size_t WordRep::occurrences(int gen) const {
   const int abs_gen = std::abs(gen);
   size_t result = 0;
 
-  for (const auto el : elements_) {
+  for (const auto el : *this) {
     if (abs_gen == std::abs(el)) {
       ++result;
     }
@@ -159,7 +176,7 @@ int WordRep::exponentSum(int gen) const {
   const int abs_gen = std::abs(gen);
   int result = 0;
 
-  for (const auto el : elements_) {
+  for (const auto el : *this) {
     const int degree = (el > 0) ? 1 : -1;
 
     if (abs_gen == std::abs(el)) {
@@ -174,7 +191,7 @@ WordRep WordRep::inverse() const {
   storage_t elements;
   elements.reserve(size());
 
-  for (auto it = elements_.rbegin(); it != elements_.rend(); ++it) {
+  for (auto it = rbegin(); it != rend(); ++it) {
     elements.push_back(-*it);
   }
 
@@ -182,7 +199,7 @@ WordRep WordRep::inverse() const {
 }
 
 bool WordRep::operator==(const WordRep& other) const {
-  return elements_ == other.elements_;
+  return size() == other.size() && std::equal(begin(), end(), other.begin());
 }
 
 bool WordRep::operator!=(const WordRep& other) const {
@@ -197,8 +214,8 @@ bool WordRep::operator<(const WordRep& other) const {
     return this_size < other_size;
   }
 
-  auto this_it = elements_.begin();
-  auto other_it = other.elements_.begin();
+  auto this_it = begin();
+  auto other_it = other.begin();
 
   for (size_t t = 0; t < this_size; ++t) {
     if (*this_it < *other_it) {
@@ -221,13 +238,18 @@ bool WordRep::operator>(const WordRep& other) const {
 void WordRep::insert(iterator position, int g) {
   validate_({g});
 
-  elements_.insert(position, g);
+  if (position == begin() && offset_ > 0) {
+    buffer_[--offset_] = g;
+    return;
+  }
+
+  buffer_.insert(position, g);
 }
 
 void WordRep::insert(size_t position, int g) {
   position = std::min(position, size());
 
-  auto it = elements_.begin();
+  auto it = begin();
   std::advance(it, position);
 
   insert(it, g);
@@ -244,7 +266,7 @@ void WordRep::replace(size_t position, int g) {
     throw std::invalid_argument("Bad position.");
   }
 
-  auto it = elements_.begin();
+  auto it = begin();
   std::advance(it, position);
 
   replace(it, g);
@@ -264,10 +286,23 @@ void WordRep::cyclicallyPermute(int n) {
     return;
   }
 
-  auto middle = elements_.begin();
-  std::advance(middle, n);
+  // move the shorter of the two parts to the other end of the buffer
+  if (n <= sz - n) {
+    for (int i = 0; i < n; ++i) {
+      buffer_.push_back(buffer_[offset_ + i]);
+    }
+
+    offset_ += n;
+    compact_();
+  } else {
+    reserve_front_(sz - n);
 
-  std::rotate(elements_.begin(), middle, elements_.end());
+    for (int i = n; i < sz; ++i) {
+      const int g = buffer_.back();
+      buffer_.pop_back();
+      buffer_[--offset_] = g;
+    }
+  }
 
   freelyReduce();
 }
@@ -289,10 +324,10 @@ WordRep WordRep::subword(size_t from, size_t to) const {
   from = std::min(from, size());
   to = std::min(to, size());
 
-  auto it_begin = elements_.begin();
+  auto it_begin = begin();
   std::advance(it_begin, from);
 
-  auto it_end = elements_.begin();
+  auto it_end = begin();
   std::advance(it_end, to);
 
   return WordRep(it_begin, it_end);
@@ -301,7 +336,8 @@ WordRep WordRep::subword(size_t from, size_t to) const {
 void WordRep::initialSegment(size_t to) {
   to = std::min(to, size());
 
-  elements_.resize(to);
+  buffer_.resize(offset_ + to);
+  reset_if_empty_();
 }
 
 void WordRep::terminalSegment(size_t from) {
@@ -309,30 +345,30 @@ void WordRep::terminalSegment(size_t from) {
     from = size();
   }
 
-  auto it = elements_.begin();
-  std::advance(it, from);
-
-  elements_.erase(elements_.begin(), it);
+  offset_ += from;
+  reset_if_empty_();
+  compact_();
 }
 
 WordRep WordRep::cyclicallyReduce() {
   WordRep conjugator;
 
-  // TODO: rewrite using iterators to avoid erase
-  while (elements_.size() > 1) {
-    const auto b = elements_.front();
-    const auto e = elements_.back();
+  while (size() > 1) {
+    const auto b = front();
+    const auto e = back();
 
     if (e + b != 0) {
       break;
     }
 
-    elements_.pop_back();
-    elements_.erase(elements_.begin());
+    pop_back();
+    pop_front();
 
-    conjugator.elements_.insert(conjugator.elements_.begin(), e);
+    conjugator.buffer_.push_back(e);
   }
 
+  std::reverse(conjugator.buffer_.begin(), conjugator.buffer_.end());
+
   return conjugator;
 }
 
@@ -416,80 +452,68 @@ std::pair<WordRep, int> WordRep::root() const {
 };
 
 void WordRep::freelyReduce() {
-  for (auto it = elements_.begin(); it != elements_.end();) {
-    auto next = it;
-    ++next;
-
-    if (next == elements_.end()) {
-      return;
-    }
-
-    if (*it + *next != 0) {
-      it = next;
-      continue;
-    }
-
-    // reduction
-    const auto is_beginning = (it == elements_.begin());
+  freelyReduce(begin(), end());
+}
 
-    it = elements_.erase(elements_.erase(it));
+void WordRep::freelyReduce(iterator begin, iterator end) {
+  // the reduced part of [begin, end) is kept as a stack growing from begin
+  auto top = begin;
 
-    if (!is_beginning) {
-      --it;
+  for (auto it = begin; it != end; ++it) {
+    if (top != begin && *(top - 1) + *it == 0) {
+      --top;
+    } else {
+      *(top++) = *it;
     }
   }
+
+  buffer_.erase(top, end);
+  reset_if_empty_();
 }
 
-void WordRep::freelyReduce(iterator begin, iterator end) {
-  // cut suffix
-  storage_t suffix(end, elements_.end());
-  elements_.erase(end, elements_.end());
+void WordRep::compact_slow_() {
+  const auto length = size();
+  std::move(buffer_.begin() + offset_, buffer_.end(), buffer_.begin() + MIN_FRONT_HEADROOM);
+  buffer_.resize(MIN_FRONT_HEADROOM + length);
+  offset_ = MIN_FRONT_HEADROOM;
+}
 
-  // cut prefix
-  storage_t prefix(elements_.begin(), begin);
-  elements_.erase(elements_.begin(), begin);
+void WordRep::reserve_front_(size_t n) {
+  if (offset_ >= n) {
+    return;
+  }
 
+  const auto headroom = std::max(std::max(n, size()), MIN_FRONT_HEADROOM);
 
-  // reduce the remaining part
-  freelyReduce();
+  storage_t buffer;
+  buffer.reserve(headroom + size());
+  buffer.resize(headroom);
+  buffer.insert(buffer.end(), begin(), end());
 
-  // put prefix and suffix back
-  elements_.insert(elements_.begin(), prefix.begin(), prefix.end());
-  elements_.insert(elements_.end(), suffix.begin(), suffix.end());
+  buffer_.swap(buffer);
+  offset_ = headroom;
 }
 
 void WordRep::reduced_push_back_(int g) {
   validate_({g});
 
-  if (elements_.empty()) {
-    elements_.push_back(g);
-    return;
-  }
-
-  const int last_el = elements_.back();
-
-  if (last_el + g == 0) {
-    elements_.pop_back();
+  if (!empty() && back() + g == 0) {
+    pop_back();
   } else {
-    elements_.push_back(g);
+    buffer_.push_back(g);
   }
 }
 
 void WordRep::reduced_push_front_(int g) {
   validate_({g});
 
-  if (elements_.empty()) {
-    elements_.push_back(g);
+  if (!empty() && front() + g == 0) {
+    pop_front();
     return;
   }
 
-  const int first_el = elements_.front();
-
-  if (first_el + g == 0) {
-    elements_.erase(elements_.begin());
-  } else {
-    elements_.insert(elements_.begin(), g);
-  }
+  reserve_front_(1);
+  buffer_[--offset_] = g;
 }
 
 std::ostream& operator<<(std::ostream& out, const WordRep& w) {
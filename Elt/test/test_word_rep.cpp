@@ -367,4 +367,109 @@ TEST(WordRep, ReplaceRange) {
 
   EXPECT_THROW({ w.replace(100, v.begin(), v.end()); }, std::invalid_argument);
 }
+
+TEST(WordRep, PushPopFront) {
+  WordRep w({1, 2});
+
+  w.push_front(3);
+  w.push_front(4);
+  EXPECT_EQ(WordRep({4, 3, 1, 2}), w);
+
+  w.push_front(-4);
+  EXPECT_EQ(WordRep({3, 1, 2}), w);
+
+  w.pop_front();
+  w.pop_front();
+  EXPECT_EQ(WordRep(2), w);
+
+  w.pop_front();
+  EXPECT_TRUE(w.empty());
+
+  for (int i = 1; i <= 100; ++i) {
+    w.push_front(i);
+    w.push_back(i);
+  }
+
+  EXPECT_EQ(200, w.size());
+  EXPECT_EQ(100, w.front());
+  EXPECT_EQ(100, w.back());
+
+  for (int i = 100; i > 50; --i) {
+    w.push_front(-i);
+    w.push_back(-i);
+  }
+
+  EXPECT_EQ(100, w.size());
+  EXPECT_EQ(50, w.front());
+  EXPECT_EQ(50, w.back());
+}
+
+TEST(WordRep, SegmentsAfterPushFront) {
+  WordRep w({3, 4, 5});
+
+  w.push_front(2);
+  w.push_front(1);
+
+  w.terminalSegment(1);
+  EXPECT_EQ(WordRep({2, 3, 4, 5}), w);
+
+  w.push_front(1);
+  w.initialSegment(3);
+  EXPECT_EQ(WordRep({1, 2, 3}), w);
+
+  EXPECT_EQ(WordRep({2, 3}), w.subword(1, 3));
+  EXPECT_EQ(std::vector<int>({1, 2, 3}), w.toVector());
+}
+
+TEST(WordRep, SelfConjugationAndMultiplication) {
+  WordRep w({1, 2, -3});
+
+  w ^= w;
+  EXPECT_EQ(WordRep({1, 2, -3}), w);
+
+  w *= w;
+  EXPECT_EQ(WordRep({1, 2, -3, 1, 2, -3}), w);
+}
+
+TEST(WordRep, CyclicPermutation_03) {
+  const WordRep w({1, 2, 3, 4, 5, 6, 7});
+
+  for (int n = -10; n <= 10; ++n) {
+    auto u = w;
+    u.cyclicallyPermute(n);
+
+    auto v = w;
+    for (int i = 0; i < ((n % 7) + 7) % 7; ++i) {
+      v.cyclicLeftShift();
+    }
+
+    EXPECT_EQ(v, u);
+  }
+}
+
+TEST(WordRep, CapacityStaysBounded) {
+  std::vector<int> letters;
+  for (int i = 0; i < 1000; ++i) {
+    letters.push_back(1 + i % 3);
+  }
+  const WordRep initial(letters);
+  auto w = initial;
+
+  for (int i = 0; i < 100000; ++i) {
+    w.cyclicLeftShift();
+  }
+  EXPECT_EQ(initial, w);
+  EXPECT_LT(w.capacity(), 8 * w.size());
+
+  const WordRep x(4);
+  const WordRep x_inverse(-4);
+  for (int i = 0; i < 100000; ++i) {
+    w ^= x;
+    w ^= x_inverse;
+    w.pop_front();
+    w.push_back(letters[i % 1000]);
+  }
+  EXPECT_EQ(initial, w);
+  EXPECT_LT(w.capacity(), 8 * w.size());
+}
 } // namespace
@@ -5,8 +5,12 @@
 
 #include <boost/math/tools/polynomial.hpp>
 #include <boost/random/uniform_int_distribution.hpp>
+#include <cstdint>
+#include <initializer_list>
 #include <iostream>
 #include <random>
+#include <stdexcept>
+#include <vector>
 
 #include "GCD.h"
 
@@ -14,7 +18,9 @@ namespace crag {
 namespace finitefield {
 
 //! Factor-field RingElement / Ideal. Ideal should be principal.
-template <typename Ideal>
+//! Fields with at most 256 elements (ZZ<p> and ZZ<2>[x] / (f)) are specialized below,
+//! the specializations keep the same interface but store an element in a single byte.
+template <typename Ideal, typename Enable = void>
 class FieldElement {
 public:
   using RingElement = typename Ideal::RingElement;
@@ -257,6 +263,361 @@ public:
 template <int p>
 using ZZ = finitefield::FieldElement<finitefield::IdealGeneratedByInteger<p>>;
 
+namespace details {
+
+//! Log/antilog tables of a field with q <= 256 elements, elements are encoded by bytes 0,...,q-1 with 0 for zero.
+//! exp[k] = g^k for 0 <= k < 2(q-1) and a primitive element g, the rest of exp is zero.
+//! log[0] = 2(q-1), so that exp[log[a] + log[b]] is a * b for all a, b including zero.
+struct SmallFieldTables {
+  uint8_t exp[4 * 255 + 1];
+  uint16_t log[256];
+  uint8_t inv[256];
+};
+
+//! Multiplication of residues modulo a prime p.
+struct PrimeFieldMultiplier {
+  unsigned p;
+
+  constexpr unsigned operator()(unsigned a, unsigned b) const {
+    return (a * b) % p;
+  }
+};
+
+//! Multiplication of bit masks of polynomials over ZZ<2> modulo a polynomial of the given degree.
+struct BinaryFieldMultiplier {
+  unsigned modulus;
+  unsigned degree;
+
+  constexpr unsigned operator()(unsigned a, unsigned b) const {
+    unsigned r = 0;
+
+    for (unsigned i = 0; i < degree; ++i) {
+      if ((b >> i) & 1) {
+        r ^= a << i;
+      }
+    }
+
+    for (unsigned i = 2 * degree; i-- > degree;) {
+      if ((r >> i) & 1) {
+        r ^= modulus << (i - degree);
+      }
+    }
+
+    return r;
+  }
+};
+
+//! Returns a generator of the multiplicative group of [1, q) under mul, or 0 if there is none (mul is not a field).
+template <typename Multiplier>
+constexpr unsigned findPrimitiveElement(unsigned q, Multiplier mul) {
+  for (unsigned c = 1; c < q; ++c) {
+    unsigned x = c;
+    unsigned order = 1;
+
+    while (x != 1 && order < q) {
+      x = mul(x, c);
+      ++order;
+    }
+
+    if (order == q - 1) {
+      return c;
+    }
+  }
+
+  return 0;
+}
+
+template <typename Multiplier>
+constexpr SmallFieldTables buildSmallFieldTables(unsigned q, Multiplier mul) {
+  SmallFieldTables tables{};
+
+  const unsigned order = q - 1;
+  const unsigned g = findPrimitiveElement(q, mul);
+
+  unsigned x = 1;
+
+  for (unsigned k = 0; k < 2 * order; ++k) {
+    tables.exp[k] = static_cast<uint8_t>(x);
+    x = mul(x, g);
+  }
+
+  for (unsigned k = 0; k < order; ++k) {
+    tables.log[tables.exp[k]] = static_cast<uint16_t>(k);
+  }
+
+  tables.log[0] = static_cast<uint16_t>(2 * order);
+
+  for (unsigned a = 1; a < q; ++a) {
+    tables.inv[a] = tables.exp[order - tables.log[a]];
+  }
+
+  return tables;
+}
+
+constexpr bool isPrime(int p) {
+  if (p < 2) {
+    return false;
+  }
+
+  for (int d = 2; d * d <= p; ++d) {
+    if (p % d == 0) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+constexpr bool isSmallPrimeField(int p) {
+  return isPrime(p) && p <= 256;
+}
+
+//! Bit mask of a polynomial over ZZ<2> given by its coefficients (the lowest degree first).
+constexpr unsigned binaryPolynomialMask(std::initializer_list<int> coefs) {
+  unsigned mask = 0;
+  unsigned bit = 0;
+
+  for (const auto c : coefs) {
+    if (c % 2 != 0) {
+      mask |= 1u << bit;
+    }
+
+    ++bit;
+  }
+
+  return mask;
+}
+
+//! Checks that ZZ<2>[x] / (f) is a field with at most 256 elements, f is given by its coefficients.
+template <int... cs>
+constexpr bool isSmallBinaryField() {
+  const unsigned degree = sizeof...(cs) - 1;
+
+  if (sizeof...(cs) < 2 || degree > 8) {
+    return false;
+  }
+
+  const unsigned modulus = binaryPolynomialMask({cs...});
+
+  if ((modulus >> degree) != 1) {
+    return false;
+  }
+
+  return findPrimitiveElement(1u << degree, BinaryFieldMultiplier{modulus, degree}) != 0;
+}
+
+template <int p>
+constexpr SmallFieldTables prime_field_tables = buildSmallFieldTables(p, PrimeFieldMultiplier{p});
+
+template <int... cs>
+constexpr SmallFieldTables binary_field_tables = buildSmallFieldTables(
+    1u << (sizeof...(cs) - 1), BinaryFieldMultiplier{binaryPolynomialMask({cs...}), sizeof...(cs) - 1});
+} // namespace details
+
+
+//! Prime field ZZ<p> with p <= 256. An element is stored as its canonical residue in a byte,
+//! multiplication and inversion are lookups in the compile-time tables details::prime_field_tables<p>.
+template <int p>
+class FieldElement<IdealGeneratedByInteger<p>, typename std::enable_if<details::isSmallPrimeField(p)>::type> {
+public:
+  using RingElement = int;
+
+  FieldElement()
+      : n_(0) {}
+
+  FieldElement(const RingElement& n)
+      : n_(canonical_(n)) {}
+
+  template <typename T, typename = typename std::enable_if<!std::is_same<T, RingElement>::value>::type>
+  explicit FieldElement(const T& n)
+      : n_(canonical_(RingElement(n))) {}
+
+  const FieldElement& operator+=(const FieldElement& rhs) {
+    const unsigned s = static_cast<unsigned>(n_) + rhs.n_;
+    n_ = static_cast<uint8_t>(s >= p ? s - p : s);
+
+    return *this;
+  }
+
+  const FieldElement& operator-=(const FieldElement& rhs) {
+    const unsigned s = static_cast<unsigned>(n_) + p - rhs.n_;
+    n_ = static_cast<uint8_t>(s >= p ? s - p : s);
+
+    return *this;
+  }
+
+  const FieldElement& operator*=(const FieldElement& rhs) {
+    n_ = tables().exp[tables().log[n_] + tables().log[rhs.n_]];
+
+    return *this;
+  }
+
+  const FieldElement& operator/=(const FieldElement& rhs) {
+    return *this *= rhs.inverse();
+  }
+
+  FieldElement inverse() const {
+    if (n_ == 0) {
+      throw std::logic_error("Division by zero");
+    }
+
+    return fromCode(tables().inv[n_]);
+  }
+
+  RingElement value() const {
+    return n_;
+  }
+
+  template <typename URNG>
+  static RingElement random(URNG& g) {
+    return IdealGeneratedByInteger<p>::random(g);
+  }
+
+  //! The canonical residue of the element, a number in [0, p).
+  uint8_t code() const {
+    return n_;
+  }
+
+  static FieldElement fromCode(uint8_t code) {
+    FieldElement result;
+    result.n_ = code;
+    return result;
+  }
+
+  static const details::SmallFieldTables& tables() {
+    return details::prime_field_tables<p>;
+  }
+
+  friend bool operator==(const FieldElement& lhs, const FieldElement& rhs) {
+    return lhs.n_ == rhs.n_;
+  }
+
+  friend bool operator!=(const FieldElement& lhs, const FieldElement& rhs) {
+    return lhs.n_ != rhs.n_;
+  }
+
+private:
+  static uint8_t canonical_(int n) {
+    const auto m = n % p;
+
+    return static_cast<uint8_t>(m < 0 ? m + p : m);
+  }
+
+  uint8_t n_;
+};
+
+
+//! Binary field ZZ<2>[x] / (f) with deg f <= 8. An element is stored as the bit mask of its coefficients
+//! (bit i is the coefficient of x^i), so addition is XOR, multiplication and inversion are lookups
+//! in the compile-time tables details::binary_field_tables<cs...>.
+template <int... cs>
+class FieldElement<
+    IdealGeneratedByPolynomial<ZZ<2>, cs...>,
+    typename std::enable_if<details::isSmallBinaryField<cs...>()>::type> {
+public:
+  using RingElement = typename IdealGeneratedByPolynomial<ZZ<2>, cs...>::RingElement;
+
+  FieldElement()
+      : n_(0) {}
+
+  FieldElement(const RingElement& n)
+      : n_(canonical_(n)) {}
+
+  template <typename T, typename = typename std::enable_if<!std::is_same<T, RingElement>::value>::type>
+  explicit FieldElement(const T& n)
+      : n_(canonical_(RingElement(n))) {}
+
+  const FieldElement& operator+=(const FieldElement& rhs) {
+    n_ ^= rhs.n_;
+
+    return *this;
+  }
+
+  const FieldElement& operator-=(const FieldElement& rhs) {
+    n_ ^= rhs.n_;
+
+    return *this;
+  }
+
+  const FieldElement& operator*=(const FieldElement& rhs) {
+    n_ = tables().exp[tables().log[n_] + tables().log[rhs.n_]];
+
+    return *this;
+  }
+
+  const FieldElement& operator/=(const FieldElement& rhs) {
+    return *this *= rhs.inverse();
+  }
+
+  FieldElement inverse() const {
+    if (n_ == 0) {
+      throw std::logic_error("Division by zero");
+    }
+
+    return fromCode(tables().inv[n_]);
+  }
+
+  //! The canonical representative, a polynomial of degree less than deg f (the zero polynomial has no coefficients).
+  RingElement value() const {
+    std::vector<ZZ<2>> coefs;
+
+    for (unsigned code = n_; code != 0; code >>= 1) {
+      coefs.push_back(ZZ<2>::fromCode(code & 1));
+    }
+
+    return RingElement(coefs.begin(), coefs.end());
+  }
+
+  template <typename URNG>
+  static RingElement random(URNG& g) {
+    return IdealGeneratedByPolynomial<ZZ<2>, cs...>::random(g);
+  }
+
+  //! The bit mask of the coefficients of the canonical representative.
+  uint8_t code() const {
+    return n_;
+  }
+
+  static FieldElement fromCode(uint8_t code) {
+    FieldElement result;
+    result.n_ = code;
+    return result;
+  }
+
+  static const details::SmallFieldTables& tables() {
+    return details::binary_field_tables<cs...>;
+  }
+
+  friend bool operator==(const FieldElement& lhs, const FieldElement& rhs) {
+    return lhs.n_ == rhs.n_;
+  }
+
+  friend bool operator!=(const FieldElement& lhs, const FieldElement& rhs) {
+    return lhs.n_ != rhs.n_;
+  }
+
+private:
+  static constexpr unsigned degree_ = sizeof...(cs) - 1;
+  static constexpr unsigned modulus_ = details::binaryPolynomialMask({cs...});
+
+  //! Reduces a polynomial modulo f by the Horner scheme on bit masks.
+  static uint8_t canonical_(const RingElement& n) {
+    unsigned r = 0;
+
+    for (size_t i = n.size(); i-- > 0;) {
+      r = (r << 1) | n[i].code();
+
+      if ((r >> degree_) & 1) {
+        r ^= modulus_;
+      }
+    }
+
+    return static_cast<uint8_t>(r);
+  }
+
+  uint8_t n_;
+};
+
 //! Generates random field element not equal to 0 or 1.
 //! Doesn't work for ZZ<2>.
 template <typename T, typename URNG, typename = typename std::enable_if<!std::is_same<T, ZZ<2>>::value>::type>
@@ -0,0 +1,196 @@
+#pragma once
+
+#ifndef CRAG_SMALL_FINITE_FIELD_H
+#define CRAG_SMALL_FINITE_FIELD_H
+
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+#include "FiniteField.h"
+
+namespace crag {
+namespace finitefield {
+
+//! Describes how elements of a finite field T with at most 256 elements are encoded by bytes.
+//! Specializations with is_small == true provide
+//!     static constexpr size_t size;             // the number of elements q
+//!     static uint8_t encode(const T&);          // a bijection onto [0, q) mapping zero to 0
+//!     static T decode(uint8_t);
+//!     static uint8_t add(uint8_t, uint8_t);     // branch-free addition of codes
+//!     static uint8_t sub(uint8_t, uint8_t);     // branch-free subtraction of codes
+//!     static const details::SmallFieldTables& tables();  // the exp/log/inverse tables of FieldElement
+template <typename T>
+struct SmallFieldEncoding {
+  static constexpr bool is_small = false;
+};
+
+//! Prime field ZZ<p>, an element is encoded by its canonical residue.
+template <int p>
+struct SmallFieldEncoding<FieldElement<IdealGeneratedByInteger<p>>> {
+  using element_t = FieldElement<IdealGeneratedByInteger<p>>;
+
+  static constexpr bool is_small = details::isSmallPrimeField(p);
+  static constexpr size_t size = p;
+
+  static uint8_t encode(const element_t& x) {
+    return x.code();
+  }
+
+  static element_t decode(uint8_t x) {
+    return element_t::fromCode(x);
+  }
+
+  static const details::SmallFieldTables& tables() {
+    return element_t::tables();
+  }
+
+  static uint8_t add(uint8_t a, uint8_t b) {
+    const unsigned s = static_cast<unsigned>(a) + b;
+    return static_cast<uint8_t>(s >= p ? s - p : s);
+  }
+
+  static uint8_t sub(uint8_t a, uint8_t b) {
+    const unsigned s = static_cast<unsigned>(a) + p - b;
+    return static_cast<uint8_t>(s >= p ? s - p : s);
+  }
+};
+
+//! Binary extension field ZZ<2>[x] / (f) with deg f <= 8, an element is encoded by the bit mask of its coefficients.
+template <int... cs>
+struct SmallFieldEncoding<FieldElement<IdealGeneratedByPolynomial<ZZ<2>, cs...>>> {
+  using element_t = FieldElement<IdealGeneratedByPolynomial<ZZ<2>, cs...>>;
+
+  static constexpr bool is_small = details::isSmallBinaryField<cs...>();
+  static constexpr size_t size = size_t(1) << (sizeof...(cs) - 1);
+
+  static uint8_t encode(const element_t& x) {
+    return x.code();
+  }
+
+  static element_t decode(uint8_t x) {
+    return element_t::fromCode(x);
+  }
+
+  static const details::SmallFieldTables& tables() {
+    return element_t::tables();
+  }
+
+  static uint8_t add(uint8_t a, uint8_t b) {
+    return a ^ b;
+  }
+
+  static uint8_t sub(uint8_t a, uint8_t b) {
+    return a ^ b;
+  }
+};
+
+//! Arithmetic tables of a finite field T with at most 256 elements.
+//! FieldElement multiplies through the compile-time exp/log tables of details::SmallFieldTables, this class
+//! expands them into the full multiplication table, so that a row mulRow(c) can be applied to a whole column
+//! of codes. Since both use the same tables, decoding the result of a lookup gives exactly the element
+//! FieldElement would compute.
+template <typename T>
+class SmallField {
+public:
+  using encoding_t = SmallFieldEncoding<T>;
+
+  static_assert(encoding_t::is_small, "SmallField requires a field with at most 256 elements.");
+
+  //! Returns the tables of the field, they are built on the first call.
+  static const SmallField& instance() {
+    static const SmallField field;
+    return field;
+  }
+
+  SmallField(const SmallField&) = delete;
+  SmallField& operator=(const SmallField&) = delete;
+
+  //! The number of elements of the field.
+  size_t size() const {
+    return size_;
+  }
+
+  uint8_t encode(const T& x) const {
+    return encoding_t::encode(x);
+  }
+
+  const T& decode(uint8_t x) const {
+    return elements_[x];
+  }
+
+  uint8_t add(uint8_t a, uint8_t b) const {
+    return encoding_t::add(a, b);
+  }
+
+  uint8_t sub(uint8_t a, uint8_t b) const {
+    return encoding_t::sub(a, b);
+  }
+
+  uint8_t neg(uint8_t a) const {
+    return encoding_t::sub(0, a);
+  }
+
+  uint8_t mul(uint8_t a, uint8_t b) const {
+    return mul_[a * size_ + b];
+  }
+
+  //! Row of the multiplication table, i.e., mulRow(c)[x] == mul(c, x).
+  const uint8_t* mulRow(uint8_t c) const {
+    return &mul_[c * size_];
+  }
+
+  uint8_t inv(uint8_t a) const {
+    if (a == 0) {
+      throw std::logic_error("Division by zero");
+    }
+
+    return tables_.inv[a];
+  }
+
+  //! Discrete logarithm of a != 0 to the base of the primitive element used by the tables.
+  size_t log(uint8_t a) const {
+    if (a == 0) {
+      throw std::invalid_argument("Logarithm of zero is undefined.");
+    }
+
+    return tables_.log[a];
+  }
+
+  //! k-th power of the primitive element used by the tables.
+  uint8_t exp(size_t k) const {
+    return tables_.exp[k % (size_ - 1)];
+  }
+
+private:
+  SmallField()
+      : size_(encoding_t::size)
+      , tables_(encoding_t::tables())
+      , mul_(size_ * size_, 0) {
+    elements_.reserve(size_);
+
+    for (size_t c = 0; c < size_; ++c) {
+      elements_.push_back(encoding_t::decode(static_cast<uint8_t>(c)));
+
+      if (encoding_t::encode(elements_.back()) != c) {
+        throw std::logic_error("Invalid encoding of the field elements.");
+      }
+    }
+
+    // zero needs no special case, see details::SmallFieldTables
+    for (size_t a = 0; a < size_; ++a) {
+      for (size_t b = 0; b < size_; ++b) {
+        mul_[a * size_ + b] = tables_.exp[tables_.log[a] + tables_.log[b]];
+      }
+    }
+  }
+
+  size_t size_;
+  const details::SmallFieldTables& tables_;
+  std::vector<T> elements_;
+  std::vector<uint8_t> mul_;
+};
+} // namespace finitefield
+} // namespace crag
+
+#endif // CRAG_SMALL_FINITE_FIELD_H
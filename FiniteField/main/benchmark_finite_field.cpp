@@ -0,0 +1,107 @@
+#include <random>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "FiniteField.h"
+
+using namespace crag::finitefield;
+
+//! These ideals are not matched by the table-driven specializations of FieldElement,
+//! so they give the generic implementation of the same fields.
+template <int p>
+struct GenericIdealGeneratedByInteger : IdealGeneratedByInteger<p> {};
+
+template <int... cs>
+struct GenericIdealGeneratedByPolynomial : IdealGeneratedByPolynomial<ZZ<2>, cs...> {};
+
+using ZZ251 = ZZ<251>;
+using GenericZZ251 = FieldElement<GenericIdealGeneratedByInteger<251>>;
+using GF256 = FieldElement<IdealGeneratedByPolynomial<ZZ<2>, 1, 1, 0, 1, 1, 0, 0, 0, 1>>;
+using GenericGF256 = FieldElement<GenericIdealGeneratedByPolynomial<1, 1, 0, 1, 1, 0, 0, 0, 1>>;
+
+template <typename T>
+static std::vector<T> randomElements(size_t n, bool non_zero) {
+  std::mt19937 g(1233);
+
+  std::vector<T> result;
+  result.reserve(n);
+
+  while (result.size() < n) {
+    const T x(T::random(g));
+
+    if (!non_zero || x != T(0)) {
+      result.push_back(x);
+    }
+  }
+
+  return result;
+}
+
+//! Dot product of two vectors of length range(0), a typical inner loop of the matrix code.
+template <typename T>
+static void BM_DotProduct(benchmark::State& state) {
+  const auto n = state.range(0);
+  const auto a = randomElements<T>(n, false);
+  const auto b = randomElements<T>(n, false);
+
+  while (state.KeepRunning()) {
+    T sum(0);
+
+    for (int i = 0; i < n; ++i) {
+      sum += a[i] * b[i];
+    }
+
+    benchmark::DoNotOptimize(sum);
+  }
+
+  state.SetComplexityN(n);
+  state.SetItemsProcessed(state.iterations() * n);
+}
+
+template <typename T>
+static void BM_Inverse(benchmark::State& state) {
+  const auto n = state.range(0);
+  const auto a = randomElements<T>(n, true);
+
+  while (state.KeepRunning()) {
+    for (const auto& x : a) {
+      benchmark::DoNotOptimize(x.inverse());
+    }
+  }
+
+  state.SetComplexityN(n);
+  state.SetItemsProcessed(state.iterations() * n);
+}
+
+template <typename T>
+static void BM_Power(benchmark::State& state) {
+  const auto n = state.range(0);
+  const auto a = randomElements<T>(n, true);
+
+  while (state.KeepRunning()) {
+    for (const auto& x : a) {
+      benchmark::DoNotOptimize(pwr(x, 1000));
+    }
+  }
+
+  state.SetComplexityN(n);
+  state.SetItemsProcessed(state.iterations() * n);
+}
+
+BENCHMARK_TEMPLATE(BM_DotProduct, ZZ251)->RangeMultiplier(8)->Range(64, 1 << 15)->Complexity();
+BENCHMARK_TEMPLATE(BM_DotProduct, GenericZZ251)->RangeMultiplier(8)->Range(64, 1 << 15)->Complexity();
+BENCHMARK_TEMPLATE(BM_DotProduct, GF256)->RangeMultiplier(8)->Range(64, 1 << 15)->Complexity();
+BENCHMARK_TEMPLATE(BM_DotProduct, GenericGF256)->RangeMultiplier(8)->Range(64, 1 << 12)->Complexity();
+
+BENCHMARK_TEMPLATE(BM_Inverse, ZZ251)->Arg(1024);
+BENCHMARK_TEMPLATE(BM_Inverse, GenericZZ251)->Arg(1024);
+BENCHMARK_TEMPLATE(BM_Inverse, GF256)->Arg(1024);
+BENCHMARK_TEMPLATE(BM_Inverse, GenericGF256)->Arg(1024);
+
+BENCHMARK_TEMPLATE(BM_Power, ZZ251)->Arg(1024);
+BENCHMARK_TEMPLATE(BM_Power, GenericZZ251)->Arg(1024);
+BENCHMARK_TEMPLATE(BM_Power, GF256)->Arg(1024);
+BENCHMARK_TEMPLATE(BM_Power, GenericGF256)->Arg(1024);
+
+BENCHMARK_MAIN();
@@ -1,6 +1,10 @@
 #include "gtest/gtest.h"
 
+#include <sstream>
+#include <vector>
+
 #include "FiniteField.h"
+#include "SmallFiniteField.h"
 
 namespace crag {
 namespace finitefield {
@@ -61,6 +65,185 @@ TEST(FiniteField, RandomTest2) {
 
   EXPECT_EQ(GF256({1, 1, 1, 0, 1, 0, 1, 1, 1}), GF256::random(g));
 }
+
+template <typename T>
+void testSmallField() {
+  const auto& field = SmallField<T>::instance();
+
+  for (size_t a = 0; a < field.size(); ++a) {
+    const auto x = field.decode(a);
+
+    EXPECT_EQ(a, field.encode(x));
+    EXPECT_EQ(-x, field.decode(field.neg(a)));
+
+    if (a != 0) {
+      EXPECT_EQ(x.inverse(), field.decode(field.inv(a)));
+      EXPECT_EQ(a, field.exp(field.log(a)));
+    }
+
+    for (size_t b = 0; b < field.size(); ++b) {
+      const auto y = field.decode(b);
+
+      EXPECT_EQ(x + y, field.decode(field.add(a, b)));
+      EXPECT_EQ(x - y, field.decode(field.sub(a, b)));
+      EXPECT_EQ(x * y, field.decode(field.mul(a, b)));
+    }
+  }
+
+  EXPECT_THROW(field.inv(0), std::logic_error);
+}
+
+TEST(FiniteField, SmallPrimeField) {
+  testSmallField<ZZ<2>>();
+  testSmallField<ZZ<5>>();
+  testSmallField<ZZ<251>>();
+}
+
+TEST(FiniteField, SmallBinaryField) {
+  testSmallField<FieldElement<IdealGeneratedByPolynomial<ZZ<2>, 1, 1, 1>>>();
+  testSmallField<FieldElement<IdealGeneratedByPolynomial<ZZ<2>, 1, 0, 1, 0, 0, 1>>>();
+  testSmallField<FieldElement<IdealGeneratedByPolynomial<ZZ<2>, 1, 1, 0, 1, 1, 0, 0, 0, 1>>>();
+}
+
+//! These ideals are not matched by the table-driven specializations of FieldElement,
+//! so they give the generic implementation of the same fields.
+template <int p>
+struct GenericIdealGeneratedByInteger : IdealGeneratedByInteger<p> {};
+
+template <int... cs>
+struct GenericIdealGeneratedByPolynomial : IdealGeneratedByPolynomial<ZZ<2>, cs...> {};
+
+template <typename T>
+std::string toString(const T& x) {
+  std::stringstream out;
+  out << x;
+  return out.str();
+}
+
+//! Compares the table-driven field Fast with the generic implementation Generic on all pairs of elements.
+template <typename Fast, typename Generic>
+void testAgainstGeneric(const std::vector<typename Fast::RingElement>& elements) {
+  static_assert(sizeof(Fast) == 1, "The table-driven field should store an element in a single byte.");
+
+  for (const auto& a : elements) {
+    const Fast x(a);
+    const Generic gx(a);
+
+    EXPECT_EQ(gx.value(), x.value());
+    EXPECT_EQ(toString(gx), toString(x));
+    EXPECT_EQ(Generic(-gx).value(), Fast(-x).value());
+    EXPECT_EQ(pwr(gx, 7).value(), pwr(x, 7).value());
+
+    if (gx == Generic(0)) {
+      EXPECT_THROW(x.inverse(), std::logic_error);
+    } else {
+      EXPECT_EQ(gx.inverse().value(), x.inverse().value());
+      EXPECT_EQ(pwr(gx, -3).value(), pwr(x, -3).value());
+    }
+
+    for (const auto& b : elements) {
+      const Fast y(b);
+      const Generic gy(b);
+
+      EXPECT_EQ(gx == gy, x == y);
+      EXPECT_EQ(gx != gy, x != y);
+      EXPECT_EQ((gx + gy).value(), (x + y).value());
+      EXPECT_EQ((gx - gy).value(), (x - y).value());
+      EXPECT_EQ((gx * gy).value(), (x * y).value());
+
+      if (gy != Generic(0)) {
+        EXPECT_EQ((gx / gy).value(), (x / y).value());
+      }
+    }
+  }
+}
+
+template <int p>
+void testPrimeFieldAgainstGeneric() {
+  std::vector<int> elements;
+
+  for (int a = -p - 3; a < p + 3; ++a) {
+    elements.push_back(a);
+  }
+
+  testAgainstGeneric<ZZ<p>, FieldElement<GenericIdealGeneratedByInteger<p>>>(elements);
+}
+
+template <int... cs>
+void testBinaryFieldAgainstGeneric() {
+  using Fast = FieldElement<IdealGeneratedByPolynomial<ZZ<2>, cs...>>;
+  using Generic = FieldElement<GenericIdealGeneratedByPolynomial<cs...>>;
+
+  const auto degree = sizeof...(cs) - 1;
+
+  std::vector<typename Fast::RingElement> elements;
+
+  for (unsigned mask = 0; mask < (1u << degree); ++mask) {
+    std::vector<ZZ<2>> coefs;
+
+    for (size_t i = 0; i < degree; ++i) {
+      coefs.emplace_back(static_cast<int>((mask >> i) & 1));
+    }
+
+    elements.emplace_back(coefs.begin(), coefs.end());
+  }
+
+  // unreduced representatives
+  elements.push_back(typename Fast::RingElement({1, 0, 1, 1, 0, 0, 1, 1, 1, 0, 1, 0, 0, 1}));
+  elements.push_back(typename Fast::RingElement({cs...}));
+
+  testAgainstGeneric<Fast, Generic>(elements);
+
+  std::mt19937 g(1233);
+  std::mt19937 gg(1233);
+
+  for (int i = 0; i < 100; ++i) {
+    EXPECT_EQ(Generic(Generic::random(gg)).value(), Fast(Fast::random(g)).value());
+  }
+}
+
+TEST(FiniteField, TableDrivenPrimeField) {
+  testPrimeFieldAgainstGeneric<2>();
+  testPrimeFieldAgainstGeneric<3>();
+  testPrimeFieldAgainstGeneric<5>();
+  testPrimeFieldAgainstGeneric<251>();
+}
+
+TEST(FiniteField, TableDrivenBinaryField) {
+  testBinaryFieldAgainstGeneric<1, 1, 1>();
+  testBinaryFieldAgainstGeneric<1, 0, 1, 0, 0, 1>();
+  testBinaryFieldAgainstGeneric<1, 1, 0, 1, 1, 0, 0, 0, 1>();
+}
+
+TEST(FiniteField, TableDrivenSelection) {
+  // only fields are specialized, ZZ<4> and ZZ<2>[x] / (x^2 + 1) keep the generic implementation
+  EXPECT_TRUE(details::isSmallPrimeField(251));
+  EXPECT_FALSE(details::isSmallPrimeField(4));
+  EXPECT_FALSE(details::isSmallPrimeField(257));
+  EXPECT_TRUE((details::isSmallBinaryField<1, 1, 0, 1, 1, 0, 0, 0, 1>()));
+  EXPECT_FALSE((details::isSmallBinaryField<1, 0, 1>()));
+  EXPECT_FALSE((details::isSmallBinaryField<1, 1, 0, 0, 0, 0, 0, 0, 0, 1>()));
+
+  EXPECT_EQ(sizeof(ZZ<4>), sizeof(FieldElement<IdealGeneratedByInteger<4>>));
+  EXPECT_LT(1u, sizeof(ZZ<4>));
+  EXPECT_LT(1u, sizeof(ZZ<1237>));
+}
+
+TEST(FiniteField, TableDrivenNonZeroNonUnit) {
+  using GF256 = FieldElement<IdealGeneratedByPolynomial<ZZ<2>, 1, 1, 0, 1, 1, 0, 0, 0, 1>>;
+
+  std::mt19937 g(1233);
+
+  for (int i = 0; i < 100; ++i) {
+    const auto x = generateNonZeroNonUnit<GF256>(g);
+    EXPECT_NE(GF256(0), x);
+    EXPECT_NE(GF256(1), x);
+
+    const auto y = generateNonZeroNonUnit<ZZ<5>>(g);
+    EXPECT_NE(ZZ<5>(0), y);
+    EXPECT_NE(ZZ<5>(1), y);
+  }
+}
 } // namespace
 } // namespace finitefield
 } // namespace crag
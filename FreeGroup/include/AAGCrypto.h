@@ -220,6 +220,9 @@ namespace aag_crypto {
           std::cout << "Bob is building key" << std::endl;
         }
 
+        // one context for the whole loop, so the steps share the vertices packing the images
+        slp::recompression::NormalFormContext normal_form_context;
+
         Aut conjugation;
         switch (calc_type) {
           case CalculationType::BlockReduction: {
@@ -232,19 +235,19 @@ namespace aag_crypto {
                 for (std::size_t j = 0; j < block_length && j < params_.KEY_LENGTH - i; ++j) {
                   block *= get_part(index++);
                 }
-                blocks.push_back(AutomorphismReducer::reduce(block, true));
+                blocks.push_back(AutomorphismReducer::reduce(block, true, &normal_form_context));
               }
 
               std::cout << "building key" << std::endl;
               for (const auto& block: blocks) {
-                conjugation = AutomorphismReducer::reduce(conjugation * block, true);
+                conjugation = AutomorphismReducer::reduce(conjugation * block, true, &normal_form_context);
               }
               break;
             }
           case CalculationType::IterativeReduction: {
               std::cout << "IterativeReduction" << std::endl;
               for (std::size_t index = 0; index < priv_key.length(); ++index) {
-                conjugation = AutomorphismReducer::reduce(conjugation * get_part(index), true);
+                conjugation = AutomorphismReducer::reduce(conjugation * get_part(index), true, &normal_form_context);
               }
               break;
             }
@@ -256,7 +259,7 @@ namespace aag_crypto {
                 std::cout << "key part |" << vertices_num << "|" << std::endl;
                 if (vertices_num > fold_threshold) {
                   std::cout << "size exceeded threshold: folding..." << std::endl;
-                  conjugation = AutomorphismReducer::reduce(conjugation, true);
+                  conjugation = AutomorphismReducer::reduce(conjugation, true, &normal_form_context);
                 }
               }
               break;
@@ -274,9 +277,9 @@ namespace aag_crypto {
 
         std::cout << "key ";
         if (mode == Participant::Alice) {
-          return AutomorphismReducer::reduce(priv_key().aut() * conjugation, true);
+          return AutomorphismReducer::reduce(priv_key().aut() * conjugation, true, &normal_form_context);
         } else {//Bob
-          return AutomorphismReducer::reduce(conjugation * priv_key().inverse(), true);
+          return AutomorphismReducer::reduce(conjugation * priv_key().inverse(), true, &normal_form_context);
         }
       }
 
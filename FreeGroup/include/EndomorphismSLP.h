@@ -16,6 +16,8 @@
 #include <functional>
 #include <assert.h>
 #include <chrono>
+#include <vector>
+#include "parallel.h"
 #include "slp.h"
 
 namespace crag {
@@ -53,6 +55,25 @@ public:
   typedef std::map<TerminalSymbol, slp::Vertex>::value_type symbol_image_pair_type;
 
 
+  //! The way free_reduction(), free_reduction_precise(), remove_duplicate_vertices() and normal_form() process the images
+  /**
+   * The recompression in normal_form() is always sequential, only the images are extracted from its result concurrently.
+   */
+  enum class ReductionMode {
+    Sequential, //!< the images are processed one after another sharing the caches
+    Parallel    //!< the images are processed concurrently by crag::parallel sharing thread-safe caches
+  };
+
+  //! Sets the reduction mode of all the endomorphisms, it is ReductionMode::Sequential by default
+  static void set_reduction_mode(ReductionMode mode);
+
+  static ReductionMode reduction_mode();
+
+  //! Returns true if the reduction mode is parallel and crag::parallel uses several threads
+  static bool is_parallel_reduction() {
+    return reduction_mode() == ReductionMode::Parallel && parallel::getThreadsCount() > 1;
+  }
+
   //! Creates an identity automorphism.
   EndomorphismSLP() {}
 
@@ -223,6 +244,14 @@ public:
   //! Returns the automorphisms with freely reduced images. Might make mistakes but much faster than precise version.
   template<typename VertexHashAlgorithms = endomorphism_default_parameters::WeakReducedVertexHashAlgorithms>
   EndomorphismSLP free_reduction() const {
+    if (is_parallel_reduction()) {
+      typename VertexHashAlgorithms::ConcurrentCache vertex_hashes;
+      slp::ConcurrentMap<slp::Vertex, slp::Vertex> reduced_vertices;
+      return map_images([&vertex_hashes, &reduced_vertices] (const std::vector<slp::Vertex>& images) {
+        return VertexHashAlgorithms::reduce_narrow_slp_parallel(images, &vertex_hashes, &reduced_vertices);
+      });
+    }
+
     typename VertexHashAlgorithms::Cache vertex_hashes;
     auto reducer = [&vertex_hashes] (const slp::Vertex& vertex,
         std::unordered_map<slp::Vertex, slp::Vertex>* p_reduced_vertices) {
@@ -234,6 +263,14 @@ public:
 
   //! Returns the automorphisms with freely reduced images. It uses matching tables.
   EndomorphismSLP free_reduction_precise() const {
+    if (is_parallel_reduction()) {
+      auto mt = slp::MatchingTable::concurrent();
+      slp::ConcurrentMap<slp::Vertex, slp::Vertex> reduced_vertices;
+      return map_images([&mt, &reduced_vertices] (const std::vector<slp::Vertex>& images) {
+        return slp::reduce_parallel(images, &mt, &reduced_vertices);
+      });
+    }
+
     slp::MatchingTable mt;
     auto reducer = [&mt] (const slp::Vertex& vertex,
         std::unordered_map<slp::Vertex, slp::Vertex>* p_reduced_vertices) {
@@ -246,6 +283,14 @@ public:
   //! Returns the automorphisms, which contains no vertices with the same hash given by template parameter.
   template<typename VertexHashAlgorithms = endomorphism_default_parameters::WeakVertexHashAlgorithms>
   EndomorphismSLP remove_duplicate_vertices() const {
+    if (is_parallel_reduction()) {
+      typename VertexHashAlgorithms::ConcurrentCache vertex_hashes;
+      typename VertexHashAlgorithms::ConcurrentHashRepresentativesCache hash_representatives;
+      return map_images([&vertex_hashes, &hash_representatives] (const std::vector<slp::Vertex>& images) {
+        return VertexHashAlgorithms::remove_duplicates_parallel(images, &vertex_hashes, &hash_representatives);
+      });
+    }
+
     typename VertexHashAlgorithms::Cache vertex_hashes;
     typename VertexHashAlgorithms::HashRepresentativesCache hash_representatives;
     EndomorphismSLP result;
@@ -260,7 +305,17 @@ public:
   }
 
   //! Returns the automorphism with its representaiton in normal form.
-  EndomorphismSLP normal_form() const;
+  EndomorphismSLP normal_form() const {
+    return normal_form(nullptr);
+  }
+
+  //! Returns the automorphism with its representaiton in normal form, reusing the results stored in #context.
+  /**
+   * The images are packed into a single vertex by NormalFormContext::make_vertex(), so if the same images
+   * are processed by the context again, their normal form is not recalculated.
+   * @param context the context of the recompression, if it is null then the normal form is calculated from scratch
+   */
+  EndomorphismSLP normal_form(slp::recompression::NormalFormContext* context) const;
 
   //! Returns the image of the terminal.
   slp::VertexWord image_word(const TerminalSymbol& t) const {
@@ -394,6 +449,28 @@ private:
     return result;
   }
 
+  //! Returns the endomorphism with the images replaced by f(images), where the images are passed as a vector
+  template<typename Function>
+  EndomorphismSLP map_images(Function f) const {
+    std::vector<slp::Vertex> images;
+    images.reserve(images_.size());
+    for (const auto& pair : images_) {
+      images.push_back(pair.second);
+    }
+
+    auto new_images = f(images);
+
+    EndomorphismSLP result;
+    auto new_image = new_images.begin();
+    for (const auto& pair : images_) {
+      //insert if it is not an identity map
+      if (new_image->height() != 1 || TerminalVertex(*new_image) != pair.first)
+        result.images_.insert(std::make_pair(pair.first, *new_image));
+      ++new_image;
+    }
+    return result;
+  }
+
   //! The representation of images of terminal symbols by straight-line programs
   /**
    * If there is no entry for a given terminal symbol, then its image is the terminal itself.
@@ -629,15 +706,17 @@ class AutomorphismDescription {
     }
 
     AutomorphismDescription free_reduction() const {
-      return AutomorphismDescription(a_.free_reduction(), a_inv_.free_reduction(), num_);
+      return map_both([] (const Automorphism& a) { return a.free_reduction(); });
     }
 
-    AutomorphismDescription normal_form() const {
-      return AutomorphismDescription(a_.normal_form(), a_inv_.normal_form(), num_);
+    //! The recompression uses shared state, so the automorphism and its inverse are processed one after another
+    //! @param context the context of the recompression, shared by both of them if it is not null
+    AutomorphismDescription normal_form(slp::recompression::NormalFormContext* context = nullptr) const {
+      return AutomorphismDescription(a_.normal_form(context), a_inv_.normal_form(context), num_);
     }
 
     AutomorphismDescription remove_duplicate_vertices() const {
-      return AutomorphismDescription(a_.remove_duplicate_vertices(), a_inv_.remove_duplicate_vertices(), num_);
+      return map_both([] (const Automorphism& a) { return a.remove_duplicate_vertices(); });
     }
 
     //! Number of composed morphisms consituting the given one.
@@ -655,6 +734,24 @@ class AutomorphismDescription {
         a_inv_(std::move(a_inv)),
         num_(num) {}
 
+    //! Applies f to the automorphism and its inverse, concurrently in the parallel reduction mode
+    template<typename Function>
+    AutomorphismDescription map_both(Function f) const {
+      if (!Automorphism::is_parallel_reduction()) {
+        return AutomorphismDescription(f(a_), f(a_inv_), num_);
+      }
+
+      Automorphism a, a_inv;
+      parallel::forEach(2, [&] (size_t i) {
+        if (i == 0) {
+          a = f(a_);
+        } else {
+          a_inv = f(a_inv_);
+        }
+      });
+      return AutomorphismDescription(std::move(a), std::move(a_inv), num_);
+    }
+
 };
 
 
@@ -678,6 +775,12 @@ T make_commutator(const T& first, const T& second) {
 
 
 //! Reduces endomorphisms of their descriptions with optional logging.
+/**
+ * Every reduce() takes an optional context of the recompression, which memoizes the normal forms by the root.
+ * The free reduction builds new vertices, so only the automorphisms whose images are already reduced and
+ * have been brought to the normal form by the same context are found in it.
+ * The context must not be used by several threads at once.
+ */
 class AutomorphismReducer { //todo replace logging to std::cout by logging facility
     class SizePrinter {
       public:
@@ -693,12 +796,12 @@ class AutomorphismReducer { //todo replace logging to std::cout by logging facil
 
   public:
     template<typename Aut>
-    static Aut reduce(const Aut& aut, bool is_logging) {
-      return is_logging ? reduce(aut, SizePrinter()) : reduce(aut);
+    static Aut reduce(const Aut& aut, bool is_logging, slp::recompression::NormalFormContext* context = nullptr) {
+      return is_logging ? reduce(aut, SizePrinter(), context) : reduce(aut, context);
     }
 
     template<typename Aut, typename AutLogger>
-    static Aut reduce(const Aut& aut, AutLogger aut_logger) {
+    static Aut reduce(const Aut& aut, AutLogger aut_logger, slp::recompression::NormalFormContext* context) {
         std::ostream& out = std::cout;
         out << "|";
         aut_logger(aut);
@@ -711,17 +814,17 @@ class AutomorphismReducer { //todo replace logging to std::cout by logging facil
         auto rd = perform_action_with_logging(aut_logger, [&fr]() {return fr.remove_duplicate_vertices();});
 
         out << " nf ";
-        auto result = perform_action_with_logging(aut_logger, [&rd]() {return rd.normal_form();});
+        auto result = perform_action_with_logging(aut_logger, [&rd, context]() {return rd.normal_form(context);});
 
         out << std::endl;
         return result;
     }
 
     template<typename Aut>
-    static Aut reduce(const Aut& aut) {
+    static Aut reduce(const Aut& aut, slp::recompression::NormalFormContext* context = nullptr) {
       auto fr = aut.free_reduction();
       auto rd = fr.remove_duplicate_vertices();;
-      return rd.normal_form();
+      return rd.normal_form(context);
     }
 
     template<typename Func, typename AutLogger>
@@ -760,12 +863,12 @@ class CommutatorSet {
       return CommutatorSet(std::move(conjugate_all(comm_, conjugator)));
     }
 
-    CommutatorSet reduce() const {
+    CommutatorSet reduce(slp::recompression::NormalFormContext* context = nullptr) const {
       std::vector<AutDescription> new_comm;
       new_comm.reserve(comm_.size());
       std::transform(comm_.cbegin(), comm_.cend(),
                      std::back_inserter(new_comm),
-                     [] (const AutDescription& ad) {return AutomorphismReducer::reduce(ad);});
+                     [context] (const AutDescription& ad) {return AutomorphismReducer::reduce(ad, context);});
       return CommutatorSet(std::move(new_comm));
     }
 
@@ -93,17 +93,21 @@ namespace fga_crypto {
 
       //! Make the normal form of free reduction
       PublicKeys reduce() const {
+        // one context for all the keys, so they share the vertices packing the images
+        slp::recompression::NormalFormContext normal_form_context;
+        const auto context = &normal_form_context;
+
         std::vector<AutDescription> new_s;
         new_s.reserve(s_.size());
         std::transform(s_.cbegin(), s_.cend(),
                        std::back_inserter(new_s),
-                       [] (const AutDescription& ad) {return AutomorphismReducer::reduce(ad);});
+                       [context] (const AutDescription& ad) {return AutomorphismReducer::reduce(ad, context);});
 
         std::vector<CommSet> new_r;
         new_r.reserve(r_.size());
         std::transform(r_.cbegin(), r_.cend(),
                        std::back_inserter(new_r),
-                       [] (const CommSet& cs) {return cs.reduce();});
+                       [context] (const CommSet& cs) {return cs.reduce(context);});
         return PublicKeys(std::move(new_s), std::move(new_r));
       }
 
@@ -252,6 +256,9 @@ namespace fga_crypto {
        * @return
        */
       Aut make_shared_key(const PublicKeys& processed_public_keys, Mode mode) {
+        // one context for the whole loop, so the steps share the vertices packing the images
+        slp::recompression::NormalFormContext normal_form_context;
+
         Aut key;
         std::map<int, Aut> line_cache;
         const std::vector<int>& indices = mode == Mode::Alice ? u_ : v_;
@@ -265,7 +272,7 @@ namespace fga_crypto {
             if (is_logging) {
               std::cout << "new line calculation:" << std::endl;
             }
-            line = calculate_private_key_line(row_index, processed_public_keys, mode);
+            line = calculate_private_key_line(row_index, processed_public_keys, mode, &normal_form_context);
             line_cache.insert(std::make_pair(row_index, line));
           }
           if (is_logging) {
@@ -279,7 +286,7 @@ namespace fga_crypto {
           if (is_logging) {
             std::cout << "line addtion: ";
           }
-          key = AutomorphismReducer::reduce(key, is_logging);
+          key = AutomorphismReducer::reduce(key, is_logging, &normal_form_context);
         }
 
         if (mode == Mode::Alice) {
@@ -291,7 +298,7 @@ namespace fga_crypto {
         if (is_logging) {
           std::cout << "key: ";
         }
-        key = AutomorphismReducer::reduce(key, is_logging);
+        key = AutomorphismReducer::reduce(key, is_logging, &normal_form_context);
         return key;
       }
 
@@ -327,7 +334,8 @@ namespace fga_crypto {
         return result;
       }
 
-      Aut calculate_private_key_line(int row_index, const PublicKeys& public_key, Mode mode) {
+      Aut calculate_private_key_line(int row_index, const PublicKeys& public_key, Mode mode,
+                                     slp::recompression::NormalFormContext* context) {
         Aut value;
         const std::vector<int>& indices = mode == Mode::Alice ? v_ : u_;
         auto get_r = [&mode, &row_index, &public_key] (int col_index) {
@@ -346,7 +354,7 @@ namespace fga_crypto {
           if (is_logging) {
             std::cout << "line step ";
           }
-          value = AutomorphismReducer::reduce(value, is_logging);//reducing the size
+          value = AutomorphismReducer::reduce(value, is_logging, context);//reducing the size
         }
         return value;
       }
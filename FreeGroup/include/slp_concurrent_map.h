@@ -0,0 +1,155 @@
+/*
+ * slp_concurrent_map.h
+ *
+ * Caches of vertex images shared by several threads.
+ */
+
+#pragma once
+#ifndef CRAG_FREEGROUP_SLP_CONCURRENT_MAP_H_
+#define CRAG_FREEGROUP_SLP_CONCURRENT_MAP_H_
+
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "parallel.h"
+
+namespace crag {
+namespace slp {
+
+//! Thread-safe map, which is used to share the images of vertices computed by several threads
+/**
+ * The entries are never changed or removed, so that the first stored image of a key wins.
+ * The entries are spread over shards guarded by their own mutexes.
+ *
+ * Algorithms written for std::unordered_map work with it through View, see map_vertices().
+ */
+template <typename Key, typename Value>
+class ConcurrentMap {
+  public:
+    //! Creates a map with shards_count shards, by default 4 per hardware thread
+    explicit ConcurrentMap(size_t shards_count = 0) {
+      if (shards_count == 0) {
+        shards_count = 4 * parallel::getHardwareConcurrency();
+      }
+
+      for (size_t i = 0; i < shards_count; ++i) {
+        shards_.emplace_back(new Shard());
+      }
+    }
+
+    ConcurrentMap(const ConcurrentMap&) = delete;
+    ConcurrentMap& operator=(const ConcurrentMap&) = delete;
+
+    //! Copies the image to *value if the key is stored
+    bool find(const Key& key, Value* value) const {
+      auto& shard = get_shard(key);
+      std::lock_guard<std::mutex> lock(shard.mutex);
+
+      auto item = shard.map.find(key);
+      if (item == shard.map.end()) {
+        return false;
+      }
+
+      *value = item->second;
+      return true;
+    }
+
+    //! Stores the image if the key is not stored yet, returns the stored image
+    Value insert(const Key& key, const Value& value) {
+      auto& shard = get_shard(key);
+      std::lock_guard<std::mutex> lock(shard.mutex);
+
+      return shard.map.insert(std::make_pair(key, value)).first->second;
+    }
+
+    size_t size() const {
+      size_t result = 0;
+      for (const auto& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        result += shard->map.size();
+      }
+      return result;
+    }
+
+    //! View of the map for a single thread, it mimics the part of the std::unordered_map interface used by the algorithms
+    /**
+     * The entries found in the shared map are copied into the local std::unordered_map, so that
+     * the returned iterators and references stay valid. Inserted entries go to both maps, if some
+     * other thread has already stored an image of the key, it replaces the inserted one.
+     */
+    class View {
+      public:
+        typedef typename std::unordered_map<Key, Value>::iterator iterator;
+        typedef typename std::unordered_map<Key, Value>::const_iterator const_iterator;
+        typedef std::pair<const Key, Value> value_type;
+
+        explicit View(ConcurrentMap* shared)
+          : shared_(shared)
+        { }
+
+        iterator find(const Key& key) const {
+          auto item = local_.find(key);
+          if (item != local_.end()) {
+            return item;
+          }
+
+          Value value;
+          if (shared_->find(key, &value)) {
+            return local_.insert(std::make_pair(key, std::move(value))).first;
+          }
+          return local_.end();
+        }
+
+        iterator end() const {
+          return local_.end();
+        }
+
+        size_t count(const Key& key) const {
+          return find(key) != end() ? 1 : 0;
+        }
+
+        std::pair<iterator, bool> insert(const value_type& entry) {
+          auto item = local_.find(entry.first);
+          if (item != local_.end()) {
+            return std::make_pair(item, false);
+          }
+
+          auto stored = shared_->insert(entry.first, entry.second);
+          return local_.insert(std::make_pair(entry.first, std::move(stored)));
+        }
+
+        //! Unlike insert(), a default constructed value is only stored locally
+        Value& operator[](const Key& key) {
+          auto item = find(key);
+          if (item != end()) {
+            return item->second;
+          }
+          return local_[key];
+        }
+
+      private:
+        ConcurrentMap* shared_;
+        mutable std::unordered_map<Key, Value> local_;
+    };
+
+  private:
+    struct Shard {
+      mutable std::mutex mutex;
+      std::unordered_map<Key, Value> map;
+    };
+
+    Shard& get_shard(const Key& key) const {
+      static const std::hash<Key> key_hash = std::hash<Key>();
+      return *shards_[key_hash(key) % shards_.size()];
+    }
+
+    std::vector<std::unique_ptr<Shard>> shards_;
+};
+
+} //namespace slp
+} //namespace crag
+
+#endif /* CRAG_FREEGROUP_SLP_CONCURRENT_MAP_H_ */
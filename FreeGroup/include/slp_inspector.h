@@ -164,7 +164,9 @@ class InspectorPath : public AcceptPolicy<AcceptFunctor> {
 
   private:
 //    std::vector<InspectorTask> scheduled_tasks_;
-    std::vector<InspectorTask, boost::pool_allocator<InspectorTask, boost::default_user_allocator_malloc_free, boost::details::pool::null_mutex, 128, 0>> scheduled_tasks_;
+    //The pool is a process-wide singleton, so it is guarded by a mutex: inspectors may run in several threads
+    //sharing a concurrent MatchingTable. The vector rarely reallocates, so the lock is cheap.
+    std::vector<InspectorTask, boost::pool_allocator<InspectorTask, boost::default_user_allocator_malloc_free, boost::details::pool::default_mutex, 128, 0>> scheduled_tasks_;
 };
 
 template <typename AcceptFunctor>
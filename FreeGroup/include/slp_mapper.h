@@ -9,10 +9,15 @@
 #ifndef CRAG_FREEGROUP_SLP_MAPPER_H_
 #define CRAG_FREEGROUP_SLP_MAPPER_H_
 
+#include <algorithm>
 #include <unordered_map>
+#include <unordered_set>
+#include <iterator>
 #include <functional>
+#include <vector>
 #include "slp_vertex.h"
 #include "slp_inspector.h"
+#include "slp_concurrent_map.h"
 
 namespace crag {
 namespace slp {
@@ -22,11 +27,11 @@ namespace slp {
  * It inspects vertices and if a vertex is already a key in #vertices_map then it is skipped
  * along with its descendants, otherwise after its descendants processed  the mapping {@code vertex => f(vertex)}
  * is added to #vertices_map.
- * @tparam Func function or functor accepting signature ImageType (const slp::Vertex&, const std::unordered_map<slp::Vertex, ImageType>&), i.e. mapping slp::Vertex to ImageType
- * @tparam ImageType type of object which is an image of slp::Vertex under Func
+ * @tparam Func function or functor accepting signature ImageType (const slp::Vertex&, const VerticesMap&), i.e. mapping slp::Vertex to ImageType
+ * @tparam VerticesMap std::unordered_map<slp::Vertex, ImageType> or ConcurrentMap<slp::Vertex, ImageType>::View, if several threads share the images
  */
-template<typename ImageType, typename Func>
-void map_vertices(const slp::Vertex& root, std::unordered_map<slp::Vertex, ImageType>* p_images, Func f) {
+template<typename VerticesMap, typename Func>
+void map_vertices(const slp::Vertex& root, VerticesMap* p_images, Func f) {
   if (p_images->find(root) != p_images->end())
     return;//root is already mapped
 
@@ -42,6 +47,81 @@ void map_vertices(const slp::Vertex& root, std::unordered_map<slp::Vertex, Image
   }
 }
 
+//! Maps #roots and their descendants using the functions made by #make_function, the vertices of the same height are mapped concurrently.
+/*
+ * Unlike map_vertices(), the images are shared between threads through #p_images. The vertices of the same height
+ * do not depend on each other, so the vertices are mapped level by level, each level is split into chunks processed
+ * by crag::parallel::forEach (the negations of the mapped vertices go after them, so that they may reuse the images).
+ * Every chunk gets its own function {@code auto f = make_function();}, so the functions may keep
+ * some state, and a view of #p_images.
+ * @tparam FunctionFactory functor returning a function with signature ImageType (const slp::Vertex&, const ConcurrentMap<slp::Vertex, ImageType>::View&)
+ */
+template<typename ImageType, typename FunctionFactory>
+void map_vertices_parallel(const std::vector<slp::Vertex>& roots, ConcurrentMap<slp::Vertex, ImageType>* p_images, FunctionFactory make_function) {
+  typedef typename ConcurrentMap<slp::Vertex, ImageType>::View ImagesView;
+
+  //collecting vertices which are not mapped yet by their heights
+  std::vector<std::vector<slp::Vertex>> levels;
+  {
+    ImagesView images(p_images);
+    std::unordered_set<slp::Vertex> visited;
+    std::vector<slp::Vertex> stack;
+
+    auto visit = [&] (const slp::Vertex& vertex) {
+      if (images.find(vertex) == images.end() && visited.insert(vertex).second) {
+        stack.push_back(vertex);
+      }
+    };
+
+    std::for_each(roots.begin(), roots.end(), visit);
+
+    while (!stack.empty()) {
+      slp::Vertex vertex = std::move(stack.back());
+      stack.pop_back();
+
+      if (levels.size() <= vertex.height()) {
+        levels.resize(vertex.height() + 1);
+      }
+      levels[vertex.height()].push_back(vertex);
+
+      if (vertex.height() > 1) {
+        visit(vertex.left_child());
+        visit(vertex.right_child());
+      }
+    }
+  }
+
+  //a vertex and its negation often have the same image up to negation, so the negative vertices
+  //are mapped after their positive pairs from the same level, and may reuse their images
+  std::vector<std::vector<slp::Vertex>> stages;
+  for (auto& level : levels) {
+    std::unordered_set<slp::Vertex> level_vertices(level.begin(), level.end());
+    auto negative_begin = std::stable_partition(level.begin(), level.end(), [&level_vertices] (const slp::Vertex& vertex) {
+      return vertex.vertex_id() > 0 || level_vertices.count(vertex.negate()) == 0;
+    });
+
+    std::vector<slp::Vertex> negative(std::make_move_iterator(negative_begin), std::make_move_iterator(level.end()));
+    level.erase(negative_begin, level.end());
+    stages.push_back(std::move(level));
+    stages.push_back(std::move(negative));
+  }
+
+  const size_t max_chunks_count = 4 * parallel::getThreadsCount();
+
+  for (const auto& stage : stages) {
+    const size_t chunks_count = std::min(stage.size(), max_chunks_count);
+
+    parallel::forEach(chunks_count, [&] (size_t chunk) {
+      auto f = make_function();
+      ImagesView images(p_images);
+
+      for (size_t i = chunk * stage.size() / chunks_count; i < (chunk + 1) * stage.size() / chunks_count; ++i) {
+        images.insert(std::make_pair(stage[i], f(stage[i], images)));
+      }
+    });
+  }
+}
+
 }//namespace slp
 }//namespace crag
 
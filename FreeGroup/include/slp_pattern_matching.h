@@ -9,8 +9,10 @@
 #ifndef CRAG_FREEGROUP_SLP_PATTERN_MATCHING_H_
 #define CRAG_FREEGROUP_SLP_PATTERN_MATCHING_H_
 
-#include <unordered_map>
+#include <cstdint>
 #include <iostream>
+#include <memory>
+#include <vector>
 
 #include "slp_vertex.h"
 #include "slp_inspector.h"
@@ -19,6 +21,104 @@
 namespace crag {
 namespace slp {
 
+namespace internal {
+
+//! Flat open-addressing cache of matching results with bounded size
+/**
+ * A key is the pair of signed ids of the pattern and the text vertices. Terminal and nonterminal vertices
+ * may have equal ids, so the key also records which of them are terminal. The key does not keep vertices alive,
+ * and ids of nonterminal vertices are never reused (unless NonterminalVertex::reset_vertex_id() is called,
+ * which makes all stored results invalid), so the entries of destroyed vertices are just never hit again.
+ *
+ * The entries are stored in a single array with linear probing. When the cache holds max_size entries,
+ * every insertion evicts an entry chosen by the clock (second chance) policy: each hit marks an entry,
+ * the clock hand goes around the array clearing marks until it meets an unmarked entry.
+ *
+ * The cache is not thread-safe, see MatchingTable::concurrent().
+ */
+class MatchingCache {
+  public:
+    struct Key {
+      Vertex::VertexSignedId pattern;
+      Vertex::VertexSignedId text;
+      uint8_t terminals; //!< bit 0 is set if the pattern is terminal, bit 1 if the text is terminal
+
+      Key(const Vertex& pattern_vertex, const Vertex& text_vertex)
+        : pattern(pattern_vertex.vertex_id())
+        , text(text_vertex.vertex_id())
+        , terminals((pattern_vertex.height() == 1 ? 1 : 0) | (text_vertex.height() == 1 ? 2 : 0))
+      { }
+
+      bool operator==(const Key& other) const {
+        return pattern == other.pattern && text == other.text && terminals == other.terminals;
+      }
+
+      size_t hash() const;
+    };
+
+    explicit MatchingCache(size_t max_size);
+
+    //! Copies the result to *value and marks the entry as recently used if the key is stored
+    bool find(const Key& key, FiniteArithmeticSequence* value);
+
+    bool contains(const Key& key) const;
+
+    //! Stores the result if the key is not stored yet, evicting an entry if the cache is full
+    void insert(const Key& key, FiniteArithmeticSequence value);
+
+    size_t size() const {
+      return size_;
+    }
+
+    size_t max_size() const {
+      return max_size_;
+    }
+
+    size_t hits() const {
+      return hits_;
+    }
+
+    size_t misses() const {
+      return misses_;
+    }
+
+    size_t evictions() const {
+      return evictions_;
+    }
+
+    void reset_statistics() {
+      hits_ = misses_ = evictions_ = 0;
+    }
+
+  private:
+    struct Slot {
+      Key key = Key(Vertex(), Vertex());
+      bool used = false;
+      bool referenced = false;
+      FiniteArithmeticSequence value;
+    };
+
+    //! The index of the slot with the key, or of the empty slot where it should be inserted
+    size_t position_(const Key& key) const;
+    void grow_();
+    void evict_();
+    //! Removes the entry and shifts the following entries of the probe sequence back
+    void erase_(size_t index);
+
+    ::std::vector<Slot> slots_;
+    size_t size_;
+    size_t max_size_;
+    size_t clock_hand_;
+
+    size_t hits_;
+    size_t misses_;
+    size_t evictions_;
+};
+
+class MatchingTableStorage;
+
+} //namespace internal
+
 //! Matching tables (or progression tables) which are described in the thesis by Lifshits
 /**
  * It is a class of the matching table as described in the thesis
@@ -40,12 +140,27 @@ namespace slp {
  *
  * See the "Algorithms and complexity analysis for processing compressed text"
  * for details.
+ *
+ * The cells are kept in a bounded cache (see internal::MatchingCache), an evicted cell is recalculated
+ * when it is needed again. Copies of a table share the cells, use clone() to get an independent table.
+ * A table created by concurrent() may be shared by several threads running reduce() or longest_common_prefix().
  */
 class MatchingTable {
   public:
+    //! Default maximal number of the stored cells, a cell takes about 100 bytes
+    static const size_t DEFAULT_MAX_SIZE = 1 << 20;
+
+    //! Counters of the lookups done by matches()
+    struct Statistics {
+      size_t hits = 0;
+      size_t misses = 0;
+      size_t evictions = 0;
+      size_t size = 0;
+    };
+
     //! Return all matches of the pattern around the "split point"
     /**
-     * This function get the result from #match_table_ and recursively calculate
+     * This function get the result from the stored cells and recursively calculate
      * it if needed.
      *
      * @param pattern The SLP for a word we want to find in text.
@@ -53,30 +168,41 @@ class MatchingTable {
      *
      * @return The sequence of the beginnings of matches.
      */
-    const FiniteArithmeticSequence& matches(const Vertex& pattern,
-                                           const Vertex& text);
+    FiniteArithmeticSequence matches(const Vertex& pattern,
+                                     const Vertex& text);
 
     bool is_calculated(const Vertex& pattern, const Vertex& text) const {
-      return pattern.length() <= 1 || text.length() <= 1 || match_table_->count(::std::make_pair(pattern, text));
+      return pattern.length() <= 1 || text.length() <= 1 || is_stored(pattern, text);
     }
 
-    size_t size() const {
-      return match_table_->size();
-    }
+    size_t size() const;
 
-    MatchingTable()
-      : match_table_(::std::make_shared<std::unordered_map<std::pair<Vertex, Vertex>, FiniteArithmeticSequence>>())
-    { }
+    Statistics statistics() const;
 
-    MatchingTable clone() const {
-      return MatchingTable(::std::make_shared<std::unordered_map<std::pair<Vertex, Vertex>, FiniteArithmeticSequence>>(*match_table_));
-    }
+    void reset_statistics();
+
+    //! Creates a table keeping at most max_size cells, it must not be used by several threads at once
+    explicit MatchingTable(size_t max_size = DEFAULT_MAX_SIZE);
+
+    //! Creates a thread-safe table keeping at most max_size cells
+    /**
+     * The cells are spread over shards_count shards (by default, 4 per hardware thread),
+     * each of them is guarded by its own mutex.
+     */
+    static MatchingTable concurrent(size_t max_size = DEFAULT_MAX_SIZE, size_t shards_count = 0);
+
+    MatchingTable clone() const;
 
   protected:
-    MatchingTable(::std::shared_ptr<std::unordered_map<std::pair<Vertex, Vertex>, FiniteArithmeticSequence>> match_table)
-      : match_table_(::std::move(match_table))
+    explicit MatchingTable(::std::shared_ptr<internal::MatchingTableStorage> storage)
+      : storage_(::std::move(storage))
     { }
-    ::std::shared_ptr<std::unordered_map<std::pair<Vertex, Vertex>, FiniteArithmeticSequence>> match_table_; //! The actual storage for the calculated values.
+
+    bool is_stored(const Vertex& pattern, const Vertex& text) const;
+
+    void store(const Vertex& pattern, const Vertex& text, FiniteArithmeticSequence result);
+
+    ::std::shared_ptr<internal::MatchingTableStorage> storage_; //!< The actual storage for the calculated values.
 };
 
 namespace inspector {
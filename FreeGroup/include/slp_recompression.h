@@ -376,8 +376,11 @@ inline void Rule::register_inclusion(Rule* rule, Rule::iterator letter) {
   nonterminal_index_.push_back(LetterPosition(rule, letter));
 }
 
+class NormalFormContext;
+
 struct JezRules {
-    JezRules(const Vertex& slp);
+    //! Builds the rules of #slp, the new vertices are made by #context if it is not null
+    JezRules(const Vertex& slp, NormalFormContext* context = nullptr);
 
     void remove_crossing_blocks();
     std::vector<LetterPosition> list_blocks();
@@ -403,8 +406,12 @@ struct JezRules {
       return fresh_terminal_id_;
     }
 
+    //! Returns the vertex with the given children, it is shared with the previous results if there is a context
+    Vertex make_vertex(const Vertex& left, const Vertex& right);
+
   private:
     TerminalId fresh_terminal_id_;
+    NormalFormContext* context_;
 
     RuleLetter get_letter(const Vertex& vertex) {
       if (vertex.height() > 1) {
@@ -476,6 +483,86 @@ class OneStepPairs {
 
 Vertex normal_form(Vertex root);
 
+//! Context memoizing normal_form() by the root
+/**
+ * The context remembers the normal form of every processed root, and the normal form is also remembered
+ * as the normal form of itself, so bringing the same vertex to the normal form again is a single lookup.
+ * Besides, a new vertex built by the recompression or by make_vertex() with the same children as an earlier one
+ * is replaced by that earlier vertex, so a root packed from the same vertices is found in the context again.
+ *
+ * The normal forms of subgraphs are not reused under a new root: the recompression compresses the whole word
+ * in each phase, so the normal form of a subword is not a part of the normal form of the word. A root made of
+ * new vertices (e.g., by free reduction) is never found in the context.
+ *
+ * The context keeps the stored vertices alive. When it stores more than max_size vertices, it is cleared.
+ * It is not thread-safe.
+ */
+class NormalFormContext {
+  public:
+    //! Default maximal number of the stored vertices
+    static const size_t DEFAULT_MAX_SIZE = 1 << 16;
+
+    //! Counters of the context work
+    struct Statistics {
+      size_t calls = 0;              //!< calls of normal_form() with nonterminal roots
+      size_t hits = 0;               //!< calls answered by the stored normal forms
+      size_t clears = 0;             //!< times the context was cleared because of max_size
+      size_t rules = 0;              //!< rules built by the recompression
+      size_t max_rules = 0;          //!< maximal number of rules built by a single call
+      size_t made_vertices = 0;      //!< requests for vertices with the given children
+      size_t reused_vertices = 0;    //!< of them, answered by the stored vertices
+      size_t normal_forms = 0;       //!< currently stored normal forms
+      size_t vertices = 0;           //!< currently stored vertices
+    };
+
+    explicit NormalFormContext(size_t max_size = DEFAULT_MAX_SIZE)
+      : max_size_(max_size)
+    { }
+
+    NormalFormContext(const NormalFormContext&) = delete;
+    NormalFormContext& operator=(const NormalFormContext&) = delete;
+
+    //! Returns the normal form of #root, reusing the results of the previous calls
+    Vertex normal_form(const Vertex& root);
+
+    //! Returns the vertex with the given children, a stored one if the context has it
+    Vertex make_vertex(const Vertex& left, const Vertex& right);
+
+    //! Number of the stored normal forms and vertices
+    size_t size() const {
+      return normal_forms_.size() + vertices_.size();
+    }
+
+    size_t max_size() const {
+      return max_size_;
+    }
+
+    Statistics statistics() const;
+
+    void reset_statistics();
+
+    //! Forgets all the stored normal forms and vertices
+    void clear();
+
+  private:
+    friend Vertex normal_form(Vertex root, NormalFormContext* context);
+
+    struct VertexPairHash {
+      size_t operator()(const std::pair<Vertex, Vertex>& children) const {
+        std::hash<Vertex> vertex_hash;
+        return vertex_hash(children.first) * 0x9E3779B97F4A7C15ULL + vertex_hash(children.second);
+      }
+    };
+
+    size_t max_size_;
+    std::unordered_map<Vertex, Vertex> normal_forms_;
+    std::unordered_map<std::pair<Vertex, Vertex>, Vertex, VertexPairHash> vertices_;
+    Statistics statistics_;
+};
+
+//! Returns the normal form of #root, the context collects the statistics and shares the new vertices if it is not null
+Vertex normal_form(Vertex root, NormalFormContext* context);
+
 namespace mad_sorts {
 inline unsigned char reverse_bits_in_byte(unsigned char byte) {
   return static_cast<unsigned char>(((byte * 0x80200802ULL) & 0x0884422110ULL) * 0x0101010101ULL >> 32);
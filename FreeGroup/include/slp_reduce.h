@@ -16,6 +16,7 @@ typedef mpz_class LongInteger;
 #include "slp_mapper.h"
 #include "slp_inspector.h"
 #include "slp_common_prefix.h"
+#include "slp_concurrent_map.h"
 
 namespace std {
 //(x)->_mp_d
@@ -113,73 +114,117 @@ inline LongInteger get_cancellation_length(const Vertex& vertex) {
   return get_cancellation_length(vertex, &temp);
 }
 
-template <typename GetCancellationLengthFunctor>
-inline Vertex base_reduce(
+//! Reduces the vertex assuming that the reduced images of its children are stored in #reduced_vertices
+template <typename GetCancellationLengthFunctor, typename ReducedVerticesMap>
+inline Vertex reduce_vertex(
     const Vertex& vertex,
-    GetCancellationLengthFunctor get_cancellation_length,
-    std::unordered_map<Vertex, Vertex>* reduced_vertices)
+    const ReducedVerticesMap& reduced_vertices,
+    GetCancellationLengthFunctor& get_cancellation_length)
 {
-  map_vertices(vertex, reduced_vertices,
-    [get_cancellation_length](
-        const slp::Vertex& vertex,
-        const std::unordered_map<Vertex, Vertex>& reduced_vertices
-    ) -> Vertex {
-      if (vertex.height() <= 1) {
+  if (vertex.height() <= 1) {
+    return vertex;
+  }
+  auto reversed = reduced_vertices.find(vertex.negate());
+  if (reversed != reduced_vertices.end()) {
+    return reversed->second.negate();
+  }
+  const Vertex& left = reduced_vertices.find(vertex.left_child())->second;
+  const Vertex& right = reduced_vertices.find(vertex.right_child())->second;
+  if (!left && !right) {
+    return Vertex();
+  } else {
+    NonterminalVertex result(left, right);
+    LongInteger cancellation_length = get_cancellation_length(result);
+    if (cancellation_length == 0) {
+      if (left == vertex.left_child() && right == vertex.right_child()) {
+        assert((vertex.height() > 1 && vertex.length() > 1) || (vertex.length() == 1 && vertex.height() == 1) || (vertex.length() == 0 && vertex.height() == 0));
         return vertex;
+      } else if (!left) {
+        return right;
+      } else if (!right) {
+        return left;
+      } else {
+        assert((result.height() > 1 && result.length() > 1) || (result.length() == 1 && result.height() == 1) || (result.length() == 0 && result.height() == 0));
+        return result;
       }
-      auto reversed = reduced_vertices.find(vertex.negate());
-      if (reversed != reduced_vertices.end()) {
-        return reversed->second.negate();
-      }
-      const Vertex& left = reduced_vertices.find(vertex.left_child())->second;
-      const Vertex& right = reduced_vertices.find(vertex.right_child())->second;
-      if (!left && !right) {
+    } else {
+      Vertex reduced_left = get_sub_slp(left, 0, left.length() - cancellation_length);
+      Vertex reduced_right = get_sub_slp(right, cancellation_length, right.length());
+
+      if (!reduced_left && !reduced_right) {
         return Vertex();
+      } else if (!reduced_left) {
+        assert(reduced_right.height() >= 1);
+        assert(reduced_right.height() != 1 || reduced_right.length() == 1);
+        return reduced_right;
+      } else if (!reduced_right) {
+        assert(reduced_left.height() >= 1);
+        assert(reduced_left.height() != 1 || reduced_left.length() == 1);
+        return reduced_left;
       } else {
-        NonterminalVertex result(left, right);
-        LongInteger cancellation_length = get_cancellation_length(result);
-        if (cancellation_length == 0) {
-          if (left == vertex.left_child() && right == vertex.right_child()) {
-            assert((vertex.height() > 1 && vertex.length() > 1) || (vertex.length() == 1 && vertex.height() == 1) || (vertex.length() == 0 && vertex.height() == 0));
-            return vertex;
-          } else if (!left) {
-            return right;
-          } else if (!right) {
-            return left;
-          } else {
-            assert((result.height() > 1 && result.length() > 1) || (result.length() == 1 && result.height() == 1) || (result.length() == 0 && result.height() == 0));
-            return result;
-          }
-        } else {
-          Vertex reduced_left = get_sub_slp(left, 0, left.length() - cancellation_length);
-          Vertex reduced_right = get_sub_slp(right, cancellation_length, right.length());
-
-          if (!reduced_left && !reduced_right) {
-            return Vertex();
-          } else if (!reduced_left) {
-            assert(reduced_right.height() >= 1);
-            assert(reduced_right.height() != 1 || reduced_right.length() == 1);
-            return reduced_right;
-          } else if (!reduced_right) {
-            assert(reduced_left.height() >= 1);
-            assert(reduced_left.height() != 1 || reduced_left.length() == 1);
-            return reduced_left;
-          } else {
-            auto result = NonterminalVertex(reduced_left, reduced_right);
-            assert(result.length() > 1);
-            assert(result.height() > 1);
-            return result;
-          }
-        }
+        auto result = NonterminalVertex(reduced_left, reduced_right);
+        assert(result.length() > 1);
+        assert(result.height() > 1);
+        return result;
       }
+    }
+  }
+}
+
+//! Reduces the vertex, the reduced images of all the subvertices are stored in #reduced_vertices
+/**
+ * @tparam ReducedVerticesMap std::unordered_map<Vertex, Vertex>, or ConcurrentMap<Vertex, Vertex>::View to share the images between threads
+ */
+template <typename GetCancellationLengthFunctor, typename ReducedVerticesMap>
+inline Vertex base_reduce(
+    const Vertex& vertex,
+    GetCancellationLengthFunctor get_cancellation_length,
+    ReducedVerticesMap* reduced_vertices)
+{
+  map_vertices(vertex, reduced_vertices,
+    [&get_cancellation_length](
+        const slp::Vertex& vertex,
+        const ReducedVerticesMap& reduced_vertices
+    ) {
+      return reduce_vertex(vertex, reduced_vertices, get_cancellation_length);
   });
   return (*reduced_vertices)[vertex];
 }
 
+//! Reduces the roots concurrently, see map_vertices_parallel()
+/**
+ * @param make_get_cancellation_length returns the functor computing cancellation lengths for a single thread
+ */
+template <typename GetCancellationLengthFactory>
+inline std::vector<Vertex> base_reduce_parallel(
+    const std::vector<Vertex>& roots,
+    GetCancellationLengthFactory make_get_cancellation_length,
+    ConcurrentMap<Vertex, Vertex>* reduced_vertices)
+{
+  map_vertices_parallel(roots, reduced_vertices, [&make_get_cancellation_length] () {
+    auto get_cancellation_length = make_get_cancellation_length();
+    return [get_cancellation_length](
+        const slp::Vertex& vertex,
+        const ConcurrentMap<Vertex, Vertex>::View& reduced_vertices
+    ) mutable {
+      return reduce_vertex(vertex, reduced_vertices, get_cancellation_length);
+    };
+  });
+
+  ConcurrentMap<Vertex, Vertex>::View reduced_vertices_view(reduced_vertices);
+  std::vector<Vertex> result;
+  result.reserve(roots.size());
+  for (const auto& root : roots) {
+    result.push_back(reduced_vertices_view[root]);
+  }
+  return result;
+}
+
+template <typename ReducedVerticesMap>
 inline Vertex reduce(
     const Vertex& vertex,
     MatchingTable* matching_table,
-    std::unordered_map<Vertex, Vertex>* reduced_vertices)
+    ReducedVerticesMap* reduced_vertices)
 {
   return base_reduce(vertex,
                      [matching_table](const Vertex& vertex) { return get_cancellation_length(vertex, matching_table); },
@@ -188,6 +233,20 @@ inline Vertex reduce(
 }
 
 
+//! Reduces the roots concurrently, #matching_table should be thread-safe (see MatchingTable::concurrent())
+inline std::vector<Vertex> reduce_parallel(
+    const std::vector<Vertex>& roots,
+    MatchingTable* matching_table,
+    ConcurrentMap<Vertex, Vertex>* reduced_vertices)
+{
+  return base_reduce_parallel(roots,
+                              [matching_table]() {
+                                return [matching_table](const Vertex& vertex) { return get_cancellation_length(vertex, matching_table); };
+                              },
+                              reduced_vertices
+  );
+}
+
 inline Vertex reduce(const Vertex& vertex) {
   MatchingTable matching_table;
   std::unordered_map<Vertex, Vertex> reduced_vertices;
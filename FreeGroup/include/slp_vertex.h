@@ -10,8 +10,13 @@
 #define CRAG_FREEGROUP_SLP_VERTEX_H_
 
 #include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
 #include <memory>
+#include <new>
 #include <iostream>
+#include <limits>
 #include <cassert>
 
 #include <gmpxx.h>
@@ -19,7 +24,7 @@ typedef mpz_class LongInteger;
 
 #include "common.h"
 
-//#include "boost/pool/pool_alloc.hpp"
+#include "boost/pool/singleton_pool.hpp"
 
 namespace crag {
 namespace slp {
@@ -29,8 +34,67 @@ typedef int64_t TerminalSymbol;
 
 namespace internal {
 class BasicVertex;
-//struct BasicVertexAllocatorTag{};
-//typedef boost::fast_pool_allocator<BasicVertex, boost::default_user_allocator_malloc_free, boost::details::pool::null_mutex, 1, 0> BasicVertexPoolAllocator;
+
+//! Size of a pool node, it should fit a BasicVertex together with the shared_ptr control block
+CONSTEXPR_OR_CONST size_t VERTEX_NODE_SIZE = 96;
+
+struct VertexPoolTag {};
+typedef boost::singleton_pool<VertexPoolTag, VERTEX_NODE_SIZE, boost::default_user_allocator_malloc_free, boost::details::pool::default_mutex, 4096> VertexPool;
+
+//! The number of nodes taken from VertexPool and not returned yet
+extern std::atomic<size_t> vertex_nodes_count;
+
+//! Allocator of the vertex nodes, single objects of at most VERTEX_NODE_SIZE bytes are taken from the shared pool
+template <typename T>
+class VertexPoolAllocator {
+  public:
+    typedef T value_type;
+
+    VertexPoolAllocator() = default;
+
+    template <typename U>
+    VertexPoolAllocator(const VertexPoolAllocator<U>&)
+    { }
+
+    T* allocate(size_t n) {
+      if (!is_pooled(n)) {
+        return static_cast<T*>(::operator new(n * sizeof(T)));
+      }
+
+      void* node = VertexPool::malloc();
+      if (!node) {
+        throw std::bad_alloc();
+      }
+
+      ++vertex_nodes_count;
+      return static_cast<T*>(node);
+    }
+
+    void deallocate(T* p, size_t n) {
+      if (!is_pooled(n)) {
+        ::operator delete(p);
+        return;
+      }
+
+      VertexPool::free(p);
+      --vertex_nodes_count;
+    }
+
+    template <typename U>
+    bool operator==(const VertexPoolAllocator<U>&) const {
+      return true;
+    }
+
+    template <typename U>
+    bool operator!=(const VertexPoolAllocator<U>&) const {
+      return false;
+    }
+
+  private:
+    static bool is_pooled(size_t n) {
+      return n == 1 && sizeof(T) <= VERTEX_NODE_SIZE && alignof(T) <= alignof(std::max_align_t);
+    }
+};
 }
 
 //! Basic interface for vertex. Also represents empty vertex, use Vertex() as empty vertex
@@ -66,6 +130,9 @@ class Vertex {
 
     const LongInteger& length() const;
 
+    //! The length if it is less than 2^64, 0 otherwise
+    uint64_t short_length() const;
+
     unsigned int height() const;
 
     size_t vertex_hash() const {
@@ -85,8 +152,7 @@ class Vertex {
     }
 
   protected:
-    typedef std::allocator<internal::BasicVertex> VertexAllocator;
-    //typedef internal::BasicVertexPoolAllocator VertexAllocator;
+    typedef internal::VertexPoolAllocator<internal::BasicVertex> VertexAllocator;
     VertexSignedId vertex_signed_id_;
     std::shared_ptr<internal::BasicVertex> vertex_;
 
@@ -106,24 +172,58 @@ inline void PrintTo(const Vertex& vertex, ::std::ostream* os) {
 
 
 namespace internal {
+//! Production rule of a nonterminal vertex
+/**
+ * The nodes are taken from a pool (see VertexPoolAllocator), the children come first to share a cache line
+ * with the control block of the shared_ptr.
+ *
+ * Lengths less than 2^64 are stored inline in short_length_, and length_ is a read-only mpz view of it
+ * (see mpz_roinit_n), so creating a vertex does not allocate GMP memory. Longer lengths are stored in
+ * length_ as usual, and short_length_ is 0 then. The view is only used by the GMP versions
+ * which do not allocate in mpz_init (6.2 and later), older ones always store length_.
+ */
 class BasicVertex {
   public:
-    LongInteger length_;
-    unsigned int height_;
     Vertex left_child_;
     Vertex right_child_;
-
-    BasicVertex()
-      : length_(0)
-      , height_(0)
-    { }
+    uint64_t short_length_;
+    unsigned int height_;
+    LongInteger length_;
 
     BasicVertex(Vertex&& left_child, Vertex&& right_child)
-      : length_(left_child.length() + right_child.length())
-      , height_(std::max(left_child.height(), right_child.height()) + 1)
-      , left_child_(std::move(left_child))
+      : left_child_(std::move(left_child))
       , right_child_(std::move(right_child))
-    { }
+      , short_length_(0)
+      , height_(std::max(left_child_.height(), right_child_.height()) + 1)
+    {
+      const auto left_length = left_child_.short_length();
+      const auto right_length = right_child_.short_length();
+
+      if (left_length && right_length && left_length <= std::numeric_limits<uint64_t>::max() - right_length) {
+        short_length_ = left_length + right_length;
+        set_short_length();
+      } else {
+        short_length_ = 0;
+        length_ = left_child_.length() + right_child_.length();
+      }
+    }
+
+    BasicVertex(const BasicVertex&) = delete;
+    BasicVertex& operator=(const BasicVertex&) = delete;
+
+  private:
+#if GMP_LIMB_BITS == 64 && GMP_NAIL_BITS == 0 && \
+    (__GNU_MP_VERSION > 6 || (__GNU_MP_VERSION == 6 && __GNU_MP_VERSION_MINOR >= 2))
+    void set_short_length() {
+      static_assert(sizeof(mp_limb_t) == sizeof(short_length_), "Inline length must be a single limb");
+      //mpz_init has not allocated anything, and mpz_clear does not free the memory of a view
+      mpz_roinit_n(length_.get_mpz_t(), reinterpret_cast<const mp_limb_t*>(&short_length_), 1);
+    }
+#else
+    void set_short_length() {
+      length_ = left_child_.length() + right_child_.length();
+    }
+#endif
 };
 
 }
@@ -174,6 +274,16 @@ inline const LongInteger& Vertex::length() const {
   }
 }
 
+inline uint64_t Vertex::short_length() const {
+  if (vertex_) {
+    return vertex_->short_length_;
+  } else if (vertex_signed_id_) {
+    return 1;
+  } else {
+    return 0;
+  }
+}
+
 inline unsigned int Vertex::height() const {
   if (vertex_) {
     return vertex_->height_;
@@ -245,8 +355,8 @@ class NonterminalVertex : public Vertex {
     NonterminalVertex(Vertex left, Vertex right)
       : Vertex(
           ++last_vertex_id_,
-          std::make_shared<internal::BasicVertex>(
-            //get_allocator(),
+          std::allocate_shared<internal::BasicVertex>(
+            get_allocator(),
             ::std::move(left),
             ::std::move(right)
           ))
@@ -258,7 +368,7 @@ class NonterminalVertex : public Vertex {
       assert(height() > 1);
       assert(length() > 1);
 
-      if (last_vertex_id_ <= 0) {
+      if (vertex_signed_id_ <= 0) {
         throw std::overflow_error("NonterminalVertex::vertex_id is overflowed");
       }
     }
@@ -267,8 +377,15 @@ class NonterminalVertex : public Vertex {
       last_vertex_id_ = 0;
     }
 
+    //! Frees all the memory of the vertex pool at once if there are no vertices left
+    /**
+     * Returns false and does nothing if some vertex is still alive. It must not be called
+     * while other threads create vertices.
+     */
+    static bool release_vertex_memory();
+
   private:
-    static Vertex::VertexSignedId last_vertex_id_; //All vertices are enumerated
+    static std::atomic<Vertex::VertexSignedId> last_vertex_id_; //All vertices are enumerated, possibly by several threads
     static const Vertex::VertexAllocator& get_allocator();
 };
 }//namespace slp
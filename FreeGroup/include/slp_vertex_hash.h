@@ -9,6 +9,7 @@
 #include <cassert>
 #include <new>
 #include <memory>
+#include <mutex>
 
 #include "gmpxx.h"
 
@@ -18,6 +19,8 @@ typedef mpz_class LongInteger;
 #include "permutation16.h"
 #include "slp_vertex.h"
 #include "slp_reduce.h"
+#include "slp_concurrent_map.h"
+#include "slp_mapper.h"
 
 namespace crag {
 namespace slp {
@@ -74,6 +77,10 @@ class TVertexHash<TFirstHasher, TOtherHashers...> : public TFirstHasher, public
       , OtherHasher(other)
     { }
 
+    TVertexHash(TVertexHash&& other) = default;
+    TVertexHash& operator=(const TVertexHash& other) = default;
+    TVertexHash& operator=(TVertexHash&& other) = default;
+
     TVertexHash& operator*=(const TVertexHash& other) {
       FirstHasher::concatenate_with(other);
       OtherHasher::operator*=(other);
@@ -81,8 +88,6 @@ class TVertexHash<TFirstHasher, TOtherHashers...> : public TFirstHasher, public
       return *this;
     }
 
-    //I do not add move support right now, since for current hashers it makes no sense
-
     bool operator==(const TVertexHash& other) const {
       return FirstHasher::is_equal_to(other) && OtherHasher::operator==(other);
     }
@@ -170,6 +175,8 @@ class PowerCountHash {
       }
     }
 
+    PowerCountHash& operator=(const PowerCountHash& other) = default;
+
     void concatenate_with(const PowerCountHash& other) {
       for (size_t i = 0; i < RANK; ++i) {
         terminal_power_[i] += other.terminal_power_[i];
@@ -207,6 +214,8 @@ class SinglePowerHash {
       terminals_power_ = other.terminals_power_;
     }
 
+    SinglePowerHash& operator=(const SinglePowerHash& other) = default;
+
     void concatenate_with(const SinglePowerHash& other) {
       terminals_power_ += other.terminals_power_;
     }
@@ -234,6 +243,8 @@ class PermutationHashBase {
   
     static TPermutation GetTerminalPermutation(Vertex::VertexSignedId terminal_id) {
       static std::vector<TPermutation> permutations(BasePermutations::permutations());
+      static std::mutex permutations_mutex; //the permutations of new terminals are generated lazily by any thread
+      std::lock_guard<std::mutex> lock(permutations_mutex);
 
       size_t terminal = terminal_id < 0 ? -terminal_id : terminal_id;
 
@@ -261,6 +272,8 @@ class PermutationHashBase {
       : permutation_(other.permutation_)
     { }
 
+    PermutationHashBase& operator=(const PermutationHashBase& other) = default;
+
     void concatenate_with(const PermutationHashBase& other) {
       permutation_ *= other.permutation_;
     }
@@ -313,6 +326,10 @@ class ImageLengthHash {
       : length_(other.length_)
     {}
 
+    ImageLengthHash(ImageLengthHash&& other) = default;
+    ImageLengthHash& operator=(const ImageLengthHash& other) = default;
+    ImageLengthHash& operator=(ImageLengthHash&& other) = default;
+
     void concatenate_with(const ImageLengthHash& other) {
       length_ += other.length_;
     }
@@ -348,8 +365,13 @@ class TVertexHashAlgorithms {
      */
     typedef std::unordered_map<VertexHash, Vertex> HashRepresentativesCache;
 
+    //! Thread-safe versions of the caches used by the parallel algorithms.
+    typedef ConcurrentMap<Vertex, VertexHash> ConcurrentCache;
+    typedef ConcurrentMap<VertexHash, Vertex> ConcurrentHashRepresentativesCache;
+
     //! Calculate the hash of the word produced by root, starting from begin to end, filling hash cache for all the subvertices.
-    static VertexHash get_subvertex_hash(const Vertex& root, const LongInteger& begin, const LongInteger& end, Cache* cache) {
+    template <typename HashCache>
+    static VertexHash get_subvertex_hash(const Vertex& root, const LongInteger& begin, const LongInteger& end, HashCache* cache) {
       assert(cache);
       assert(begin >= 0 && end <= root.length());
 
@@ -404,7 +426,8 @@ class TVertexHashAlgorithms {
     }
 
     //! Calculate the hash of the word produced by root, filling hash cache for all the subvertices
-    static VertexHash get_vertex_hash(const Vertex& root, Cache* cache) {
+    template <typename HashCache>
+    static VertexHash get_vertex_hash(const Vertex& root, HashCache* cache) {
       return get_subvertex_hash(root, 0, root.length(), cache);
     }
 
@@ -414,12 +437,13 @@ class TVertexHashAlgorithms {
     }
 
     //! Get the longest common prefix using binary search and hashes
+    template <typename HashCache>
     static LongInteger get_longest_common_prefix(
         const Vertex& first,
         const Vertex& second,
         LongInteger begin, //already verified left boundary
         LongInteger end, //already verified right boundary
-        Cache* calculated_hashes
+        HashCache* calculated_hashes
     ) {
 
       if (first.length() > second.length()) {
@@ -442,10 +466,11 @@ class TVertexHashAlgorithms {
       return begin;
     }
 
+    template <typename HashCache>
     static LongInteger get_longest_common_prefix(
         const Vertex& first,
         const Vertex& second,
-        Cache* calculated_hashes
+        HashCache* calculated_hashes
     ) {
       return get_longest_common_prefix(first, second, 0, -1, calculated_hashes);
     }
@@ -459,9 +484,10 @@ class TVertexHashAlgorithms {
     }
 
 
+    template <typename HashCache>
     static LongInteger get_cancellation_length(
         const Vertex& vertex,
-        Cache* calculated_hashes) {
+        HashCache* calculated_hashes) {
       return get_longest_common_prefix(
           vertex.left_child().negate(),
           vertex.right_child(),
@@ -475,10 +501,11 @@ class TVertexHashAlgorithms {
       return get_cancellation_length(vertex, &cache);
     }
 
+    template <typename HashCache, typename ReducedVerticesMap>
     static Vertex reduce(
         const Vertex& vertex,
-        Cache* calculated_hashes,
-        std::unordered_map<Vertex, Vertex>* reduced_vertices
+        HashCache* calculated_hashes,
+        ReducedVerticesMap* reduced_vertices
     ) {
       return base_reduce(
           vertex,
@@ -495,85 +522,116 @@ class TVertexHashAlgorithms {
 
     static const size_t CANCELLATION_LENGTH_CACHE_SIZE = 100;
 
-    static Vertex reduce_narrow_slp(
-        const Vertex& vertex,
-        Cache* calculated_hashes,
-        std::unordered_map<Vertex, Vertex>* reduced_vertices
-    ) {
-      std::vector<std::pair<LongInteger, size_t>> cancellation_length_cache;
-      cancellation_length_cache.reserve(CANCELLATION_LENGTH_CACHE_SIZE);
+    //! Computes the cancellation lengths trying the recently found ones first, see reduce_narrow_slp()
+    template <typename HashCache>
+    class NarrowCancellationLength {
+      public:
+        explicit NarrowCancellationLength(HashCache* calculated_hashes)
+          : calculated_hashes_(calculated_hashes)
+          , current_iteration_(0)
+        {
+          cancellation_length_cache_.reserve(CANCELLATION_LENGTH_CACHE_SIZE);
+        }
 
-      size_t current_iteration = 0;
+        LongInteger operator()(const Vertex& vertex) {
+        ++current_iteration_;
+        Vertex left = vertex.left_child().negate();
+        Vertex right = vertex.right_child();
 
-      return base_reduce(
-          vertex,
-          [calculated_hashes, &cancellation_length_cache, &current_iteration](const Vertex& vertex) -> LongInteger {
-            ++current_iteration;
-            Vertex left = vertex.left_child().negate();
-            Vertex right = vertex.right_child();
+        if (!left || !right) {
+          return LongInteger(0);
+        }
 
-            if (!left || !right) {
-              return LongInteger(0);
-            }
+        if (crag::slp::get_sub_slp(left, 0, 1) !=
+            crag::slp::get_sub_slp(right, 0, 1)) {
+          return LongInteger(0);
+        }
+
+        size_t previous_reduction_begin = 0;
+        size_t previous_reduction_end = cancellation_length_cache_.size();
+
+        while (previous_reduction_begin < previous_reduction_end) {
+          size_t split = (previous_reduction_begin + previous_reduction_end) / 2;
+          const auto& current_length = cancellation_length_cache_[split].first;
 
-            if (crag::slp::get_sub_slp(left, 0, 1) !=
-                crag::slp::get_sub_slp(right, 0, 1)) {
-              return LongInteger(0);
+          if (current_length <= left.length() && current_length <= right.length() &&
+              get_subvertex_hash(left, 0, current_length, calculated_hashes_) ==
+              get_subvertex_hash(right, 0, current_length, calculated_hashes_)) {
+            if (crag::slp::get_sub_slp(left, current_length, current_length + 1) !=
+                crag::slp::get_sub_slp(right, current_length, current_length + 1)) {
+              cancellation_length_cache_.at(split).second = current_iteration_;
+              return cancellation_length_cache_[split].first;
             }
+            previous_reduction_begin = split + 1;
+          } else {
+            previous_reduction_end = split;
+          }
+        }
 
-            size_t previous_reduction_begin = 0;
-            size_t previous_reduction_end = cancellation_length_cache.size();
-
-            while (previous_reduction_begin < previous_reduction_end) {
-              size_t split = (previous_reduction_begin + previous_reduction_end) / 2;
-              const auto& current_length = cancellation_length_cache[split].first;
-
-              if (current_length <= left.length() && current_length <= right.length() &&
-                  get_subvertex_hash(left, 0, current_length, calculated_hashes) ==
-                  get_subvertex_hash(right, 0, current_length, calculated_hashes)) {
-                if (crag::slp::get_sub_slp(left, current_length, current_length + 1) !=
-                    crag::slp::get_sub_slp(right, current_length, current_length + 1)) {
-                  cancellation_length_cache.at(split).second = current_iteration;
-                  return cancellation_length_cache[split].first;
-                }
-                previous_reduction_begin = split + 1;
-              } else {
-                previous_reduction_end = split;
+        auto new_length_insert_position = cancellation_length_cache_.begin() + previous_reduction_begin;
+
+        if (cancellation_length_cache_.size() >= CANCELLATION_LENGTH_CACHE_SIZE) {
+          auto oldest_entry = std::min_element(cancellation_length_cache_.begin(), cancellation_length_cache_.end(),
+              [](const std::pair<const LongInteger, size_t>& first, const std::pair<const LongInteger, size_t>& second) {
+                return first.second < second.second;
               }
-            }
+          );
 
-            auto new_length_insert_position = cancellation_length_cache.begin() + previous_reduction_begin;
+          if (new_length_insert_position > oldest_entry) {
+            --new_length_insert_position;
+            --previous_reduction_begin;
+            --previous_reduction_end;
+          }
 
-            if (cancellation_length_cache.size() >= CANCELLATION_LENGTH_CACHE_SIZE) {
-              auto oldest_entry = std::min_element(cancellation_length_cache.begin(), cancellation_length_cache.end(),
-                  [](const std::pair<const LongInteger, size_t>& first, const std::pair<const LongInteger, size_t>& second) {
-                    return first.second < second.second;
-                  }
-              );
+          cancellation_length_cache_.erase(oldest_entry);
+        }
 
-              if (new_length_insert_position > oldest_entry) {
-                --new_length_insert_position;
-                --previous_reduction_begin;
-                --previous_reduction_end;
-              }
+        assert(new_length_insert_position <= cancellation_length_cache_.end());
+        assert(new_length_insert_position >= cancellation_length_cache_.begin());
 
-              cancellation_length_cache.erase(oldest_entry);
-            }
+        LongInteger cancellation_length = get_longest_common_prefix(
+            left,
+            right,
+            previous_reduction_begin > 0 ? cancellation_length_cache_[previous_reduction_begin - 1].first : 0,
+            previous_reduction_end < cancellation_length_cache_.size() ? cancellation_length_cache_[previous_reduction_end].first : -1,
+            calculated_hashes_
+        );
+
+        auto new_length = cancellation_length_cache_.emplace(new_length_insert_position, std::move(cancellation_length), current_iteration_);
 
-            assert(new_length_insert_position <= cancellation_length_cache.end());
-            assert(new_length_insert_position >= cancellation_length_cache.begin());
+        return new_length->first;
+        }
 
-            LongInteger cancellation_length = get_longest_common_prefix(
-                left,
-                right,
-                previous_reduction_begin > 0 ? cancellation_length_cache[previous_reduction_begin - 1].first : 0,
-                previous_reduction_end < cancellation_length_cache.size() ? cancellation_length_cache[previous_reduction_end].first : -1,
-                calculated_hashes
-            );
+      private:
+        HashCache* calculated_hashes_;
+        std::vector<std::pair<LongInteger, size_t>> cancellation_length_cache_;
+        size_t current_iteration_;
+    };
 
-            auto new_length = cancellation_length_cache.emplace(new_length_insert_position, std::move(cancellation_length), current_iteration);
+    template <typename HashCache, typename ReducedVerticesMap>
+    static Vertex reduce_narrow_slp(
+        const Vertex& vertex,
+        HashCache* calculated_hashes,
+        ReducedVerticesMap* reduced_vertices
+    ) {
+      return base_reduce(vertex, NarrowCancellationLength<HashCache>(calculated_hashes), reduced_vertices);
+    }
 
-            return new_length->first;
+    //! Reduces the roots concurrently, the threads share the calculated hashes and the reduced vertices
+    static std::vector<Vertex> reduce_narrow_slp_parallel(
+        const std::vector<Vertex>& roots,
+        ConcurrentCache* calculated_hashes,
+        ConcurrentMap<Vertex, Vertex>* reduced_vertices
+    ) {
+      return base_reduce_parallel(
+          roots,
+          [calculated_hashes]() {
+            auto calculated_hashes_view = std::make_shared<typename ConcurrentCache::View>(calculated_hashes);
+            NarrowCancellationLength<typename ConcurrentCache::View> get_cancellation_length(calculated_hashes_view.get());
+
+            return [calculated_hashes_view, get_cancellation_length](const Vertex& vertex) mutable {
+              return get_cancellation_length(vertex);
+            };
           },
           reduced_vertices
       );
@@ -586,38 +644,44 @@ class TVertexHashAlgorithms {
     }
 
 
-    //! Remove redundant vertices with the same hash value reducing the size of SLP in this way.
-    static Vertex remove_duplicates(const Vertex& root, Cache* p_cache, HashRepresentativesCache* p_hash_cache) {
-      assert(p_cache);
-      assert(p_hash_cache);
-
-      //returning the canonical vertex corresponding to the vertex hash
-      auto map_vertex = [&] (const Vertex& v, const std::unordered_map<Vertex, Vertex>& new_vertices) -> Vertex {
-        //side effect of this call is the cache filling for all the subvertices
-        auto hash = get_vertex_hash(v, p_cache);
-        auto item = p_hash_cache->find(hash);
-        if (item != p_hash_cache->end()) {
-          return item->second;
+    //! Returns the canonical vertex with the same hash, the representatives of the children of #v must be known
+    template <typename HashCache, typename HashRepresentativesMap>
+    static Vertex get_representative(const Vertex& v, HashCache* p_cache, HashRepresentativesMap* p_hash_cache) {
+      //side effect of this call is the cache filling for all the subvertices
+      auto hash = get_vertex_hash(v, p_cache);
+      auto item = p_hash_cache->find(hash);
+      if (item != p_hash_cache->end()) {
+        return item->second;
+      } else {
+        if (v.height() == 1) {
+          return p_hash_cache->insert(std::make_pair(hash, v)).first->second;
         } else {
-          if (v.height() == 1) {
-            p_hash_cache->insert(std::make_pair(hash, v));
-            return v;
-          } else {
 
-            auto left_hash = get_vertex_hash(v.left_child(), p_cache);
-            auto right_hash = get_vertex_hash(v.right_child(), p_cache);
+          auto left_hash = get_vertex_hash(v.left_child(), p_cache);
+          auto right_hash = get_vertex_hash(v.right_child(), p_cache);
 
-            auto left_item = p_hash_cache->find(left_hash);
-            auto right_item = p_hash_cache->find(right_hash);
-            assert(left_item != p_hash_cache->end());
-            assert(right_item != p_hash_cache->end());
+          auto left_item = p_hash_cache->find(left_hash);
+          auto right_item = p_hash_cache->find(right_hash);
+          assert(left_item != p_hash_cache->end());
+          assert(right_item != p_hash_cache->end());
 
-            NonterminalVertex new_v(left_item->second, right_item->second);
-            p_hash_cache->insert(std::make_pair(hash, new_v));
+          NonterminalVertex new_v(left_item->second, right_item->second);
 
-            return Vertex(new_v);
-          }
+          //another thread sharing the cache might have stored its representative first
+          return p_hash_cache->insert(std::make_pair(hash, Vertex(new_v))).first->second;
         }
+      }
+    }
+
+    //! Remove redundant vertices with the same hash value reducing the size of SLP in this way.
+    template <typename HashCache, typename HashRepresentativesMap>
+    static Vertex remove_duplicates(const Vertex& root, HashCache* p_cache, HashRepresentativesMap* p_hash_cache) {
+      assert(p_cache);
+      assert(p_hash_cache);
+
+      //returning the canonical vertex corresponding to the vertex hash
+      auto map_vertex = [&] (const Vertex& v, const std::unordered_map<Vertex, Vertex>& new_vertices) -> Vertex {
+        return get_representative(v, p_cache, p_hash_cache);
       };
 
 
@@ -629,6 +693,32 @@ class TVertexHashAlgorithms {
       assert(root_item != new_vertices.end());
       return root_item->second;
     }
+
+    //! Removes the duplicates from the roots concurrently, the threads share the hashes and the representatives
+    static std::vector<Vertex> remove_duplicates_parallel(
+        const std::vector<Vertex>& roots,
+        ConcurrentCache* p_cache,
+        ConcurrentHashRepresentativesCache* p_hash_cache
+    ) {
+      ConcurrentMap<Vertex, Vertex> new_vertices;
+
+      map_vertices_parallel(roots, &new_vertices, [p_cache, p_hash_cache]() {
+        auto cache_view = std::make_shared<typename ConcurrentCache::View>(p_cache);
+        auto hash_cache_view = std::make_shared<typename ConcurrentHashRepresentativesCache::View>(p_hash_cache);
+
+        return [cache_view, hash_cache_view](const Vertex& v, const ConcurrentMap<Vertex, Vertex>::View&) {
+          return get_representative(v, cache_view.get(), hash_cache_view.get());
+        };
+      });
+
+      ConcurrentMap<Vertex, Vertex>::View new_vertices_view(&new_vertices);
+      std::vector<Vertex> result;
+      result.reserve(roots.size());
+      for (const auto& root : roots) {
+        result.push_back(new_vertices_view[root]);
+      }
+      return result;
+    }
 };
 
 } //namespace slp
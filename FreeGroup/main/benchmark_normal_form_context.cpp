@@ -0,0 +1,106 @@
+/*
+ * benchmark_normal_form_context.cpp
+ *
+ * Reductions of automorphisms with and without a NormalFormContext.
+ */
+
+#include <memory>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+
+#include "EndomorphismSLP.h"
+
+using crag::UniformAutomorphismSLPGenerator;
+using crag::EndomorphismSLP;
+using crag::AutomorphismReducer;
+using crag::slp::recompression::NormalFormContext;
+
+static std::vector<EndomorphismSLP> randomParts(size_t count, size_t part_length) {
+  UniformAutomorphismSLPGenerator<> generator(3, 112233);
+  std::vector<EndomorphismSLP> parts;
+  parts.reserve(count);
+
+  for (size_t i = 0; i < count; ++i) {
+    parts.push_back(EndomorphismSLP::composition(part_length, generator));
+  }
+
+  return parts;
+}
+
+//! The loop of the key builders: the product is reduced after every new part.
+static EndomorphismSLP reduceProduct(const std::vector<EndomorphismSLP>& parts, NormalFormContext* context) {
+  EndomorphismSLP product;
+
+  for (const auto& part : parts) {
+    product = AutomorphismReducer::reduce(product * part, context);
+  }
+
+  return product;
+}
+
+//! The argument is the maximal size of the context, 0 means no context.
+static std::unique_ptr<NormalFormContext> makeContext(const benchmark::State& state) {
+  return state.range(0) ? std::unique_ptr<NormalFormContext>(new NormalFormContext(state.range(0))) : nullptr;
+}
+
+//! Reports the counters of the context of the last iteration.
+static void setCounters(benchmark::State& state, const NormalFormContext* context) {
+  if (context) {
+    const auto statistics = context->statistics();
+    state.counters["calls"] = statistics.calls;
+    state.counters["hits"] = statistics.hits;
+    state.counters["reused_vertices"] = statistics.reused_vertices;
+    state.counters["made_vertices"] = statistics.made_vertices;
+  }
+}
+
+//! The product is built once, so only the vertices can be shared between the steps.
+static void BM_IterativeReduction(benchmark::State& state) {
+  const auto parts = randomParts(20, 20);
+
+  std::unique_ptr<NormalFormContext> context;
+
+  for (auto _ : state) {
+    context = makeContext(state);
+    benchmark::DoNotOptimize(reduceProduct(parts, context.get()));
+  }
+
+  setCounters(state, context.get());
+
+  state.SetItemsProcessed(state.iterations() * parts.size());
+}
+BENCHMARK(BM_IterativeReduction)->Arg(0)->Arg(1 << 12)->Arg(1 << 16)->Arg(1 << 20)->Unit(benchmark::kMillisecond);
+
+//! The product is built twice by the same context, as when a key is rebuilt from the same parts.
+static void BM_RepeatedReduction(benchmark::State& state) {
+  const auto parts = randomParts(20, 20);
+
+  std::unique_ptr<NormalFormContext> context;
+
+  for (auto _ : state) {
+    context = makeContext(state);
+    benchmark::DoNotOptimize(reduceProduct(parts, context.get()));
+    benchmark::DoNotOptimize(reduceProduct(parts, context.get()));
+  }
+
+  setCounters(state, context.get());
+
+  state.SetItemsProcessed(state.iterations() * 2 * parts.size());
+}
+BENCHMARK(BM_RepeatedReduction)->Arg(0)->Arg(1 << 12)->Arg(1 << 16)->Arg(1 << 20)->Unit(benchmark::kMillisecond);
+
+//! The same automorphism is brought to the normal form again and again, every call after the first one is a hit.
+static void BM_NormalFormAgain(benchmark::State& state) {
+  const auto product = reduceProduct(randomParts(20, 20), nullptr);
+  auto context = makeContext(state);
+
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(product.normal_form(context.get()));
+  }
+
+  setCounters(state, context.get());
+}
+BENCHMARK(BM_NormalFormAgain)->Arg(0)->Arg(1 << 16)->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
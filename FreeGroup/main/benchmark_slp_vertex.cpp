@@ -0,0 +1,91 @@
+/*
+ * benchmark_slp_vertex.cpp
+ *
+ * Building and traversing SLP vertices.
+ */
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+
+#include "slp.h"
+#include "EndomorphismSLP.h"
+
+using crag::slp::Vertex;
+using crag::slp::TerminalVertex;
+using crag::slp::NonterminalVertex;
+using crag::UniformAutomorphismSLPGenerator;
+using crag::EndomorphismSLP;
+
+//! Random DAG, every vertex joins two random vertices among the first window ones.
+//! If long_words is set, the DAG starts with a doubling chain, so that most of the lengths exceed 2^64.
+static std::vector<Vertex> randomDag(size_t vertices_count, size_t window, bool long_words) {
+  std::mt19937 g(17);
+  std::vector<Vertex> vertices = {TerminalVertex(1), TerminalVertex(2), TerminalVertex(-1)};
+
+  if (long_words) {
+    for (int i = 0; i < 80; ++i) {
+      vertices.push_back(NonterminalVertex(vertices.back(), vertices.back()));
+    }
+  }
+
+  while (vertices.size() < vertices_count) {
+    std::uniform_int_distribution<size_t> index(0, std::min(window, vertices.size()) - 1);
+    vertices.push_back(NonterminalVertex(vertices[index(g)], vertices[index(g)]));
+  }
+
+  return vertices;
+}
+
+static void BM_BuildShortDag(benchmark::State& state) {
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(randomDag(state.range(0), 4096, false));
+  }
+
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_BuildShortDag)->Arg(1 << 16)->Arg(1 << 20);
+
+static void BM_BuildLongDag(benchmark::State& state) {
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(randomDag(state.range(0), state.range(0), true));
+  }
+
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_BuildLongDag)->Arg(1 << 16)->Arg(1 << 20);
+
+static void BM_TraverseChildren(benchmark::State& state) {
+  const auto vertices = randomDag(state.range(0), 4096, false);
+
+  for (auto _ : state) {
+    size_t heights = 0;
+    LongInteger lengths = 0;
+
+    for (const auto& v : vertices) {
+      const auto left = v.negate().left_child();
+      heights += left.height();
+      lengths += left.length();
+    }
+
+    benchmark::DoNotOptimize(heights);
+    benchmark::DoNotOptimize(lengths);
+  }
+
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_TraverseChildren)->Arg(1 << 16);
+
+static void BM_Composition(benchmark::State& state) {
+  UniformAutomorphismSLPGenerator<> generator(3, 112233);
+
+  for (auto _ : state) {
+    auto composition = EndomorphismSLP::composition(state.range(0), generator);
+    benchmark::DoNotOptimize(composition.image(1).length());
+  }
+}
+BENCHMARK(BM_Composition)->Arg(1000)->Arg(10000);
+
+BENCHMARK_MAIN();
@@ -45,6 +45,7 @@ int main() {
 //  > VertexHashAlgorithms;
 
   auto normal_form_duration = begin - begin;
+  crag::slp::recompression::NormalFormContext context;
 
   while (--count >= 0) {
     auto image = EndomorphismSLP::composition(ENDOMORPHISMS_NUMBER, generator).image(1);
@@ -54,7 +55,7 @@ int main() {
 //    Vertex reduced = VertexHashAlgorithms::reduce(image, &vertex_hashes, &reduced_vertices);
 
     auto normal_form_start = std::chrono::system_clock::now();
-    Vertex normal_form = crag::slp::recompression::normal_form(image);
+    Vertex normal_form = context.normal_form(image);
     normal_form_duration += std::chrono::system_clock::now() - normal_form_start;
     auto end = std::chrono::system_clock::now();
     std::cout << "Duration: "<< std::chrono::duration_cast<std::chrono::milliseconds>(end - begin).count() << std::endl;
@@ -63,6 +64,10 @@ int main() {
   auto end = std::chrono::system_clock::now();
   std::cout << std::chrono::duration_cast<std::chrono::milliseconds>(end - begin).count()/REPEAT << std::endl;
   std::cout << "Normal form: " << std::chrono::duration_cast<std::chrono::milliseconds>(normal_form_duration).count()/REPEAT << std::endl;
+
+  auto statistics = context.statistics();
+  std::cout << "Rules: " << statistics.rules << ", max " << statistics.max_rules << std::endl;
+  std::cout << "Vertices: " << statistics.vertices << " stored, " << statistics.reused_vertices << " of " << statistics.made_vertices << " reused" << std::endl;
 }
 
 
@@ -1,49 +1,56 @@
 /*
- * profile_matching_new.cpp
+ * profile_reduce.cpp
  *
  *  Created on: Apr 2, 2013
  *      Author: dpantele
  */
 
-#include <memory>
-#include <functional>
-#include <utility>
+#include <iostream>
+#include <iomanip>
 #include <vector>
-#include <tuple>
-#include <algorithm>
 #include <chrono>
 
+#include "parallel.h"
 #include "slp.h"
 #include "EndomorphismSLP.h"
 #include "gmp_boost_pool_allocator.h"
 
-using crag::slp::Vertex;
-using crag::slp::PreorderInspector;
-using crag::slp::TerminalVertex;
-using crag::slp::NonterminalVertex;
-using crag::slp::MatchingTable;
 using crag::UniformAutomorphismSLPGenerator;
 using crag::EndomorphismSLP;
 
+//! Reduces the compositions of random automorphisms with 1, 2, ..., CRAG_NUM_THREADS threads
 int main() {
   gmp_pool_setup();
-  int REPEAT = 50;
-  const size_t RANK = 3;
+  const int REPEAT = 10;
+  const size_t RANK = 6;
   const size_t ENDOMORPHISMS_NUMBER = 100;
-  size_t seed = 112233;
-  UniformAutomorphismSLPGenerator<> generator(RANK, seed);
-  auto begin = std::chrono::system_clock::now();
-  int count = REPEAT;
-  while (--count >= 0) {
-    auto image = EndomorphismSLP::composition(ENDOMORPHISMS_NUMBER, generator).image(1);
-
-    Vertex reduced = reduce(image);
-    auto end = std::chrono::system_clock::now();
-    std::cout << std::chrono::duration_cast<std::chrono::milliseconds>(end - begin).count() << std::endl;
-  }
+  const size_t seed = 112233;
 
-  auto end = std::chrono::system_clock::now();
-  std::cout << std::chrono::duration_cast<std::chrono::milliseconds>(end - begin).count()/REPEAT << std::endl;
-}
+  const auto max_threads_count = crag::parallel::getThreadsCount();
+  EndomorphismSLP::set_reduction_mode(EndomorphismSLP::ReductionMode::Parallel);
+
+  std::cout << "threads,ms,speedup" << std::endl;
+  double single_thread_ms = 0;
+
+  for (size_t threads_count = 1; threads_count <= max_threads_count; ++threads_count) {
+    crag::parallel::setThreadsCount(threads_count);
+    UniformAutomorphismSLPGenerator<> generator(RANK, seed);
 
+    std::chrono::duration<double, std::milli> total(0);
+    for (int i = 0; i < REPEAT; ++i) {
+      auto composition = EndomorphismSLP::composition(ENDOMORPHISMS_NUMBER, generator);
 
+      auto begin = std::chrono::steady_clock::now();
+      auto reduced = composition.free_reduction_precise();
+      total += std::chrono::steady_clock::now() - begin;
+    }
+
+    const double ms = total.count() / REPEAT;
+    if (threads_count == 1) {
+      single_thread_ms = ms;
+    }
+
+    std::cout << threads_count << "," << std::fixed << std::setprecision(2) << ms << ","
+              << single_thread_ms / ms << std::endl;
+  }
+}
@@ -1,5 +1,8 @@
 #include <chrono>
+#include <iomanip>
+#include <iostream>
 
+#include "parallel.h"
 #include "slp.h"
 #include "EndomorphismSLP.h"
 #include "gmp_boost_pool_allocator.h"
@@ -10,6 +13,7 @@ typedef crag::slp::TVertexHashAlgorithms<
 > VertexHashAlgorithms;
 
 
+//! Reduces the composition of random automorphisms with 1, 2, ..., CRAG_NUM_THREADS threads
 int main() {
   gmp_pool_setup();
   CONSTEXPR_OR_CONST size_t RANK = 6;
@@ -17,23 +21,28 @@ int main() {
   size_t seed = 112233;
   crag::UniformAutomorphismSLPGenerator<> generator(RANK, seed);
 
-  typedef crag::slp::TVertexHashAlgorithms<
-      crag::slp::hashers::SinglePowerHash,
-      crag::slp::hashers::PermutationHash<crag::Permutation16>
-  > VertexHashAlgorithms;
+  auto composition = crag::EndomorphismSLP::composition(ENDOMORPHISMS_NUMBER, generator);
 
-  auto slp = crag::EndomorphismSLP::composition(ENDOMORPHISMS_NUMBER, generator).image(1);
+  const auto max_threads_count = crag::parallel::getThreadsCount();
+  crag::EndomorphismSLP::set_reduction_mode(crag::EndomorphismSLP::ReductionMode::Parallel);
 
-  VertexHashAlgorithms::Cache calculated_hashes;
-  std::unordered_map<crag::slp::Vertex, crag::slp::Vertex> reduced_vertices;
+  std::cout << "threads,ms,speedup" << std::endl;
+  double single_thread_ms = 0;
 
-  auto begin = std::chrono::system_clock::now();
-  auto reduced = VertexHashAlgorithms::reduce_narrow_slp(slp, &calculated_hashes, &reduced_vertices);
-  auto end = std::chrono::system_clock::now();
+  for (size_t threads_count = 1; threads_count <= max_threads_count; ++threads_count) {
+    crag::parallel::setThreadsCount(threads_count);
 
-  std::cout << std::chrono::duration_cast<std::chrono::milliseconds>(end - begin).count() << std::endl;
+    auto begin = std::chrono::steady_clock::now();
+    auto reduced = composition.free_reduction<VertexHashAlgorithms>();
+    const std::chrono::duration<double, std::milli> ms = std::chrono::steady_clock::now() - begin;
 
-  return 0;
-}
+    if (threads_count == 1) {
+      single_thread_ms = ms.count();
+    }
 
+    std::cout << threads_count << "," << std::fixed << std::setprecision(2) << ms.count() << ","
+              << single_thread_ms / ms.count() << std::endl;
+  }
 
+  return 0;
+}
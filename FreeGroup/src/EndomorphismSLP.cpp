@@ -6,10 +6,23 @@
 
 #include "EndomorphismSLP.h"
 
+#include <atomic>
 #include <set>
 
 namespace crag {
 
+namespace {
+std::atomic<EndomorphismSLP::ReductionMode> g_reduction_mode(EndomorphismSLP::ReductionMode::Sequential);
+}
+
+void EndomorphismSLP::set_reduction_mode(ReductionMode mode) {
+  g_reduction_mode = mode;
+}
+
+EndomorphismSLP::ReductionMode EndomorphismSLP::reduction_mode() {
+  return g_reduction_mode;
+}
+
 EndomorphismSLP EndomorphismSLP::inverse() const {
   if (images_.size() == 0) //identity
     return *this;
@@ -79,26 +92,28 @@ bool EndomorphismSLP::operator==(const EndomorphismSLP& a) const {
 }
 
 EndomorphismSLP& EndomorphismSLP::operator*=(const EndomorphismSLP& a) {
+  if (a.images_.empty()) {//composition with the identity
+    return *this;
+  }
+  if (images_.empty()) {//the images of #a are mapped to themselves
+    images_ = a.images_;
+    return *this;
+  }
+
   std::unordered_map<slp::Vertex, slp::Vertex> new_vertices;//a's vertices to new vertices correspondence
 
+  auto map_vertex = [this] (const slp::Vertex& vertex, const std::unordered_map<slp::Vertex, slp::Vertex>& images) {
+    return this->map_vertex(vertex, images);
+  };
   for (const auto& root_entry: a.images_) {//mapping vertices of #a to new ones
-    slp::map_vertices(root_entry.second, &new_vertices,
-                      std::bind(&EndomorphismSLP::map_vertex, *this, std::placeholders::_1, std::placeholders::_2));
+    slp::map_vertices(root_entry.second, &new_vertices, map_vertex);
   }
 
-  //replacing roots
-  std::map<TerminalSymbol, slp::Vertex> new_images;
+  //replacing roots, the images not mapped by #a are kept
   for (const auto& root_entry: a.images_) {
-    auto new_root = new_vertices.find(root_entry.second)->second;
-    new_images.insert(std::make_pair(root_entry.first, new_root));
-  }
-  //adding images that were not inserted
-  for (const auto& root_entry: images_) {
-    if (new_images.find(root_entry.first) == new_images.end())//it was not mapped by a
-      new_images.insert(root_entry);
+    images_[root_entry.first] = new_vertices.find(root_entry.second)->second;
   }
 
-  swap(images_, new_images);
   return *this;
 }
 
@@ -433,7 +448,7 @@ void EndomorphismSLP::print(std::ostream *p_out) const {
 namespace internal {
   class Packer {//todo remove class
     public:
-      static slp::Vertex pack_slps_into_one(const std::vector<slp::Vertex>& v) {
+      static slp::Vertex pack_slps_into_one(const std::vector<slp::Vertex>& v, slp::recompression::NormalFormContext* context = nullptr) {
         std::size_t num = v.size();
         assert (num > 0);
         if (num == 1) {
@@ -443,17 +458,21 @@ namespace internal {
         unsigned int packed_num = (num / 2) + (num % 2);
         packed_v.reserve(packed_num);
         for (std::size_t i = 0; i < num - 1; i += 2) {
-          packed_v.push_back(slp::NonterminalVertex(v[i], v[i + 1]));
+          if (context) {
+            packed_v.push_back(context->make_vertex(v[i], v[i + 1]));
+          } else {
+            packed_v.push_back(slp::NonterminalVertex(v[i], v[i + 1]));
+          }
         }
         if (num % 2 == 1) {
           packed_v.push_back(v.back());
         }
-        return pack_slps_into_one(packed_v);
+        return pack_slps_into_one(packed_v, context);
       }
   };
 }
 
-EndomorphismSLP EndomorphismSLP::normal_form() const {
+EndomorphismSLP EndomorphismSLP::normal_form(slp::recompression::NormalFormContext* context) const {
   if (non_trivial_images_num() == 0)
     return EndomorphismSLP();
   //we rewrite all vertices into a single SLP then find normal form
@@ -479,17 +498,26 @@ EndomorphismSLP EndomorphismSLP::normal_form() const {
     vertices.push_back(v);
   });
 
-  slp::Vertex slp = internal::Packer::pack_slps_into_one(vertices);
-  auto nf = slp::recompression::normal_form(slp);
+  slp::Vertex slp = internal::Packer::pack_slps_into_one(vertices, context);
+  auto nf = context ? context->normal_form(slp) : slp::recompression::normal_form(slp);
 
   //extracting slps
+  auto extract = [&nf, &end_positions] (size_t i) {
+    return slp::get_sub_slp(nf, i == 0 ? LongInteger(0) : end_positions[i - 1].second, end_positions[i].second);
+  };
+
+  std::vector<slp::Vertex> sub_slps;
+  if (is_parallel_reduction()) {
+    sub_slps = parallel::map<slp::Vertex>(end_positions.size(), extract);
+  } else {
+    for (size_t i = 0; i < end_positions.size(); ++i) {
+      sub_slps.push_back(extract(i));
+    }
+  }
+
   EndomorphismSLP result;
-  LongInteger begin(0);
-  for (auto key_pos_pair: end_positions) {
-    auto end = key_pos_pair.second;
-    auto sub_slp = slp::get_sub_slp(nf, begin, end);
-    result.images_.insert(std::make_pair(key_pos_pair.first, sub_slp));
-    begin = end;
+  for (size_t i = 0; i < end_positions.size(); ++i) {
+    result.images_.insert(std::make_pair(end_positions[i].first, sub_slps[i]));
   }
 
   return result;
@@ -5,8 +5,12 @@
  *      Author: dpantele
  */
 
+#include <algorithm>
 #include <iostream>
+#include <mutex>
+#include <stdexcept>
 
+#include "parallel.h"
 #include "slp.h"
 
 namespace crag {
@@ -27,7 +31,18 @@ const Vertex::VertexAllocator& NonterminalVertex::get_allocator() {
   return allocator;
 }
 
-Vertex::VertexSignedId NonterminalVertex::last_vertex_id_;
+std::atomic<Vertex::VertexSignedId> NonterminalVertex::last_vertex_id_(0);
+
+std::atomic<size_t> internal::vertex_nodes_count(0);
+
+bool NonterminalVertex::release_vertex_memory() {
+  if (internal::vertex_nodes_count != 0) {
+    return false;
+  }
+
+  internal::VertexPool::purge_memory();
+  return true;
+}
 
 } //namespace slp
 
@@ -225,8 +240,291 @@ FiniteArithmeticSequence PatternMatchesGenerator::next_match() {
   return result;
 }
 
-const FiniteArithmeticSequence& MatchingTable::matches(const Vertex& pattern,
-                                                      const Vertex& text) {
+namespace internal {
+
+namespace {
+//! The cache starts with that many slots and grows up to the size needed for max_size entries
+const size_t MATCHING_CACHE_INITIAL_CAPACITY = 64;
+
+//! The maximal fraction of the used slots is 3/4
+bool is_overloaded(size_t size, size_t capacity) {
+  return 4 * size > 3 * capacity;
+}
+}
+
+size_t MatchingCache::Key::hash() const {
+  //splitmix64 finalizer of the combined ids
+  uint64_t x = static_cast<uint64_t>(pattern) * 0x9e3779b97f4a7c15ULL;
+  x ^= static_cast<uint64_t>(text) + 0x632be59bd9b4e019ULL + (x << 6) + (x >> 2);
+  x ^= terminals;
+  x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+  return static_cast<size_t>(x ^ (x >> 31));
+}
+
+MatchingCache::MatchingCache(size_t max_size)
+  : size_(0)
+  , max_size_(max_size)
+  , clock_hand_(0)
+  , hits_(0)
+  , misses_(0)
+  , evictions_(0) {
+  if (max_size == 0) {
+    throw std::invalid_argument("MatchingCache must be able to keep at least one entry.");
+  }
+}
+
+size_t MatchingCache::position_(const Key& key) const {
+  const size_t mask = slots_.size() - 1;
+  size_t index = key.hash() & mask;
+
+  while (slots_[index].used && !(slots_[index].key == key)) {
+    index = (index + 1) & mask;
+  }
+
+  return index;
+}
+
+bool MatchingCache::find(const Key& key, FiniteArithmeticSequence* value) {
+  if (!slots_.empty()) {
+    auto& slot = slots_[position_(key)];
+
+    if (slot.used) {
+      ++hits_;
+      slot.referenced = true;
+      *value = slot.value;
+      return true;
+    }
+  }
+
+  ++misses_;
+  return false;
+}
+
+bool MatchingCache::contains(const Key& key) const {
+  return !slots_.empty() && slots_[position_(key)].used;
+}
+
+void MatchingCache::insert(const Key& key, FiniteArithmeticSequence value) {
+  if (slots_.empty()) {
+    slots_.resize(MATCHING_CACHE_INITIAL_CAPACITY);
+  }
+
+  if (slots_[position_(key)].used) {
+    return;
+  }
+
+  if (size_ >= max_size_) {
+    evict_();
+  } else if (is_overloaded(size_ + 1, slots_.size())) {
+    grow_();
+  }
+
+  auto& slot = slots_[position_(key)];
+  slot.key = key;
+  slot.used = true;
+  slot.referenced = true;
+  slot.value = std::move(value);
+  ++size_;
+}
+
+void MatchingCache::grow_() {
+  ::std::vector<Slot> old_slots(slots_.size() * 2);
+  old_slots.swap(slots_);
+
+  for (auto& old_slot : old_slots) {
+    if (old_slot.used) {
+      auto& slot = slots_[position_(old_slot.key)];
+      slot.key = old_slot.key;
+      slot.used = true;
+      slot.referenced = old_slot.referenced;
+      slot.value = std::move(old_slot.value);
+    }
+  }
+
+  clock_hand_ = 0;
+}
+
+void MatchingCache::evict_() {
+  const size_t mask = slots_.size() - 1;
+
+  while (true) {
+    auto& slot = slots_[clock_hand_];
+
+    if (slot.used) {
+      if (!slot.referenced) {
+        erase_(clock_hand_);
+        ++evictions_;
+        return;
+      }
+
+      slot.referenced = false;
+    }
+
+    clock_hand_ = (clock_hand_ + 1) & mask;
+  }
+}
+
+void MatchingCache::erase_(size_t index) {
+  const size_t mask = slots_.size() - 1;
+
+  slots_[index].used = false;
+  --size_;
+
+  size_t next = index;
+
+  while (true) {
+    next = (next + 1) & mask;
+
+    if (!slots_[next].used) {
+      return;
+    }
+
+    //the entry may fill the hole only if its home slot is not in the cyclic interval (index, next]
+    const size_t home = slots_[next].key.hash() & mask;
+    const bool home_in_between = (index <= next) ? (index < home && home <= next) : (index < home || home <= next);
+
+    if (!home_in_between) {
+      slots_[index].key = slots_[next].key;
+      slots_[index].used = true;
+      slots_[index].referenced = slots_[next].referenced;
+      slots_[index].value = std::move(slots_[next].value);
+      slots_[next].used = false;
+      index = next;
+    }
+  }
+}
+
+//! Cells of a MatchingTable split into shards, every shard is guarded by a mutex if the table is thread-safe
+class MatchingTableStorage {
+  public:
+    MatchingTableStorage(size_t max_size, size_t shards_count, bool thread_safe)
+      : thread_safe_(thread_safe) {
+      if (max_size == 0) {
+        throw std::invalid_argument("MatchingTable must be able to keep at least one cell.");
+      }
+
+      const size_t shard_max_size = std::max<size_t>(1, (max_size + shards_count - 1) / shards_count);
+
+      for (size_t i = 0; i < shards_count; ++i) {
+        shards_.emplace_back(new Shard(shard_max_size));
+      }
+    }
+
+    MatchingTableStorage(const MatchingTableStorage& other)
+      : thread_safe_(other.thread_safe_) {
+      for (const auto& other_shard : other.shards_) {
+        auto lock = other.lock_(*other_shard);
+        shards_.emplace_back(new Shard(other_shard->cache));
+      }
+    }
+
+    bool find(const MatchingCache::Key& key, FiniteArithmeticSequence* value) {
+      auto& shard = shard_(key);
+      auto lock = lock_(shard);
+      return shard.cache.find(key, value);
+    }
+
+    bool contains(const MatchingCache::Key& key) const {
+      auto& shard = shard_(key);
+      auto lock = lock_(shard);
+      return shard.cache.contains(key);
+    }
+
+    void insert(const MatchingCache::Key& key, FiniteArithmeticSequence value) {
+      auto& shard = shard_(key);
+      auto lock = lock_(shard);
+      shard.cache.insert(key, std::move(value));
+    }
+
+    MatchingTable::Statistics statistics() const {
+      MatchingTable::Statistics result;
+
+      for (const auto& shard : shards_) {
+        auto lock = lock_(*shard);
+        result.hits += shard->cache.hits();
+        result.misses += shard->cache.misses();
+        result.evictions += shard->cache.evictions();
+        result.size += shard->cache.size();
+      }
+
+      return result;
+    }
+
+    void reset_statistics() {
+      for (const auto& shard : shards_) {
+        auto lock = lock_(*shard);
+        shard->cache.reset_statistics();
+      }
+    }
+
+  private:
+    struct Shard {
+      explicit Shard(size_t max_size)
+        : cache(max_size)
+      { }
+
+      explicit Shard(const MatchingCache& other_cache)
+        : cache(other_cache)
+      { }
+
+      std::mutex mutex;
+      MatchingCache cache;
+    };
+
+    Shard& shard_(const MatchingCache::Key& key) const {
+      //the high bits of the hash, the low ones choose the slot inside the shard
+      return *shards_[(key.hash() >> 48) % shards_.size()];
+    }
+
+    std::unique_lock<std::mutex> lock_(Shard& shard) const {
+      return thread_safe_ ? std::unique_lock<std::mutex>(shard.mutex) : std::unique_lock<std::mutex>();
+    }
+
+    bool thread_safe_;
+    std::vector<std::unique_ptr<Shard>> shards_;
+};
+
+} //namespace internal
+
+MatchingTable::MatchingTable(size_t max_size)
+  : storage_(std::make_shared<internal::MatchingTableStorage>(max_size, 1, false))
+{ }
+
+MatchingTable MatchingTable::concurrent(size_t max_size, size_t shards_count) {
+  if (shards_count == 0) {
+    shards_count = 4 * parallel::getHardwareConcurrency();
+  }
+
+  return MatchingTable(std::make_shared<internal::MatchingTableStorage>(max_size, shards_count, true));
+}
+
+MatchingTable MatchingTable::clone() const {
+  return MatchingTable(std::make_shared<internal::MatchingTableStorage>(*storage_));
+}
+
+size_t MatchingTable::size() const {
+  return storage_->statistics().size;
+}
+
+MatchingTable::Statistics MatchingTable::statistics() const {
+  return storage_->statistics();
+}
+
+void MatchingTable::reset_statistics() {
+  storage_->reset_statistics();
+}
+
+bool MatchingTable::is_stored(const Vertex& pattern, const Vertex& text) const {
+  return storage_->contains(internal::MatchingCache::Key(pattern, text));
+}
+
+void MatchingTable::store(const Vertex& pattern, const Vertex& text, FiniteArithmeticSequence result) {
+  storage_->insert(internal::MatchingCache::Key(pattern, text), std::move(result));
+}
+
+FiniteArithmeticSequence MatchingTable::matches(const Vertex& pattern,
+                                               const Vertex& text) {
   if (pattern.length() == 0) {
     return FiniteArithmeticSequence::NullSequence();
   }
@@ -240,12 +538,11 @@ const FiniteArithmeticSequence& MatchingTable::matches(const Vertex& pattern,
     return trivial;
   }
 
-  auto match_result_iterator = match_table_->find(std::make_pair(pattern, text));
+  FiniteArithmeticSequence match_result;
 
-  if (match_result_iterator != match_table_->end()) { //if already calculated
-    return match_result_iterator->second;
+  if (storage_->find(internal::MatchingCache::Key(pattern, text), &match_result)) { //if already calculated
+    return match_result;
   }
-  FiniteArithmeticSequence match_result;
 
   if (pattern.length() == 1) {//Trivial case
     Vertex pattern_vertex = pattern;
@@ -300,10 +597,10 @@ const FiniteArithmeticSequence& MatchingTable::matches(const Vertex& pattern,
   }
 
   FiniteArithmeticSequence inversed_result = FiniteArithmeticSequence(match_result).shift_right(text.length() - pattern.length() - match_result.last() - match_result.first());
-  match_table_->insert(std::make_pair(std::make_pair(pattern.negate(), text.negate()), std::move(inversed_result)));
-  auto inserted_element = match_table_->insert(std::make_pair(std::make_pair(pattern, text), std::move(match_result)));
+  storage_->insert(internal::MatchingCache::Key(pattern.negate(), text.negate()), std::move(inversed_result));
+  storage_->insert(internal::MatchingCache::Key(pattern, text), match_result);
 
-  return inserted_element.first->second;
+  return match_result;
 }
 
 namespace internal {
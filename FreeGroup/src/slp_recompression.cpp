@@ -1,4 +1,5 @@
 #include "slp_recompression.h"
+#include <algorithm>
 #include <iterator>
 
 namespace crag {
@@ -279,8 +280,9 @@ void Rule::insert_popped_letter_left(
   //assert(!begin()->is_empty_nonterminal());
 }
 
-JezRules::JezRules(const Vertex& slp)
+JezRules::JezRules(const Vertex& slp, NormalFormContext* context)
   : fresh_terminal_id_(0)
+  , context_(context)
 {
   auto acceptor = [this] (const inspector::InspectorTask& task) {
     return this->vertex_rules_.count(task.vertex) == 0;
@@ -436,7 +438,7 @@ void JezRules::compress_blocks(const std::vector<LetterPosition>& blocks) {
           if ((terminal_power.first & 1) != 0) {
             if (*terminal_power.second != last_vertex) {
               last_vertex = *terminal_power.second;
-              last_power = NonterminalVertex(last_vertex, current_terminal_vertex);
+              last_power = make_vertex(last_vertex, current_terminal_vertex);
             }
             *terminal_power.second = last_power;
           }
@@ -447,7 +449,7 @@ void JezRules::compress_blocks(const std::vector<LetterPosition>& blocks) {
             continue_iterations = true;
           }
         }
-        current_terminal_vertex = NonterminalVertex(
+        current_terminal_vertex = make_vertex(
           current_terminal_vertex,
           current_terminal_vertex
         );
@@ -792,7 +794,7 @@ void OneStepPairs::compress_pairs_from_letter_lists(
           if (terminal) {
             rules_->terminal_vertices_.insert(std::make_pair(
                 terminal,
-                NonterminalVertex(
+                rules_->make_vertex(
                     rules_->terminal_vertices_[pair.id_],
                     rules_->terminal_vertices_[right_letter->id_]
                 )
@@ -820,6 +822,13 @@ void OneStepPairs::compress_pairs_from_letter_lists(
   }
 }
 
+Vertex JezRules::make_vertex(const Vertex& left, const Vertex& right) {
+  if (context_) {
+    return context_->make_vertex(left, right);
+  }
+  return NonterminalVertex(left, right);
+}
+
 Vertex JezRules::get_exponent(Vertex vertex, LetterPower power) {
   Vertex result;
 
@@ -828,12 +837,12 @@ Vertex JezRules::get_exponent(Vertex vertex, LetterPower power) {
   while (power != 0) {
     if ((power & 1) != 0) {
       if (result) {
-        result = NonterminalVertex(result, vertex);
+        result = make_vertex(result, vertex);
       } else {
         result = vertex;
       }
     }
-    vertex = NonterminalVertex(vertex, vertex);
+    vertex = make_vertex(vertex, vertex);
     power >>= 1;
   }
 
@@ -882,10 +891,22 @@ void JezRules::debug_print(std::ostream* os) const {
 //#define DEBUG_OUTPUT
 
 Vertex normal_form(Vertex root) {
+  return normal_form(std::move(root), nullptr);
+}
+
+Vertex normal_form(Vertex root, NormalFormContext* context) {
   if (root.height() < 2) {
     return root;
   }
-  JezRules rules(root);
+  NormalFormContext::Statistics* statistics = context ? &context->statistics_ : nullptr;
+
+  JezRules rules(root, context);
+
+  if (statistics) {
+    statistics->rules += rules.rules_.size();
+    statistics->max_rules = std::max(statistics->max_rules, rules.rules_.size());
+  }
+
   Rule& root_rule = *(rules.vertex_rules_[root]);
 
   while (root_rule.size() > 1 || (
@@ -978,6 +999,66 @@ Vertex normal_form(Vertex root) {
   return result;
 }
 
+Vertex NormalFormContext::normal_form(const Vertex& root) {
+  if (root.height() < 2) {
+    return root;
+  }
+
+  ++statistics_.calls;
+
+  auto stored = normal_forms_.find(root);
+  if (stored != normal_forms_.end()) {
+    ++statistics_.hits;
+    return stored->second;
+  }
+
+  auto result = recompression::normal_form(root, this);
+
+  if (size() + 2 > max_size_) {
+    clear();
+    ++statistics_.clears;
+  }
+
+  normal_forms_.insert(std::make_pair(root, result));
+  normal_forms_.insert(std::make_pair(result, result));
+  return result;
+}
+
+Vertex NormalFormContext::make_vertex(const Vertex& left, const Vertex& right) {
+  ++statistics_.made_vertices;
+
+  auto stored = vertices_.find(std::make_pair(left, right));
+  if (stored != vertices_.end()) {
+    ++statistics_.reused_vertices;
+    return stored->second;
+  }
+
+  if (size() + 1 > max_size_) {
+    clear();
+    ++statistics_.clears;
+  }
+
+  Vertex vertex = NonterminalVertex(left, right);
+  vertices_.insert(std::make_pair(std::make_pair(left, right), vertex));
+  return vertex;
+}
+
+NormalFormContext::Statistics NormalFormContext::statistics() const {
+  auto result = statistics_;
+  result.normal_forms = normal_forms_.size();
+  result.vertices = vertices_.size();
+  return result;
+}
+
+void NormalFormContext::reset_statistics() {
+  statistics_ = Statistics();
+}
+
+void NormalFormContext::clear() {
+  normal_forms_.clear();
+  vertices_.clear();
+}
+
 }
 }
 }
@@ -7,6 +7,7 @@
 
 #include "gtest/gtest.h"
 #include "EndomorphismSLP.h"
+#include "parallel.h"
 
 namespace crag {
 
@@ -866,6 +867,58 @@ TEST_F(EndomorphismSLPTest, RemoveDuplicatesTest) {
   }
 }
 
+TEST_F(EndomorphismSLPTest, ParallelReductionTest) {
+  const auto threads_count = parallel::getThreadsCount();
+  parallel::setThreadsCount(4);
+
+  for (auto rank : {3, 6}) {
+    UniformAutomorphismSLPGenerator<> rnd(rank);
+    for (int i = 0; i < 3; ++i) {
+      auto description = AutomorphismDescription<>(60, rnd);
+      auto e = description();
+
+      auto fr = e.free_reduction();
+      auto fr_precise = e.free_reduction_precise();
+      auto rd = fr.remove_duplicate_vertices();
+      auto nf = rd.normal_form();
+      auto reduced_description = AutomorphismReducer::reduce(description);
+
+      EMorphism::set_reduction_mode(EMorphism::ReductionMode::Parallel);
+      auto parallel_fr = e.free_reduction();
+      auto parallel_fr_precise = e.free_reduction_precise();
+      auto parallel_rd = parallel_fr.remove_duplicate_vertices();
+      auto parallel_nf = parallel_rd.normal_form();
+      auto parallel_reduced_description = AutomorphismReducer::reduce(description);
+      EMorphism::set_reduction_mode(EMorphism::ReductionMode::Sequential);
+
+      EXPECT_EQ(fr, parallel_fr);
+      EXPECT_EQ(fr_precise, parallel_fr_precise);
+      EXPECT_EQ(rd, parallel_rd);
+      EXPECT_EQ(nf, parallel_nf);
+      EXPECT_EQ(slp_vertices_num(fr_precise), slp_vertices_num(parallel_fr_precise));
+      EXPECT_EQ(slp_vertices_num(rd), slp_vertices_num(parallel_rd));
+      EXPECT_EQ(reduced_description(), parallel_reduced_description());
+      EXPECT_EQ(reduced_description.inverse(), parallel_reduced_description.inverse());
+    }
+  }
+
+  parallel::setThreadsCount(threads_count);
+}
+
+TEST_F(EndomorphismSLPTest, CompositionWithIdentityTest) {
+  UniformAutomorphismSLPGenerator<> rnd(4);
+  auto e = EMorphism::composition(20, rnd);
+
+  auto left = EMorphism::identity() * e;
+  auto right = e * EMorphism::identity();
+  EXPECT_EQ(e, left);
+  EXPECT_EQ(e, right);
+  for (auto symbol : {1, 2, 3, 4}) {
+    EXPECT_EQ(e.image(symbol), left.image(symbol));
+    EXPECT_EQ(e.image(symbol), right.image(symbol));
+  }
+}
+
 
 
 } /* namespace crag */
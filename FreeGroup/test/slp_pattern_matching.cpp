@@ -13,6 +13,7 @@
 #include <algorithm>
 
 #include "gtest/gtest.h"
+#include "parallel.h"
 #include "slp_inspector.h"
 #include "slp_pattern_matching.h"
 #include "slp_vertex_word.h"
@@ -121,7 +122,7 @@ class FilledMatchingTable : public MatchingTable {
           FiniteArithmeticSequence result;
 
           if (pattern_inspector.vertex().length() <= text_inspector.vertex().length() &&
-              match_table_->find(::std::make_pair(pattern_inspector.vertex(), text_inspector.vertex())) == match_table_->end()) {
+              !is_stored(pattern_inspector.vertex(), text_inspector.vertex())) {
             VertexWord current_pattern_word(pattern_inspector.vertex());
             std::string current_pattern(current_pattern_word.begin(), current_pattern_word.end());
             size_t current_match = text_inspector.vertex().split_point().get_ui() -
@@ -155,7 +156,7 @@ class FilledMatchingTable : public MatchingTable {
               result = FiniteArithmeticSequence(first_match, step, count);
             }
           }
-          this->match_table_->insert(::std::make_pair(::std::make_pair(pattern_inspector.vertex(), text_inspector.vertex()), result));
+          store(pattern_inspector.vertex(), text_inspector.vertex(), result);
           pattern_inspector.next();
         }
         text_inspector.next();
@@ -608,6 +609,104 @@ TEST(SLPMatchingTable, StressTest) {
   }
 }
 
+
+//! Pairs of vertices of the slp, all of them are looked up in the tables below
+::std::vector<::std::pair<Vertex, Vertex>> get_vertex_pairs(const Vertex& slp) {
+  ::std::vector<::std::pair<Vertex, Vertex>> pairs;
+
+  PostorderInspector text(slp);
+  while (!text.stopped()) {
+    PostorderInspector pattern(slp);
+    while (!pattern.stopped()) {
+      pairs.emplace_back(pattern.vertex(), text.vertex());
+      pattern.next();
+    }
+    text.next();
+  }
+
+  return pairs;
+}
+
+TEST(SLPMatchingTable, BoundedSize) {
+  const unsigned int WORD_SIZE = 20;
+  int repeat = 20;
+
+  srand(time(NULL));
+
+  while (--repeat >= 0) {
+    Vertex slp = get_random_slp_on_2_letters(WORD_SIZE);
+
+    MatchingTable real_matching_table;
+    MatchingTable small_matching_table(16);
+
+    for (const auto& pair : get_vertex_pairs(slp)) {
+      ASSERT_EQ(real_matching_table.matches(pair.first, pair.second), small_matching_table.matches(pair.first, pair.second));
+      ASSERT_LE(small_matching_table.size(), 16u);
+    }
+  }
+
+  EXPECT_THROW(MatchingTable(0), std::invalid_argument);
+}
+
+TEST(SLPMatchingTable, Statistics) {
+  TerminalVertex a('a');
+  TerminalVertex b('b');
+
+  NonterminalVertex ba(b, a);
+  NonterminalVertex bab(ba, b);
+  NonterminalVertex baba(bab, a);
+
+  MatchingTable table;
+  EXPECT_EQ(FiniteArithmeticSequence(2, 1, 1), table.matches(ba, baba));
+
+  const auto statistics = table.statistics();
+  EXPECT_LT(0u, statistics.misses);
+  EXPECT_EQ(0u, statistics.evictions);
+  EXPECT_EQ(table.size(), statistics.size);
+
+  // copies share the cells
+  auto copy = table;
+  EXPECT_EQ(FiniteArithmeticSequence(2, 1, 1), copy.matches(ba, baba));
+  EXPECT_EQ(statistics.hits + 1, table.statistics().hits);
+  EXPECT_EQ(statistics.misses, table.statistics().misses);
+
+  auto clone = table.clone();
+  table.reset_statistics();
+  EXPECT_EQ(0u, table.statistics().hits);
+  EXPECT_EQ(0u, table.statistics().misses);
+  EXPECT_EQ(statistics.hits + 1, clone.statistics().hits);
+  EXPECT_EQ(table.size(), clone.size());
+}
+
+TEST(SLPMatchingTable, Concurrent) {
+  const unsigned int WORD_SIZE = 20;
+  int repeat = 20;
+
+  srand(time(NULL));
+
+  while (--repeat >= 0) {
+    Vertex slp = get_random_slp_on_2_letters(WORD_SIZE);
+    const auto pairs = get_vertex_pairs(slp);
+
+    MatchingTable real_matching_table;
+    std::vector<FiniteArithmeticSequence> expected;
+    for (const auto& pair : pairs) {
+      expected.push_back(real_matching_table.matches(pair.first, pair.second));
+    }
+
+    // small enough to evict while other threads are reading
+    auto shared_table = MatchingTable::concurrent(256, 4);
+    std::vector<FiniteArithmeticSequence> results(pairs.size());
+    parallel::forEach(pairs.size(), [&](size_t i) {
+      results[i] = shared_table.matches(pairs[i].first, pairs[i].second);
+    });
+
+    for (size_t i = 0; i < pairs.size(); ++i) {
+      ASSERT_EQ(expected[i], results[i]);
+    }
+  }
+}
+
 }
 }
 }
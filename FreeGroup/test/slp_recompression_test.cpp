@@ -1213,6 +1213,99 @@ TEST(Recompression, StressEndomorphismNormal) {
 }
 
 
+TEST(Recompression, NormalFormContext) {
+  const unsigned int WORD_SIZE = 100;
+  const unsigned int ALPHABET_SIZE = 3;
+  int REPEAT = 30;
+
+  srand(1717);
+  NormalFormContext context;
+
+  while (--REPEAT >= 0) {
+    Vertex slp = get_random_slp_on_n_letters(WORD_SIZE, ALPHABET_SIZE);
+    Vertex normal_slp = context.normal_form(slp);
+
+    ASSERT_TRUE(is_normal_form(slp, normal_slp));
+    EXPECT_EQ(normal_slp, context.normal_form(slp));
+    EXPECT_EQ(normal_slp, context.normal_form(normal_slp));
+  }
+
+  auto statistics = context.statistics();
+  EXPECT_EQ(90u, statistics.calls);
+  EXPECT_EQ(60u, statistics.hits);
+  EXPECT_EQ(0u, statistics.clears);
+  EXPECT_LT(0u, statistics.rules);
+  EXPECT_LE(statistics.max_rules, statistics.rules);
+  EXPECT_LT(0u, statistics.reused_vertices);
+  EXPECT_EQ(statistics.made_vertices - statistics.reused_vertices, statistics.vertices);
+  EXPECT_LE(statistics.normal_forms, 60u);
+
+  context.reset_statistics();
+  EXPECT_EQ(0u, context.statistics().calls);
+  EXPECT_EQ(statistics.normal_forms, context.statistics().normal_forms);
+
+  context.clear();
+  EXPECT_EQ(0u, context.size());
+}
+
+TEST(Recompression, NormalFormContextMaxSize) {
+  srand(1717);
+  NormalFormContext context(50);
+
+  for (int i = 0; i < 20; ++i) {
+    Vertex slp = get_random_slp_on_n_letters(100, 3);
+    ASSERT_TRUE(is_normal_form(slp, context.normal_form(slp)));
+    EXPECT_GE(50u, context.size());
+  }
+
+  EXPECT_LT(0u, context.statistics().clears);
+}
+
+TEST(Recompression, EndomorphismNormalFormContext) {
+  UniformAutomorphismSLPGenerator<> generator(4, 112233);
+  NormalFormContext context;
+
+  for (int i = 0; i < 10; ++i) {
+    auto e = EndomorphismSLP::composition(20, generator);
+    auto normal_form = e.normal_form(&context);
+
+    EXPECT_EQ(e, normal_form);
+    EXPECT_EQ(e.normal_form(), normal_form);
+
+    auto hits = context.statistics().hits;
+    EXPECT_EQ(normal_form, e.normal_form(&context));
+    EXPECT_EQ(hits + 1, context.statistics().hits);
+  }
+}
+
+TEST(Recompression, AutomorphismReducerContext) {
+  UniformAutomorphismSLPGenerator<> generator(3, 445566);
+  NormalFormContext context;
+
+  AutomorphismDescription<> product, product_with_context;
+  for (int i = 0; i < 6; ++i) {
+    const AutomorphismDescription<> part(4, generator);
+    product = AutomorphismReducer::reduce(product * part);
+    product_with_context = AutomorphismReducer::reduce(product_with_context * part, false, &context);
+
+    EXPECT_EQ(product(), product_with_context());
+    EXPECT_EQ(product.inverse(), product_with_context.inverse());
+  }
+
+  EXPECT_EQ(12u, context.statistics().calls);
+  EXPECT_LT(0u, context.statistics().reused_vertices);
+
+  const CommutatorSet<AutomorphismDescription<>> commutators(product, AutomorphismDescription<>(4, generator));
+  const auto reduced = commutators.reduce();
+  const auto reduced_with_context = commutators.reduce(&context);
+  for (bool first_inversed : {false, true}) {
+    for (bool second_inversed : {false, true}) {
+      EXPECT_EQ(reduced.get(first_inversed, second_inversed)(),
+                reduced_with_context.get(first_inversed, second_inversed)());
+    }
+  }
+}
+
 
 } //namespace
 }
@@ -8,6 +8,7 @@
 #include <memory>
 #include <functional>
 #include <utility>
+#include <vector>
 
 #include "gtest/gtest.h"
 #include "slp_vertex.h"
@@ -108,6 +109,62 @@ TEST_F(VertexTest, NonterminalVertex) {
   EXPECT_NE(hash(ab_1), hash(Vertex()));
 }
 
+TEST_F(VertexTest, LongLength) {
+  Vertex power = a;
+  LongInteger length = 1;
+
+  for (int i = 1; i < 70; ++i) {
+    power = NonterminalVertex(power, power.negate());
+    length *= 2;
+
+    EXPECT_EQ(length, power.length());
+    EXPECT_EQ(length, power.negate().length());
+    EXPECT_EQ(length / 2, power.split_point());
+    EXPECT_EQ(i + 1, power.height());
+
+    if (i < 64) {
+      EXPECT_EQ(length.get_ui(), power.short_length());
+    } else {
+      EXPECT_EQ(0, power.short_length());
+    }
+  }
+
+  auto longer = NonterminalVertex(power, NonterminalVertex(b, c));
+  EXPECT_EQ(length + 2, longer.length());
+  EXPECT_EQ(0, longer.short_length());
+  EXPECT_EQ(power, longer.left_child());
+
+  //2^64 - 1 is the longest inline length
+  std::vector<Vertex> powers = {a};
+  Vertex all_ones = a;
+  for (int i = 1; i < 64; ++i) {
+    powers.push_back(NonterminalVertex(powers.back(), powers.back()));
+    all_ones = NonterminalVertex(all_ones, powers.back());
+  }
+
+  EXPECT_EQ(UINT64_MAX, all_ones.short_length());
+  auto overflow = NonterminalVertex(all_ones, c);
+  EXPECT_EQ(0, overflow.short_length());
+  EXPECT_EQ(LongInteger(all_ones.length()) + 1, overflow.length());
+  EXPECT_EQ(length / 64 * 2, overflow.length());
+}
+
+TEST_F(VertexTest, ReleaseVertexMemory) {
+  {
+    auto ab = NonterminalVertex(a, b);
+    auto abab = NonterminalVertex(ab, ab);
+
+    EXPECT_FALSE(NonterminalVertex::release_vertex_memory());
+    EXPECT_EQ(4, abab.length());
+  }
+
+  EXPECT_TRUE(NonterminalVertex::release_vertex_memory());
+
+  auto ab = NonterminalVertex(a, b);
+  EXPECT_EQ(a, ab.left_child());
+  EXPECT_EQ(2, ab.length());
+}
+
 //Tests for hash<std::pair>
 TEST(HashPair, HashPair) {
   std::hash<std::pair<int, int> > hash;
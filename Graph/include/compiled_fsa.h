@@ -0,0 +1,116 @@
+#pragma once
+
+#ifndef CRAG_COMPILED_FSA_H
+#define CRAG_COMPILED_FSA_H
+
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <boost/container/vector.hpp>
+
+#include "FSA.h"
+#include "Word.h"
+
+namespace crag {
+namespace fsa {
+
+//! A frozen minimal deterministic automaton with a dense transition table.
+/*!
+  The labels of the automaton form its alphabet, the transition by the letter number i from the state s is
+  transitions[s * alphabetSize() + i]. Missing transitions lead to the implicit dead state, which is not stored.
+  The state 0 is the initial one.
+
+  The automaton is stored in one flat buffer which has the layout of the file written by save(), so load() maps
+  the file into memory instead of reading it. Copies share the buffer.
+ */
+class CompiledFSA {
+public:
+  using State = uint32_t;
+
+  //! Marks a missing transition
+  static constexpr State NO_STATE = std::numeric_limits<State>::max();
+
+  //! Builds the minimal deterministic automaton accepting the language of fsa: the subset construction is
+  //! followed by the minimization of Hopcroft. Every label is a letter, there are no empty transitions.
+  //! Throws std::length_error if the automaton has too many states or the labels range too wide.
+  explicit CompiledFSA(const FSA& fsa);
+
+  //! Maps the file written by save(). Throws std::runtime_error if it is not a valid automaton file.
+  static CompiledFSA load(const std::string& path);
+
+  //! Writes the buffer to the file. Throws std::runtime_error if the file can't be written.
+  void save(const std::string& path) const;
+
+  size_t size() const;
+
+  //! The labels in increasing order
+  std::vector<int> alphabet() const;
+
+  bool isTerminal(State s) const {
+    return terminal_[s] != 0;
+  }
+
+  //! The target of the transition by the label or NO_STATE
+  State target(State s, int label) const {
+    const auto letter = letterIndex_(label);
+    return letter == NO_LETTER ? NO_STATE : transitions_[s * alphabet_size_ + letter];
+  }
+
+  bool accepts(const Word& w) const;
+
+  //! Checks the words in parallel. Every thread advances a group of words in an interleaved fashion, so the loads of
+  //! their transitions overlap.
+  boost::container::vector<bool> acceptsAll(const std::vector<Word>& words) const;
+
+  //! Returns the automaton as an FSA with the states 0, ..., size() - 1
+  FSA toFSA() const;
+
+private:
+  static constexpr uint32_t NO_LETTER = std::numeric_limits<uint32_t>::max();
+
+  //! The beginning of the buffer
+  struct Header {
+    char magic[8];
+    uint32_t version;
+    uint32_t states_count;
+    uint32_t alphabet_size;
+    int32_t min_label;
+    uint32_t labels_range;
+    uint32_t reserved;
+  };
+
+  CompiledFSA() = default;
+
+  //! Sets the pointers into the buffer and checks its header and size.
+  //! Throws std::runtime_error if the buffer is not a valid automaton.
+  void attach_(std::shared_ptr<const void> holder, const char* data, size_t size);
+
+  uint32_t letterIndex_(int label) const {
+    const auto offset = static_cast<int64_t>(label) - min_label_;
+    return (offset < 0) || (offset >= labels_range_) ? NO_LETTER : letter_indices_[offset];
+  }
+
+  //! keeps the buffer alive, it is a vector or a mapped file
+  std::shared_ptr<const void> holder_;
+  const char* data_ = nullptr;
+  size_t data_size_ = 0;
+
+  size_t states_count_ = 0;
+  size_t alphabet_size_ = 0;
+  int64_t min_label_ = 0;
+  int64_t labels_range_ = 0;
+
+  //! the labels, the letter indices of the labels min_label, min_label + 1, ..., the transitions, the terminal flags
+  const int32_t* alphabet_ = nullptr;
+  const uint32_t* letter_indices_ = nullptr;
+  const State* transitions_ = nullptr;
+  const uint8_t* terminal_ = nullptr;
+};
+
+} // namespace fsa
+} // namespace crag
+
+#endif // CRAG_COMPILED_FSA_H
@@ -72,6 +72,11 @@ FSA FSA::operator * ( const FSA& F ) const
 	if( init.first.empty( ) || init.second.empty( ) )
 		return result;
 	result.makeInitial( S[init] = result.newState( ) );
+	list< int > initTerminal1, initTerminal2;
+	set_intersection( T1.begin( ) , T1.end( ) , init.first.begin( ) , init.first.end( ) , back_inserter( initTerminal1 ) );
+	set_intersection( T2.begin( ) , T2.end( ) , init.second.begin( ) , init.second.end( ) , back_inserter( initTerminal2 ) );
+	if( !initTerminal1.empty( ) && !initTerminal2.empty( ) )
+		result.makeTerminal( S[init] );
 	toCheck.push_back( init );
 	
 	while( !toCheck.empty( ) ) {
@@ -114,10 +119,10 @@ FSA FSA::operator * ( const FSA& F ) const
 				toCheck.push_back( node );
 
 				list< int > intersection1;
-				set_intersection( T1.begin( ) , T1.end( ) , node.first.begin( ) , node.first.end( ) , intersection1.begin( ) );
+				set_intersection( T1.begin( ) , T1.end( ) , node.first.begin( ) , node.first.end( ) , back_inserter( intersection1 ) );
 				if( !intersection1.empty( ) ) {
 					list< int > intersection2;
-					set_intersection( T2.begin( ) , T2.end( ) , node.second.begin( ) , node.second.end( ) , intersection2.begin( ) );
+					set_intersection( T2.begin( ) , T2.end( ) , node.second.begin( ) , node.second.end( ) , back_inserter( intersection2 ) );
 					if( !intersection2.empty( ) )
 						result.makeTerminal( (*node_it).second );
 				}
@@ -147,6 +152,8 @@ bool FSA::isDeterministic( ) const
 	for( ; s_it!=theStates.end() ; ++s_it ) {
 		const FSAState& s = (*s_it).second;
 		const set< FSAEdge >& out = s.out;
+		if( out.empty( ) )
+			continue;
 		set< FSAEdge >::const_iterator out_it1 = out.begin( ), out_it2 = out.begin( );
 		for( ++out_it2 ; out_it2!=out.end( ) ; ++out_it1, ++out_it2 )
 			if( (*out_it1).label==(*out_it2).label )
@@ -178,6 +185,10 @@ FSA FSA::deterministic( ) const
 	// the initial vertex
 	NODE init( I1 );
 	result.makeInitial( S[init] = result.newState( ) );
+	list< int > initTerminal;
+	set_intersection( T1.begin( ) , T1.end( ) , init.begin( ) , init.end( ) , back_inserter( initTerminal ) );
+	if( !initTerminal.empty( ) )
+		result.makeTerminal( S[init] );
 	toCheck.push_back( init );
 	
 	while( !toCheck.empty( ) ) {
@@ -215,7 +226,7 @@ FSA FSA::deterministic( ) const
 				// cout << endl;
 
 				list< int > intersection1;
-				set_intersection( T1.begin( ) , T1.end( ) , node.begin( ) , node.end( ) , intersection1.begin( ) );
+				set_intersection( T1.begin( ) , T1.end( ) , node.begin( ) , node.end( ) , back_inserter( intersection1 ) );
 				if( !intersection1.empty( ) )
 					result.makeTerminal( (*node_it).second );
 			}
@@ -0,0 +1,517 @@
+#include "compiled_fsa.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <unordered_map>
+
+#include <boost/functional/hash.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+#include "parallel.h"
+
+namespace crag {
+namespace fsa {
+
+namespace {
+
+using State = CompiledFSA::State;
+constexpr State NO_STATE = CompiledFSA::NO_STATE;
+
+constexpr char MAGIC[8] = {'C', 'R', 'A', 'G', 'D', 'F', 'A', '\0'};
+constexpr uint32_t VERSION = 1;
+
+//! The labels of an automaton are expected to be small numbers, like letters of words
+constexpr int64_t MAX_LABELS_RANGE = int64_t(1) << 24;
+
+//! The number of words advanced together by a thread of acceptsAll
+constexpr size_t GROUP_SIZE = 8;
+
+//! A deterministic automaton with the initial state 0, the transitions of the state s are
+//! transitions[s * alphabet_size, (s + 1) * alphabet_size)
+struct Dfa {
+  std::vector<State> transitions;
+  std::vector<uint8_t> terminal;
+};
+
+//! The automaton with no words
+Dfa emptyDfa(size_t alphabet_size) {
+  return {std::vector<State>(alphabet_size, NO_STATE), {0}};
+}
+
+State checkedState(size_t s) {
+  if (s >= NO_STATE) {
+    throw std::length_error("Too many states in the automaton.");
+  }
+
+  return static_cast<State>(s);
+}
+
+//! The subset construction
+Dfa determinize(const FSA& fsa, const std::vector<int>& alphabet) {
+  const auto& states = fsa.getStates();
+  const auto alphabet_size = alphabet.size();
+
+  // the states are numbered densely, and their edges are stored in one array sorted by the letters
+  std::unordered_map<int, State> numbers;
+  for (const auto& state : states) {
+    numbers.emplace(state.first, checkedState(numbers.size()));
+  }
+
+  std::vector<size_t> offsets = {0};
+  std::vector<std::pair<uint32_t, State>> edges;
+  std::vector<uint8_t> terminal(numbers.size(), 0);
+  for (const auto& state : states) {
+    for (const auto& edge : state.second.out) {
+      const auto letter = std::lower_bound(alphabet.begin(), alphabet.end(), edge.label) - alphabet.begin();
+      edges.emplace_back(static_cast<uint32_t>(letter), numbers.at(edge.target));
+    }
+    offsets.push_back(edges.size());
+  }
+  for (const auto s : fsa.getTermStates()) {
+    const auto number = numbers.find(s);
+    if (number != numbers.end()) {
+      terminal[number->second] = 1;
+    }
+  }
+
+  std::vector<State> initial;
+  for (const auto s : fsa.getInitStates()) {
+    const auto number = numbers.find(s);
+    if (number != numbers.end()) {
+      initial.push_back(number->second);
+    }
+  }
+  std::sort(initial.begin(), initial.end());
+
+  if (initial.empty()) {
+    return emptyDfa(alphabet_size);
+  }
+
+  Dfa result;
+  std::vector<std::vector<State>> subsets = {initial};
+  std::unordered_map<std::vector<State>, State, boost::hash<std::vector<State>>> subset_numbers = {{initial, 0}};
+  std::vector<std::vector<State>> targets(alphabet_size);
+  std::vector<uint32_t> letters;
+
+  for (size_t k = 0; k < subsets.size(); ++k) {
+    letters.clear();
+    uint8_t is_terminal = 0;
+
+    for (const auto s : subsets[k]) {
+      is_terminal |= terminal[s];
+      for (auto i = offsets[s]; i < offsets[s + 1]; ++i) {
+        const auto& edge = edges[i];
+        if (targets[edge.first].empty()) {
+          letters.push_back(edge.first);
+        }
+        targets[edge.first].push_back(edge.second);
+      }
+    }
+
+    result.terminal.push_back(is_terminal);
+    result.transitions.resize(result.transitions.size() + alphabet_size, NO_STATE);
+
+    for (const auto letter : letters) {
+      auto& subset = targets[letter];
+      std::sort(subset.begin(), subset.end());
+      subset.erase(std::unique(subset.begin(), subset.end()), subset.end());
+
+      const auto inserted = subset_numbers.emplace(subset, checkedState(subsets.size()));
+      if (inserted.second) {
+        subsets.push_back(subset);
+      }
+      result.transitions[k * alphabet_size + letter] = inserted.first->second;
+      subset.clear();
+    }
+  }
+
+  return result;
+}
+
+//! The minimization of Hopcroft, the states which don't lead to terminal ones are removed
+Dfa minimize(const Dfa& dfa, size_t alphabet_size) {
+  // the missing transitions lead to the sink, which is the last state
+  const auto n = dfa.terminal.size() + 1;
+  const auto sink = static_cast<State>(n - 1);
+  checkedState(n);
+
+  const auto transition = [&](State s, size_t letter) {
+    if (s == sink) {
+      return sink;
+    }
+    const auto t = dfa.transitions[s * alphabet_size + letter];
+    return t == NO_STATE ? sink : t;
+  };
+
+  // the inverse transitions of the letter a into the state t are
+  // predecessors[offsets[a * n + t], offsets[a * n + t + 1])
+  std::vector<size_t> offsets(alphabet_size * n + 1, 0);
+  for (size_t s = 0; s < n; ++s) {
+    for (size_t a = 0; a < alphabet_size; ++a) {
+      ++offsets[a * n + transition(static_cast<State>(s), a) + 1];
+    }
+  }
+  for (size_t i = 1; i < offsets.size(); ++i) {
+    offsets[i] += offsets[i - 1];
+  }
+  std::vector<State> predecessors(offsets.back());
+  {
+    auto positions = offsets;
+    for (size_t s = 0; s < n; ++s) {
+      for (size_t a = 0; a < alphabet_size; ++a) {
+        predecessors[positions[a * n + transition(static_cast<State>(s), a)]++] = static_cast<State>(s);
+      }
+    }
+  }
+
+  // the states of a block are elements[begin, end), its marked states are elements[begin, marked)
+  std::vector<State> elements;
+  std::vector<size_t> locations(n);
+  std::vector<uint32_t> blocks(n);
+  std::vector<size_t> begins, ends, marked;
+
+  for (const uint8_t terminal : {1, 0}) {
+    const auto begin = elements.size();
+    for (size_t s = 0; s < n; ++s) {
+      const auto is_terminal = s == sink ? 0 : dfa.terminal[s];
+      if (is_terminal == terminal) {
+        locations[s] = elements.size();
+        blocks[s] = static_cast<uint32_t>(begins.size());
+        elements.push_back(static_cast<State>(s));
+      }
+    }
+
+    if (elements.size() > begin) {
+      begins.push_back(begin);
+      ends.push_back(elements.size());
+      marked.push_back(begin);
+    }
+  }
+
+  // the splitters (block, letter) to process
+  std::vector<std::pair<uint32_t, uint32_t>> splitters;
+  std::vector<uint8_t> is_splitter(begins.size() * alphabet_size, 0);
+  const auto addSplitter = [&](uint32_t block, size_t letter) {
+    is_splitter[block * alphabet_size + letter] = 1;
+    splitters.emplace_back(block, static_cast<uint32_t>(letter));
+  };
+
+  if (begins.size() == 2) {
+    const uint32_t smaller = ends[0] - begins[0] <= ends[1] - begins[1] ? 0 : 1;
+    for (size_t a = 0; a < alphabet_size; ++a) {
+      addSplitter(smaller, a);
+    }
+  }
+
+  std::vector<State> splitter_states;
+  std::vector<uint32_t> touched;
+
+  while (!splitters.empty()) {
+    const auto splitter = splitters.back();
+    splitters.pop_back();
+    is_splitter[splitter.first * alphabet_size + splitter.second] = 0;
+
+    // the block may be split while its predecessors are marked, so its states are copied
+    splitter_states.assign(elements.begin() + begins[splitter.first], elements.begin() + ends[splitter.first]);
+
+    for (const auto t : splitter_states) {
+      const auto index = splitter.second * n + t;
+      for (auto i = offsets[index]; i < offsets[index + 1]; ++i) {
+        const auto s = predecessors[i];
+        const auto block = blocks[s];
+        if (locations[s] < marked[block]) {
+          continue;
+        }
+
+        // swap s with the first unmarked state of its block
+        const auto other = elements[marked[block]];
+        std::swap(elements[locations[s]], elements[marked[block]]);
+        locations[other] = locations[s];
+        locations[s] = marked[block];
+        if (marked[block]++ == begins[block]) {
+          touched.push_back(block);
+        }
+      }
+    }
+
+    for (const auto block : touched) {
+      if (marked[block] == ends[block]) {
+        marked[block] = begins[block];
+        continue;
+      }
+
+      // the marked states form a new block
+      const auto new_block = static_cast<uint32_t>(begins.size());
+      begins.push_back(begins[block]);
+      ends.push_back(marked[block]);
+      marked.push_back(begins[block]);
+      begins[block] = marked[block];
+
+      for (auto i = begins[new_block]; i < ends[new_block]; ++i) {
+        blocks[elements[i]] = new_block;
+      }
+
+      is_splitter.resize(begins.size() * alphabet_size, 0);
+      const auto smaller = ends[new_block] - begins[new_block] <= ends[block] - begins[block] ? new_block : block;
+      for (size_t a = 0; a < alphabet_size; ++a) {
+        if (is_splitter[block * alphabet_size + a]) {
+          addSplitter(new_block, a);
+        } else {
+          addSplitter(smaller, a);
+        }
+      }
+    }
+    touched.clear();
+  }
+
+  // the blocks are numbered breadth first from the block of the initial state, the block of the sink is dropped
+  const auto sink_block = blocks[sink];
+  if (blocks[0] == sink_block) {
+    return emptyDfa(alphabet_size);
+  }
+
+  std::vector<State> numbers(begins.size(), NO_STATE);
+  std::vector<uint32_t> order = {blocks[0]};
+  numbers[blocks[0]] = 0;
+
+  Dfa result;
+  for (size_t k = 0; k < order.size(); ++k) {
+    const auto representative = elements[begins[order[k]]];
+    result.terminal.push_back(dfa.terminal[representative]);
+
+    for (size_t a = 0; a < alphabet_size; ++a) {
+      const auto block = blocks[transition(representative, a)];
+      if (block == sink_block) {
+        result.transitions.push_back(NO_STATE);
+        continue;
+      }
+
+      if (numbers[block] == NO_STATE) {
+        numbers[block] = static_cast<State>(order.size());
+        order.push_back(block);
+      }
+      result.transitions.push_back(numbers[block]);
+    }
+  }
+
+  return result;
+}
+
+template <typename T>
+char* append(char* position, const T* values, size_t count) {
+  if (count != 0) {
+    std::memcpy(position, values, count * sizeof(T));
+  }
+  return position + count * sizeof(T);
+}
+
+} // namespace
+
+constexpr CompiledFSA::State CompiledFSA::NO_STATE;
+constexpr uint32_t CompiledFSA::NO_LETTER;
+
+CompiledFSA::CompiledFSA(const FSA& fsa) {
+  std::vector<int> alphabet;
+  for (const auto& state : fsa.getStates()) {
+    for (const auto& edge : state.second.out) {
+      alphabet.push_back(edge.label);
+    }
+  }
+  std::sort(alphabet.begin(), alphabet.end());
+  alphabet.erase(std::unique(alphabet.begin(), alphabet.end()), alphabet.end());
+
+  const int64_t min_label = alphabet.empty() ? 0 : alphabet.front();
+  const int64_t labels_range = alphabet.empty() ? 0 : int64_t(alphabet.back()) - min_label + 1;
+  if (labels_range > MAX_LABELS_RANGE) {
+    throw std::length_error("The labels of the automaton range too wide.");
+  }
+
+  std::vector<uint32_t> letter_indices(labels_range, NO_LETTER);
+  for (size_t i = 0; i < alphabet.size(); ++i) {
+    letter_indices[alphabet[i] - min_label] = static_cast<uint32_t>(i);
+  }
+
+  const auto dfa = minimize(determinize(fsa, alphabet), alphabet.size());
+
+  Header header;
+  std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+  header.version = VERSION;
+  header.states_count = static_cast<uint32_t>(dfa.terminal.size());
+  header.alphabet_size = static_cast<uint32_t>(alphabet.size());
+  header.min_label = static_cast<int32_t>(min_label);
+  header.labels_range = static_cast<uint32_t>(labels_range);
+  header.reserved = 0;
+
+  const std::vector<int32_t> labels(alphabet.begin(), alphabet.end());
+  auto buffer = std::make_shared<std::vector<char>>(
+      sizeof(Header) + sizeof(int32_t) * labels.size() + sizeof(uint32_t) * letter_indices.size() +
+      sizeof(State) * dfa.transitions.size() + dfa.terminal.size());
+
+  auto position = append(buffer->data(), &header, 1);
+  position = append(position, labels.data(), labels.size());
+  position = append(position, letter_indices.data(), letter_indices.size());
+  position = append(position, dfa.transitions.data(), dfa.transitions.size());
+  append(position, dfa.terminal.data(), dfa.terminal.size());
+
+  const auto data = buffer->data();
+  const auto size = buffer->size();
+  attach_(std::move(buffer), data, size);
+}
+
+void CompiledFSA::attach_(std::shared_ptr<const void> holder, const char* data, size_t size) {
+  Header header;
+  if (size < sizeof(Header)) {
+    throw std::runtime_error("The automaton is too short.");
+  }
+  std::memcpy(&header, data, sizeof(Header));
+
+  if ((std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0) || (header.version != VERSION)) {
+    throw std::runtime_error("The data is not an automaton of a supported version.");
+  }
+
+  const uint64_t expected_size = sizeof(Header) + sizeof(int32_t) * uint64_t(header.alphabet_size) +
+                                 sizeof(uint32_t) * uint64_t(header.labels_range) +
+                                 sizeof(State) * uint64_t(header.states_count) * header.alphabet_size +
+                                 header.states_count;
+  if ((header.states_count == 0) || (expected_size != size)) {
+    throw std::runtime_error("The size of the automaton is inconsistent.");
+  }
+
+  holder_ = std::move(holder);
+  data_ = data;
+  data_size_ = size;
+  states_count_ = header.states_count;
+  alphabet_size_ = header.alphabet_size;
+  min_label_ = header.min_label;
+  labels_range_ = header.labels_range;
+
+  alphabet_ = reinterpret_cast<const int32_t*>(data + sizeof(Header));
+  letter_indices_ = reinterpret_cast<const uint32_t*>(alphabet_ + alphabet_size_);
+  transitions_ = reinterpret_cast<const State*>(letter_indices_ + labels_range_);
+  terminal_ = reinterpret_cast<const uint8_t*>(transitions_ + states_count_ * alphabet_size_);
+}
+
+CompiledFSA CompiledFSA::load(const std::string& path) {
+  namespace bip = boost::interprocess;
+
+  std::shared_ptr<bip::mapped_region> region;
+  try {
+    const bip::file_mapping file(path.c_str(), bip::read_only);
+    region = std::make_shared<bip::mapped_region>(file, bip::read_only);
+  } catch (const bip::interprocess_exception& e) {
+    throw std::runtime_error("Can't map the file " + path + ": " + e.what());
+  }
+
+  CompiledFSA result;
+  result.attach_(region, static_cast<const char*>(region->get_address()), region->get_size());
+
+  // the table is checked once, so that the transitions can be followed without checks
+  for (size_t i = 0; i < result.states_count_ * result.alphabet_size_; ++i) {
+    const auto t = result.transitions_[i];
+    if ((t != NO_STATE) && (t >= result.states_count_)) {
+      throw std::runtime_error("The file " + path + " has a transition to a missing state.");
+    }
+  }
+  for (int64_t i = 0; i < result.labels_range_; ++i) {
+    const auto letter = result.letter_indices_[i];
+    if ((letter != NO_LETTER) && (letter >= result.alphabet_size_)) {
+      throw std::runtime_error("The file " + path + " has a missing letter.");
+    }
+  }
+
+  return result;
+}
+
+void CompiledFSA::save(const std::string& path) const {
+  std::ofstream out(path, std::ios::binary | std::ios::trunc);
+  out.write(data_, static_cast<std::streamsize>(data_size_));
+  out.close();
+
+  if (!out) {
+    throw std::runtime_error("Can't write the file " + path + ".");
+  }
+}
+
+size_t CompiledFSA::size() const {
+  return states_count_;
+}
+
+std::vector<int> CompiledFSA::alphabet() const {
+  return std::vector<int>(alphabet_, alphabet_ + alphabet_size_);
+}
+
+bool CompiledFSA::accepts(const Word& w) const {
+  State s = 0;
+  for (const auto label : w) {
+    s = target(s, label);
+    if (s == NO_STATE) {
+      return false;
+    }
+  }
+
+  return isTerminal(s);
+}
+
+boost::container::vector<bool> CompiledFSA::acceptsAll(const std::vector<Word>& words) const {
+  boost::container::vector<bool> result(words.size());
+  const auto groups_count = (words.size() + GROUP_SIZE - 1) / GROUP_SIZE;
+
+  parallel::forEach(groups_count, [&](size_t group) {
+    const auto begin = group * GROUP_SIZE;
+    const auto count = std::min(words.size() - begin, GROUP_SIZE);
+
+    State states[GROUP_SIZE];
+    Word::const_iterator positions[GROUP_SIZE];
+    Word::const_iterator ends[GROUP_SIZE];
+    for (size_t i = 0; i < count; ++i) {
+      states[i] = 0;
+      positions[i] = words[begin + i].begin();
+      ends[i] = words[begin + i].end();
+    }
+
+    // one letter of every word per round
+    for (bool active = true; active;) {
+      active = false;
+      for (size_t i = 0; i < count; ++i) {
+        if ((states[i] != NO_STATE) && (positions[i] != ends[i])) {
+          states[i] = target(states[i], *positions[i]++);
+          active = true;
+        }
+      }
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+      result[begin + i] = (states[i] != NO_STATE) && isTerminal(states[i]);
+    }
+  });
+
+  return result;
+}
+
+FSA CompiledFSA::toFSA() const {
+  FSA result;
+  for (size_t s = 0; s < states_count_; ++s) {
+    result.newState();
+    if (isTerminal(static_cast<State>(s))) {
+      result.makeTerminal(static_cast<int>(s));
+    }
+  }
+  result.makeInitial(0);
+
+  for (size_t s = 0; s < states_count_; ++s) {
+    for (size_t a = 0; a < alphabet_size_; ++a) {
+      const auto t = transitions_[s * alphabet_size_ + a];
+      if (t != NO_STATE) {
+        result.newEdge(static_cast<int>(s), static_cast<int>(t), alphabet_[a]);
+      }
+    }
+  }
+
+  return result;
+}
+
+} // namespace fsa
+} // namespace crag
@@ -0,0 +1,167 @@
+#include <gtest/gtest.h>
+
+#include <fstream>
+#include <random>
+
+#include "compiled_fsa.h"
+#include "random_word.h"
+
+namespace crag {
+namespace fsa {
+namespace {
+
+//! Reads w in the nondeterministic automaton
+bool acceptsNondeterministic(const FSA& fsa, const Word& w) {
+  set<int> current = fsa.getInitStates();
+  for (const auto label : w) {
+    set<int> next;
+    for (const auto s : current) {
+      for (const auto& edge : fsa.getStates().at(s).out) {
+        if (edge.label == label) {
+          next.insert(edge.target);
+        }
+      }
+    }
+    current = std::move(next);
+  }
+
+  for (const auto s : current) {
+    if (fsa.getTermStates().count(s)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+FSA randomFSA(size_t states_count, size_t edges_count, int rank, std::mt19937& g) {
+  FSA result;
+  for (size_t s = 0; s < states_count; ++s) {
+    result.newState();
+    if (g() % 4 == 0) {
+      result.makeTerminal(static_cast<int>(s));
+    }
+  }
+  result.makeInitial(0);
+  if (g() % 2 == 0) {
+    result.makeInitial(static_cast<int>(g() % states_count));
+  }
+
+  for (size_t i = 0; i < edges_count; ++i) {
+    const auto label = static_cast<int>(1 + g() % rank);
+    result.newEdge(
+        static_cast<int>(g() % states_count), static_cast<int>(g() % states_count), g() % 2 == 0 ? label : -label);
+  }
+
+  return result;
+}
+
+//! Words with an even number of the letters 1, with redundant states
+FSA evenOnes() {
+  FSA result;
+  for (int s = 0; s < 4; ++s) {
+    result.newState();
+  }
+  result.makeInitial(0);
+  result.makeTerminal(0);
+  result.makeTerminal(2);
+
+  for (int s = 0; s < 4; ++s) {
+    result.newEdge(s, (s + 1) % 4, 1);
+    result.newEdge(s, s, 2);
+  }
+
+  return result;
+}
+
+TEST(CompiledFSA, Example) {
+  const CompiledFSA compiled(evenOnes());
+
+  EXPECT_EQ(2, compiled.size());
+  EXPECT_EQ(std::vector<int>({1, 2}), compiled.alphabet());
+  EXPECT_TRUE(compiled.accepts(Word()));
+  EXPECT_TRUE(compiled.accepts(Word({1, 2, 1})));
+  EXPECT_FALSE(compiled.accepts(Word({1, 2, 2})));
+  EXPECT_FALSE(compiled.accepts(Word({3})));
+  EXPECT_FALSE(compiled.accepts(Word({-1})));
+  EXPECT_EQ(CompiledFSA::NO_STATE, compiled.target(0, 5));
+}
+
+TEST(CompiledFSA, Empty) {
+  const CompiledFSA no_initial((FSA()));
+  EXPECT_EQ(1, no_initial.size());
+  EXPECT_FALSE(no_initial.accepts(Word()));
+
+  // no terminal states
+  auto fsa = evenOnes();
+  fsa.makeNonTerminal(0);
+  fsa.makeNonTerminal(2);
+  const CompiledFSA no_terminal(fsa);
+  EXPECT_EQ(1, no_terminal.size());
+  EXPECT_FALSE(no_terminal.accepts(Word({1, 1})));
+}
+
+TEST(CompiledFSA, RandomAutomata) {
+  std::mt19937 g(0);
+
+  for (size_t i = 0; i < 100; ++i) {
+    const size_t states_count = 1 + g() % 8;
+    const auto fsa = randomFSA(states_count, g() % (4 * states_count), 2, g);
+    const CompiledFSA compiled(fsa);
+
+    for (size_t j = 0; j < 50; ++j) {
+      const auto w = random::randomWord(2, g() % 8, g);
+      ASSERT_EQ(acceptsNondeterministic(fsa, w), compiled.accepts(w)) << "case: fsa = " << fsa << ", w = " << w;
+    }
+
+    // the automaton is minimal, so compiling it again changes nothing
+    const auto deterministic = compiled.toFSA();
+    ASSERT_TRUE(deterministic.isDeterministic());
+    EXPECT_EQ(compiled.size(), CompiledFSA(deterministic).size());
+
+    // the legacy subset construction gives an equivalent automaton
+    EXPECT_EQ(compiled.size(), CompiledFSA(fsa.deterministic()).size()) << "case: fsa = " << fsa;
+  }
+}
+
+TEST(CompiledFSA, AcceptsAll) {
+  std::mt19937 g(0);
+  const auto fsa = randomFSA(20, 80, 3, g);
+  const CompiledFSA compiled(fsa);
+
+  std::vector<Word> words;
+  for (size_t i = 0; i < 1000; ++i) {
+    words.push_back(random::randomWord(3, g() % 10, g));
+  }
+
+  const auto accepted = compiled.acceptsAll(words);
+  ASSERT_EQ(words.size(), accepted.size());
+  for (size_t i = 0; i < words.size(); ++i) {
+    EXPECT_EQ(compiled.accepts(words[i]), accepted[i]) << "case: w = " << words[i];
+  }
+}
+
+TEST(CompiledFSA, SaveAndLoad) {
+  std::mt19937 g(0);
+  const auto path = testing::TempDir() + "test_compiled_fsa.dfa";
+  const CompiledFSA compiled(randomFSA(20, 80, 3, g));
+
+  compiled.save(path);
+  const auto loaded = CompiledFSA::load(path);
+
+  EXPECT_EQ(compiled.size(), loaded.size());
+  EXPECT_EQ(compiled.alphabet(), loaded.alphabet());
+  for (size_t i = 0; i < 200; ++i) {
+    const auto w = random::randomWord(3, g() % 10, g);
+    EXPECT_EQ(compiled.accepts(w), loaded.accepts(w)) << "case: w = " << w;
+  }
+
+  std::ofstream(path, std::ios::trunc) << "not an automaton";
+  EXPECT_THROW(CompiledFSA::load(path), std::runtime_error);
+  EXPECT_THROW(CompiledFSA::load(path + ".missing"), std::runtime_error);
+
+  std::remove(path.c_str());
+}
+
+} // namespace
+} // namespace fsa
+} // namespace crag
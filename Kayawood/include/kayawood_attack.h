@@ -12,6 +12,7 @@
 #include "ThLeftNormalForm.h"
 #include "braid_group.h"
 #include "fast_identity_check.h"
+#include "phase_timer.h"
 
 namespace crag {
 namespace kayawood {
@@ -229,8 +230,20 @@ std::vector<std::pair<size_t, Word>> availableFlips(size_t n, size_t a, size_t b
   }
 
   // 2. Apply shortenBraid2
-  return parallel::map(
-      result, [n](const std::pair<size_t, Word>& p) { return std::make_pair(p.first, shortenBraid2(n, p.second)); });
+  std::vector<Word> words;
+  words.reserve(result.size());
+
+  for (const auto& p : result) {
+    words.push_back(p.second);
+  }
+
+  words = shortenBraids(n, words);
+
+  for (size_t i = 0; i < result.size(); ++i) {
+    result[i].second = std::move(words[i]);
+  }
+
+  return result;
 }
 
 template <typename Stabilizer, typename URNG>
@@ -420,7 +433,10 @@ bool attack(const ProtocolInstance<T>& instance, URNG& g) {
   std::vector<Word> new_betas;
 
   std::cout << "Recovering conjugator c and betas from betas conjugates..." << std::endl;
-  std::tie(recovered_z, new_betas) = recoverZ(n, betas);
+  {
+    campaign::ScopedPhase phase("recovery");
+    std::tie(recovered_z, new_betas) = recoverZ(n, betas);
+  }
   std::cout << "c and betas recovered" << std::endl;
 
   // DIAGNOSTICS
@@ -461,6 +477,7 @@ bool attack(const ProtocolInstance<T>& instance, URNG& g) {
   // 2. The attack
   Word result;
   try {
+    campaign::ScopedPhase phase("reduction");
     result = reduce<Stabilizer>(
         n, sigma_z[sigma_b[a]], sigma_z[sigma_b[b]], (-recovered_z) * pub_a * recovered_z, new_betas, g);
   } catch (const std::logic_error&) {
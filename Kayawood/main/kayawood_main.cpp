@@ -2,62 +2,66 @@
 
 #include "ThLeftNormalForm.h"
 #include "braid_group.h"
+#include "campaign.h"
 #include "kayawood_attack.h"
 
 using namespace crag;
 
-int main() {
-  const size_t init_seed = 0;
-  const size_t experiments_count = 100;
+//! Runs the attack on the protocol instance with the given seed, returns true if it is successful.
+static bool experiment(size_t i) {
+  std::cout << "Generating random instance with seed = " << i << std::endl;
+  //    const auto protocol = kayawood::getProtocolFor128BitsSecurity(i);
+  //    const auto protocol = kayawood::getProtocolFor256BitsSecurity(i);
+  //    const auto protocol = kayawood::getProtocolFor128BitsSecurityMultipleCloaking(i);
+  const auto protocol = kayawood::getProtocolFor256BitsSecurityMultipleCloaking(i);
 
-  size_t success_count = 0;
+  const auto parameters = protocol.parameters();
+  const auto instance = protocol.generateInstance(i);
 
-  for (size_t i = init_seed; i < init_seed + experiments_count; ++i) {
-    std::cout << "Generating random instance with seed = " << i << std::endl;
-//    const auto protocol = kayawood::getProtocolFor128BitsSecurity(i);
-//    const auto protocol = kayawood::getProtocolFor256BitsSecurity(i);
-//    const auto protocol = kayawood::getProtocolFor128BitsSecurityMultipleCloaking(i);
-    const auto protocol = kayawood::getProtocolFor256BitsSecurityMultipleCloaking(i);
+  if (kayawood::isBadInstance(instance)) {
+    std::cout << "Protocol instance #" << i << " is bad, shared key can be obtained from public keys." << std::endl;
+  }
 
-    const auto parameters = protocol.parameters();
-    const auto instance = protocol.generateInstance(i);
+  const auto priv_a = instance.alicePrivateKey();
+  const auto pub_a = instance.alicePublicKey();
 
-    if (kayawood::isBadInstance(instance)) {
-      std::cout << "Protocol instance #" << i << " is bad, shared key can be obtained from public keys." << std::endl;
-    }
+  std::cout << "========================================================" << std::endl;
+  std::cout << "|alice_private_key| = " << priv_a.length() << std::endl;
+  std::cout << "|alice_public_key| = " << pub_a.length() << std::endl;
 
-    const auto priv_a = instance.alicePrivateKey();
-    const auto pub_a = instance.alicePublicKey();
+  // Some diagnostics
+  typedef ThLeftNormalForm NF;
+  const auto n = protocol.parameters().n();
 
-    std::cout << "========================================================" << std::endl;
-    std::cout << "|alice_private_key| = " << priv_a.length() << std::endl;
-    std::cout << "|alice_public_key| = " << pub_a.length() << std::endl;
+  if (NF(n, priv_a * -pub_a).isTrivial()) {
+    std::cout << "Error: Same Public and private keys!" << std::endl;
+    return false;
+  }
 
-    // Some diagnostics
-    typedef ThLeftNormalForm NF;
-    const auto n = protocol.parameters().n();
+  std::mt19937_64 g(i);
 
-    if (NF(n, priv_a * -pub_a).isTrivial()) {
-      std::cout << "Error: Same Public and private keys!" << std::endl;
-      continue;
-    }
+  const auto is_successful_attack =
+      kayawood::attack<decltype(protocol)::field_t, decltype(protocol)::stabilizer_t>(instance, g);
 
-    std::mt19937_64 g(i);
+  std::cout << "Experiment #" << i << (is_successful_attack ? " is successful." : " failed.") << std::endl;
 
-    int spent_time = time(0);
-
-    const auto is_successful_attack =
-        kayawood::attack<decltype(protocol)::field_t, decltype(protocol)::stabilizer_t>(instance, g);
+  return is_successful_attack;
+}
 
-    spent_time = time(0) - spent_time;
+//! Instances are distributed over worker processes and recorded in a log, see campaign.h and --help.
+int main(int argc, char** argv) {
+  campaign::CampaignOptions defaults;
+  defaults.first_seed = 0;
+  defaults.count = 100;
+  defaults.log_path = "kayawood_campaign.log";
 
-    if (is_successful_attack) {
-      ++success_count;
+  try {
+    if (const auto options = campaign::parseCommandLine(argc, argv, defaults)) {
+      campaign::run(options.get(), experiment);
     }
-
-    std::cout << "Experiment #" << i << (is_successful_attack ? " is successful." : " failed.") << std::endl;
-    std::cout << "Time spent: " << spent_time << std::endl;
-    std::cout << "Success: " << success_count << " out of " << (i + 1 - init_seed) << std::endl;
+  } catch (const std::exception& e) {
+    std::cerr << e.what() << std::endl;
+    return 1;
   }
 
   return 0;
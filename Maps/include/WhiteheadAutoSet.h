@@ -5,7 +5,10 @@
 
 #include "Map.h"
 #include "Word.h"
+#include "whitehead_length.h"
 
+#include <memory>
+#include <mutex>
 #include <unordered_set>
 //#include <ext/stl_hash_fun.h>
 
@@ -223,17 +226,20 @@ private:
   Greedy procedure applies automorphisms from a  Whitehead set of type II  to a word until 
   its length is reduced. If a shorter image is found, procedure is applied to the
   shorten word. If none of the automorphisms can reduce the length, procedure stops and
-  the shortest word is returned.
+  the shortest word is returned. <br>
+  The length changes are computed from the Whitehead graph of the word (see 
+  crag::whitehead::WhiteheadLengthChange) in parallel, and only the image of the chosen
+  automorphism is computed. The automorphisms are enumerated on the fly.
  */
 class WhiteheadMinimization
 {
  public:
   //! Constructor. 
-  /*! A set of Whitehead automorphisms is created in the constructor. 
-    May not be applicable when the rank is large.
+  /*! The set of Whitehead automorphisms is not created, so the constructor is cheap for any rank.
+    Still the number of automorphisms to check is \f$ 2n 4^{n-1} \f$.
     \param n - the rank  of a free group.
   */
-  WhiteheadMinimization( int n ): wSet( n ) { } 
+  WhiteheadMinimization( int n ): nGens( n ), theAutomorphisms( n ) { } 
 
   //! Test if the word is minimal
   /*!
@@ -248,20 +254,27 @@ class WhiteheadMinimization
   //! Find a word of the minimal length 
   /*!
     Applies automorphisms from the Whitehead set to find a word of the minimal length
-    in the automorphic orbit of a given word.
+    in the automorphic orbit of a given word. On every step an automorphism which
+    shortens the word the most is applied.
     \param w - initial word.
+    \param out - if not \c NULL, the applied automorphisms are printed to it.
     \return a word of the minimal length in the orbit of \c w.
    */
   Word findMinimal( const Word& w, ostream* out = NULL )const;
 
   //! Get the Whitehead set of type II.
   /*!
+    The set is created on the first call. May not be applicable when the rank is large.
     \return the Whitehead set of type II.
    */
-  const WhiteheadAutoSetType2& getSet() const { return wSet; }
+  const WhiteheadAutoSetType2& getSet() const;
 
  private:
-  WhiteheadAutoSetType2 wSet;
+  int nGens;
+  crag::whitehead::WhiteheadAutomorphisms theAutomorphisms;
+
+  mutable std::once_flag wSetCreated;
+  mutable std::unique_ptr<WhiteheadAutoSetType2> wSet;
 };
 
 
@@ -0,0 +1,108 @@
+#pragma once
+
+#ifndef CRAG_WHITEHEAD_LENGTH_H
+#define CRAG_WHITEHEAD_LENGTH_H
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include <boost/optional.hpp>
+
+#include "Map.h"
+#include "Word.h"
+
+namespace crag {
+namespace whitehead {
+
+//! Whitehead automorphism of type II of the free group of rank n, it fixes the letter a and sends every other
+//! generator x to one of
+//!     0: x,  1: x a,  2: a^-1 x,  3: a^-1 x a.
+struct WhiteheadAutomorphism {
+  //! the letter fixed by the automorphism, x_g or x_g^-1
+  int a;
+
+  //! types[i] is the image type of the generator x_{i+1}, it is 0 for the generator of a
+  std::vector<uint8_t> types;
+
+  //! Returns the freely reduced image of w
+  Word imageOf(const Word& w) const;
+
+  //! Returns the automorphism as a map of the free group of rank types.size()
+  Map toMap() const;
+};
+
+//! The automorphisms of WhiteheadAutoSetType2 of the free group of rank n, enumerated without storing them.
+/*!
+  The k-th automorphism fixes the letter number k / 4^(n-1) (x_1, x_1^-1, x_2, ...), the base 4 digits of
+  k % 4^(n-1) are the types of the other generators. The identity occurs once for every letter, the other
+  automorphisms are distinct.
+ */
+class WhiteheadAutomorphisms {
+public:
+  //! Throws std::invalid_argument if the number of automorphisms doesn't fit into size_t.
+  explicit WhiteheadAutomorphisms(size_t rank);
+
+  size_t rank() const {
+    return rank_;
+  }
+
+  size_t size() const {
+    return 2 * rank_ * types_count_;
+  }
+
+  WhiteheadAutomorphism operator[](size_t k) const;
+
+private:
+  size_t rank_;
+
+  //! 4^(n-1)
+  size_t types_count_;
+};
+
+//! Computes the change of the length of a word under Whitehead automorphisms without computing the images.
+/*!
+  The word is represented by the counts of its two-letter subwords, i.e. by the edges of its Whitehead graph, and
+  by its first and last letters. An automorphism inserts a^-1 before and a after some letters, and these letters
+  cancel only with each other and with the letters a^{+-1} of the word. So the length change is a sum of the
+  contributions of the subwords, which takes O(n^2) for the rank n per automorphism.
+ */
+class WhiteheadLengthChange {
+public:
+  //! Throws std::invalid_argument if w has a letter of index greater than rank.
+  //! If cyclic is true, w must be cyclically reduced, and the change of the cyclic length is computed
+  //! (the pair of the last and the first letters is counted too).
+  WhiteheadLengthChange(const Word& w, size_t rank, bool cyclic = false);
+
+  //! Returns |phi(w)| - |w| for the freely (cyclically if cyclic) reduced image phi(w)
+  int operator()(const WhiteheadAutomorphism& phi) const;
+
+  //! The index of an automorphism of the set which shortens w the most and the change of the length.
+  //! The first one among the equal ones is chosen. Returns none if no automorphism shortens w.
+  //! Automorphisms are evaluated in parallel.
+  boost::optional<std::pair<size_t, int>> findShortening(const WhiteheadAutomorphisms& automorphisms) const;
+
+  //! Checks if an automorphism of the set shortens w, stops as soon as one is found
+  bool isShortenable(const WhiteheadAutomorphisms& automorphisms) const;
+
+private:
+  struct SubwordCount {
+    size_t first;
+    size_t second;
+    int count;
+  };
+
+  size_t rank_;
+  bool cyclic_;
+
+  //! the non-zero counts of the two-letter subwords, letters are encoded by letterIndex
+  std::vector<SubwordCount> subwords_;
+
+  //! indices of the first and the last letters, they are used for non-cyclic words only
+  boost::optional<std::pair<size_t, size_t>> ends_;
+};
+
+} // namespace whitehead
+} // namespace crag
+
+#endif // CRAG_WHITEHEAD_LENGTH_H
@@ -172,7 +172,7 @@ void WhiteheadAutoSetType2::computeSet(  int nGens )
       theSet.insert( m2 );
    
       int i=ngens-1;
-      while ( tCounts[i]+1 == nElemAutos  ){
+      while ( !done && tCounts[i]+1 == nElemAutos  ){
 	if (i==0) done  = true;
 	tCounts[i] = 0;
 	i--;
@@ -232,38 +232,35 @@ const Map& WhiteheadAutoSetType2::getRandomAuto()const
 
 bool  WhiteheadMinimization::isMinimal( const Word& w) const
 {
-  const SetOfMaps& theSet = wSet.getSet();
-  for( SetOfMaps::const_iterator I=theSet.begin(); I!=theSet.end();I++ ){
-    Word w_trans = I->imageOf( w );
-    if (w.length() > (w_trans.freelyReduce()).length())
-      return false;
-  }
-  return true;
+  crag::whitehead::WhiteheadLengthChange lengthChange( w, nGens );
+  return !lengthChange.isShortenable( theAutomorphisms );
 }
 
 
 Word WhiteheadMinimization::findMinimal( const Word& w, ostream* out )const
 {
   Word minWord(w);
-  const SetOfMaps& theSet = wSet.getSet();
-  bool haveSorterWord = false;
-
-  do {
-    haveSorterWord = false;
-    for( SetOfMaps::const_iterator I=theSet.begin(); I!=theSet.end();I++ ){
-      Word w_trans = I->imageOf( minWord ); 
-      //   Word w_trans_reduced = w_trans.freelyReduce();
-      if (w_trans.length() < minWord.length() ){
-	if (out){
-	  //const Map& m = *I;
-	  *out << "{" << (*I) << "} " << flush; 
-	}
-	minWord = w_trans;
-	haveSorterWord = true;
-	break;
-      }
+
+  while ( true ) {
+    crag::whitehead::WhiteheadLengthChange lengthChange( minWord, nGens );
+    boost::optional<pair<size_t,int> > best = lengthChange.findShortening( theAutomorphisms );
+    if ( !best )
+      break;
+
+    // only the image under the chosen automorphism is computed
+    crag::whitehead::WhiteheadAutomorphism phi = theAutomorphisms[best->first];
+    if (out){
+      *out << "{" << phi.toMap() << "} " << flush; 
     }
-  } while ( haveSorterWord );
+    minWord = phi.imageOf( minWord );
+  }
     
   return minWord;
 }
+
+
+const WhiteheadAutoSetType2& WhiteheadMinimization::getSet() const
+{
+  std::call_once( wSetCreated, [this]() { wSet.reset( new WhiteheadAutoSetType2( nGens ) ); } );
+  return *wSet;
+}
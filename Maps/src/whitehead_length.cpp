@@ -0,0 +1,240 @@
+#include "whitehead_length.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <limits>
+#include <stdexcept>
+
+#include <boost/container/small_vector.hpp>
+
+#include "parallel.h"
+
+namespace crag {
+namespace whitehead {
+
+namespace {
+
+//! x_1, x_1^-1, x_2, x_2^-1, ... are numbered 0, 1, 2, 3, ...
+size_t letterIndex(int letter) {
+  return letter > 0 ? 2 * static_cast<size_t>(letter - 1) : 2 * static_cast<size_t>(-letter - 1) + 1;
+}
+
+//! The number of automorphisms evaluated by a task of a parallel loop
+constexpr size_t CHUNK_SIZE = 256;
+
+} // namespace
+
+Word WhiteheadAutomorphism::imageOf(const Word& w) const {
+  std::vector<int> image;
+  image.reserve(w.length());
+
+  for (const auto letter : w) {
+    const auto generator = static_cast<size_t>(std::abs(letter)) - 1;
+    const auto type = (letter == a) || (letter == -a) ? 0 : types.at(generator);
+
+    // x -> x a, a^-1 x, a^-1 x a, so x^-1 -> a^-1 x^-1, x^-1 a, a^-1 x^-1 a
+    const bool a_after = letter > 0 ? (type == 1) || (type == 3) : (type == 2) || (type == 3);
+    const bool a_before = letter > 0 ? (type == 2) || (type == 3) : (type == 1) || (type == 3);
+
+    if (a_before) {
+      image.push_back(-a);
+    }
+    image.push_back(letter);
+    if (a_after) {
+      image.push_back(a);
+    }
+  }
+
+  return Word(std::move(image));
+}
+
+Map WhiteheadAutomorphism::toMap() const {
+  const auto n = static_cast<int>(types.size());
+  std::vector<Word> images;
+
+  for (int i = 1; i <= n; ++i) {
+    images.push_back(imageOf(Word(i)));
+  }
+
+  return Map(n, n, images);
+}
+
+WhiteheadAutomorphisms::WhiteheadAutomorphisms(size_t rank)
+    : rank_(rank)
+    , types_count_(1) {
+  if (rank == 0) {
+    throw std::invalid_argument("The rank must be positive.");
+  }
+
+  for (size_t i = 1; i < rank; ++i) {
+    if (types_count_ > std::numeric_limits<size_t>::max() / (8 * rank)) {
+      throw std::invalid_argument("Too many Whitehead automorphisms to enumerate.");
+    }
+    types_count_ *= 4;
+  }
+}
+
+WhiteheadAutomorphism WhiteheadAutomorphisms::operator[](size_t k) const {
+  const auto letter = k / types_count_;
+  auto digits = k % types_count_;
+
+  WhiteheadAutomorphism result;
+  result.a = letter % 2 == 0 ? static_cast<int>(letter / 2 + 1) : -static_cast<int>(letter / 2 + 1);
+  result.types.assign(rank_, 0);
+
+  for (size_t i = rank_; i-- > 0;) {
+    if (i != letter / 2) {
+      result.types[i] = static_cast<uint8_t>(digits % 4);
+      digits /= 4;
+    }
+  }
+
+  return result;
+}
+
+WhiteheadLengthChange::WhiteheadLengthChange(const Word& w, size_t rank, bool cyclic)
+    : rank_(rank)
+    , cyclic_(cyclic) {
+  for (const auto letter : w) {
+    if (static_cast<size_t>(std::abs(letter)) > rank) {
+      throw std::invalid_argument("The word has a letter out of the rank.");
+    }
+  }
+
+  if (w.length() == 0) {
+    return;
+  }
+
+  const auto letters_count = 2 * rank;
+  std::vector<int> counts(letters_count * letters_count, 0);
+
+  auto previous = w.begin();
+  for (auto current = std::next(previous); current != w.end(); ++previous, ++current) {
+    ++counts[letterIndex(*previous) * letters_count + letterIndex(*current)];
+  }
+
+  if (cyclic) {
+    ++counts[letterIndex(*previous) * letters_count + letterIndex(*w.begin())];
+  } else {
+    ends_ = std::make_pair(letterIndex(*w.begin()), letterIndex(*previous));
+  }
+
+  for (size_t i = 0; i < counts.size(); ++i) {
+    if (counts[i] != 0) {
+      subwords_.push_back({i / letters_count, i % letters_count, counts[i]});
+    }
+  }
+}
+
+int WhiteheadLengthChange::operator()(const WhiteheadAutomorphism& phi) const {
+  // before[l] and after[l] tell if a^-1 is inserted before the letter l and a after it,
+  // fixed[l] is 1 for a, -1 for a^-1 and 0 otherwise
+  const auto letters_count = 2 * rank_;
+  boost::container::small_vector<int, 32> before(letters_count, 0);
+  boost::container::small_vector<int, 32> after(letters_count, 0);
+  boost::container::small_vector<int, 32> fixed(letters_count, 0);
+
+  for (size_t i = 0; i < rank_; ++i) {
+    const auto type = phi.types[i];
+    after[2 * i] = before[2 * i + 1] = (type == 1) || (type == 3) ? 1 : 0;
+    before[2 * i] = after[2 * i + 1] = (type == 2) || (type == 3) ? 1 : 0;
+  }
+
+  const auto a = letterIndex(phi.a);
+  const auto a_inverse = letterIndex(-phi.a);
+  before[a] = after[a] = before[a_inverse] = after[a_inverse] = 0;
+  fixed[a] = 1;
+  fixed[a_inverse] = -1;
+
+  // A maximal subword a^m (m may be 0 or negative) between letters u, v != a^{+-1} becomes
+  // a^(after(u) + m - before(v)), the inserted letters change its length by
+  //     after(u) + before(v) - 2 after(u) before(v) if m == 0,
+  //     after(u) - before(v)                        if m > 0,
+  //     before(v) - after(u)                        if m < 0,
+  // which is split between the subwords u a^{+-1}, a^{+-1} v and u v.
+  int result = 0;
+
+  for (const auto& subword : subwords_) {
+    const auto u = subword.first;
+    const auto v = subword.second;
+
+    int change = 0;
+    if ((fixed[u] == 0) && (fixed[v] == 0)) {
+      change = after[u] + before[v] - 2 * after[u] * before[v];
+    } else if (fixed[u] == 0) {
+      change = fixed[v] * after[u];
+    } else if (fixed[v] == 0) {
+      change = -fixed[u] * before[v];
+    }
+
+    result += change * subword.count;
+  }
+
+  // the letters inserted at the ends of a non-cyclic word don't cancel
+  if (ends_) {
+    if (fixed[ends_->first] == 0) {
+      result += before[ends_->first];
+    }
+
+    if (fixed[ends_->second] == 0) {
+      result += after[ends_->second];
+    }
+  }
+
+  return result;
+}
+
+boost::optional<std::pair<size_t, int>> WhiteheadLengthChange::findShortening(
+    const WhiteheadAutomorphisms& automorphisms) const {
+  if (automorphisms.rank() != rank_) {
+    throw std::invalid_argument("The automorphisms are of a different rank.");
+  }
+
+  const auto chunks_count = (automorphisms.size() + CHUNK_SIZE - 1) / CHUNK_SIZE;
+  std::vector<std::pair<int, size_t>> best(chunks_count);
+
+  parallel::forEach(chunks_count, [&](size_t chunk) {
+    const auto end = std::min(automorphisms.size(), (chunk + 1) * CHUNK_SIZE);
+
+    best[chunk] = std::make_pair(0, end);
+    for (size_t k = chunk * CHUNK_SIZE; k < end; ++k) {
+      const auto change = (*this)(automorphisms[k]);
+      if (change < best[chunk].first) {
+        best[chunk] = std::make_pair(change, k);
+      }
+    }
+  });
+
+  // pairs are compared by the change first and by the index then
+  const auto result = std::min_element(best.begin(), best.end());
+  if ((result == best.end()) || (result->first >= 0)) {
+    return boost::none;
+  }
+
+  return std::make_pair(result->second, result->first);
+}
+
+bool WhiteheadLengthChange::isShortenable(const WhiteheadAutomorphisms& automorphisms) const {
+  if (automorphisms.rank() != rank_) {
+    throw std::invalid_argument("The automorphisms are of a different rank.");
+  }
+
+  const auto chunks_count = (automorphisms.size() + CHUNK_SIZE - 1) / CHUNK_SIZE;
+  std::atomic<bool> found(false);
+
+  parallel::forEach(chunks_count, [&](size_t chunk) {
+    const auto end = std::min(automorphisms.size(), (chunk + 1) * CHUNK_SIZE);
+
+    for (size_t k = chunk * CHUNK_SIZE; (k < end) && !found; ++k) {
+      if ((*this)(automorphisms[k]) < 0) {
+        found = true;
+      }
+    }
+  });
+
+  return found;
+}
+
+} // namespace whitehead
+} // namespace crag
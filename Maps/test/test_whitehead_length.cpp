@@ -0,0 +1,128 @@
+#include <gtest/gtest.h>
+
+#include <random>
+
+#include "WhiteheadAutoSet.h"
+#include "random_word.h"
+#include "whitehead_length.h"
+
+namespace crag {
+namespace whitehead {
+namespace {
+
+TEST(WhiteheadLengthChange, Example) {
+  // x_1 -> x_1 x_2
+  const WhiteheadAutomorphism phi{2, {1, 0}};
+
+  EXPECT_EQ(Word({1, 2}), phi.imageOf(Word({1})));
+  EXPECT_EQ(Word({1}), phi.imageOf(Word({1, -2})));
+
+  EXPECT_EQ(1, WhiteheadLengthChange(Word({1}), 2)(phi));
+  EXPECT_EQ(-1, WhiteheadLengthChange(Word({1, -2}), 2)(phi));
+  EXPECT_EQ(0, WhiteheadLengthChange(Word(), 2)(phi));
+
+  EXPECT_THROW(WhiteheadLengthChange(Word({3}), 2), std::invalid_argument);
+}
+
+TEST(WhiteheadLengthChange, Enumeration) {
+  for (size_t n = 1; n <= 4; ++n) {
+    const WhiteheadAutomorphisms automorphisms(n);
+    ASSERT_EQ(2 * n * (1u << (2 * (n - 1))), automorphisms.size());
+
+    SetOfMaps maps;
+    for (size_t k = 0; k < automorphisms.size(); ++k) {
+      const auto phi = automorphisms[k];
+      ASSERT_EQ(n, phi.types.size());
+      EXPECT_EQ(0, phi.types[std::abs(phi.a) - 1]);
+
+      maps.insert(phi.toMap());
+    }
+
+    const WhiteheadAutoSetType2 type2(n);
+    const auto& expected = type2.getSet();
+    EXPECT_EQ(expected.size(), maps.size()) << "case: n = " << n;
+    for (const auto& map : maps) {
+      EXPECT_EQ(1, expected.count(map)) << "case: n = " << n;
+    }
+  }
+}
+
+TEST(WhiteheadLengthChange, RandomWords) {
+  std::mt19937 g(0);
+
+  for (size_t n = 2; n <= 4; ++n) {
+    const WhiteheadAutomorphisms automorphisms(n);
+
+    for (size_t i = 0; i < 20; ++i) {
+      const auto w = random::randomWord(n, g() % 30, g);
+      const auto w_cyclic = w.cyclicallyReduce();
+
+      const WhiteheadLengthChange change(w, n);
+      const WhiteheadLengthChange cyclic_change(w_cyclic, n, true);
+
+      for (size_t k = 0; k < automorphisms.size(); ++k) {
+        const auto phi = automorphisms[k];
+        const auto image = phi.imageOf(w);
+
+        ASSERT_EQ(phi.toMap().imageOf(w), image);
+        ASSERT_EQ(static_cast<int>(image.length()) - static_cast<int>(w.length()), change(phi))
+            << "case: n = " << n << ", w = " << w << ", k = " << k;
+
+        const auto cyclic_image = phi.imageOf(w_cyclic).cyclicallyReduce();
+        ASSERT_EQ(static_cast<int>(cyclic_image.length()) - static_cast<int>(w_cyclic.length()), cyclic_change(phi))
+            << "case: n = " << n << ", w = " << w_cyclic << ", k = " << k;
+      }
+    }
+  }
+}
+
+//! The exhaustive check over the set of maps
+bool isMinimalByImages(const Word& w, const SetOfMaps& maps) {
+  for (const auto& map : maps) {
+    if (map.imageOf(w).length() < w.length()) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+TEST(WhiteheadMinimization, FindMinimal) {
+  std::mt19937 g(0);
+  const size_t n = 3;
+  const WhiteheadMinimization minimization(n);
+  const WhiteheadAutomorphisms automorphisms(n);
+
+  for (size_t i = 0; i < 20; ++i) {
+    // an image of a short word under several automorphisms
+    auto w = random::randomWord(n, 1 + g() % 5, g);
+    for (size_t j = 0; j < 6; ++j) {
+      w = automorphisms[g() % automorphisms.size()].imageOf(w);
+    }
+
+    EXPECT_EQ(isMinimalByImages(w, minimization.getSet().getSet()), minimization.isMinimal(w)) << "case: w = " << w;
+
+    const auto minimal = minimization.findMinimal(w);
+    EXPECT_LE(minimal.length(), w.length());
+    EXPECT_TRUE(minimization.isMinimal(minimal)) << "case: w = " << w;
+    EXPECT_TRUE(isMinimalByImages(minimal, minimization.getSet().getSet())) << "case: w = " << w;
+  }
+}
+
+TEST(WhiteheadMinimization, Primitive) {
+  std::mt19937 g(0);
+  const size_t n = 7;
+  const WhiteheadMinimization minimization(n);
+  const WhiteheadAutomorphisms automorphisms(n);
+
+  auto w = Word({1});
+  for (size_t j = 0; j < 5; ++j) {
+    w = automorphisms[g() % automorphisms.size()].imageOf(w);
+  }
+
+  EXPECT_EQ(1, minimization.findMinimal(w).length()) << "case: w = " << w;
+}
+
+} // namespace
+} // namespace whitehead
+} // namespace crag
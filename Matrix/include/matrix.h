@@ -8,11 +8,24 @@
 #include <string>
 #include <vector>
 #include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+#include "parallel.h"
 
 namespace crag {
 namespace matrix {
 
-//! Plain template matrix over (discrete) ring
+namespace details {
+//! Edge of the square tiles of the multiplication kernel, a tile of int values fits into L1 cache.
+const size_t MULTIPLICATION_BLOCK_SIZE = 64;
+
+//! Products with at least that many elementary multiplications are split by row tiles between threads.
+const size_t PARALLEL_MULTIPLICATION_THRESHOLD = size_t(1) << 21;
+} // namespace details
+
+//! Plain template matrix over (discrete) ring.
+//! The entries are stored in a single row-major buffer.
 template <typename T>
 class Matrix {
 public:
@@ -20,39 +33,25 @@ public:
 
   //! Creates (n, n) matrix filled with T(0)
   explicit Matrix(size_t n)
-      : rows_(n, std::vector<T>(n, T(0))) {
-    if (n == 0) {
-      throw std::invalid_argument("Dimensions of the matrix must be non zero.");
-    }
-  }
+      : Matrix(std::make_pair(n, n)) {}
 
   //! Creates (n, n) matrix filled with value
   Matrix(size_t n, const T& value)
-      : rows_(n, std::vector<T>(n, value)) {
-    if (n == 0) {
-      throw std::invalid_argument("Dimensions of the matrix must be non zero.");
-    }
-  }
+      : Matrix(std::make_pair(n, n), value) {}
 
   //! Creates (n, n) matrix filled with values
   Matrix(size_t n, const std::vector<T>& values)
-      : rows_(toRows_(n, n, values)) {
-    if (n == 0) {
-      throw std::invalid_argument("Dimensions of the matrix must be non zero.");
-    }
-  }
+      : Matrix(std::make_pair(n, n), values) {}
 
   //! Creates (n, m) matrix filled with T(0)
   explicit Matrix(std::pair<size_t, size_t> size)
-      : rows_(size.first, std::vector<T>(size.second, T(0))) {
-    if ((size.first == 0) || (size.second == 0)) {
-      throw std::invalid_argument("Dimensions of the matrix must be non zero.");
-    }
-  }
+      : Matrix(size, T(0)) {}
 
   //! Creates (n, m) matrix filled with value
   Matrix(std::pair<size_t, size_t> size, const T& value)
-      : rows_(size.first, std::vector<T>(size.second, value)) {
+      : size1_(size.first)
+      , size2_(size.second)
+      , values_(size.first * size.second, value) {
     if ((size.first == 0) || (size.second == 0)) {
       throw std::invalid_argument("Dimensions of the matrix must be non zero.");
     }
@@ -60,7 +59,9 @@ public:
 
   //! Creates (n, m) matrix filled with values
   Matrix(std::pair<size_t, size_t> size, const std::vector<T>& values)
-      : rows_(toRows_(size.first, size.second, values)) {
+      : size1_(size.first)
+      , size2_(size.second)
+      , values_(checkValues_(size.first, size.second, values)) {
     if ((size.first == 0) || (size.second == 0)) {
       throw std::invalid_argument("Dimensions of the matrix must be non zero.");
     }
@@ -68,25 +69,27 @@ public:
 
   //! Returns the number of rows
   size_t size1() const {
-    return rows_.size();
+    return size1_;
   }
 
   //! Returns the number of columns
   size_t size2() const {
-    return rows_.front().size();
+    return size2_;
   }
 
   //! Exchanges the content of matrices
   void swap(Matrix& other) {
-    std::swap(rows_, other.rows_);
+    std::swap(size1_, other.size1_);
+    std::swap(size2_, other.size2_);
+    std::swap(values_, other.values_);
   }
 
   T& operator()(size_t i, size_t j) {
-    return rows_[i][j];
+    return values_[i * size2_ + j];
   }
 
   const T& operator()(size_t i, size_t j) const {
-    return rows_[i][j];
+    return values_[i * size2_ + j];
   }
 
   bool operator==(const Matrix& other) const {
@@ -94,11 +97,9 @@ public:
       return false;
     }
 
-    for (size_t i = 0; i < size1(); ++i) {
-      for (size_t j = 0; j < size2(); ++j) {
-        if (rows_[i][j] != other.rows_[i][j]) {
-          return false;
-        }
+    for (size_t i = 0; i < values_.size(); ++i) {
+      if (values_[i] != other.values_[i]) {
+        return false;
       }
     }
 
@@ -110,7 +111,7 @@ public:
   }
 
   bool operator==(const T& val) const {
-    return (size1() == 1) && (size2() == 1) && (rows_[0][0] == val);
+    return (size1() == 1) && (size2() == 1) && (values_[0] == val);
   }
 
   bool operator!=(const T& val) const {
@@ -118,41 +119,21 @@ public:
   }
 
   Matrix& operator*=(const T& coef) {
-    for (size_t i = 0; i < size1(); ++i) {
-      for (size_t j = 0; j < size2(); ++j) {
-        rows_[i][j] *= coef;
-      }
+    for (auto& value : values_) {
+      value *= coef;
     }
 
     return *this;
   }
 
+  //! Multiplies by the tiled i-k-j kernel, large products are computed by several threads (see crag::parallel).
   Matrix& operator*=(const Matrix& other) {
     if ((size1() != other.size1()) || (size2() != other.size2())) {
       throw std::invalid_argument("Dimensions of matrices don't match.");
     }
 
-    std::vector<std::vector<T>> new_rows;
-    new_rows.reserve(size1());
-
-    for (size_t i = 0; i < size1(); ++i) {
-      std::vector<T> row;
-      row.reserve(other.size2());
-
-      for (size_t j = 0; j < other.size2(); ++j) {
-        T m_ij = rows_[i][0] * other.rows_[0][j];
-
-        for (size_t k = 1; k < size2(); ++k) {
-          m_ij += rows_[i][k] * other.rows_[k][j];
-        }
-
-        row.push_back(std::move(m_ij));
-      }
-
-      new_rows.push_back(std::move(row));
-    }
-
-    rows_ = std::move(new_rows);
+    values_ = multiply_(*this, other);
+    size2_ = other.size2_;
 
     return *this;
   }
@@ -162,10 +143,8 @@ public:
       throw std::invalid_argument("Dimensions of matrices don't match.");
     }
 
-    for (size_t i = 0; i < size1(); ++i) {
-      for (size_t j = 0; j < size2(); ++j) {
-        rows_[i][j] += other.rows_[i][j];
-      }
+    for (size_t i = 0; i < values_.size(); ++i) {
+      values_[i] += other.values_[i];
     }
 
     return *this;
@@ -176,10 +155,8 @@ public:
       throw std::invalid_argument("Dimensions of matrices don't match.");
     }
 
-    for (size_t i = 0; i < size1(); ++i) {
-      for (size_t j = 0; j < size2(); ++j) {
-        rows_[i][j] -= other.rows_[i][j];
-      }
+    for (size_t i = 0; i < values_.size(); ++i) {
+      values_[i] -= other.values_[i];
     }
 
     return *this;
@@ -188,24 +165,73 @@ public:
   std::string toString() const;
 
 private:
-  std::vector<std::vector<T>> rows_;
+  size_t size1_;
+  size_t size2_;
+  std::vector<T> values_;
 
-  std::vector<std::vector<T>> toRows_(size_t n, size_t m, const std::vector<T>& values) {
+  static std::vector<T> checkValues_(size_t n, size_t m, const std::vector<T>& values) {
     if ((n * m) != values.size()) {
       throw std::invalid_argument("Dimensions of the matrix doesn't match the number of values provided.");
     }
 
-    std::vector<std::vector<T>> rows;
-    rows.reserve(n);
+    return values;
+  }
 
-    auto it = values.begin();
+  //! Row-major values of a * b.
+  //! Rows are processed in tiles of MULTIPLICATION_BLOCK_SIZE, within a row tile the loops over k and j are tiled too,
+  //! so that a tile of b stays in cache while it is applied to all rows of the tile, and the innermost loop
+  //! runs over contiguous rows of b and of the result.
+  static std::vector<T> multiply_(const Matrix& a, const Matrix& b) {
+    const auto n = a.size1_;
+    const auto inner = a.size2_;
+    const auto m = b.size2_;
+    const auto block = details::MULTIPLICATION_BLOCK_SIZE;
+
+    // the result starts with the first terms, so that T(0) is not required (e.g., multivariate polynomials need
+    // the number of variables)
+    std::vector<T> result;
+    result.reserve(n * m);
 
     for (size_t i = 0; i < n; ++i) {
-      rows.push_back(std::vector<T>(it, it + m));
-      it += m;
+      const auto& a_i0 = a.values_[i * inner];
+
+      for (size_t j = 0; j < m; ++j) {
+        result.push_back(a_i0 * b.values_[j]);
+      }
+    }
+
+    const auto multiply_rows = [&](size_t i0, size_t i1) {
+      for (size_t k0 = 1; k0 < inner; k0 += block) {
+        const auto k1 = std::min(inner, k0 + block);
+
+        for (size_t j0 = 0; j0 < m; j0 += block) {
+          const auto j1 = std::min(m, j0 + block);
+
+          for (size_t i = i0; i < i1; ++i) {
+            T* result_row = &result[i * m];
+
+            for (size_t k = k0; k < k1; ++k) {
+              const auto& a_ik = a.values_[i * inner + k];
+              const T* b_row = &b.values_[k * m];
+
+              for (size_t j = j0; j < j1; ++j) {
+                result_row[j] += a_ik * b_row[j];
+              }
+            }
+          }
+        }
+      }
+    };
+
+    const auto row_blocks = (n + block - 1) / block;
+
+    if ((row_blocks > 1) && (n * inner * m >= details::PARALLEL_MULTIPLICATION_THRESHOLD)) {
+      parallel::forEach(row_blocks, [&](size_t r) { multiply_rows(r * block, std::min(n, (r + 1) * block)); });
+    } else {
+      multiply_rows(0, n);
     }
 
-    return rows;
+    return result;
   }
 };
 
@@ -370,6 +396,82 @@ bool isSquare(const Matrix<T>& m) {
   return m.size1() == m.size2();
 }
 
+namespace details {
+//! Returns the (n, n) block of m with the upper left corner at (i0, j0), entries outside of m are T(0).
+template <typename T>
+Matrix<T> block(const Matrix<T>& m, size_t i0, size_t j0, size_t n) {
+  Matrix<T> result(n);
+
+  for (size_t i = i0; i < std::min(m.size1(), i0 + n); ++i) {
+    for (size_t j = j0; j < std::min(m.size2(), j0 + n); ++j) {
+      result(i - i0, j - j0) = m(i, j);
+    }
+  }
+
+  return result;
+}
+
+//! Copies the part of b that fits into m to m with the upper left corner at (i0, j0).
+template <typename T>
+void setBlock(Matrix<T>& m, size_t i0, size_t j0, const Matrix<T>& b) {
+  for (size_t i = i0; i < std::min(m.size1(), i0 + b.size1()); ++i) {
+    for (size_t j = j0; j < std::min(m.size2(), j0 + b.size2()); ++j) {
+      m(i, j) = b(i - i0, j - j0);
+    }
+  }
+}
+} // namespace details
+
+//! Product of square (n, n) matrices by Strassen's algorithm, blocks of dimension at most cutoff are multiplied
+//! by operator*. A matrix of odd dimension is padded by T(0).
+//! Every level replaces one block multiplication by 18 block additions, so it pays off for rings with cheap exact
+//! arithmetic (int, small finite fields) and a cutoff about a few hundreds, see benchmark_matrix.
+template <typename T>
+Matrix<T> strassen(const Matrix<T>& a, const Matrix<T>& b, size_t cutoff) {
+  if (!isSquare(a) || (a.size1() != b.size1()) || (a.size2() != b.size2())) {
+    throw std::invalid_argument("Dimensions of matrices don't match.");
+  }
+
+  if (cutoff == 0) {
+    throw std::invalid_argument("Cutoff of Strassen's algorithm must be non zero.");
+  }
+
+  const auto n = a.size1();
+
+  if (n <= cutoff) {
+    return a * b;
+  }
+
+  const auto h = (n + 1) / 2;
+
+  const auto a11 = details::block(a, 0, 0, h);
+  const auto a12 = details::block(a, 0, h, h);
+  const auto a21 = details::block(a, h, 0, h);
+  const auto a22 = details::block(a, h, h, h);
+
+  const auto b11 = details::block(b, 0, 0, h);
+  const auto b12 = details::block(b, 0, h, h);
+  const auto b21 = details::block(b, h, 0, h);
+  const auto b22 = details::block(b, h, h, h);
+
+  const auto m1 = strassen(a11 + a22, b11 + b22, cutoff);
+  const auto m2 = strassen(a21 + a22, b11, cutoff);
+  const auto m3 = strassen(a11, b12 - b22, cutoff);
+  const auto m4 = strassen(a22, b21 - b11, cutoff);
+  const auto m5 = strassen(a11 + a12, b22, cutoff);
+  const auto m6 = strassen(a21 - a11, b11 + b12, cutoff);
+  const auto m7 = strassen(a12 - a22, b21 + b22, cutoff);
+
+  Matrix<T> result(n);
+
+  details::setBlock(result, 0, 0, m1 + m4 - m5 + m7);
+  details::setBlock(result, 0, h, m3 + m5);
+  details::setBlock(result, h, 0, m2 + m4);
+  details::setBlock(result, h, h, m1 - m2 + m3 + m6);
+
+  return result;
+}
+
 template <typename T> T tr(const Matrix<T> &m) {
   if (m.size1() != m.size2()) {
     throw std::invalid_argument("Dimensions of the matrix don't match.");
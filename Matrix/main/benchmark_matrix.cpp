@@ -2,15 +2,124 @@
 
 #include <benchmark/benchmark.h>
 
+#include "FiniteField.h"
 #include "matrix.h"
+#include "parallel.h"
+
+using crag::matrix::Matrix;
+
+using ZZ251 = crag::finitefield::ZZ<251>;
+
+template <typename T>
+static Matrix<T> randomMatrix(size_t n, std::mt19937& g) {
+  std::uniform_int_distribution<> d(-10, 10);
+
+  Matrix<T> m(n);
+
+  for (size_t i = 0; i < n; ++i) {
+    for (size_t j = 0; j < n; ++j) {
+      m(i, j) = T(d(g));
+    }
+  }
+
+  return m;
+}
+
+//! Reference i-j-k kernel striding down the columns of b.
+template <typename T>
+static Matrix<T> naiveProduct(const Matrix<T>& a, const Matrix<T>& b) {
+  Matrix<T> result(a.size1());
+
+  for (size_t i = 0; i < a.size1(); ++i) {
+    for (size_t j = 0; j < b.size2(); ++j) {
+      T m_ij = a(i, 0) * b(0, j);
+
+      for (size_t k = 1; k < a.size2(); ++k) {
+        m_ij += a(i, k) * b(k, j);
+      }
+
+      result(i, j) = m_ij;
+    }
+  }
+
+  return result;
+}
+
+//! Reports the rate of the 2 n^3 ring operations of the classical algorithm, whatever the kernel does.
+static void setCounters(benchmark::State& state, size_t n) {
+  state.SetComplexityN(n);
+  state.counters["GFLOPS"] =
+      benchmark::Counter(2.0 * n * n * n / 1e9, benchmark::Counter::kIsIterationInvariantRate);
+}
+
+template <typename T>
+static void BM_NaiveMultiplication(benchmark::State& state) {
+  std::mt19937 g(1233);
+  const size_t n = state.range(0);
+  const auto a = randomMatrix<T>(n, g);
+  const auto b = randomMatrix<T>(n, g);
+
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(naiveProduct(a, b));
+  }
+
+  setCounters(state, n);
+}
+
+template <typename T>
+static void BM_TiledMultiplication(benchmark::State& state) {
+  std::mt19937 g(1233);
+  const size_t n = state.range(0);
+  const auto a = randomMatrix<T>(n, g);
+  const auto b = randomMatrix<T>(n, g);
+
+  const auto threads_count = crag::parallel::getThreadsCount();
+  crag::parallel::setThreadsCount(1);
+
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(a * b);
+  }
+
+  crag::parallel::setThreadsCount(threads_count);
+
+  setCounters(state, n);
+}
+
+template <typename T>
+static void BM_ParallelMultiplication(benchmark::State& state) {
+  std::mt19937 g(1233);
+  const size_t n = state.range(0);
+  const auto a = randomMatrix<T>(n, g);
+  const auto b = randomMatrix<T>(n, g);
+
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(a * b);
+  }
+
+  setCounters(state, n);
+}
+
+template <typename T>
+static void BM_StrassenMultiplication(benchmark::State& state) {
+  std::mt19937 g(1233);
+  const size_t n = state.range(0);
+  const auto a = randomMatrix<T>(n, g);
+  const auto b = randomMatrix<T>(n, g);
+
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(crag::matrix::strassen(a, b, state.range(1)));
+  }
+
+  setCounters(state, n);
+}
 
 static void BM_MatrixMultiplication(benchmark::State& state) {
   std::mt19937 g(1233);
   std::uniform_int_distribution<> d(-10, 10);
 
   size_t n = state.range(0);
-  
-  while (state.KeepRunning()) { 
+
+  while (state.KeepRunning()) {
     crag::matrix::Matrix<int> a(state.range(0));
     crag::matrix::Matrix<int> b(state.range(0));
 
@@ -24,10 +133,22 @@ static void BM_MatrixMultiplication(benchmark::State& state) {
     benchmark::DoNotOptimize(a * b);
   }
 
-  state.SetComplexityN(state.range(0));
+  setCounters(state, n);
 }
 
 
 BENCHMARK(BM_MatrixMultiplication)->RangeMultiplier(2)->Range(1, 512)->Complexity();
 
+BENCHMARK_TEMPLATE(BM_NaiveMultiplication, int)->RangeMultiplier(2)->Range(16, 512)->Complexity();
+BENCHMARK_TEMPLATE(BM_TiledMultiplication, int)->RangeMultiplier(2)->Range(16, 512)->Complexity();
+BENCHMARK_TEMPLATE(BM_ParallelMultiplication, int)->RangeMultiplier(2)->Range(16, 512)->Complexity();
+BENCHMARK_TEMPLATE(BM_StrassenMultiplication, int)
+    ->ArgsProduct({{256, 512, 1024}, {64, 128, 256}});
+
+BENCHMARK_TEMPLATE(BM_NaiveMultiplication, ZZ251)->RangeMultiplier(2)->Range(16, 512)->Complexity();
+BENCHMARK_TEMPLATE(BM_TiledMultiplication, ZZ251)->RangeMultiplier(2)->Range(16, 512)->Complexity();
+BENCHMARK_TEMPLATE(BM_ParallelMultiplication, ZZ251)->RangeMultiplier(2)->Range(16, 512)->Complexity();
+BENCHMARK_TEMPLATE(BM_StrassenMultiplication, ZZ251)
+    ->ArgsProduct({{256, 512, 1024}, {64, 128, 256}});
+
 BENCHMARK_MAIN();
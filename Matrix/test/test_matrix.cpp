@@ -1,5 +1,7 @@
 #include <gtest/gtest.h>
 
+#include <random>
+
 #include "matrix.h"
 
 namespace crag {
@@ -70,6 +72,62 @@ TEST(Matrix, Test_CharPoly_1) {
   EXPECT_EQ(std::vector<double>({16, -32, 24, -8, 1}),  charPoly(Matrix<double>(4, {1, 1, 0, 0, -1, 3, 0, 0, -6, 8, -1, 1, -16, 22, -9, 5})));
 }
 
+Matrix<int> randomMatrix(size_t n, std::mt19937& g) {
+  std::uniform_int_distribution<> d(-10, 10);
+
+  Matrix<int> m(n);
+
+  for (size_t i = 0; i < n; ++i) {
+    for (size_t j = 0; j < n; ++j) {
+      m(i, j) = d(g);
+    }
+  }
+
+  return m;
+}
+
+Matrix<int> naiveProduct(const Matrix<int>& a, const Matrix<int>& b) {
+  Matrix<int> result(std::make_pair(a.size1(), b.size2()));
+
+  for (size_t i = 0; i < a.size1(); ++i) {
+    for (size_t j = 0; j < b.size2(); ++j) {
+      for (size_t k = 0; k < a.size2(); ++k) {
+        result(i, j) += a(i, k) * b(k, j);
+      }
+    }
+  }
+
+  return result;
+}
+
+TEST(Matrix, TiledMultiplication) {
+  std::mt19937 g(1233);
+
+  // below, at and above the tile size, and large enough for the multi-threaded path
+  for (size_t n : {1, 2, 7, 63, 64, 65, 129, 200}) {
+    const auto a = randomMatrix(n, g);
+    const auto b = randomMatrix(n, g);
+
+    EXPECT_EQ(naiveProduct(a, b), a * b);
+  }
+}
+
+TEST(Matrix, Strassen) {
+  std::mt19937 g(1233);
+
+  for (size_t n : {1, 2, 3, 5, 8, 17, 33, 100}) {
+    const auto a = randomMatrix(n, g);
+    const auto b = randomMatrix(n, g);
+
+    for (size_t cutoff : {1, 2, 16}) {
+      EXPECT_EQ(naiveProduct(a, b), strassen(a, b, cutoff));
+    }
+  }
+
+  EXPECT_THROW(strassen(unit<int>(2), unit<int>(3), 1), std::invalid_argument);
+  EXPECT_THROW(strassen(unit<int>(2), unit<int>(2), 0), std::invalid_argument);
+}
+
 } // namespace
 } // namespace matrix
 } // namespace crag
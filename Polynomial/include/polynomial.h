@@ -3,51 +3,117 @@
 #ifndef CRAG_POLYNOMIAL_H
 #define CRAG_POLYNOMIAL_H
 
+#include <algorithm>
+#include <cstdint>
 #include <functional>
-#include <map>
+#include <iterator>
+#include <memory>
 #include <sstream>
 #include <string>
 #include <type_traits>
 #include <unordered_set>
+#include <utility>
 #include <vector>
 
+#include <boost/container/small_vector.hpp>
+
 #include "monomial.h"
 
 namespace crag {
 namespace polynomials {
 
-template <typename T, typename ExponentType, typename TermCompare = std::less<Term<ExponentType>>>
+//! Sum of monomials with coefficients in T, i.e. a polynomial (or a Laurent polynomial for signed ExponentType).
+//! Terms are kept sorted in the lexicographic order of their exponents without any per-term allocations:
+//! exponents of a term are packed into fields of 8, 16 or 32 bits of a few 64-bit words (signed exponents are stored
+//! with an offset of a half of the field range), and coefficients are kept in a separate array.
+//! Fields are made wider as soon as exponents don't fit them anymore.
+template <typename T, typename ExponentType>
 class MonomialSum {
 public:
   using exponent_t = ExponentType;
   using term_t = Term<ExponentType>;
   using monomial_t = Monomial<T, ExponentType>;
-  using MonomialMap = std::map<term_t, T, TermCompare>;
-  using const_iterator = typename MonomialMap::const_iterator;
+
+  //! Iterates over pairs (term, coefficient) in the increasing order of terms, terms are unpacked on access.
+  class const_iterator {
+  public:
+    using value_type = std::pair<term_t, T>;
+    using reference = value_type;
+    using difference_type = std::ptrdiff_t;
+    using iterator_category = std::input_iterator_tag;
+
+    class pointer {
+    public:
+      explicit pointer(value_type value)
+          : value_(std::move(value)) {}
+
+      const value_type* operator->() const {
+        return &value_;
+      }
+
+    private:
+      value_type value_;
+    };
+
+    const_iterator(const MonomialSum* sum, size_t index)
+        : sum_(sum)
+        , index_(index) {}
+
+    value_type operator*() const {
+      return value_type(sum_->term(index_), sum_->coef(index_));
+    }
+
+    pointer operator->() const {
+      return pointer(**this);
+    }
+
+    const_iterator& operator++() {
+      ++index_;
+      return *this;
+    }
+
+    const_iterator operator++(int) {
+      auto result = *this;
+      ++index_;
+      return result;
+    }
+
+    bool operator==(const const_iterator& other) const {
+      return (sum_ == other.sum_) && (index_ == other.index_);
+    }
+
+    bool operator!=(const const_iterator& other) const {
+      return !(*this == other);
+    }
+
+  private:
+    const MonomialSum* sum_;
+    size_t index_;
+  };
 
   //! Constructs empty monomial sum of given dimension
   explicit MonomialSum(size_t dimension)
-      : dimension_(dimension) {
+      : dimension_(dimension)
+      , bits_(8)
+      , words_(wordsPerTerm_(bits_)) {
     if (dimension_ < 2) {
       throw std::invalid_argument("Multivariate polynomial requires at least 2 variables.");
     }
   }
 
   explicit MonomialSum(const monomial_t& monomial)
-      : dimension_(monomial.dimension())
-      , monomials_({{monomial.term(), monomial.coef()}}) {}
+      : MonomialSum(monomial.dimension()) {
+    (*this) += monomial;
+  }
 
   MonomialSum(const T& coef, const term_t& term)
-      : dimension_(term.size())
-      , monomials_({{term, coef}}) {
-    if (dimension_ < 2) {
-      throw std::invalid_argument("Multivariate polynomial requires at least 2 variables.");
-    }
+      : MonomialSum(term.size()) {
+    (*this) += monomial_t(coef, term);
   }
 
   //! Returns the number of monomials
   size_t size() const {
-    return monomials_.size();
+    return coefs_.size();
   }
 
   //! Returns the number of variables
@@ -56,16 +122,26 @@ public:
   }
 
   const_iterator begin() const {
-    return monomials_.begin();
+    return const_iterator(this, 0);
   }
 
   const_iterator end() const {
-    return monomials_.end();
+    return const_iterator(this, size());
+  }
+
+  //! Returns the term of the k-th monomial in the increasing order of terms
+  term_t term(size_t k) const {
+    return termOf_(key_(k), bits_);
+  }
+
+  //! Returns the coefficient of the k-th monomial in the increasing order of terms
+  const T& coef(size_t k) const {
+    return coefs_[k];
   }
 
   //! Checks if the sum is actually zero
   bool isZero() const {
-    return monomials_.empty();
+    return coefs_.empty();
   }
 
   //! Checks if the sum is actually a number
@@ -78,14 +154,18 @@ public:
       return false;
     }
 
-    const auto term = monomials_.begin()->first;
+    for (size_t i = 0; i < dimension_; ++i) {
+      if (exponent_(key_(0), i, bits_) != 0) {
+        return false;
+      }
+    }
 
-    return std::all_of(term.begin(), term.end(), [](const ExponentType& e) { return e == 0; });
+    return true;
   }
 
   //! Checks if the sum is actually unit
   bool isUnit() const {
-    return (monomials_.size() == 1) && (monomials_.begin()->second == T(1)) && isNumber();
+    return (size() == 1) && (coefs_[0] == T(1)) && isNumber();
   }
 
   MonomialSum& operator+=(const monomial_t& monomial) {
@@ -97,33 +177,34 @@ public:
       return *this;
     }
 
-    auto it = monomials_.find(monomial.term());
+    const auto range = termRange_(monomial.term());
+    widen_(fieldBits_(range.first, range.second));
+    extendRange_(range);
 
-    if (it == monomials_.end()) {
-      // add new term
-      monomials_.emplace(monomial.term(), monomial.coef());
-    } else {
+    small_key_t key(words_);
+    pack_(monomial.term(), bits_, key.data());
+
+    const auto k = lowerBound_(key.data());
+
+    if ((k < size()) && std::equal(key.begin(), key.end(), key_(k))) {
       // update coef of existing term
-      it->second += monomial.coef();
+      coefs_[k] += monomial.coef();
 
-      if (it->second == T(0)) {
-        monomials_.erase(it);
+      if (coefs_[k] == T(0)) {
+        keys_.erase(keys_.begin() + k * words_, keys_.begin() + (k + 1) * words_);
+        coefs_.erase(coefs_.begin() + k);
       }
+    } else {
+      // add new term
+      keys_.insert(keys_.begin() + k * words_, key.begin(), key.end());
+      coefs_.insert(coefs_.begin() + k, monomial.coef());
     }
 
     return *this;
   }
 
   MonomialSum& operator+=(const MonomialSum& other) {
-    if (dimension_ != other.dimension_) {
-      throw std::invalid_argument("Dimensions of polynomials don't match.");
-    }
-
-    for (const auto& it : other) {
-      (*this) += monomial_t(it.second, it.first);
-    }
-
-    return *this;
+    return merge_(other, false);
   }
 
   MonomialSum& operator+=(const term_t& term) {
@@ -139,15 +220,7 @@ public:
   }
 
   MonomialSum& operator-=(const MonomialSum& other) {
-    if (dimension_ != other.dimension_) {
-      throw std::invalid_argument("Dimensions of polynomials don't match.");
-    }
-
-    for (const auto& it : other) {
-      (*this) += monomial_t(-it.second, it.first);
-    }
-
-    return *this;
+    return merge_(other, true);
   }
 
   MonomialSum& operator-=(const term_t& term) {
@@ -163,25 +236,110 @@ public:
     return result *= -T(1);
   }
 
+  //! Multiplies by the heap merge of the products of the terms of the shorter sum with the terms of the longer one.
   MonomialSum& operator*=(const MonomialSum& other) {
     if (dimension_ != other.dimension_) {
       throw std::invalid_argument("Dimensions of polynomials don't match.");
     }
 
-    MonomialSum result(dimension_);
+    if (isZero() || other.isZero()) {
+      clear_();
+      return *this;
+    }
+
+    if (other.size() == 1) {
+      return multiplyByTerm_(other, false);
+    }
+
+    if (size() == 1) {
+      const auto factor = *this;
+      *this = other;
+      return multiplyByTerm_(factor, true);
+    }
+
+    auto lhs_range = range_;
+    auto rhs_range = other.range_;
+
+    if (!fits_(std::max(bits_, other.bits_), lhs_range.first + rhs_range.first, lhs_range.second + rhs_range.second)) {
+      lhs_range = range_ = exactRange_();
+      rhs_range = other.exactRange_();
+    }
+
+    const auto range = std::make_pair(lhs_range.first + rhs_range.first, lhs_range.second + rhs_range.second);
+
+    widen_(std::max(other.bits_, fieldBits_(range.first, range.second)));
+    std::unique_ptr<MonomialSum> storage;
+    const auto& rhs = widened_(other, bits_, storage);
+
+    // every term of the shorter sum gives a sorted stream of products with the terms of the longer one
+    const bool lhs_streams = size() <= rhs.size();
+    const auto& streams = lhs_streams ? *this : rhs;
+    const auto& factors = lhs_streams ? rhs : *this;
+
+    const auto offset = offsetKey_(bits_);
+    const auto words = words_;
 
-    for (const auto& this_monomial : monomials_) {
-      for (const auto& other_monomial : other.monomials_) {
-        auto m = monomial_t(this_monomial.second, this_monomial.first);
+    std::vector<size_t> positions(streams.size(), 0);
+    std::vector<uint64_t> products(streams.size() * words);
 
-        m *= other_monomial.first;
-        m *= other_monomial.second;
+    const auto product = [&](size_t s) { return &products[s * words]; };
 
-        result += m;
+    const auto computeProduct = [&](size_t s) {
+      addKeys_(streams.key_(s), factors.key_(positions[s]), offset.data(), words, product(s));
+    };
+
+    // std heap functions build a max-heap, so the comparison is reversed
+    const auto greater = [&](size_t a, size_t b) {
+      return std::lexicographical_compare(product(b), product(b) + words, product(a), product(a) + words);
+    };
+
+    std::vector<size_t> heap(streams.size());
+    for (size_t s = 0; s < streams.size(); ++s) {
+      heap[s] = s;
+      computeProduct(s);
+    }
+    std::make_heap(heap.begin(), heap.end(), greater);
+
+    std::vector<uint64_t> keys;
+    std::vector<T> coefs;
+    keys.reserve(std::max(keys_.size(), rhs.keys_.size()));
+    coefs.reserve(std::max(size(), rhs.size()));
+
+    while (!heap.empty()) {
+      std::pop_heap(heap.begin(), heap.end(), greater);
+      const auto s = heap.back();
+
+      const auto coef = lhs_streams ? streams.coefs_[s] * factors.coefs_[positions[s]]
+                                    : factors.coefs_[positions[s]] * streams.coefs_[s];
+
+      if (!coefs.empty() && std::equal(product(s), product(s) + words, keys.end() - words)) {
+        coefs.back() += coef;
+      } else {
+        if (!coefs.empty() && (coefs.back() == T(0))) {
+          keys.resize(keys.size() - words);
+          coefs.pop_back();
+        }
+
+        keys.insert(keys.end(), product(s), product(s) + words);
+        coefs.push_back(coef);
       }
+
+      if (++positions[s] < factors.size()) {
+        computeProduct(s);
+        std::push_heap(heap.begin(), heap.end(), greater);
+      } else {
+        heap.pop_back();
+      }
+    }
+
+    if (!coefs.empty() && (coefs.back() == T(0))) {
+      keys.resize(keys.size() - words);
+      coefs.pop_back();
     }
 
-    monomials_ = result.monomials_;
+    keys_ = std::move(keys);
+    coefs_ = std::move(coefs);
+    range_ = range;
 
     return *this;
   }
@@ -191,7 +349,7 @@ public:
       throw std::invalid_argument("Dimensions of polynomials don't match.");
     }
 
-    return (*this) *= (MonomialSum(dimension_) + monomial);
+    return (*this) *= MonomialSum(monomial);
   }
 
   MonomialSum& operator*=(const term_t& term) {
@@ -200,11 +358,11 @@ public:
 
   MonomialSum& operator*=(const T& coef) {
     if (coef == T(0)) {
-      monomials_.clear();
+      clear_();
     }
 
-    for (auto& it : monomials_) {
-      it.second *= coef;
+    for (auto& c : coefs_) {
+      c *= coef;
     }
 
     return *this;
@@ -224,12 +382,56 @@ public:
     return (*this) *= inverse_term;
   }
 
+  //! Returns the sum with every variable x_i replaced by x_{target[i]}, target must be a permutation of the variables.
+  template <typename Target>
+  MonomialSum permuteVariables(const Target& target) const {
+    MonomialSum result(*this);
+
+    std::vector<uint64_t> keys(keys_.size());
+    for (size_t k = 0; k < size(); ++k) {
+      const auto key = key_(k);
+      auto permuted = &keys[k * words_];
+
+      for (size_t i = 0; i < dimension_; ++i) {
+        setExponent_(permuted, target[i], exponent_(key, i, bits_), bits_);
+      }
+    }
+
+    // the order of terms changes, so they are sorted again
+    std::vector<size_t> order(size());
+    for (size_t k = 0; k < order.size(); ++k) {
+      order[k] = k;
+    }
+
+    std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+      return std::lexicographical_compare(
+          &keys[a * words_], &keys[a * words_] + words_, &keys[b * words_], &keys[b * words_] + words_);
+    });
+
+    for (size_t k = 0; k < order.size(); ++k) {
+      std::copy(&keys[order[k] * words_], &keys[order[k] * words_] + words_, &result.keys_[k * words_]);
+      result.coefs_[k] = coefs_[order[k]];
+    }
+
+    return result;
+  }
+
   bool operator==(const MonomialSum& other) const {
     if (dimension_ != other.dimension_) {
       throw std::invalid_argument("Dimensions of polynomials don't match.");
     }
 
-    return monomials_ == other.monomials_;
+    if (coefs_ != other.coefs_) {
+      return false;
+    }
+
+    if (bits_ == other.bits_) {
+      return keys_ == other.keys_;
+    }
+
+    std::unique_ptr<MonomialSum> storage;
+    const auto bits = std::max(bits_, other.bits_);
+    return widened_(*this, bits, storage).keys_ == widened_(other, bits, storage).keys_;
   }
 
   bool operator!=(const MonomialSum& other) const {
@@ -249,9 +451,7 @@ public:
       return false;
     }
 
-    const auto it = monomials_.begin();
-
-    return (it->second == monomial.coef()) && (it->first == monomial.term());
+    return (coefs_[0] == monomial.coef()) && (term(0) == monomial.term());
   }
 
   bool operator!=(const monomial_t& monomial) const {
@@ -271,7 +471,7 @@ public:
       return isZero();
     }
 
-    return isNumber() && (monomials_.begin()->second == coef);
+    return isNumber() && (coefs_[0] == coef);
   }
 
   bool operator!=(const T& coef) const {
@@ -294,195 +494,466 @@ public:
 
 private:
   size_t dimension_;
-  MonomialMap monomials_;
+
+  //! width of the exponent fields, 8, 16 or 32
+  unsigned bits_;
+
+  //! 64-bit words per term
+  size_t words_;
+
+  //! packed terms in the increasing order, words_ per term
+  std::vector<uint64_t> keys_;
+
+  std::vector<T> coefs_;
+
+  //! a single key, most terms fit into a few words
+  using small_key_t = boost::container::small_vector<uint64_t, 4>;
+
+  //! bounds (not necessarily exact) of the exponents of all terms
+  std::pair<int64_t, int64_t> range_ = {0, 0};
+
+  // Variable i is stored in the field i % (64 / bits) of the word i / (64 / bits), fields are counted from the most
+  // significant bits. Since the offset doesn't change the order of exponents, the lexicographic order of the words of
+  // two terms is the lexicographic order of their exponents.
+
+  static int64_t offset_(unsigned bits) {
+    return std::is_signed<ExponentType>::value ? (int64_t(1) << (bits - 1)) : 0;
+  }
+
+  static bool fits_(unsigned bits, int64_t min, int64_t max) {
+    return (min >= -offset_(bits)) && (max < (int64_t(1) << bits) - offset_(bits));
+  }
+
+  static unsigned fieldBits_(int64_t min, int64_t max) {
+    for (unsigned bits : {8, 16}) {
+      if (fits_(bits, min, max)) {
+        return bits;
+      }
+    }
+
+    return 32;
+  }
+
+  size_t wordsPerTerm_(unsigned bits) const {
+    const size_t fields = 64 / bits;
+    return (dimension_ + fields - 1) / fields;
+  }
+
+  static int64_t exponent_(const uint64_t* key, size_t i, unsigned bits) {
+    const size_t fields = 64 / bits;
+    const auto shift = 64 - bits * (i % fields + 1);
+    const auto mask = (uint64_t(1) << bits) - 1;
+
+    return static_cast<int64_t>((key[i / fields] >> shift) & mask) - offset_(bits);
+  }
+
+  //! Sets the field of a key, the field must be zero
+  static void setExponent_(uint64_t* key, size_t i, int64_t exponent, unsigned bits) {
+    const size_t fields = 64 / bits;
+    const auto shift = 64 - bits * (i % fields + 1);
+    const auto mask = (uint64_t(1) << bits) - 1;
+
+    key[i / fields] |= (static_cast<uint64_t>(exponent + offset_(bits)) & mask) << shift;
+  }
+
+  term_t termOf_(const uint64_t* key, unsigned bits) const {
+    term_t result(dimension_);
+
+    for (size_t i = 0; i < dimension_; ++i) {
+      result[i] = static_cast<ExponentType>(exponent_(key, i, bits));
+    }
+
+    return result;
+  }
+
+  void pack_(const term_t& term, unsigned bits, uint64_t* key) const {
+    std::fill(key, key + wordsPerTerm_(bits), 0);
+
+    for (size_t i = 0; i < dimension_; ++i) {
+      setExponent_(key, i, term[i], bits);
+    }
+  }
+
+  //! Key of the term with zero exponents, the sum of the keys of two terms minus it is the key of their product
+  small_key_t offsetKey_(unsigned bits) const {
+    small_key_t key(wordsPerTerm_(bits), 0);
+
+    for (size_t i = 0; i < dimension_; ++i) {
+      setExponent_(key.data(), i, 0, bits);
+    }
+
+    return key;
+  }
+
+  //! Fields don't overflow if the exponents of the product fit them, so no carry crosses fields
+  //! (the subtraction of the offset may wrap around, but the final value is exact).
+  static void addKeys_(const uint64_t* a, const uint64_t* b, const uint64_t* offset, size_t words, uint64_t* result) {
+    for (size_t w = 0; w < words; ++w) {
+      result[w] = a[w] + b[w] - offset[w];
+    }
+  }
+
+  const uint64_t* key_(size_t k) const {
+    return &keys_[k * words_];
+  }
+
+  //! Index of the first term which is not less than key
+  size_t lowerBound_(const uint64_t* key) const {
+    size_t first = 0;
+    size_t count = size();
+
+    while (count > 0) {
+      const auto step = count / 2;
+      const auto k = first + step;
+
+      if (std::lexicographical_compare(key_(k), key_(k) + words_, key, key + words_)) {
+        first = k + 1;
+        count -= step + 1;
+      } else {
+        count = step;
+      }
+    }
+
+    return first;
+  }
+
+  static std::pair<int64_t, int64_t> termRange_(const term_t& term) {
+    const auto minmax = std::minmax_element(term.begin(), term.end());
+    return {*minmax.first, *minmax.second};
+  }
+
+  void extendRange_(const std::pair<int64_t, int64_t>& range) {
+    range_.first = std::min(range_.first, range.first);
+    range_.second = std::max(range_.second, range.second);
+  }
+
+  std::pair<int64_t, int64_t> exactRange_() const {
+    std::pair<int64_t, int64_t> range(0, 0);
+
+    for (size_t k = 0; k < size(); ++k) {
+      for (size_t i = 0; i < dimension_; ++i) {
+        const auto e = exponent_(key_(k), i, bits_);
+        range.first = std::min(range.first, e);
+        range.second = std::max(range.second, e);
+      }
+    }
+
+    return range;
+  }
+
+  //! Repacks the terms if fields of the given width are wider than the current ones
+  void widen_(unsigned bits) {
+    if (bits <= bits_) {
+      return;
+    }
+
+    const auto words = wordsPerTerm_(bits);
+    std::vector<uint64_t> keys(size() * words, 0);
+
+    for (size_t k = 0; k < size(); ++k) {
+      for (size_t i = 0; i < dimension_; ++i) {
+        setExponent_(&keys[k * words], i, exponent_(key_(k), i, bits_), bits);
+      }
+    }
+
+    keys_ = std::move(keys);
+    bits_ = bits;
+    words_ = words;
+  }
+
+  //! Returns sum itself if its fields are of the given width, otherwise its copy with wider fields kept in storage
+  static const MonomialSum& widened_(const MonomialSum& sum, unsigned bits, std::unique_ptr<MonomialSum>& storage) {
+    if (sum.bits_ == bits) {
+      return sum;
+    }
+
+    storage.reset(new MonomialSum(sum));
+    storage->widen_(bits);
+    return *storage;
+  }
+
+  void clear_() {
+    keys_.clear();
+    coefs_.clear();
+    range_ = {0, 0};
+  }
+
+  //! Linear merge of two sorted sums
+  MonomialSum& merge_(const MonomialSum& other, bool subtract) {
+    if (dimension_ != other.dimension_) {
+      throw std::invalid_argument("Dimensions of polynomials don't match.");
+    }
+
+    if (other.isZero()) {
+      return *this;
+    }
+
+    if (isZero()) {
+      *this = other;
+      return subtract ? (*this) *= -T(1) : *this;
+    }
+
+    widen_(other.bits_);
+    std::unique_ptr<MonomialSum> storage;
+    const auto& rhs = widened_(other, bits_, storage);
+    extendRange_(other.range_);
+
+    std::vector<uint64_t> keys;
+    std::vector<T> coefs;
+    keys.reserve(keys_.size() + rhs.keys_.size());
+    coefs.reserve(size() + rhs.size());
+
+    const auto append = [&](const uint64_t* key, const T& coef) {
+      keys.insert(keys.end(), key, key + words_);
+      coefs.push_back(coef);
+    };
+
+    size_t a = 0;
+    size_t b = 0;
+
+    while ((a < size()) || (b < rhs.size())) {
+      if ((b == rhs.size())
+          || ((a < size())
+              && std::lexicographical_compare(key_(a), key_(a) + words_, rhs.key_(b), rhs.key_(b) + words_))) {
+        append(key_(a), coefs_[a]);
+        ++a;
+      } else if (
+          (a == size())
+          || std::lexicographical_compare(rhs.key_(b), rhs.key_(b) + words_, key_(a), key_(a) + words_)) {
+        append(rhs.key_(b), subtract ? -rhs.coefs_[b] : rhs.coefs_[b]);
+        ++b;
+      } else {
+        const auto coef = subtract ? coefs_[a] - rhs.coefs_[b] : coefs_[a] + rhs.coefs_[b];
+
+        if (coef != T(0)) {
+          append(key_(a), coef);
+        }
+
+        ++a;
+        ++b;
+      }
+    }
+
+    keys_ = std::move(keys);
+    coefs_ = std::move(coefs);
+
+    return *this;
+  }
+
+  //! Multiplies by the only monomial of factor (which may be this sum), on the left if factor_on_left is set.
+  //! Adding the same key to all terms doesn't change their order.
+  MonomialSum& multiplyByTerm_(const MonomialSum& factor, bool factor_on_left) {
+    const auto coef = factor.coefs_[0];
+    const auto factor_bits = factor.bits_;
+    small_key_t key(factor.key_(0), factor.key_(0) + factor.words_);
+
+    auto range = std::make_pair(range_.first + factor.range_.first, range_.second + factor.range_.second);
+
+    if (!fits_(std::max(bits_, factor.bits_), range.first, range.second)) {
+      range_ = exactRange_();
+      const auto factor_range = factor.exactRange_();
+      range = std::make_pair(range_.first + factor_range.first, range_.second + factor_range.second);
+    }
+
+    widen_(std::max(factor_bits, fieldBits_(range.first, range.second)));
+    if (factor_bits != bits_) {
+      const auto term = termOf_(key.data(), factor_bits);
+      key.resize(words_);
+      pack_(term, bits_, key.data());
+    }
+    const auto offset = offsetKey_(bits_);
+
+    size_t count = 0;
+
+    for (size_t k = 0; k < size(); ++k) {
+      const auto c = factor_on_left ? coef * coefs_[k] : coefs_[k] * coef;
+
+      if (c == T(0)) {
+        continue;
+      }
+
+      addKeys_(key_(k), key.data(), offset.data(), words_, &keys_[count * words_]);
+      coefs_[count++] = c;
+    }
+
+    keys_.resize(count * words_);
+    coefs_.resize(count);
+    range_ = range;
+
+    return *this;
+  }
 };
 
-template <typename T, typename ExponentType, typename TermCompare>
-MonomialSum<T, ExponentType, TermCompare>
-operator+(MonomialSum<T, ExponentType, TermCompare> lhs, const MonomialSum<T, ExponentType, TermCompare>& rhs) {
+template <typename T, typename ExponentType>
+MonomialSum<T, ExponentType> operator+(MonomialSum<T, ExponentType> lhs, const MonomialSum<T, ExponentType>& rhs) {
   lhs += rhs;
   return lhs;
 }
 
-template <typename T, typename ExponentType, typename TermCompare>
-MonomialSum<T, ExponentType, TermCompare>
-operator+(MonomialSum<T, ExponentType, TermCompare> lhs, const Monomial<T, ExponentType>& monomial) {
+template <typename T, typename ExponentType>
+MonomialSum<T, ExponentType> operator+(MonomialSum<T, ExponentType> lhs, const Monomial<T, ExponentType>& monomial) {
   lhs += monomial;
   return lhs;
 }
 
-template <typename T, typename ExponentType, typename TermCompare>
-MonomialSum<T, ExponentType, TermCompare>
-operator+(const Monomial<T, ExponentType>& monomial, MonomialSum<T, ExponentType, TermCompare> rhs) {
+template <typename T, typename ExponentType>
+MonomialSum<T, ExponentType> operator+(const Monomial<T, ExponentType>& monomial, MonomialSum<T, ExponentType> rhs) {
   rhs += monomial;
   return rhs;
 }
 
-template <typename T, typename ExponentType, typename TermCompare>
-MonomialSum<T, ExponentType, TermCompare>
-operator+(MonomialSum<T, ExponentType, TermCompare> lhs, const Term<ExponentType>& term) {
+template <typename T, typename ExponentType>
+MonomialSum<T, ExponentType> operator+(MonomialSum<T, ExponentType> lhs, const Term<ExponentType>& term) {
   lhs += term;
   return lhs;
 }
 
-template <typename T, typename ExponentType, typename TermCompare>
-MonomialSum<T, ExponentType, TermCompare>
-operator+(const Term<ExponentType>& term, MonomialSum<T, ExponentType, TermCompare> rhs) {
+template <typename T, typename ExponentType>
+MonomialSum<T, ExponentType> operator+(const Term<ExponentType>& term, MonomialSum<T, ExponentType> rhs) {
   rhs += term;
   return rhs;
 }
 
-template <typename T, typename ExponentType, typename TermCompare>
-MonomialSum<T, ExponentType, TermCompare> operator+(MonomialSum<T, ExponentType, TermCompare> lhs, const T& coef) {
+template <typename T, typename ExponentType>
+MonomialSum<T, ExponentType> operator+(MonomialSum<T, ExponentType> lhs, const T& coef) {
   lhs += coef;
   return lhs;
 }
 
-template <typename T, typename ExponentType, typename TermCompare>
-MonomialSum<T, ExponentType, TermCompare> operator+(const T& coef, MonomialSum<T, ExponentType, TermCompare> rhs) {
+template <typename T, typename ExponentType>
+MonomialSum<T, ExponentType> operator+(const T& coef, MonomialSum<T, ExponentType> rhs) {
   rhs += coef;
   return rhs;
 }
 
-template <typename T, typename ExponentType, typename TermCompare>
-MonomialSum<T, ExponentType, TermCompare>
-operator-(MonomialSum<T, ExponentType, TermCompare> lhs, const MonomialSum<T, ExponentType, TermCompare>& rhs) {
+template <typename T, typename ExponentType>
+MonomialSum<T, ExponentType> operator-(MonomialSum<T, ExponentType> lhs, const MonomialSum<T, ExponentType>& rhs) {
   lhs -= rhs;
   return lhs;
 }
 
-template <typename T, typename ExponentType, typename TermCompare>
-MonomialSum<T, ExponentType, TermCompare>
-operator-(MonomialSum<T, ExponentType, TermCompare> lhs, const Monomial<T, ExponentType>& monomial) {
+template <typename T, typename ExponentType>
+MonomialSum<T, ExponentType> operator-(MonomialSum<T, ExponentType> lhs, const Monomial<T, ExponentType>& monomial) {
   lhs -= monomial;
   return lhs;
 }
 
-template <typename T, typename ExponentType, typename TermCompare>
-MonomialSum<T, ExponentType, TermCompare>
-operator-(const Monomial<T, ExponentType>& monomial, MonomialSum<T, ExponentType, TermCompare> rhs) {
+template <typename T, typename ExponentType>
+MonomialSum<T, ExponentType> operator-(const Monomial<T, ExponentType>& monomial, MonomialSum<T, ExponentType> rhs) {
   rhs *= -T(1);
   rhs += monomial;
   return rhs;
 }
 
-template <typename T, typename ExponentType, typename TermCompare>
-MonomialSum<T, ExponentType, TermCompare>
-operator-(MonomialSum<T, ExponentType, TermCompare> lhs, const Term<ExponentType>& term) {
+template <typename T, typename ExponentType>
+MonomialSum<T, ExponentType> operator-(MonomialSum<T, ExponentType> lhs, const Term<ExponentType>& term) {
   lhs -= term;
   return lhs;
 }
 
-template <typename T, typename ExponentType, typename TermCompare>
-MonomialSum<T, ExponentType, TermCompare>
-operator-(const Term<ExponentType>& term, MonomialSum<T, ExponentType, TermCompare> rhs) {
+template <typename T, typename ExponentType>
+MonomialSum<T, ExponentType> operator-(const Term<ExponentType>& term, MonomialSum<T, ExponentType> rhs) {
   rhs *= -T(1);
   rhs += term;
   return rhs;
 }
 
-template <typename T, typename ExponentType, typename TermCompare>
-MonomialSum<T, ExponentType, TermCompare> operator-(MonomialSum<T, ExponentType, TermCompare> lhs, const T& coef) {
+template <typename T, typename ExponentType>
+MonomialSum<T, ExponentType> operator-(MonomialSum<T, ExponentType> lhs, const T& coef) {
   lhs -= coef;
   return lhs;
 }
 
-template <typename T, typename ExponentType, typename TermCompare>
-MonomialSum<T, ExponentType, TermCompare> operator-(const T& coef, MonomialSum<T, ExponentType, TermCompare> rhs) {
+template <typename T, typename ExponentType>
+MonomialSum<T, ExponentType> operator-(const T& coef, MonomialSum<T, ExponentType> rhs) {
   rhs *= -T(1);
   rhs += coef;
   return rhs;
 }
 
-template <typename T, typename ExponentType, typename TermCompare>
-MonomialSum<T, ExponentType, TermCompare>
-operator*(MonomialSum<T, ExponentType, TermCompare> lhs, const MonomialSum<T, ExponentType, TermCompare>& rhs) {
+template <typename T, typename ExponentType>
+MonomialSum<T, ExponentType> operator*(MonomialSum<T, ExponentType> lhs, const MonomialSum<T, ExponentType>& rhs) {
   lhs *= rhs;
   return lhs;
 }
 
-template <typename T, typename ExponentType, typename TermCompare>
-MonomialSum<T, ExponentType, TermCompare>
-operator*(MonomialSum<T, ExponentType, TermCompare> lhs, const Monomial<T, ExponentType>& monomial) {
+template <typename T, typename ExponentType>
+MonomialSum<T, ExponentType> operator*(MonomialSum<T, ExponentType> lhs, const Monomial<T, ExponentType>& monomial) {
   lhs *= monomial;
   return lhs;
 }
 
-template <typename T, typename ExponentType, typename TermCompare>
-MonomialSum<T, ExponentType, TermCompare>
-operator*(const Monomial<T, ExponentType>& monomial, MonomialSum<T, ExponentType, TermCompare> rhs) {
+template <typename T, typename ExponentType>
+MonomialSum<T, ExponentType> operator*(const Monomial<T, ExponentType>& monomial, MonomialSum<T, ExponentType> rhs) {
   rhs *= monomial;
   return rhs;
 }
 
-template <typename T, typename ExponentType, typename TermCompare>
-MonomialSum<T, ExponentType, TermCompare>
-operator*(MonomialSum<T, ExponentType, TermCompare> lhs, const Term<ExponentType>& term) {
+template <typename T, typename ExponentType>
+MonomialSum<T, ExponentType> operator*(MonomialSum<T, ExponentType> lhs, const Term<ExponentType>& term) {
   lhs *= term;
   return lhs;
 }
 
-template <typename T, typename ExponentType, typename TermCompare>
-MonomialSum<T, ExponentType, TermCompare>
-operator*(const Term<ExponentType>& term, MonomialSum<T, ExponentType, TermCompare> rhs) {
+template <typename T, typename ExponentType>
+MonomialSum<T, ExponentType> operator*(const Term<ExponentType>& term, MonomialSum<T, ExponentType> rhs) {
   rhs *= term;
   return rhs;
 }
 
-template <typename T, typename ExponentType, typename TermCompare>
-MonomialSum<T, ExponentType, TermCompare> operator*(MonomialSum<T, ExponentType, TermCompare> lhs, const T& coef) {
+template <typename T, typename ExponentType>
+MonomialSum<T, ExponentType> operator*(MonomialSum<T, ExponentType> lhs, const T& coef) {
   lhs *= coef;
   return lhs;
 }
 
-template <typename T, typename ExponentType, typename TermCompare>
-MonomialSum<T, ExponentType, TermCompare> operator*(const T& coef, MonomialSum<T, ExponentType, TermCompare> rhs) {
+template <typename T, typename ExponentType>
+MonomialSum<T, ExponentType> operator*(const T& coef, MonomialSum<T, ExponentType> rhs) {
   rhs *= coef;
   return rhs;
 }
 
 template <
-    typename T, typename ExponentType, typename TermCompare,
+    typename T, typename ExponentType,
     typename = typename std::enable_if<std::is_signed<ExponentType>::value>::type>
-MonomialSum<T, ExponentType, TermCompare>
-operator/(MonomialSum<T, ExponentType, TermCompare> lhs, const Term<ExponentType>& term) {
+MonomialSum<T, ExponentType> operator/(MonomialSum<T, ExponentType> lhs, const Term<ExponentType>& term) {
   lhs /= term;
   return lhs;
 }
 
-template <typename T, typename ExponentType, typename TermCompare>
-bool operator==(const Monomial<T, ExponentType>& monomial, const MonomialSum<T, ExponentType, TermCompare>& rhs) {
+template <typename T, typename ExponentType>
+bool operator==(const Monomial<T, ExponentType>& monomial, const MonomialSum<T, ExponentType>& rhs) {
   return rhs == monomial;
 }
 
-template <typename T, typename ExponentType, typename TermCompare>
-bool operator!=(const Monomial<T, ExponentType>& monomial, const MonomialSum<T, ExponentType, TermCompare>& rhs) {
+template <typename T, typename ExponentType>
+bool operator!=(const Monomial<T, ExponentType>& monomial, const MonomialSum<T, ExponentType>& rhs) {
   return !(rhs == monomial);
 }
 
-template <typename T, typename ExponentType, typename TermCompare>
-bool operator==(const Term<ExponentType>& term, const MonomialSum<T, ExponentType, TermCompare>& rhs) {
+template <typename T, typename ExponentType>
+bool operator==(const Term<ExponentType>& term, const MonomialSum<T, ExponentType>& rhs) {
   return rhs == term;
 }
 
-template <typename T, typename ExponentType, typename TermCompare>
-bool operator!=(const Term<ExponentType>& term, const MonomialSum<T, ExponentType, TermCompare>& rhs) {
+template <typename T, typename ExponentType>
+bool operator!=(const Term<ExponentType>& term, const MonomialSum<T, ExponentType>& rhs) {
   return !(rhs == term);
 }
 
-template <typename T, typename ExponentType, typename TermCompare>
-bool operator==(const T& coef, const MonomialSum<T, ExponentType, TermCompare>& rhs) {
+template <typename T, typename ExponentType>
+bool operator==(const T& coef, const MonomialSum<T, ExponentType>& rhs) {
   return rhs == coef;
 }
 
-template <typename T, typename ExponentType, typename TermCompare>
-bool operator!=(const T& coef, const MonomialSum<T, ExponentType, TermCompare>& rhs) {
+template <typename T, typename ExponentType>
+bool operator!=(const T& coef, const MonomialSum<T, ExponentType>& rhs) {
   return !(rhs == coef);
 }
 
-template <typename T, typename ExponentType, typename TermCompare>
+template <typename T, typename ExponentType>
 void print(
-    const MonomialSum<T, ExponentType, TermCompare>& p, const std::vector<std::string>& vars, std::ostream& out) {
+    const MonomialSum<T, ExponentType>& p, const std::vector<std::string>& vars, std::ostream& out) {
   if (p.dimension() != vars.size()) {
     throw std::invalid_argument("Number of variables doesn't match dimension of the polynomial.");
   }
@@ -531,8 +1002,8 @@ void print(
   }
 }
 
-template <typename T, typename ExponentType, typename TermCompare>
-void print(const MonomialSum<T, ExponentType, TermCompare>& p, const std::string& var, std::ostream& out) {
+template <typename T, typename ExponentType>
+void print(const MonomialSum<T, ExponentType>& p, const std::string& var, std::ostream& out) {
   std::vector<std::string> vars;
   vars.reserve(p.dimension());
 
@@ -543,39 +1014,39 @@ void print(const MonomialSum<T, ExponentType, TermCompare>& p, const std::string
   print(p, vars, out);
 }
 
-template <typename T, typename ExponentType, typename TermCompare>
-std::ostream& operator<<(std::ostream& out, const MonomialSum<T, ExponentType, TermCompare>& p) {
+template <typename T, typename ExponentType>
+std::ostream& operator<<(std::ostream& out, const MonomialSum<T, ExponentType>& p) {
   print(p, "x", out);
   return out;
 }
 
-template <typename T, typename ExponentType, typename TermCompare>
-std::string MonomialSum<T, ExponentType, TermCompare>::toString() const {
+template <typename T, typename ExponentType>
+std::string MonomialSum<T, ExponentType>::toString() const {
   return toString("x");
 }
 
-template <typename T, typename ExponentType, typename TermCompare>
-std::string MonomialSum<T, ExponentType, TermCompare>::toString(const std::string& var) const {
+template <typename T, typename ExponentType>
+std::string MonomialSum<T, ExponentType>::toString(const std::string& var) const {
   std::stringstream out;
   print(*this, var, out);
   return out.str();
 }
 
-template <typename T, typename ExponentType, typename TermCompare>
-std::string MonomialSum<T, ExponentType, TermCompare>::toString(const std::vector<std::string>& vars) const {
+template <typename T, typename ExponentType>
+std::string MonomialSum<T, ExponentType>::toString(const std::vector<std::string>& vars) const {
   std::stringstream out;
   print(*this, vars, out);
   return out.str();
 }
 
 //! Evaluates a polynomial at a point.
-template <typename T, typename ExponentType, typename TermCompare>
-T evaluate(const MonomialSum<T, ExponentType, TermCompare>& m, const std::vector<T>& values);
+template <typename T, typename ExponentType>
+T evaluate(const MonomialSum<T, ExponentType>& m, const std::vector<T>& values);
 
 //! Implementation for finite fields.
-template <typename Ideal, typename ExponentType, typename TermCompare>
+template <typename Ideal, typename ExponentType>
 FieldElement<Ideal> evaluate(
-    const MonomialSum<FieldElement<Ideal>, ExponentType, TermCompare>& m,
+    const MonomialSum<FieldElement<Ideal>, ExponentType>& m,
     const std::vector<FieldElement<Ideal>>& values) {
   if (m.dimension() != values.size()) {
     throw std::invalid_argument("The number of values provided doesn't match dimension of the polynomial.");
@@ -1,5 +1,8 @@
 #include <gtest/gtest.h>
 
+#include <map>
+#include <random>
+
 #include "polynomial.h"
 
 namespace crag {
@@ -228,6 +231,126 @@ TEST(Polynomial, Evaluation_2) {
   const auto p = LaurentPolynomial<GF5>(2) + LaurentMonomial<GF5>({-2, 3});
   EXPECT_THROW({ evaluate(p, {GF5(0), GF5(1)}); }, std::logic_error);
 }
+TEST(LaurentPolynomial, WideExponents) {
+  const auto x = IntLaurentPolynomial(2) + IntLaurentMonomial({100, -1});
+  const auto y = IntLaurentPolynomial(2) + IntLaurentMonomial({-100, 1});
+
+  EXPECT_EQ("x_1^200 * x_2^-2", (x * x).toString());
+
+  // fields of 8, 16 and 32 bits are used one after another
+  auto power = x;
+  for (int i = 1; i < 400; ++i) {
+    power *= x;
+  }
+  EXPECT_EQ("x_1^40000 * x_2^-400", power.toString());
+  EXPECT_TRUE((x * y).isUnit());
+  EXPECT_EQ(x * x * y, x);
+}
+
+//! Straightforward sum of monomials to compare with
+using ReferenceSum = std::map<std::vector<int32_t>, int>;
+
+ReferenceSum randomReferenceSum(size_t dimension, int max_exponent, std::mt19937& g) {
+  std::uniform_int_distribution<int> exponent(-max_exponent, max_exponent);
+  std::uniform_int_distribution<int> coef(-3, 3);
+
+  ReferenceSum result;
+  for (int i = std::uniform_int_distribution<int>(0, 20)(g); i > 0; --i) {
+    std::vector<int32_t> term(dimension);
+    for (auto& e : term) {
+      e = exponent(g);
+    }
+    result[term] += coef(g);
+  }
+
+  return result;
+}
+
+void normalize(ReferenceSum& sum) {
+  for (auto it = sum.begin(); it != sum.end();) {
+    it = (it->second == 0) ? sum.erase(it) : std::next(it);
+  }
+}
+
+IntLaurentPolynomial toPolynomial(size_t dimension, const ReferenceSum& sum) {
+  IntLaurentPolynomial result(dimension);
+  for (const auto& m : sum) {
+    result += IntLaurentMonomial(m.second, m.first);
+  }
+  return result;
+}
+
+void expectEqual(ReferenceSum expected, const IntLaurentPolynomial& p) {
+  normalize(expected);
+  ASSERT_EQ(expected.size(), p.size());
+
+  auto it = expected.begin();
+  for (const auto& m : p) {
+    EXPECT_EQ(it->first, m.first);
+    EXPECT_EQ(it->second, m.second);
+    ++it;
+  }
+}
+
+class RandomLaurentPolynomial : public ::testing::TestWithParam<std::pair<size_t, int>> {};
+
+TEST_P(RandomLaurentPolynomial, Arithmetic) {
+  const auto dimension = GetParam().first;
+  const auto max_exponent = GetParam().second;
+  std::mt19937 g(0);
+
+  for (size_t i = 0; i < 50; ++i) {
+    const auto a = randomReferenceSum(dimension, max_exponent, g);
+    const auto b = randomReferenceSum(dimension, max_exponent, g);
+    const auto p = toPolynomial(dimension, a);
+    const auto q = toPolynomial(dimension, b);
+
+    expectEqual(a, p);
+
+    auto sum = a;
+    auto difference = a;
+    ReferenceSum product;
+    for (const auto& m : b) {
+      sum[m.first] += m.second;
+      difference[m.first] -= m.second;
+
+      for (const auto& n : a) {
+        auto term = n.first;
+        for (size_t j = 0; j < dimension; ++j) {
+          term[j] += m.first[j];
+        }
+        product[term] += n.second * m.second;
+      }
+    }
+
+    expectEqual(sum, p + q);
+    expectEqual(difference, p - q);
+    expectEqual(product, p * q);
+    expectEqual({}, p - p);
+
+    // variables are shifted cyclically
+    std::vector<size_t> target(dimension);
+    ReferenceSum permuted;
+    for (size_t j = 0; j < dimension; ++j) {
+      target[j] = (j + 1) % dimension;
+    }
+    for (const auto& m : a) {
+      std::vector<int32_t> term(dimension);
+      for (size_t j = 0; j < dimension; ++j) {
+        term[target[j]] = m.first[j];
+      }
+      permuted[term] = m.second;
+    }
+    expectEqual(permuted, p.permuteVariables(target));
+  }
+}
+
+INSTANTIATE_TEST_CASE_P(
+    DimensionAndExponents, RandomLaurentPolynomial,
+    ::testing::Values(
+        std::make_pair(2, 3), std::make_pair(3, 100), std::make_pair(9, 2), std::make_pair(9, 1000),
+        std::make_pair(17, 50000)));
+
 } // namespace
 } // namespace polynomials
 } // namespace crag
\ No newline at end of file
@@ -14,9 +14,12 @@
 #include "GraphType.h"
 #include "GraphConcept.h"
 #include "GraphConceptAlgorithms.h"
+#include "stallings_folding.h"
 using namespace Graphs;
 
 
+#include "list"
+#include "map"
 #include "vector"
 using namespace std;
 
@@ -40,7 +43,9 @@ public:
   template< class ConstWordIterator > SubgroupFG( int n_gens , ConstWordIterator B , ConstWordIterator E ) : 
     theNumberOfGenerators( n_gens ),
     fsaDone( false ),
-    nielsDone( false )
+    graphDone( false ),
+    nielsDone( false ),
+    expressDone( false )
       {
 	int sz = 0;
 	ConstWordIterator C = B;
@@ -51,7 +56,7 @@ public:
       }
 
  protected:
-  SubgroupFG( int n_gens , const IntLabeledGraph& fsa );
+  SubgroupFG( int n_gens , const crag::stallings::SubgroupAutomaton& automaton );
 
 
   /////////////////////////////////////////////////////////
@@ -124,8 +129,12 @@ public:
   const vector< Word >& getNielsenGenerators( ) const;
   
   
-  //! Get an automaton corresponding to a subgroup of a free froup
+  //! Get an automaton corresponding to a subgroup of a free froup (converted from getAutomaton( ) on the first call)
   const IntLabeledGraph& getFSA( ) const;
+
+
+  //! Get the folded automaton of a subgroup of a free group (with flat transition arrays)
+  const crag::stallings::SubgroupAutomaton& getAutomaton( ) const;
   
   
   //! Compute the index of a subgroup of a free group, -1 means infinite
@@ -176,6 +185,10 @@ private:
 
   void computeFSA( ) const;
   void computeNielsenGenerators( ) const;
+  void computeExpressDetails( ) const;
+
+  //! Drop all the data computed for the current generators
+  void resetComputed( );
   
   /////////////////////////////////////////////////////////
   //                                                     //
@@ -189,11 +202,19 @@ private:
   int theNumberOfGenerators;
   
   mutable bool fsaDone;
+  mutable crag::stallings::SubgroupAutomaton theAutomaton;
+
+  mutable bool graphDone;
   mutable IntLabeledGraph theFSA;
-  mutable list< FoldDetails< IntLabeledGraph::vertex_type , IntLabeledGraph::edge_type > > foldDetails;
   
   mutable bool nielsDone;
   mutable vector< Word > theNielsenGenerators;
+
+  // the graph folded from theGenerators with the details of the folds, used to express words
+  mutable bool expressDone;
+  mutable IntLabeledGraph theFoldedGraph;
+  mutable list< FoldDetails< IntLabeledGraph::vertex_type , IntLabeledGraph::edge_type > > theFoldDetails;
+  mutable map< Word , int > theNumberedGenerators;
 };
 
 
@@ -0,0 +1,132 @@
+#pragma once
+
+#ifndef CRAG_STALLINGS_FOLDING_H
+#define CRAG_STALLINGS_FOLDING_H
+
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+
+#include "GraphType.h"
+#include "Word.h"
+
+namespace crag {
+namespace stallings {
+
+using State = uint32_t;
+
+//! Marks a missing transition
+constexpr State NO_STATE = std::numeric_limits<State>::max();
+
+//! The folded graph (Stallings graph) of a subgroup of the free group, it is immutable.
+/*!
+  A state has 2n transition slots for the letters x_1, x_1^-1, x_2, ... of the free group of rank n, the slots of
+  all states are stored in one array. The state 0 is the initial one, and every state is reachable from it. A word
+  belongs to the subgroup if and only if it can be read from 0 back to 0, which takes O(|w|).
+ */
+class SubgroupAutomaton {
+public:
+  //! The automaton of the trivial subgroup, it has one state and no transitions
+  SubgroupAutomaton();
+
+  size_t rank() const {
+    return rank_;
+  }
+
+  size_t size() const {
+    return size_;
+  }
+
+  //! The target of the transition by the letter or NO_STATE. Letters out of the rank have no transitions.
+  State target(State s, int letter) const;
+
+  //! Reads w from the state s, returns NO_STATE if it can't be read
+  State trace(State s, const Word& w) const;
+
+  //! Checks if w belongs to the subgroup
+  bool accepts(const Word& w) const {
+    return trace(0, w) == 0;
+  }
+
+  //! Checks if all transitions are defined, i.e. if the subgroup is of finite index
+  bool isComplete() const;
+
+  //! Checks if there is an isomorphism of the automata which sends s to other_s
+  bool isIsomorphic(const SubgroupAutomaton& other, State s, State other_s) const;
+
+  //! Returns the automaton as a graph with the vertices 0, ..., size() - 1 and the edges labelled by letters
+  IntLabeledGraph toGraph() const;
+
+private:
+  friend class StallingsFolding;
+  friend SubgroupAutomaton intersection(const SubgroupAutomaton& a, const SubgroupAutomaton& b);
+
+  //! The automaton of the states reachable from initial, the targets must be states of transitions.
+  //! removed states and the transitions to them are skipped.
+  SubgroupAutomaton(
+      size_t rank, const std::vector<State>& transitions, State initial, const std::vector<bool>& removed = {});
+
+  State targetBySlot_(State s, size_t slot) const {
+    return slot < 2 * rank_ ? transitions_[s * 2 * rank_ + slot] : NO_STATE;
+  }
+
+  size_t rank_;
+  size_t size_;
+  std::vector<State> transitions_;
+};
+
+//! Builds the folded graph of a subgroup given by generators.
+/*!
+  Every state has a flat row of 2n transition slots. Identified states are merged with union-find: the rows of the
+  absorbed state are moved to the representative, and the conflicting transitions are put on a queue of pairs of
+  states to identify next. The transitions to absorbed states are resolved by find when they are read.
+  A loop reuses the longest prefix and suffix of its word readable from the initial state, so new states are
+  created for the rest of the word only and a fold is needed only if the whole word can be read.
+ */
+class StallingsFolding {
+public:
+  //! The graph of the trivial subgroup of the free group of rank n
+  explicit StallingsFolding(size_t rank);
+
+  //! Adds the loop labelled by w at the initial state and folds the graph.
+  //! Throws std::invalid_argument if w has a letter out of the rank.
+  void addLoop(const Word& w);
+
+  //! Returns the folded graph
+  SubgroupAutomaton automaton() const;
+
+private:
+  State find_(State s) const;
+  State target_(State s, size_t slot) const;
+  State newState_();
+
+  //! Adds the edge s -> t labelled by the slot and the inverse edge, s and t must be representatives
+  void addEdge_(State s, size_t slot, State t);
+  void setTransition_(State s, size_t slot, State t);
+
+  //! Identifies the pairs of states on the queue until the graph is folded
+  void fold_();
+
+  size_t rank_;
+  std::vector<State> transitions_;
+  mutable std::vector<State> parents_;
+  std::vector<State> sizes_;
+  std::vector<std::pair<State, State>> pending_;
+};
+
+//! Returns the automaton of the subgroup generated by the words in the free group of rank n
+SubgroupAutomaton foldLoops(size_t rank, const std::vector<Word>& words);
+
+//! Returns the automaton of the intersection of the subgroups.
+/*!
+  The product automaton is built breadth first from (0, 0). The successors of the pairs of a level are computed in
+  parallel, the new pairs are numbered sequentially in the order of the level, so the result doesn't depend on
+  the scheduling. The hanging trees of the product (which contain no loops at (0, 0)) are removed.
+ */
+SubgroupAutomaton intersection(const SubgroupAutomaton& a, const SubgroupAutomaton& b);
+
+} // namespace stallings
+} // namespace crag
+
+#endif // CRAG_STALLINGS_FOLDING_H
@@ -23,7 +23,9 @@
 SubgroupFG::SubgroupFG( int n_gens ) :
   theNumberOfGenerators( n_gens ),
   fsaDone( false ),
-  nielsDone( false )
+  graphDone( false ),
+  nielsDone( false ),
+  expressDone( false )
 {
 
 }
@@ -33,20 +35,23 @@ SubgroupFG::SubgroupFG( int n_gens , const vector< Word >& gens ) :
   theNumberOfGenerators( n_gens ),
   theGenerators( gens ),
   fsaDone( false ),
-  nielsDone( false )
+  graphDone( false ),
+  nielsDone( false ),
+  expressDone( false )
 {
 
 }
 
 
-SubgroupFG::SubgroupFG( int n_gens , const IntLabeledGraph& fsa ) :
-theNumberOfGenerators( n_gens )
+SubgroupFG::SubgroupFG( int n_gens , const crag::stallings::SubgroupAutomaton& automaton ) :
+  theNumberOfGenerators( n_gens ),
+  fsaDone( true ),
+  theAutomaton( automaton ),
+  graphDone( false ),
+  nielsDone( false ),
+  expressDone( false )
 {
-  // 1. make fsa deterministic
-  theFSA = fsa;
-  fsaDone = true;
-  
-  // 2. find a Nielsen basis
+  // the automaton is folded already, find a Nielsen basis
   computeNielsenGenerators( );
   theGenerators = theNielsenGenerators;
 }
@@ -81,11 +86,7 @@ SubgroupFG& SubgroupFG::operator^= ( const Word& conjugator )
   for( vector< Word >::iterator g_it = theGenerators.begin( ) ; g_it!=theGenerators.end( ) ; ++g_it )
     *g_it ^= conjugator;
   
-  fsaDone = false;
-  nielsDone = false;
-  
-  theFSA.clear( );
-  theNielsenGenerators.clear( );
+  resetComputed( );
   
   return *this;
 }
@@ -100,11 +101,7 @@ SubgroupFG& SubgroupFG::operator+= ( const Word& w )
 {
   theGenerators.push_back( w );
   
-  fsaDone = false;
-  nielsDone = false;
-  
-  theFSA.clear( );
-  theNielsenGenerators.clear( );
+  resetComputed( );
   
   return *this;
 }
@@ -115,13 +112,24 @@ SubgroupFG& SubgroupFG::operator+= ( const SubgroupFG& sbgp )
   for( vector< Word >::const_iterator g_it = sbgp.theGenerators.begin( ) ; g_it!=sbgp.theGenerators.end( ) ; ++g_it )
     theGenerators.push_back( *g_it );
   
+  resetComputed( );
+  
+  return *this;
+}
+
+
+void SubgroupFG::resetComputed( )
+{
   fsaDone = false;
+  graphDone = false;
   nielsDone = false;
+  expressDone = false;
   
   theFSA.clear( );
   theNielsenGenerators.clear( );
-  
-  return *this;
+  theFoldedGraph.clear( );
+  theFoldDetails.clear( );
+  theNumberedGenerators.clear( );
 }
 
 
@@ -132,19 +140,30 @@ SubgroupFG& SubgroupFG::operator+= ( const SubgroupFG& sbgp )
 
 const IntLabeledGraph& SubgroupFG::getFSA( ) const
 {
-  if( !fsaDone ) computeFSA( );
+  if( !graphDone ) {
+    theFSA = getAutomaton( ).toGraph( );
+    graphDone = true;
+  }
   return theFSA;
 }
 
 
+const crag::stallings::SubgroupAutomaton& SubgroupFG::getAutomaton( ) const
+{
+  if( !fsaDone ) computeFSA( );
+  return theAutomaton;
+}
+
+
 void SubgroupFG::computeFSA( ) const
 {
-  int is = theFSA.newVertex( );
-  for( int i=0 ; i<theGenerators.size( ) ; ++i ) {
-    const Word& lst = theGenerators[i];
-    addLoop( theFSA , is , lst.begin( ) , lst.end( ) );
-  }
-  fold( theFSA , 0 , &foldDetails );
+  // the generators may contain letters out of theNumberOfGenerators (e.g., for SubgroupFG( ))
+  int rank = theNumberOfGenerators;
+  for( int i=0 ; i<theGenerators.size( ) ; ++i )
+    for( Word::const_iterator w_it=theGenerators[i].begin( ) ; w_it!=theGenerators[i].end( ) ; ++w_it )
+      rank = max( rank , abs( *w_it ) );
+  
+  theAutomaton = crag::stallings::foldLoops( rank , theGenerators );
   fsaDone = true;
 }
 
@@ -156,8 +175,7 @@ void SubgroupFG::computeFSA( ) const
 
 bool SubgroupFG::doesBelong( const Word& w ) const
 {
-  if( !fsaDone ) computeFSA( );
-  return trace( getFSA( ) , 0 , w.begin( ) , w.end( ) )==0;
+  return getAutomaton( ).accepts( w );
 }
 
 
@@ -168,25 +186,11 @@ bool SubgroupFG::doesBelong( const Word& w ) const
 
 int SubgroupFG::getIndex( ) const
 {
-  typedef IntLabeledGraph::edge_type edge_type;
-  typedef IntLabeledGraph::vertex_type vertex_type;
-
-  if( !fsaDone ) computeFSA( );
-  const map< int , vertex_type >& theVertices = theFSA.getVertices( );
-  
-  for( map< int , vertex_type >::const_iterator v_it = theVertices.begin( ) ; v_it!=theVertices.end( ) ; ++v_it ) {
-    const set< edge_type >& out = (*v_it).second.out;
-    if( out.size( )!=2*theNumberOfGenerators )
-      return -1;
-    set< edge_type >::const_iterator out_it = out.begin( );
-    for( int i=-theNumberOfGenerators ; out_it!=out.end( ) ; ++out_it, ++i ) {
-      if( i==0 ) ++i;
-      if( (*out_it).theLabel!=i )
-	return -1;
-    }	
-  }
+  const crag::stallings::SubgroupAutomaton& A = getAutomaton( );
+  if( A.rank( )!=theNumberOfGenerators || !A.isComplete( ) )
+    return -1;
   
-  return theVertices.size( );
+  return A.size( );
 }
 
 
@@ -197,75 +201,7 @@ int SubgroupFG::getIndex( ) const
 
 bool SubgroupFG::checkIsomorphism( const SubgroupFG& S , int vert1 , int vert2 ) const
 {
-  typedef IntLabeledGraph::edge_type edge_type;
-  typedef IntLabeledGraph::vertex_type vertex_type;
-
-  if( !fsaDone ) computeFSA( );
-  if( !S.fsaDone ) S.computeFSA( );
-  const map< int , vertex_type >& V1 =   theFSA.getVertices( );
-  const map< int , vertex_type >& V2 = S.theFSA.getVertices( );
-  if( V1.size( )!=V2.size( ) )
-    return false;
-  
-  set< int > images;
-  map< int , int > M;
-  images.insert( vert2 );
-  M[vert1] = vert2;
-  
-  typedef pair< int , int > PII;
-  set< PII > vertices;
-  vertices.insert( PII( 0 , vert1 ) );
-  
-  while( 1 ) {
-    
-    // cout << "A1" << endl;
-    // process the first element
-    PII p = *vertices.begin( );
-    if( p.first==1 ) break;
-    int n1 = p.second;
-    vertices.erase( vertices.begin( ) );
-    vertices.insert( PII( 1 , n1 ) );
-    
-    // cout << "A2" << endl;
-    // get states and edges
-    int n2 = M[n1];
-    const vertex_type& v1 = (*V1.find( n1 )).second;
-    const vertex_type& v2 = (*V2.find( n2 )).second;
-    const set< edge_type >& out1 = v1.out;
-    const set< edge_type >& out2 = v2.out;
-    if( out1.size( )!=out2.size( ) )
-      return false;
-    
-    // cout << "A3" << endl;
-    // process leaving edges
-    set< edge_type >::const_iterator out_it1 = out1.begin( );
-    set< edge_type >::const_iterator out_it2 = out2.begin( );
-    for( ; out_it1!=out1.end( ) ; ++out_it1, ++out_it2 ) {
-      
-      if( (*out_it1).theLabel!=(*out_it2).theLabel )
-	return false;
-      int t1 = (*out_it1).theTarget;
-      int t2 = (*out_it2).theTarget;
-      
-      if( M.find(t1)==M.end() ) {
-	// without this you'd a morphism
-	if( images.find( t2 )!=images.end( ) )
-	  return false;
-	images.insert( t2 );
-	M[t1] = t2;
-      } else {
-	if( M[t1]!=t2 )
-	  return false;
-      }
-      
-      if( vertices.find( PII(0,t1) )==vertices.end( ) && vertices.find( PII(1,t1) )==vertices.end( ) )
-	vertices.insert( PII(0,t1) );
-    }
-    // cout << "A4" << endl;
-    
-  }
-  
-  return true;
+  return getAutomaton( ).isIsomorphic( S.getAutomaton( ) , vert1 , vert2 );
 }
 
 
@@ -287,62 +223,9 @@ bool SubgroupFG::operator== ( const SubgroupFG& S ) const
 
 SubgroupFG SubgroupFG::operator* ( const SubgroupFG& S ) const
 {
-  typedef IntLabeledGraph::edge_type edge_type;
-  typedef IntLabeledGraph::vertex_type vertex_type;
-  
-  if( !fsaDone ) computeFSA( );
-  if( !S.fsaDone ) S.computeFSA( );
-  const map< int , vertex_type >& V1 =   theFSA.getVertices( );
-  const map< int , vertex_type >& V2 = S.theFSA.getVertices( );
-  
-  IntLabeledGraph fsa;
-  typedef pair< int , int > PII;
-  map< PII , int > vertices;
-  vertices[PII(0,0)] = fsa.newVertex( );
-  list< PII > to_check;
-  to_check.push_back( PII(0,0) );
-  
-  while( !to_check.empty( ) ) {
-    
-    PII p = *to_check.begin( );
-    to_check.erase( to_check.begin( ) );
-    
-    int n1 = p.first;
-    int n2 = p.second;
-    int n = vertices[PII(n1,n2)];
-    const vertex_type& v1 = (*V1.find( n1 )).second;
-    const vertex_type& v2 = (*V2.find( n2 )).second;
-    const set< edge_type >& out1 = v1.out;
-    const set< edge_type >& out2 = v2.out;
-    set< edge_type >::const_iterator out_it1 = out1.begin( );
-    set< edge_type >::const_iterator out_it2 = out2.begin( );
-    
-    while( out_it1!=out1.end( ) && out_it2!=out2.end( ) ) {
-      int l1 = (*out_it1).theLabel;
-      int l2 = (*out_it2).theLabel;
-      if( l1<l2 ) { ++out_it1; continue; }
-      if( l2<l1 ) { ++out_it2; continue; }
-      
-      int t1 = (*out_it1).theTarget;
-      int t2 = (*out_it2).theTarget;
-      int t;
-      map< PII , int >::iterator vertices_it = vertices.find( PII(t1,t2) );
-      if( vertices_it==vertices.end( ) ) {
-	to_check.push_back( PII(t1,t2) );
-	vertices[PII(t1,t2)] = t = fsa.newVertex( );
-	// cout << "  " << t << " -> (" << t1 << "," << t2 << ")" << endl;
-      } else 
-	t = (*vertices_it).second;
-      
-      fsa.newEdge( n , edge_type( t ,  l1 ) );
-      fsa.newEdge( t , edge_type( n , -l1 ) );
-      ++out_it1;
-      ++out_it2;
-    }
-    
-  }
-  
-  return SubgroupFG( theNumberOfGenerators>S.theNumberOfGenerators ? theNumberOfGenerators : S.theNumberOfGenerators , fsa );
+  // the product of the automata is built in parallel
+  return SubgroupFG( theNumberOfGenerators>S.theNumberOfGenerators ? theNumberOfGenerators : S.theNumberOfGenerators , 
+		     crag::stallings::intersection( getAutomaton( ) , S.getAutomaton( ) ) );
 }
 
 
@@ -353,49 +236,48 @@ SubgroupFG SubgroupFG::operator* ( const SubgroupFG& S ) const
 
 void SubgroupFG::computeNielsenGenerators( ) const
 {
-  typedef IntLabeledGraph::edge_type edge_type;
-  typedef IntLabeledGraph::vertex_type vertex_type;
-  
-  if( !fsaDone ) computeFSA( );
+  using crag::stallings::State;
+  using crag::stallings::NO_STATE;
+  
+  const crag::stallings::SubgroupAutomaton& A = getAutomaton( );
+  const int rank = A.rank( );
+  
+  // compute a geodesic tree rooted at 0, the tree edge of a state comes from its parent
+  vector< State > parent( A.size( ) , NO_STATE );
+  vector< int > parentLetter( A.size( ) , 0 );
+  vector< State > queue( 1 , 0 );
+  parent[0] = 0;
+  for( size_t q=0 ; q<queue.size( ) ; ++q ) {
+    State s = queue[q];
+    for( int x=1 ; x<=rank ; ++x ) {
+      for( int letter : { x , -x } ) {
+	State t = A.target( s , letter );
+	if( t!=NO_STATE && parent[t]==NO_STATE ) {
+	  parent[t] = s;
+	  parentLetter[t] = letter;
+	  queue.push_back( t );
+	}
+      }
+    }
+  }
   
-  // compute geodesic subtree
-  map< int , edge_type > GT = getGeodesicTree_in( theFSA , 0 );
-
-  // go over all states
-  const map< int , vertex_type >& theVertices = theFSA.getVertices( );
-  map< int , vertex_type >::const_iterator v_it = theVertices.begin( );
-  for( ; v_it!=theVertices.end( ) ; ++v_it ) {
-    
-    // process all vertices incoming into a state
-    int cur_v = (*v_it).first;
-    const vertex_type& cur_V = (*v_it).second;
-    const edge_type tree_edge = GT[cur_v];
-    const set< edge_type >& out = cur_V.out;
-    set< edge_type >::const_iterator out_it = out.begin( );
-    for( ; out_it!=out.end( ) ; ++out_it ) {
-
-      if( tree_edge==*out_it || (*out_it).theLabel<0 )
-	continue;
+  // the path from 0 to s in the tree
+  auto treePath = [&]( State s ) {
+    Word w;
+    for( ; s!=0 ; s=parent[s] )
+      w.push_front( parentLetter[s] );
+    return w;
+  };
+  
+  // every positive edge out of the tree gives a generator
+  for( State s=0 ; s<A.size( ) ; ++s ) {
+    for( int x=1 ; x<=rank ; ++x ) {
       
-      int from_v = (*out_it).theTarget;
-      const edge_type tree_edge2 = GT[from_v];
-      if( tree_edge2==edge_type( cur_v , -(*out_it).theLabel ) )
+      State t = A.target( s , x );
+      if( t==NO_STATE || ( parent[t]==s && parentLetter[t]==x ) || ( parent[s]==t && parentLetter[s]==-x ) )
 	continue;
       
-      // cout << "   ! " << from_state << " " << tree_edge2.label << " " << tree_edge2.target << endl;
-      // cout << "   - " << cur_state.theState << " " << (*out_it).label << " " << from_state << endl;
-      list< edge_type > L1 = readoffGeodesicTree( GT , cur_v ).second;
-      list< edge_type > L2 = readoffGeodesicTree( GT , from_v ).second;
-      L2.push_front( *out_it );
-      
-      Word w;
-      list< edge_type >::iterator L_it = L1.begin( );
-      for( ; L_it!=L1.end( ) ; ++L_it )
-	w.push_front( -(*L_it).theLabel );
-      L_it = L2.begin( );
-      for( ; L_it!=L2.end( ) ; ++L_it )
-	w.push_back( (*L_it).theLabel );
-      theNielsenGenerators.push_back( w );
+      theNielsenGenerators.push_back( treePath( s ) * Word( x ) * -treePath( t ) );
     }
   }
   
@@ -436,36 +318,47 @@ int SubgroupFG::getRank( ) const
 //---------------------------------------------------------------------------//
 
 
+void SubgroupFG::computeExpressDetails( ) const
+{
+  // the flat automaton doesn't keep the folds, so the graph is folded with the details once here
+  int is = theFoldedGraph.newVertex( );
+  for( int i=0 ; i<theGenerators.size( ) ; ++i )
+    addLoop( theFoldedGraph , is , theGenerators[i].begin( ) , theGenerators[i].end( ) );
+  fold( theFoldedGraph , 0 , &theFoldDetails );
+  
+  vector< Word >::const_iterator g_it = theGenerators.begin( );
+  for( int t=1 ; g_it!=theGenerators.end( ) ; ++g_it, ++t ) {
+    theNumberedGenerators[*g_it]  =  t;
+    theNumberedGenerators[-*g_it] = -t;
+  }
+  
+  expressDone = true;
+}
+
+
 Word SubgroupFG::express( const Word& w ) const
 {
   typedef IntLabeledGraph::edge_type edge_type;
-  typedef IntLabeledGraph::vertex_type vertex_type;
   
   Word result;
   
-  IntLabeledGraph fsa = theFSA;
-  pair< bool , list< edge_type > > path = trace_path( fsa , 0 , w.begin( ) , w.end( ) );
+  if( !expressDone ) computeExpressDetails( );
+  
+  pair< bool , list< edge_type > > path = trace_path( theFoldedGraph , 0 , w.begin( ) , w.end( ) );
   if( !path.first || (path.second.size( ) && (*--path.second.end()).theTarget!=0 ) ) {
     cout << "Error" << endl;
     exit( 1 );
   }
   
-  liftup( fsa , 0 , path.second , foldDetails.begin( ) , foldDetails.end( ) );
-  map< Word , int > numbered_gens;
-  vector< Word >::const_iterator g_it = theGenerators.begin( );
-  for( int t=1 ; g_it!=theGenerators.end( ) ; ++g_it, ++t ) {
-    numbered_gens[*g_it]  =  t;
-    numbered_gens[-*g_it] = -t;
-  }
+  liftup( theFoldedGraph , 0 , path.second , theFoldDetails.begin( ) , theFoldDetails.end( ) );
 
   Word cur_gen;
-  int cur_state = 0;
   list< edge_type >::iterator path_it = path.second.begin( );
   for( ; path_it!=path.second.end( ) ; ++path_it ) {
     cur_gen.push_back( (*path_it).theLabel );
     if( (*path_it).theTarget==0 ) {
-      int n = numbered_gens[cur_gen];
-      if( n )	result.push_back( n );
+      map< Word , int >::const_iterator n_it = theNumberedGenerators.find( cur_gen );
+      if( n_it!=theNumberedGenerators.end( ) ) result.push_back( (*n_it).second );
       cur_gen = Word( );
     }
   }
@@ -508,15 +401,15 @@ SubgroupFG SubgroupFG::normalizer( ) const
 {
   SubgroupFG result;
   
-  if( !fsaDone ) computeFSA( );
+  const IntLabeledGraph& FSA = getFSA( );
   
   typedef IntLabeledGraph::edge_type edge_type;
   typedef IntLabeledGraph::vertex_type vertex_type;
 
   // compute geodesic subtree
-  map< int , edge_type > GT = getGeodesicTree_in( theFSA , 0 );
+  map< int , edge_type > GT = getGeodesicTree_in( FSA , 0 );
   
-  const map< int , vertex_type >& theVertices = theFSA.getVertices( );
+  const map< int , vertex_type >& theVertices = FSA.getVertices( );
   map< int , vertex_type >::const_iterator v_it = theVertices.begin( );
   for( ; v_it!=theVertices.end( ) ; ++v_it ) {
 
@@ -552,15 +445,13 @@ pair< bool , Word > SubgroupFG::areConjugate( const SubgroupFG& sbgp ) const
   const SubgroupFG& Sbgp1 = pr1.first;
   const SubgroupFG& Sbgp2 = pr2.first;
 
-  if( !Sbgp1.fsaDone ) Sbgp1.computeFSA( );
-  if( !Sbgp2.fsaDone ) Sbgp2.computeFSA( );
-  const map< int , vertex_type >& V1 = Sbgp1.theFSA.getVertices( );
-  const map< int , vertex_type >& V2 = Sbgp2.theFSA.getVertices( );
-  if( V1.size( )!=V2.size( ) )
+  if( Sbgp1.getAutomaton( ).size( )!=Sbgp2.getAutomaton( ).size( ) )
     return pair< bool , Word >( false , Word( ) );
   
   // compute geodesic subtree
-  map< int , edge_type > GT = getGeodesicTree_in( Sbgp2.theFSA , 0 );
+  const IntLabeledGraph& FSA2 = Sbgp2.getFSA( );
+  const map< int , vertex_type >& V2 = FSA2.getVertices( );
+  map< int , edge_type > GT = getGeodesicTree_in( FSA2 , 0 );
   
   map< int , vertex_type >::const_iterator v_it = V2.begin( );
   for( ; v_it!=V2.end( ) ; ++v_it ) {
@@ -589,12 +480,10 @@ pair< SubgroupFG , Word > SubgroupFG::trim( ) const
   typedef IntLabeledGraph::edge_type edge_type;
   typedef IntLabeledGraph::vertex_type vertex_type;
   
-  if( !fsaDone ) computeFSA( );
-  
   int prev_v = 0;
   int cur_v = 0;
   Word tail;
-  const map< int , vertex_type >& theVertices = theFSA.getVertices( );
+  const map< int , vertex_type >& theVertices = getFSA( ).getVertices( );
   for( int i=0 ; ; ++i ) {
     
     vertex_type V = (*theVertices.find(cur_v)).second;
@@ -641,9 +530,7 @@ string SubgroupFG::graphviz_format( ) const
   
   typedef IntLabeledGraph::vertex_type vertex_type;
   typedef IntLabeledGraph::edge_type edge_type;
-  const map< int, vertex_type >& theVertices = theFSA.getVertices( );
-
-  if( !fsaDone ) computeFSA( );
+  const map< int, vertex_type >& theVertices = getFSA( ).getVertices( );
 
   GraphDrawingAttributes GDA;
   GDA.setNodeColor( 0 , COLOR(255,0,0) );
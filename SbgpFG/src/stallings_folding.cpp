@@ -0,0 +1,379 @@
+#include "stallings_folding.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <stdexcept>
+#include <unordered_map>
+
+#include "parallel.h"
+
+namespace crag {
+namespace stallings {
+
+namespace {
+
+//! x_1, x_1^-1, x_2, x_2^-1, ... occupy the slots 0, 1, 2, 3, ..., so the inverse letter of the slot is slot ^ 1
+size_t letterSlot(int letter) {
+  return letter > 0 ? 2 * static_cast<size_t>(letter - 1) : 2 * static_cast<size_t>(-letter - 1) + 1;
+}
+
+int slotLetter(size_t slot) {
+  const auto generator = static_cast<int>(slot / 2 + 1);
+  return slot % 2 == 0 ? generator : -generator;
+}
+
+} // namespace
+
+SubgroupAutomaton::SubgroupAutomaton()
+    : rank_(0)
+    , size_(1) {}
+
+SubgroupAutomaton::SubgroupAutomaton(
+    size_t rank, const std::vector<State>& transitions, State initial, const std::vector<bool>& removed)
+    : rank_(rank)
+    , size_(1) {
+  const auto width = 2 * rank;
+  if (width == 0) {
+    return;
+  }
+
+  // the states are numbered breadth first from the initial one
+  std::vector<State> numbers(transitions.size() / width, NO_STATE);
+  std::vector<State> order = {initial};
+  numbers[initial] = 0;
+
+  for (size_t k = 0; k < order.size(); ++k) {
+    for (size_t slot = 0; slot < width; ++slot) {
+      const auto t = transitions[order[k] * width + slot];
+      if ((t != NO_STATE) && (numbers[t] == NO_STATE) && (removed.empty() || !removed[t])) {
+        numbers[t] = static_cast<State>(order.size());
+        order.push_back(t);
+      }
+    }
+  }
+
+  size_ = order.size();
+  transitions_.resize(size_ * width);
+  for (size_t k = 0; k < size_; ++k) {
+    for (size_t slot = 0; slot < width; ++slot) {
+      const auto t = transitions[order[k] * width + slot];
+      transitions_[k * width + slot] = t == NO_STATE ? NO_STATE : numbers[t];
+    }
+  }
+}
+
+State SubgroupAutomaton::target(State s, int letter) const {
+  if ((letter == 0) || (static_cast<size_t>(std::abs(letter)) > rank_)) {
+    return NO_STATE;
+  }
+
+  return transitions_[s * 2 * rank_ + letterSlot(letter)];
+}
+
+State SubgroupAutomaton::trace(State s, const Word& w) const {
+  for (const auto letter : w) {
+    s = target(s, letter);
+    if (s == NO_STATE) {
+      break;
+    }
+  }
+
+  return s;
+}
+
+bool SubgroupAutomaton::isComplete() const {
+  return std::find(transitions_.begin(), transitions_.end(), NO_STATE) == transitions_.end();
+}
+
+bool SubgroupAutomaton::isIsomorphic(const SubgroupAutomaton& other, State s, State other_s) const {
+  if (size_ != other.size_) {
+    return false;
+  }
+
+  // the automata are deterministic, so the isomorphism is unique if it exists
+  const auto width = 2 * std::max(rank_, other.rank_);
+  std::vector<State> images(size_, NO_STATE);
+  std::vector<bool> is_image(size_, false);
+  std::vector<State> queue = {s};
+  images[s] = other_s;
+  is_image[other_s] = true;
+
+  for (size_t k = 0; k < queue.size(); ++k) {
+    const auto u = queue[k];
+    const auto v = images[u];
+
+    for (size_t slot = 0; slot < width; ++slot) {
+      const auto t = targetBySlot_(u, slot);
+      const auto other_t = other.targetBySlot_(v, slot);
+
+      if ((t == NO_STATE) != (other_t == NO_STATE)) {
+        return false;
+      }
+      if (t == NO_STATE) {
+        continue;
+      }
+
+      if (images[t] == NO_STATE) {
+        if (is_image[other_t]) {
+          return false;
+        }
+        images[t] = other_t;
+        is_image[other_t] = true;
+        queue.push_back(t);
+      } else if (images[t] != other_t) {
+        return false;
+      }
+    }
+  }
+
+  return true;
+}
+
+IntLabeledGraph SubgroupAutomaton::toGraph() const {
+  IntLabeledGraph result;
+  for (size_t s = 0; s < size_; ++s) {
+    result.newVertex();
+  }
+
+  for (size_t s = 0; s < size_; ++s) {
+    for (size_t slot = 0; slot < 2 * rank_; ++slot) {
+      const auto t = targetBySlot_(static_cast<State>(s), slot);
+      if (t != NO_STATE) {
+        result.newEdge(static_cast<int>(s), IntLabeledGraph::edge_type(static_cast<int>(t), slotLetter(slot)));
+      }
+    }
+  }
+
+  return result;
+}
+
+StallingsFolding::StallingsFolding(size_t rank)
+    : rank_(rank)
+    , transitions_(2 * rank, NO_STATE)
+    , parents_({0})
+    , sizes_({1}) {}
+
+State StallingsFolding::find_(State s) const {
+  // path halving
+  while (parents_[s] != s) {
+    parents_[s] = parents_[parents_[s]];
+    s = parents_[s];
+  }
+
+  return s;
+}
+
+State StallingsFolding::target_(State s, size_t slot) const {
+  const auto t = transitions_[s * 2 * rank_ + slot];
+  return t == NO_STATE ? NO_STATE : find_(t);
+}
+
+State StallingsFolding::newState_() {
+  const auto result = static_cast<State>(parents_.size());
+  if (result == NO_STATE) {
+    throw std::length_error("Too many states in the folded graph.");
+  }
+
+  parents_.push_back(result);
+  sizes_.push_back(1);
+  transitions_.resize(transitions_.size() + 2 * rank_, NO_STATE);
+
+  return result;
+}
+
+void StallingsFolding::setTransition_(State s, size_t slot, State t) {
+  auto& transition = transitions_[s * 2 * rank_ + slot];
+
+  if (transition == NO_STATE) {
+    transition = t;
+  } else {
+    pending_.emplace_back(transition, t);
+  }
+}
+
+void StallingsFolding::addEdge_(State s, size_t slot, State t) {
+  setTransition_(s, slot, t);
+  setTransition_(t, slot ^ 1, s);
+}
+
+void StallingsFolding::fold_() {
+  while (!pending_.empty()) {
+    auto a = find_(pending_.back().first);
+    auto b = find_(pending_.back().second);
+    pending_.pop_back();
+
+    if (a == b) {
+      continue;
+    }
+
+    // union by size, b is absorbed by a
+    if (sizes_[a] < sizes_[b]) {
+      std::swap(a, b);
+    }
+    parents_[b] = a;
+    sizes_[a] += sizes_[b];
+
+    for (size_t slot = 0; slot < 2 * rank_; ++slot) {
+      const auto t = transitions_[b * 2 * rank_ + slot];
+      if (t != NO_STATE) {
+        setTransition_(a, slot, t);
+      }
+    }
+  }
+}
+
+void StallingsFolding::addLoop(const Word& w) {
+  for (const auto letter : w) {
+    if ((letter == 0) || (static_cast<size_t>(std::abs(letter)) > rank_)) {
+      throw std::invalid_argument("The word has a letter out of the rank.");
+    }
+  }
+
+  const auto length = w.length();
+  if (length == 0) {
+    return;
+  }
+
+  const auto letters = w.begin();
+  const auto initial = find_(0);
+
+  // the longest prefix of w which can be read from the initial state
+  auto s = initial;
+  size_t i = 0;
+  for (; i < length; ++i) {
+    const auto t = target_(s, letterSlot(letters[i]));
+    if (t == NO_STATE) {
+      break;
+    }
+    s = t;
+  }
+
+  // the longest suffix of the rest which can be read to the initial state
+  auto e = initial;
+  size_t j = length;
+  for (; j > i; --j) {
+    const auto t = target_(e, letterSlot(letters[j - 1]) ^ 1);
+    if (t == NO_STATE) {
+      break;
+    }
+    e = t;
+  }
+
+  if (i == j) {
+    pending_.emplace_back(s, e);
+  } else {
+    for (; i + 1 < j; ++i) {
+      const auto next = newState_();
+      addEdge_(s, letterSlot(letters[i]), next);
+      s = next;
+    }
+    addEdge_(s, letterSlot(letters[i]), e);
+  }
+
+  fold_();
+}
+
+SubgroupAutomaton StallingsFolding::automaton() const {
+  auto transitions = transitions_;
+  for (auto& t : transitions) {
+    if (t != NO_STATE) {
+      t = find_(t);
+    }
+  }
+
+  return SubgroupAutomaton(rank_, transitions, find_(0));
+}
+
+SubgroupAutomaton foldLoops(size_t rank, const std::vector<Word>& words) {
+  StallingsFolding folding(rank);
+  for (const auto& w : words) {
+    folding.addLoop(w);
+  }
+
+  return folding.automaton();
+}
+
+SubgroupAutomaton intersection(const SubgroupAutomaton& a, const SubgroupAutomaton& b) {
+  const auto rank = std::max(a.rank(), b.rank());
+  const auto width = 2 * rank;
+  if (width == 0) {
+    return SubgroupAutomaton();
+  }
+
+  using Pair = std::pair<State, State>;
+  std::vector<Pair> pairs = {Pair(0, 0)};
+  std::unordered_map<uint64_t, State> numbers = {{0, 0}};
+  std::vector<State> transitions(width, NO_STATE);
+  std::vector<Pair> successors;
+
+  for (size_t level_begin = 0; level_begin < pairs.size();) {
+    const auto level_end = pairs.size();
+
+    successors.assign((level_end - level_begin) * width, Pair(NO_STATE, NO_STATE));
+    parallel::forEach(level_end - level_begin, [&](size_t k) {
+      const auto& p = pairs[level_begin + k];
+      for (size_t slot = 0; slot < width; ++slot) {
+        const auto t1 = a.targetBySlot_(p.first, slot);
+        const auto t2 = b.targetBySlot_(p.second, slot);
+        if ((t1 != NO_STATE) && (t2 != NO_STATE)) {
+          successors[k * width + slot] = Pair(t1, t2);
+        }
+      }
+    });
+
+    for (size_t k = 0; k < level_end - level_begin; ++k) {
+      for (size_t slot = 0; slot < width; ++slot) {
+        const auto& t = successors[k * width + slot];
+        if (t.first == NO_STATE) {
+          continue;
+        }
+
+        const auto key = (uint64_t(t.first) << 32) | t.second;
+        const auto inserted = numbers.emplace(key, static_cast<State>(pairs.size()));
+        if (inserted.second) {
+          if (pairs.size() == NO_STATE) {
+            throw std::length_error("Too many states in the product automaton.");
+          }
+          pairs.push_back(t);
+          transitions.resize(transitions.size() + width, NO_STATE);
+        }
+        transitions[(level_begin + k) * width + slot] = inserted.first->second;
+      }
+    }
+
+    level_begin = level_end;
+  }
+
+  // remove the hanging trees: a state other than (0, 0) with at most one edge is on no reduced loop at (0, 0)
+  const auto states_count = pairs.size();
+  std::vector<size_t> degrees(states_count, 0);
+  std::vector<State> hanging;
+  for (size_t s = 0; s < states_count; ++s) {
+    degrees[s] = width - std::count(transitions.begin() + s * width, transitions.begin() + (s + 1) * width, NO_STATE);
+    if ((s != 0) && (degrees[s] <= 1)) {
+      hanging.push_back(static_cast<State>(s));
+    }
+  }
+
+  std::vector<bool> removed(states_count, false);
+  while (!hanging.empty()) {
+    const auto s = hanging.back();
+    hanging.pop_back();
+    if (removed[s]) {
+      continue;
+    }
+    removed[s] = true;
+
+    for (size_t slot = 0; slot < width; ++slot) {
+      const auto t = transitions[s * width + slot];
+      if ((t != NO_STATE) && !removed[t] && (--degrees[t] <= 1) && (t != 0)) {
+        hanging.push_back(t);
+      }
+    }
+  }
+
+  return SubgroupAutomaton(rank, transitions, 0, removed);
+}
+
+} // namespace stallings
+} // namespace crag
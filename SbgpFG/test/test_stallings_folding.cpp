@@ -0,0 +1,212 @@
+#include <gtest/gtest.h>
+
+#include <random>
+
+#include "SubgroupFG.h"
+#include "random_word.h"
+#include "stallings_folding.h"
+
+namespace crag {
+namespace stallings {
+namespace {
+
+//! The folding of GraphConceptAlgorithms.h
+IntLabeledGraph foldLegacy(const std::vector<Word>& words) {
+  IntLabeledGraph result;
+  const int initial = result.newVertex();
+  for (const auto& w : words) {
+    addLoop(result, initial, w.begin(), w.end());
+  }
+  fold(result, 0);
+
+  return result;
+}
+
+std::vector<Word> randomWords(size_t rank, size_t count, size_t max_length, std::mt19937& g) {
+  std::vector<Word> result;
+  for (size_t i = 0; i < count; ++i) {
+    result.push_back(random::randomWord(rank, 1 + g() % max_length, g));
+  }
+
+  return result;
+}
+
+//! A random product of the words and their inverses
+Word randomProduct(const std::vector<Word>& words, size_t length, std::mt19937& g) {
+  Word result;
+  for (size_t i = 0; i < length; ++i) {
+    const auto& w = words[g() % words.size()];
+    result *= g() % 2 == 0 ? w : w.inverse();
+  }
+
+  return result;
+}
+
+TEST(StallingsFolding, Example) {
+  // <x1^2, x1 x2 x1^-1>
+  const auto automaton = foldLoops(2, {Word({1, 1}), Word({1, 2, -1})});
+
+  EXPECT_EQ(2, automaton.size());
+  EXPECT_FALSE(automaton.isComplete());
+  EXPECT_TRUE(automaton.accepts(Word()));
+  EXPECT_TRUE(automaton.accepts(Word({-1, -1})));
+  EXPECT_TRUE(automaton.accepts(Word({1, 2, 2, 1})));
+  EXPECT_FALSE(automaton.accepts(Word({1})));
+  EXPECT_FALSE(automaton.accepts(Word({2})));
+  EXPECT_FALSE(automaton.accepts(Word({3})));
+
+  EXPECT_EQ(1, automaton.trace(0, Word({1, 2})));
+  EXPECT_EQ(NO_STATE, automaton.trace(0, Word({2})));
+
+  EXPECT_THROW(foldLoops(2, {Word({3})}), std::invalid_argument);
+}
+
+TEST(StallingsFolding, Trivial) {
+  const auto automaton = foldLoops(3, {Word(), Word({1, 2, -2, -1})});
+
+  EXPECT_EQ(1, automaton.size());
+  EXPECT_TRUE(automaton.accepts(Word()));
+  EXPECT_FALSE(automaton.accepts(Word({1})));
+
+  EXPECT_EQ(1, SubgroupAutomaton().size());
+  EXPECT_EQ(1, foldLoops(0, {}).size());
+}
+
+TEST(StallingsFolding, CompareWithLegacy) {
+  std::mt19937 g(0);
+
+  for (size_t i = 0; i < 50; ++i) {
+    const size_t rank = 2 + g() % 3;
+    const auto generators = randomWords(rank, 1 + g() % 6, 20, g);
+
+    const auto automaton = foldLoops(rank, generators);
+    const auto legacy = foldLegacy(generators);
+    ASSERT_EQ(legacy.getVertices().size(), automaton.size());
+
+    for (size_t j = 0; j < 20; ++j) {
+      EXPECT_TRUE(automaton.accepts(randomProduct(generators, 1 + g() % 5, g)));
+
+      const auto w = random::randomWord(rank, g() % 10, g);
+      EXPECT_EQ(trace(legacy, 0, w.begin(), w.end()) == 0, automaton.accepts(w));
+    }
+
+    // the graph doesn't depend on the order of the generators
+    auto shuffled = generators;
+    std::shuffle(shuffled.begin(), shuffled.end(), g);
+    EXPECT_TRUE(automaton.isIsomorphic(foldLoops(rank, shuffled), 0, 0));
+  }
+}
+
+TEST(StallingsFolding, Isomorphism) {
+  const auto a = foldLoops(2, {Word({1, 2}), Word({2})});
+  const auto b = foldLoops(2, {Word({1})});
+  const auto c = foldLoops(2, {Word({2, 1, -2})});
+
+  // <x1 x2, x2> = <x1, x2> != <x1>
+  EXPECT_TRUE(a.isIsomorphic(foldLoops(2, {Word({1}), Word({2})}), 0, 0));
+  EXPECT_FALSE(a.isIsomorphic(b, 0, 0));
+
+  // c is conjugate to b, their graphs differ by a tail
+  EXPECT_FALSE(b.isIsomorphic(c, 0, 0));
+}
+
+TEST(Intersection, FiniteIndex) {
+  // the even exponent sum of x1 (index 2) and the exponent sum of x2 divisible by 3 (index 3)
+  const auto even = foldLoops(2, {Word({1, 1}), Word({2}), Word({1, 2, -1})});
+  const auto triple = foldLoops(2, {Word({2, 2, 2}), Word({1}), Word({2, 1, -2}), Word({2, 2, 1, -2, -2})});
+  ASSERT_TRUE(even.isComplete());
+  ASSERT_TRUE(triple.isComplete());
+  ASSERT_EQ(2, even.size());
+  ASSERT_EQ(3, triple.size());
+
+  const auto both = intersection(even, triple);
+  EXPECT_TRUE(both.isComplete());
+  EXPECT_EQ(6, both.size());
+
+  std::mt19937 g(0);
+  for (size_t i = 0; i < 200; ++i) {
+    const auto w = random::randomWord(2, g() % 12, g);
+    EXPECT_EQ(even.accepts(w) && triple.accepts(w), both.accepts(w)) << "case: w = " << w;
+  }
+}
+
+TEST(Intersection, HangingTrees) {
+  // <x1> and <x2 x1 x2^-1> intersect trivially
+  const auto result = intersection(foldLoops(2, {Word({1})}), foldLoops(2, {Word({2, 1, -2})}));
+  EXPECT_EQ(1, result.size());
+
+  // the intersection of <x1 x2> and <x1 x2, x3> in the groups of different ranks
+  const auto same = intersection(foldLoops(2, {Word({1, 2})}), foldLoops(3, {Word({1, 2}), Word({3})}));
+  EXPECT_EQ(3, same.rank());
+  EXPECT_TRUE(same.isIsomorphic(foldLoops(3, {Word({1, 2})}), 0, 0));
+}
+
+TEST(Intersection, RandomSubgroups) {
+  std::mt19937 g(0);
+
+  for (size_t i = 0; i < 20; ++i) {
+    const auto a = randomWords(2, 2 + g() % 3, 6, g);
+    const auto b = randomWords(2, 2 + g() % 3, 6, g);
+    const auto automaton_a = foldLoops(2, a);
+    const auto automaton_b = foldLoops(2, b);
+    const auto both = intersection(automaton_a, automaton_b);
+
+    for (size_t j = 0; j < 20; ++j) {
+      for (const auto& w : {randomProduct(a, 1 + g() % 4, g), randomProduct(b, 1 + g() % 4, g)}) {
+        EXPECT_EQ(automaton_a.accepts(w) && automaton_b.accepts(w), both.accepts(w)) << "case: w = " << w;
+      }
+    }
+
+    EXPECT_TRUE(both.isIsomorphic(intersection(automaton_b, automaton_a), 0, 0));
+  }
+}
+
+TEST(SubgroupFG, Operations) {
+  std::mt19937 g(0);
+
+  for (size_t i = 0; i < 20; ++i) {
+    const auto generators = randomWords(3, 1 + g() % 4, 10, g);
+    const SubgroupFG subgroup(3, generators);
+
+    for (size_t j = 0; j < 10; ++j) {
+      const auto w = randomProduct(generators, 1 + g() % 4, g);
+      ASSERT_TRUE(subgroup.doesBelong(w));
+      EXPECT_EQ(w, substitute(subgroup.express(w), generators)) << "case: w = " << w;
+    }
+
+    EXPECT_TRUE(subgroup == SubgroupFG(3, subgroup.getNielsenGenerators()));
+    EXPECT_TRUE(subgroup == subgroup * subgroup);
+  }
+
+  EXPECT_EQ(2, SubgroupFG(2, {Word({1, 1}), Word({2}), Word({1, 2, -1})}).getIndex());
+  EXPECT_EQ(-1, SubgroupFG(2, {Word({1, 1}), Word({2})}).getIndex());
+}
+
+TEST(SubgroupFG, IntersectionBasis) {
+  std::mt19937 g(0);
+
+  for (size_t i = 0; i < 20; ++i) {
+    const SubgroupFG a(2, randomWords(2, 2 + g() % 3, 6, g));
+    const SubgroupFG b(2, randomWords(2, 2 + g() % 3, 6, g));
+    const auto both = a * b;
+
+    for (const auto& w : both.getGenerators()) {
+      EXPECT_TRUE(a.doesBelong(w) && b.doesBelong(w)) << "case: w = " << w;
+    }
+
+    EXPECT_TRUE(both == SubgroupFG(2, both.getGenerators()));
+    EXPECT_EQ(both.getAutomaton().size(), both.getFSA().getVertices().size());
+  }
+}
+
+TEST(SubgroupFG, ExpressAfterExtension) {
+  SubgroupFG subgroup(2, {Word({1, 2})});
+  EXPECT_EQ(Word({1, 1}), subgroup.express(Word({1, 2, 1, 2})));
+
+  subgroup += Word({2});
+  EXPECT_EQ(Word({1, -2}), subgroup.express(Word({1})));
+}
+
+} // namespace
+} // namespace stallings
+} // namespace crag
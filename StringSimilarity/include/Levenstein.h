@@ -9,8 +9,8 @@
 // Description: 
 //
 //   A class for computing the Levenstein distance between two
-//   words. It converts words to strings (char*) and then calls a
-//   known string algorithm.
+//   words. It works on the letters of the words directly, see
+//   crag::stringsimilarity::editDistance.
 //
 // Revision History:
 //
@@ -24,8 +24,8 @@
 
 //!   A class for computing the Levenstein distance between two words. 
 /*!
-  Converts words to strings (char*) and then calls a
-  known string algorithm.
+  Works on the letters of the words directly, so the words may be of any
+  length and the distance may be computed in several threads at once.
 */
 class Levenstein {
   
@@ -55,24 +55,6 @@ public:
    */
   int compute( const Word& w1, const Word& w2);
 
- 
-private:
-
-  ///////////////////////////////////////////////////////
-  //                                                   //
-  //  Private functions                                //
-  //                                                   //
-  ///////////////////////////////////////////////////////
-
-  char* wordToString( const Word& );
-
-
-  ///////////////////////////////////////////////////////
-  //                                                   //
-  //  Data Members                                     //
-  //                                                   //
-  ///////////////////////////////////////////////////////
-
 };
 
 #endif
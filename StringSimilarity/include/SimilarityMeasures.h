@@ -94,6 +94,14 @@ public:
     \return the distance. It is assumed that greater values indicate less similarities.
    */
   virtual double measure(const Word& w1, const Word& w2)const  = 0;
+
+  //! Returns the distances between the words of every pair.
+  /*!
+    The pairs are processed in parallel, so measure() must not modify a shared state.
+    \param pairs - pairs of words
+    \return the distances in the order of the pairs.
+   */
+  vector<double> measureAll(const vector<pair<Word,Word> >& pairs)const;
 };
 
 
@@ -0,0 +1,40 @@
+#pragma once
+
+#ifndef CRAG_EDIT_DISTANCE_H
+#define CRAG_EDIT_DISTANCE_H
+
+#include <utility>
+#include <vector>
+
+#include <boost/optional.hpp>
+
+#include "Word.h"
+
+namespace crag {
+namespace stringsimilarity {
+
+//! Returns the edit (Levenshtein) distance between the words, i.e. the minimal number of insertions, deletions and
+//! substitutions of letters which transform u into v.
+/*!
+  The bit-parallel algorithm of Myers in the block-based form of Hyyrö is used: the columns of the dynamic programming
+  table are encoded by the vertical differences of their entries, 64 rows per machine word. The shorter word is the
+  pattern, so the time is O(|v| * ceil(|u| / 64)) for |u| <= |v| and the memory is linear.
+  All state is local, so the function may be called concurrently.
+ */
+size_t editDistance(const Word& u, const Word& v);
+
+//! Returns the edit distance between the words if it doesn't exceed max_distance, and none otherwise.
+/*!
+  The computation stops as soon as the distance is known to exceed the bound. For a small bound only the diagonal
+  band of the width 2 * max_distance + 1 of the table is computed (Ukkonen), otherwise the bit-parallel algorithm
+  is stopped early.
+ */
+boost::optional<size_t> editDistance(const Word& u, const Word& v, size_t max_distance);
+
+//! Returns the edit distances between the words of every pair, the pairs are processed in parallel.
+std::vector<size_t> editDistances(const std::vector<std::pair<Word, Word>>& pairs);
+
+} // namespace stringsimilarity
+} // namespace crag
+
+#endif // CRAG_EDIT_DISTANCE_H
@@ -28,15 +28,18 @@
 
 void PairDistanceSimilarityTest::estimateTrueDistribution()
 {
-  // generate pairs and compute corresponding measure values
+  // generate pairs (the generator is not thread safe) and compute
+  // corresponding measure values in parallel
+  vector<pair<Word,Word> > pairs(sampleSize);
   for ( int lCount=0;lCount<sampleSize;lCount++ ){
     
-    pair<Word,Word> p = theGenerator->getTruePair( );
-    measureDistr[lCount] = theSimilarity->measure( p.first,p.second );
+    pairs[lCount] = theGenerator->getTruePair( );
     
-    cout << PBar( double(lCount+1)/double(sampleSize) ) << " "  << measureDistr[lCount];
+    cout << PBar( double(lCount+1)/double(sampleSize) );
   }
   cout << endl;
+
+  measureDistr = theSimilarity->measureAll( pairs );
   
   sort(measureDistr.begin(),measureDistr.end());
   copy( measureDistr.begin(), measureDistr.end(),ostream_iterator<double>(cout," "));
@@ -10,6 +10,8 @@
 #include "Word.h"
 #include "SimilarityMeasures.h"
 #include "Levenstein.h"
+#include "edit_distance.h"
+#include "parallel.h"
 #include <limits.h>
 #include <algorithm>
 
@@ -64,6 +66,18 @@ double WordPairComparison::comparePair( const Word& w1, const Word& w2)const
 }
 
 
+vector<double> StringSimilarityMeasure::measureAll(const vector<pair<Word,Word> >& pairs)const
+{
+  vector<double> result(pairs.size());
+
+  crag::parallel::forEach(pairs, [&](size_t i, const pair<Word,Word>& p) {
+    result[i] = measure( p.first,p.second );
+  });
+
+  return result;
+}
+
+
 /////////////////////////////////////////////////////
 //
 //
@@ -78,7 +92,7 @@ double HammingDistance::measure(const Word& w1, const Word& w2) const
 {
   int minmalLength = min(w1.length(),w2.length());
   int distance = w1.length()-minmalLength+w2.length()-minmalLength;
-  for (ConstWordIterator I1 = w1.begin(), I2 = w2.begin(); I1!=w1.end() && I2!=w2.end();I1++,I2++)
+  for (Word::const_iterator I1 = w1.begin(), I2 = w2.begin(); I1!=w1.end() && I2!=w2.end();I1++,I2++)
     if (*I1 != *I2)
       distance++;
 
@@ -153,7 +167,6 @@ double EditingDistance::measure(const Word& w1, const Word& w2) const
 double SubwordEditingDistanceCyclic::measure(const Word& w1, const Word& w2) const
 {
 
-  EditingDistance ed;
   Word w1cr = w1.cyclicallyReduce();
   Word w2cr = w2.cyclicallyReduce();
 
@@ -168,12 +181,27 @@ double SubwordEditingDistanceCyclic::measure(const Word& w1, const Word& w2) con
   }
   
 
+  // the lengths of the segments don't change, so only a distance smaller than
+  // the best one found so far is computed to the end
   double min_distance = INT_MAX;
+  boost::optional<size_t> best;
   for (int i=0;i<maxWord.length();i++){
+    if ( best && *best == 0 )
+      break;
     maxWord.cyclicLeftShift();
-    double d = ed.measure(maxWord.initialSegment(min(maxWord.length()-1,minWord.length()-1)), minWord);
-    if ( d < min_distance )
+    Word segment = maxWord.initialSegment(min(maxWord.length()-1,minWord.length()-1));
+    boost::optional<size_t> ld;
+    if ( best )
+      ld = crag::stringsimilarity::editDistance(segment, minWord, *best - 1);
+    else
+      ld = crag::stringsimilarity::editDistance(segment, minWord);
+    if ( !ld )
+      continue;
+    double d = double(*ld) / double(max(segment.length(),minWord.length()));
+    if ( d < min_distance ){
       min_distance = d;
+      best = ld;
+    }
   }     
   return min_distance;
 }
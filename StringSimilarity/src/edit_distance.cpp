@@ -0,0 +1,246 @@
+#include "edit_distance.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+
+#include "parallel.h"
+
+namespace crag {
+namespace stringsimilarity {
+
+namespace {
+
+using block_t = uint64_t;
+
+constexpr size_t BLOCK_BITS = 64;
+constexpr block_t HIGH_BIT = block_t(1) << (BLOCK_BITS - 1);
+
+//! Bit masks of the positions of every letter in the pattern, BLOCK_BITS positions per block.
+class PatternMasks {
+public:
+  //! The pattern must not be empty.
+  explicit PatternMasks(const Word& pattern)
+      : blocks_count_((pattern.length() + BLOCK_BITS - 1) / BLOCK_BITS) {
+    const auto bounds = std::minmax_element(pattern.begin(), pattern.end());
+    min_letter_ = *bounds.first;
+    max_letter_ = *bounds.second;
+
+    // the last row is for the letters which don't occur in the pattern
+    const auto letters_count = static_cast<size_t>(max_letter_ - min_letter_) + 1;
+    masks_.assign((letters_count + 1) * blocks_count_, 0);
+    absent_ = letters_count * blocks_count_;
+
+    size_t i = 0;
+    for (const auto letter : pattern) {
+      masks_[static_cast<size_t>(letter - min_letter_) * blocks_count_ + i / BLOCK_BITS] |= block_t(1)
+          << (i % BLOCK_BITS);
+      ++i;
+    }
+  }
+
+  size_t blocksCount() const {
+    return blocks_count_;
+  }
+
+  //! Returns the masks of the blocks for the letter
+  const block_t* operator[](int letter) const {
+    if ((letter < min_letter_) || (letter > max_letter_)) {
+      return masks_.data() + absent_;
+    }
+
+    return masks_.data() + static_cast<size_t>(letter - min_letter_) * blocks_count_;
+  }
+
+private:
+  size_t blocks_count_;
+  int min_letter_;
+  int max_letter_;
+  size_t absent_;
+  std::vector<block_t> masks_;
+};
+
+//! Advances a block of the column by a letter of the text.
+/*!
+  pv and mv are the positive and negative vertical differences of the block, eq is the mask of the letter,
+  carry_in is the horizontal difference in the row above the block and high_bit marks the last row of the block.
+  Returns the horizontal difference in the last row of the block.
+ */
+inline int advanceBlock(block_t& pv, block_t& mv, block_t eq, int carry_in, block_t high_bit) {
+  const block_t xv = eq | mv;
+
+  if (carry_in < 0) {
+    eq |= 1;
+  }
+
+  const block_t xh = (((eq & pv) + pv) ^ pv) | eq;
+  block_t ph = mv | ~(xh | pv);
+  block_t mh = pv & xh;
+
+  int carry_out = 0;
+  if (ph & high_bit) {
+    carry_out = 1;
+  } else if (mh & high_bit) {
+    carry_out = -1;
+  }
+
+  ph <<= 1;
+  mh <<= 1;
+
+  if (carry_in < 0) {
+    mh |= 1;
+  } else if (carry_in > 0) {
+    ph |= 1;
+  }
+
+  pv = mh | ~(xv | ph);
+  mv = ph & xv;
+
+  return carry_out;
+}
+
+//! The bit-parallel algorithm, the pattern must not be empty.
+//! After a column j of the table the distance is at least D[m][j] - (|text| - j), so it stops when this bound
+//! exceeds max_distance.
+boost::optional<size_t> bitParallelDistance(const Word& pattern, const Word& text, size_t max_distance) {
+  const PatternMasks masks(pattern);
+  const auto blocks_count = masks.blocksCount();
+  const auto last_high_bit = block_t(1) << ((pattern.length() - 1) % BLOCK_BITS);
+
+  // the first column of the table is 0, 1, ..., m, the bits above the pattern in the last block never affect the
+  // bits below them
+  std::vector<block_t> pv(blocks_count, ~block_t(0));
+  std::vector<block_t> mv(blocks_count, 0);
+
+  size_t score = pattern.length();
+  size_t remaining = text.length();
+
+  for (const auto letter : text) {
+    const auto eq = masks[letter];
+
+    // the first row of the table is 0, 1, ..., n
+    int carry = 1;
+    for (size_t b = 0; b + 1 < blocks_count; ++b) {
+      carry = advanceBlock(pv[b], mv[b], eq[b], carry, HIGH_BIT);
+    }
+    carry = advanceBlock(pv[blocks_count - 1], mv[blocks_count - 1], eq[blocks_count - 1], carry, last_high_bit);
+
+    if (carry > 0) {
+      ++score;
+    } else if (carry < 0) {
+      --score;
+    }
+
+    --remaining;
+    if ((score > remaining) && (score - remaining > max_distance)) {
+      return boost::none;
+    }
+  }
+
+  return score;
+}
+
+//! Computes the entries of the table with |i - j| <= max_distance in two rows, the other entries exceed the bound.
+//! Stops when all entries of a row exceed the bound. Requires ||u| - |v|| <= max_distance.
+boost::optional<size_t> bandedDistance(const Word& u, const Word& v, size_t max_distance) {
+  const auto m = u.length();
+  const auto n = v.length();
+  const auto infinity = max_distance + 1;
+
+  std::vector<size_t> row(n + 1, infinity);
+  std::vector<size_t> next(n + 1, infinity);
+
+  for (size_t j = 0; j <= std::min(n, max_distance); ++j) {
+    row[j] = j;
+  }
+
+  auto u_letter = u.begin();
+  for (size_t i = 1; i <= m; ++i, ++u_letter) {
+    const auto from = i > max_distance ? i - max_distance : 0;
+    const auto to = std::min(n, i + max_distance);
+    const auto previous_to = std::min(n, i - 1 + max_distance);
+
+    size_t row_min = infinity;
+
+    auto v_letter = v.begin() + (from > 0 ? from - 1 : 0);
+    for (size_t j = from; j <= to; ++j) {
+      size_t d = i;
+
+      if (j > 0) {
+        d = row[j - 1] + (*u_letter == *v_letter ? 0 : 1);
+        ++v_letter;
+
+        if (j > from) {
+          d = std::min(d, next[j - 1] + 1);
+        }
+
+        if (j <= previous_to) {
+          d = std::min(d, row[j] + 1);
+        }
+      }
+
+      next[j] = std::min(d, infinity);
+      row_min = std::min(row_min, next[j]);
+    }
+
+    if (row_min > max_distance) {
+      return boost::none;
+    }
+
+    std::swap(row, next);
+  }
+
+  if (row[n] > max_distance) {
+    return boost::none;
+  }
+
+  return row[n];
+}
+
+} // namespace
+
+size_t editDistance(const Word& u, const Word& v) {
+  const auto& pattern = u.length() <= v.length() ? u : v;
+  const auto& text = u.length() <= v.length() ? v : u;
+
+  if (pattern.length() == 0) {
+    return text.length();
+  }
+
+  return *bitParallelDistance(pattern, text, std::numeric_limits<size_t>::max());
+}
+
+boost::optional<size_t> editDistance(const Word& u, const Word& v, size_t max_distance) {
+  const auto& pattern = u.length() <= v.length() ? u : v;
+  const auto& text = u.length() <= v.length() ? v : u;
+
+  if (text.length() - pattern.length() > max_distance) {
+    return boost::none;
+  }
+
+  if (pattern.length() == 0) {
+    return text.length();
+  }
+
+  // a cell of the band costs about as much as a block of a column of the bit-parallel algorithm, so the band is used
+  // if it is narrower than the column
+  const auto blocks_count = (pattern.length() + BLOCK_BITS - 1) / BLOCK_BITS;
+  if (max_distance < blocks_count / 2) {
+    return bandedDistance(pattern, text, max_distance);
+  }
+
+  return bitParallelDistance(pattern, text, max_distance);
+}
+
+std::vector<size_t> editDistances(const std::vector<std::pair<Word, Word>>& pairs) {
+  std::vector<size_t> result(pairs.size());
+
+  parallel::forEach(pairs, [&](size_t i, const std::pair<Word, Word>& pair) {
+    result[i] = editDistance(pair.first, pair.second);
+  });
+
+  return result;
+}
+
+} // namespace stringsimilarity
+} // namespace crag
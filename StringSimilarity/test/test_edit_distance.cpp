@@ -0,0 +1,185 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <random>
+
+#include "Levenstein.h"
+#include "SimilarityMeasures.h"
+#include "edit_distance.h"
+#include "random_word.h"
+
+namespace crag {
+namespace stringsimilarity {
+namespace {
+
+//! The textbook dynamic programming in two rows
+size_t referenceDistance(const Word& u, const Word& v) {
+  const std::vector<int> a(u.begin(), u.end());
+  const std::vector<int> b(v.begin(), v.end());
+
+  std::vector<size_t> row(b.size() + 1);
+  for (size_t j = 0; j <= b.size(); ++j) {
+    row[j] = j;
+  }
+
+  for (size_t i = 1; i <= a.size(); ++i) {
+    auto diagonal = row[0];
+    row[0] = i;
+
+    for (size_t j = 1; j <= b.size(); ++j) {
+      const auto up = row[j];
+      row[j] = std::min({diagonal + (a[i - 1] == b[j - 1] ? 0 : 1), row[j - 1] + 1, up + 1});
+      diagonal = up;
+    }
+  }
+
+  return row[b.size()];
+}
+
+//! Substitutes, inserts or deletes about the given number of random letters of w
+template <typename URNG>
+Word mutate(const Word& w, size_t rank, size_t changes, URNG& g) {
+  std::vector<int> letters(w.begin(), w.end());
+  std::uniform_int_distribution<int> letter(1, static_cast<int>(rank));
+
+  for (size_t i = 0; i < changes; ++i) {
+    const auto position = std::uniform_int_distribution<size_t>(0, letters.size())(g);
+
+    switch (g() % 3) {
+      case 0:
+        if (position < letters.size()) {
+          letters[position] = letter(g);
+        }
+        break;
+      case 1:
+        letters.insert(letters.begin() + position, letter(g));
+        break;
+      default:
+        if (position < letters.size()) {
+          letters.erase(letters.begin() + position);
+        }
+    }
+  }
+
+  return Word(letters);
+}
+
+TEST(EditDistance, Examples) {
+  EXPECT_EQ(0, editDistance(Word(), Word()));
+  EXPECT_EQ(3, editDistance(Word({1, 2, 1}), Word()));
+  EXPECT_EQ(3, editDistance(Word(), Word({1, 2, 1})));
+  EXPECT_EQ(0, editDistance(Word({1, 2, -1}), Word({1, 2, -1})));
+  EXPECT_EQ(1, editDistance(Word({1, 2, -1}), Word({1, -2, -1})));
+  EXPECT_EQ(2, editDistance(Word({1, 2, 1, 2}), Word({2, 1, 2, 1})));
+
+  // letters far from each other, which didn't fit into a char
+  EXPECT_EQ(1, editDistance(Word({1000, 2}), Word({-1000, 2})));
+}
+
+TEST(EditDistance, Random) {
+  std::mt19937 g(0);
+
+  for (size_t i = 0; i < 300; ++i) {
+    const auto rank = 2 + i % 3;
+    const auto u = random::randomWord(rank, g() % 300, g);
+    const auto v = i % 2 == 0 ? random::randomWord(rank, g() % 300, g) : mutate(u, rank, g() % 40, g);
+
+    const auto expected = referenceDistance(u, v);
+    EXPECT_EQ(expected, editDistance(u, v)) << "case: i = " << i;
+    EXPECT_EQ(expected, editDistance(v, u)) << "case: i = " << i;
+  }
+}
+
+TEST(EditDistance, Bounded) {
+  std::mt19937 g(0);
+
+  for (size_t i = 0; i < 200; ++i) {
+    const auto rank = 2 + i % 3;
+    const auto u = random::randomWord(rank, g() % 500, g);
+    const auto v = mutate(u, rank, g() % 30, g);
+    const auto expected = referenceDistance(u, v);
+
+    for (size_t bound : {size_t(0), size_t(1), expected / 2, expected - 1, expected, expected + 1, 2 * expected}) {
+      if (bound > 2 * expected) {
+        continue;
+      }
+
+      const auto distance = editDistance(u, v, bound);
+      if (expected <= bound) {
+        ASSERT_TRUE(distance) << "case: i = " << i << ", bound = " << bound;
+        EXPECT_EQ(expected, *distance) << "case: i = " << i << ", bound = " << bound;
+      } else {
+        EXPECT_FALSE(distance) << "case: i = " << i << ", bound = " << bound;
+      }
+    }
+  }
+}
+
+TEST(EditDistance, LongWords) {
+  std::mt19937 g(0);
+
+  // longer than the table of the former implementation
+  const auto u = random::randomWord(3, 12000, g);
+  const auto v = mutate(u, 3, 500, g);
+  const auto expected = referenceDistance(u, v);
+
+  EXPECT_EQ(expected, editDistance(u, v));
+  EXPECT_EQ(expected, *editDistance(u, v, expected));
+  EXPECT_FALSE(editDistance(u, v, expected - 1));
+  EXPECT_EQ(expected, Levenstein().compute(u, v));
+}
+
+TEST(EditDistance, Batch) {
+  std::mt19937 g(0);
+
+  std::vector<std::pair<Word, Word>> pairs;
+  for (size_t i = 0; i < 100; ++i) {
+    pairs.emplace_back(random::randomWord(3, g() % 200, g), random::randomWord(3, g() % 200, g));
+  }
+
+  const auto distances = editDistances(pairs);
+  ASSERT_EQ(pairs.size(), distances.size());
+  for (size_t i = 0; i < pairs.size(); ++i) {
+    EXPECT_EQ(referenceDistance(pairs[i].first, pairs[i].second), distances[i]) << "case: i = " << i;
+  }
+
+  const auto measures = EditingDistance().measureAll(pairs);
+  for (size_t i = 0; i < pairs.size(); ++i) {
+    EXPECT_EQ(EditingDistance().measure(pairs[i].first, pairs[i].second), measures[i]) << "case: i = " << i;
+  }
+}
+
+//! The minimum over all rotations without early termination
+double referenceSubwordCyclic(const Word& w1, const Word& w2) {
+  const auto w1cr = w1.cyclicallyReduce();
+  const auto w2cr = w2.cyclicallyReduce();
+  const auto& min_word = w1cr.length() < w2cr.length() ? w1cr : w2cr;
+  auto max_word = w1cr.length() < w2cr.length() ? w2cr : w1cr;
+
+  double result = std::numeric_limits<int>::max();
+  for (size_t i = 0; i < max_word.length(); ++i) {
+    max_word.cyclicLeftShift();
+    const auto segment = max_word.initialSegment(std::min(max_word.length() - 1, min_word.length() - 1));
+    result = std::min(
+        result,
+        double(referenceDistance(segment, min_word)) / double(std::max(segment.length(), min_word.length())));
+  }
+
+  return result;
+}
+
+TEST(EditDistance, SubwordCyclic) {
+  std::mt19937 g(0);
+  const SubwordEditingDistanceCyclic measure;
+
+  for (size_t i = 0; i < 50; ++i) {
+    const auto u = random::randomWord(2, 2 + g() % 100, g);
+    const auto v = i % 2 == 0 ? random::randomWord(2, 2 + g() % 100, g) : mutate(u, 2, g() % 10, g);
+
+    EXPECT_EQ(referenceSubwordCyclic(u, v), measure.measure(u, v)) << "case: i = " << i;
+  }
+}
+
+} // namespace
+} // namespace stringsimilarity
+} // namespace crag
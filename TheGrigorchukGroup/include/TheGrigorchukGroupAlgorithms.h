@@ -60,7 +60,7 @@ public:
   //! Solve the Identity Problem for a non-reduced word
   /*!
     Check if a word over the original alphabet represents the identity.
-    See VIII.E(47) of de la Harpe.
+    See VIII.E(47) of de la Harpe and crag::grigorchuk::WordProblemSolver.
   */
   static bool trivial( const Word& w );
 
@@ -92,6 +92,7 @@ public:
   //! Find the order of an element
   /*!
     Compute the smallest positive number \f$n\f$ such that \f$w^n\f$ is trivial in the Grigorchuk group.
+    See crag::grigorchuk::WordProblemSolver.
    */
   static int findOrder( const Word& w );
 
@@ -0,0 +1,109 @@
+#pragma once
+
+#ifndef CRAG_GRIGORCHUK_WORD_PROBLEM_H
+#define CRAG_GRIGORCHUK_WORD_PROBLEM_H
+
+#include <cstdint>
+#include <vector>
+
+#include <boost/container/vector.hpp>
+
+#include "Word.h"
+
+namespace crag {
+namespace grigorchuk {
+
+//! A reduced word over the generators a, b, c, d of the Grigorchuk group, 2 bits per letter.
+/*!
+  The letters are reduced as they are appended: a^2 = b^2 = c^2 = d^2 = 1 and the product of two different letters
+  of b, c, d is the third one. The abelian image is updated as well, so it is known without a pass over the word.
+  Clearing keeps the memory, so a word can be reused as a buffer.
+ */
+class PackedWord {
+public:
+  enum Letter : uint8_t { A = 0, B = 1, C = 2, D = 3 };
+
+  size_t length() const {
+    return length_;
+  }
+
+  Letter operator[](size_t i) const {
+    return static_cast<Letter>((blocks_[i / LETTERS_PER_BLOCK] >> (2 * (i % LETTERS_PER_BLOCK))) & 3);
+  }
+
+  //! The image in the abelianization Z_2^3, bits 0, 1, 2 correspond to a, b, c (d = bc)
+  uint8_t abelianImage() const {
+    return abelian_image_;
+  }
+
+  //! Multiplies by the generator on the right and reduces the result
+  void push_back(Letter g);
+
+  void clear() {
+    length_ = 0;
+    abelian_image_ = 0;
+  }
+
+  //! Reduces the word over a = 1, b = 2, c = 3, d = 4 (the signs of the letters are ignored).
+  //! Throws std::invalid_argument for other letters.
+  void assign(const Word& w);
+
+  Word toWord() const;
+
+private:
+  static constexpr size_t LETTERS_PER_BLOCK = 32;
+
+  void set_(size_t i, Letter g);
+
+  std::vector<uint64_t> blocks_;
+  size_t length_ = 0;
+  uint8_t abelian_image_ = 0;
+};
+
+//! Solves the word problem and finds orders of elements of the Grigorchuk group.
+/*!
+  An element of St(1) is split into the pair of its restrictions to the subtrees, the halves are at most half as
+  long, see VIII.E(47) of de la Harpe "Topics in Geometric Group Theory". The halves are processed depth first
+  with an explicit stack of packed words, the buffers are kept between calls. Results for reduced words of at most
+  MEMO_LENGTH letters are taken from a table computed once.
+  A solver is not thread safe, the free functions below use one solver per thread.
+ */
+class WordProblemSolver {
+public:
+  static constexpr size_t MEMO_LENGTH = 12;
+
+  bool isTrivial(const Word& w);
+
+  //! Returns the order of the element, it is a power of 2
+  size_t order(const Word& w);
+
+private:
+  friend class MemoTable;
+
+  bool isTrivial_(bool use_memo);
+  size_t orderExponent_(bool use_memo);
+
+  //! Makes sure that the stack has at least size words
+  void reserve_(size_t size);
+
+  //! the words and the exponents accumulated on the way to them (for the orders)
+  std::vector<PackedWord> stack_;
+  std::vector<size_t> exponents_;
+};
+
+//! Checks if w is trivial in the Grigorchuk group, see WordProblemSolver
+bool isTrivial(const Word& w);
+
+//! Returns the order of w in the Grigorchuk group, see WordProblemSolver
+size_t order(const Word& w);
+
+//! Checks the words in parallel
+boost::container::vector<bool> areTrivial(const std::vector<Word>& words);
+
+//! Finds the orders of the words in parallel
+std::vector<size_t> orders(const std::vector<Word>& words);
+
+} // namespace grigorchuk
+} // namespace crag
+
+#endif // CRAG_GRIGORCHUK_WORD_PROBLEM_H
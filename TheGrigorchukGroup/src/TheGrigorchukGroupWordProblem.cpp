@@ -11,6 +11,7 @@
 #include "Word.h"
 #include "RanlibCPP.h"
 #include "TheGrigorchukGroupAlgorithms.h"
+#include "grigorchuk_word_problem.h"
 
 
 //---------------------------------------------------------------------------//
@@ -123,8 +124,7 @@ pair< Word , Word > TheGrigorchukGroupAlgorithms::split( const Word& w )
 
 bool TheGrigorchukGroupAlgorithms::trivial( const Word& w )
 {
-  Word r = reduce( w );
-  return trivial_reduced( r );
+  return crag::grigorchuk::isTrivial( w );
 }
 
 
@@ -135,16 +135,7 @@ bool TheGrigorchukGroupAlgorithms::trivial( const Word& w )
 
 bool TheGrigorchukGroupAlgorithms::trivial_reduced( const Word& w )
 {
-  if( w.length( )==0 )
-    return true;
-
-  // check that w belongs to ST(1)
-  triple< int , int , int > a = abelianImage( w);
-  if( a.first || a.second || a.third )
-    return false;
-  
-  pair< Word , Word > sp = split( w );
-  return trivial(sp.first) && trivial(sp.second);
+  return crag::grigorchuk::isTrivial( w );
 }
 
 
@@ -192,18 +183,5 @@ Word TheGrigorchukGroupAlgorithms::randomWord( int len )
 
 int TheGrigorchukGroupAlgorithms::findOrder( const Word& w )
 {
-  if( w.length( )<=1 )
-    return w.length( )+1;
-  
-  Word r = reduce( w );
-  triple< int , int , int > A = abelianImage( w );
-  if( A.first==1 )
-    r = reduce( r*r );
-  pair< Word , Word > S = split( r );
-  int O1 = findOrder( S.first  );
-  int O2 = findOrder( S.second );
-  int O = O1>O2 ? O1 : O2;
-  O = A.first==1 ? 2*O : O;
-  
-  return O;
+  return int( crag::grigorchuk::order( w ) );
 }
@@ -0,0 +1,319 @@
+#include "grigorchuk_word_problem.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <stdexcept>
+
+#include "parallel.h"
+
+namespace crag {
+namespace grigorchuk {
+
+namespace {
+
+using Letter = PackedWord::Letter;
+
+//! Images of a, b, c, d in the abelianization
+constexpr uint8_t ABELIAN_IMAGES[] = {1, 2, 4, 6};
+
+//! Splits an element of St(1) given by a reduced word into its restrictions w0 and w1 to the subtrees.
+//! The word is a product of the letters x and the conjugates a x a, where x is one of b, c, d.
+void split(const PackedWord& w, PackedWord& w0, PackedWord& w1) {
+  w0.clear();
+  w1.clear();
+
+  for (size_t i = 0; i < w.length(); ++i) {
+    const auto g = w[i];
+
+    if (g == PackedWord::A) {
+      const auto x = w[i + 1];
+      i += 2;
+
+      // a b a = (c, a), a c a = (d, a), a d a = (b, 1)
+      if (x != PackedWord::D) {
+        w1.push_back(PackedWord::A);
+        w0.push_back(static_cast<Letter>(x + 1));
+      } else {
+        w0.push_back(PackedWord::B);
+      }
+    } else if (g != PackedWord::D) {
+      // b = (a, c), c = (a, d)
+      w0.push_back(PackedWord::A);
+      w1.push_back(static_cast<Letter>(g + 1));
+    } else {
+      // d = (1, b)
+      w1.push_back(PackedWord::B);
+    }
+  }
+}
+
+} // namespace
+
+void PackedWord::set_(size_t i, Letter g) {
+  const auto block = i / LETTERS_PER_BLOCK;
+  const auto shift = 2 * (i % LETTERS_PER_BLOCK);
+
+  if (block == blocks_.size()) {
+    blocks_.push_back(0);
+  }
+
+  blocks_[block] = (blocks_[block] & ~(uint64_t(3) << shift)) | (uint64_t(g) << shift);
+}
+
+void PackedWord::push_back(Letter g) {
+  abelian_image_ ^= ABELIAN_IMAGES[g];
+
+  if (length_ > 0) {
+    const auto last = (*this)[length_ - 1];
+
+    if ((last == A) == (g == A)) {
+      if (last == g) {
+        --length_;
+      } else {
+        // b, c, d are 1, 2, 3, and the product of two of them is the third one
+        set_(length_ - 1, static_cast<Letter>(6 - last - g));
+      }
+      return;
+    }
+  }
+
+  set_(length_, g);
+  ++length_;
+}
+
+void PackedWord::assign(const Word& w) {
+  clear();
+
+  for (const auto letter : w) {
+    const auto g = std::abs(letter);
+    if ((g < 1) || (g > 4)) {
+      throw std::invalid_argument("The Grigorchuk group has 4 generators.");
+    }
+
+    push_back(static_cast<Letter>(g - 1));
+  }
+}
+
+Word PackedWord::toWord() const {
+  std::vector<int> letters(length_);
+
+  for (size_t i = 0; i < length_; ++i) {
+    letters[i] = (*this)[i] + 1;
+  }
+
+  return Word(std::move(letters));
+}
+
+//! Triviality and orders of all reduced words of at most WordProblemSolver::MEMO_LENGTH letters.
+/*!
+  A reduced word alternates a and the letters b, c, d, so it is determined by its length, by its first letter being
+  a or not, and by the base 3 number formed by its letters b, c, d.
+ */
+class MemoTable {
+public:
+  MemoTable() {
+    WordProblemSolver solver;
+    PackedWord w;
+
+    size_t offset = 0;
+    for (size_t length = 0; length <= WordProblemSolver::MEMO_LENGTH; ++length) {
+      for (size_t starts_with_a = 0; starts_with_a < (length == 0 ? 1 : 2); ++starts_with_a) {
+        offsets_[length][starts_with_a] = offset;
+
+        const auto others = starts_with_a ? length / 2 : (length + 1) / 2;
+        size_t count = 1;
+        for (size_t i = 0; i < others; ++i) {
+          count *= 3;
+        }
+
+        for (size_t digits = 0; digits < count; ++digits) {
+          // the most significant digit is the first letter
+          auto rest = digits;
+          auto power = count;
+          w.clear();
+          for (size_t i = 0; i < length; ++i) {
+            if ((i % 2 == 0) == (starts_with_a == 1)) {
+              w.push_back(PackedWord::A);
+            } else {
+              power /= 3;
+              w.push_back(static_cast<Letter>(1 + rest / power));
+              rest %= power;
+            }
+          }
+
+          // the solver moves the words on its stack, so the word is copied for every call
+          solver.reserve_(1);
+          solver.stack_[0] = w;
+          trivial_.push_back(solver.isTrivial_(false));
+          solver.stack_[0] = w;
+          order_exponents_.push_back(static_cast<uint8_t>(solver.orderExponent_(false)));
+        }
+
+        offset += count;
+      }
+    }
+  }
+
+  bool isTrivial(const PackedWord& w) const {
+    return trivial_[index_(w)];
+  }
+
+  size_t orderExponent(const PackedWord& w) const {
+    return order_exponents_[index_(w)];
+  }
+
+private:
+  size_t index_(const PackedWord& w) const {
+    const auto starts_with_a = (w.length() > 0) && (w[0] == PackedWord::A) ? 1 : 0;
+
+    size_t result = 0;
+    for (size_t i = starts_with_a; i < w.length(); i += 2) {
+      result = 3 * result + (w[i] - 1);
+    }
+
+    return offsets_[w.length()][starts_with_a] + result;
+  }
+
+  size_t offsets_[WordProblemSolver::MEMO_LENGTH + 1][2];
+  std::vector<bool> trivial_;
+  std::vector<uint8_t> order_exponents_;
+};
+
+namespace {
+
+const MemoTable& memoTable() {
+  static const MemoTable table;
+  return table;
+}
+
+WordProblemSolver& threadSolver() {
+  thread_local WordProblemSolver solver;
+  return solver;
+}
+
+} // namespace
+
+void WordProblemSolver::reserve_(size_t size) {
+  if (stack_.size() < size) {
+    stack_.resize(size);
+    exponents_.resize(size);
+  }
+}
+
+bool WordProblemSolver::isTrivial(const Word& w) {
+  reserve_(1);
+  stack_[0].assign(w);
+
+  return isTrivial_(true);
+}
+
+size_t WordProblemSolver::order(const Word& w) {
+  reserve_(1);
+  stack_[0].assign(w);
+
+  return size_t(1) << orderExponent_(true);
+}
+
+bool WordProblemSolver::isTrivial_(bool use_memo) {
+  const MemoTable* memo = use_memo ? &memoTable() : nullptr;
+
+  // the words on the stack are the halves which are still to be checked
+  size_t top = 1;
+  while (top > 0) {
+    reserve_(top + 2);
+    auto& w = stack_[top - 1];
+
+    // a trivial element belongs to St(1) and has the trivial abelian image
+    if (w.abelianImage() != 0) {
+      return false;
+    }
+
+    if (memo && (w.length() <= MEMO_LENGTH)) {
+      if (!memo->isTrivial(w)) {
+        return false;
+      }
+      --top;
+      continue;
+    }
+
+    if (w.length() == 0) {
+      --top;
+      continue;
+    }
+
+    split(w, stack_[top], stack_[top + 1]);
+    std::swap(stack_[top - 1], stack_[top + 1]);
+    ++top;
+  }
+
+  return true;
+}
+
+size_t WordProblemSolver::orderExponent_(bool use_memo) {
+  const MemoTable* memo = use_memo ? &memoTable() : nullptr;
+
+  // the order of w is 2^e, where e is the maximum over the leaves of the splitting tree of the exponents of the
+  // leaves and the number of squarings on the way to them
+  size_t result = 0;
+  size_t top = 1;
+  exponents_[0] = 0;
+
+  while (top > 0) {
+    reserve_(top + 3);
+    auto& w = stack_[top - 1];
+    auto exponent = exponents_[top - 1];
+
+    if (memo && (w.length() <= MEMO_LENGTH)) {
+      result = std::max(result, exponent + memo->orderExponent(w));
+      --top;
+      continue;
+    }
+
+    // the identity and the generators
+    if (w.length() <= 1) {
+      result = std::max(result, exponent + w.length());
+      --top;
+      continue;
+    }
+
+    if (w.abelianImage() & 1) {
+      // w is not in St(1), but w^2 is, and the order of w is twice the order of w^2
+      auto& square = stack_[top + 1];
+      square = w;
+      for (size_t i = 0; i < w.length(); ++i) {
+        square.push_back(w[i]);
+      }
+
+      split(square, stack_[top], stack_[top + 2]);
+      std::swap(stack_[top - 1], stack_[top + 2]);
+      ++exponent;
+    } else {
+      split(w, stack_[top], stack_[top + 1]);
+      std::swap(stack_[top - 1], stack_[top + 1]);
+    }
+
+    exponents_[top - 1] = exponents_[top] = exponent;
+    ++top;
+  }
+
+  return result;
+}
+
+bool isTrivial(const Word& w) {
+  return threadSolver().isTrivial(w);
+}
+
+size_t order(const Word& w) {
+  return threadSolver().order(w);
+}
+
+boost::container::vector<bool> areTrivial(const std::vector<Word>& words) {
+  return parallel::bmap(words, [](const Word& w) { return isTrivial(w); });
+}
+
+std::vector<size_t> orders(const std::vector<Word>& words) {
+  return parallel::map<Word, size_t>(words, [](const Word& w) { return order(w); });
+}
+
+} // namespace grigorchuk
+} // namespace crag
@@ -0,0 +1,193 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <random>
+
+#include "TheGrigorchukGroupAlgorithms.h"
+#include "grigorchuk_word_problem.h"
+#include "random_word.h"
+
+namespace crag {
+namespace grigorchuk {
+namespace {
+
+//! The recursive algorithm of de la Harpe on Words
+bool isTrivialRecursive(const Word& w) {
+  const auto r = TheGrigorchukGroupAlgorithms::reduce(w);
+  if (r.length() == 0) {
+    return true;
+  }
+
+  const auto image = TheGrigorchukGroupAlgorithms::abelianImage(r);
+  if (image.first || image.second || image.third) {
+    return false;
+  }
+
+  const auto halves = TheGrigorchukGroupAlgorithms::split(r);
+  return isTrivialRecursive(halves.first) && isTrivialRecursive(halves.second);
+}
+
+size_t orderRecursive(const Word& w) {
+  auto r = TheGrigorchukGroupAlgorithms::reduce(w);
+  if (r.length() <= 1) {
+    return r.length() + 1;
+  }
+
+  const auto odd = TheGrigorchukGroupAlgorithms::abelianImage(r).first == 1;
+  if (odd) {
+    r = TheGrigorchukGroupAlgorithms::reduce(r * r);
+  }
+
+  const auto halves = TheGrigorchukGroupAlgorithms::split(r);
+  const auto result = std::max(orderRecursive(halves.first), orderRecursive(halves.second));
+  return odd ? 2 * result : result;
+}
+
+Word power(const Word& w, size_t n) {
+  std::vector<int> letters;
+  for (size_t i = 0; i < n; ++i) {
+    letters.insert(letters.end(), w.begin(), w.end());
+  }
+
+  return Word(std::move(letters));
+}
+
+//! The reverse of w is its inverse, since the generators are involutions
+Word reversed(const Word& w) {
+  return Word(std::vector<int>(w.rbegin(), w.rend()));
+}
+
+Word palindrome(const Word& w) {
+  return w * reversed(w);
+}
+
+TEST(PackedWord, Reduction) {
+  PackedWord w;
+  w.assign(Word({1, 1, 2, -3, 1, 4, 1, 2}));
+
+  // a a = 1, b c = d
+  EXPECT_EQ(Word({4, 1, 4, 1, 2}), w.toWord());
+  EXPECT_EQ(2, w.abelianImage());
+
+  w.push_back(PackedWord::B);
+  w.push_back(PackedWord::A);
+  EXPECT_EQ(Word({4, 1, 4}), w.toWord());
+  EXPECT_EQ(1, w.abelianImage());
+
+  w.clear();
+  EXPECT_EQ(0, w.length());
+  EXPECT_EQ(0, w.abelianImage());
+
+  EXPECT_THROW(w.assign(Word({5})), std::invalid_argument);
+}
+
+TEST(PackedWord, LongWords) {
+  std::mt19937 g(0);
+
+  for (size_t i = 0; i < 20; ++i) {
+    const auto w = random::randomWord(4, 200, g);
+
+    PackedWord packed;
+    packed.assign(w);
+    EXPECT_EQ(TheGrigorchukGroupAlgorithms::reduce(w), packed.toWord());
+  }
+}
+
+TEST(WordProblem, Generators) {
+  for (int g = 1; g <= 4; ++g) {
+    EXPECT_FALSE(isTrivial(Word(g)));
+    EXPECT_TRUE(isTrivial(Word({g, g})));
+    EXPECT_EQ(2, order(Word(g)));
+  }
+
+  EXPECT_TRUE(isTrivial(Word()));
+  EXPECT_EQ(1, order(Word()));
+  EXPECT_TRUE(isTrivial(Word({2, 3, 4})));
+}
+
+TEST(WordProblem, Orders) {
+  EXPECT_EQ(16, order(Word({1, 2})));
+  EXPECT_EQ(8, order(Word({1, 3})));
+  EXPECT_EQ(4, order(Word({1, 4})));
+
+  EXPECT_TRUE(isTrivial(power(Word({1, 2}), 16)));
+  EXPECT_FALSE(isTrivial(power(Word({1, 2}), 8)));
+  EXPECT_TRUE(isTrivial(power(Word({1, 3}), 8)));
+  EXPECT_TRUE(isTrivial(power(Word({1, 4}), 4)));
+}
+
+TEST(WordProblem, RandomWords) {
+  std::mt19937 g(0);
+
+  for (size_t i = 0; i < 500; ++i) {
+    const auto w = random::randomWord(4, g() % 100, g);
+
+    ASSERT_EQ(isTrivialRecursive(w), isTrivial(w)) << "case: w = " << w;
+    ASSERT_EQ(orderRecursive(w), order(w)) << "case: w = " << w;
+  }
+}
+
+TEST(WordProblem, TrivialWords) {
+  std::mt19937 g(0);
+
+  for (size_t i = 0; i < 100; ++i) {
+    const auto u = random::randomWord(4, g() % 100, g);
+    const auto v = random::randomWord(4, g() % 100, g);
+
+    EXPECT_TRUE(isTrivial(palindrome(u))) << "case: u = " << u;
+
+    // a conjugate of a relator
+    const auto w = u * palindrome(v) * reversed(u);
+    EXPECT_TRUE(isTrivial(w)) << "case: u = " << u << ", v = " << v;
+    EXPECT_EQ(1, order(w));
+  }
+}
+
+TEST(WordProblem, PowersOfOrder) {
+  std::mt19937 g(0);
+
+  for (size_t i = 0; i < 50; ++i) {
+    const auto w = random::randomWord(4, g() % 40, g);
+    const auto n = order(w);
+
+    EXPECT_TRUE(isTrivial(power(w, n))) << "case: w = " << w;
+    if (n > 1) {
+      EXPECT_FALSE(isTrivial(power(w, n / 2))) << "case: w = " << w;
+    }
+  }
+}
+
+TEST(WordProblem, Batch) {
+  std::mt19937 g(0);
+
+  std::vector<Word> words;
+  for (size_t i = 0; i < 200; ++i) {
+    const auto w = random::randomWord(4, g() % 60, g);
+    words.push_back(i % 2 == 0 ? w : palindrome(w));
+  }
+
+  const auto trivial = areTrivial(words);
+  const auto words_orders = orders(words);
+  ASSERT_EQ(words.size(), trivial.size());
+  ASSERT_EQ(words.size(), words_orders.size());
+
+  for (size_t i = 0; i < words.size(); ++i) {
+    EXPECT_EQ(isTrivial(words[i]), trivial[i]);
+    EXPECT_EQ(order(words[i]), words_orders[i]);
+  }
+}
+
+TEST(WordProblem, Legacy) {
+  std::mt19937 g(0);
+
+  for (size_t i = 0; i < 50; ++i) {
+    const auto w = random::randomWord(4, g() % 60, g);
+
+    EXPECT_EQ(isTrivialRecursive(w), TheGrigorchukGroupAlgorithms::trivial(w));
+    EXPECT_EQ(static_cast<int>(orderRecursive(w)), TheGrigorchukGroupAlgorithms::findOrder(w));
+  }
+}
+
+} // namespace
+} // namespace grigorchuk
+} // namespace crag
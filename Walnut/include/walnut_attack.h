@@ -11,7 +11,9 @@
 #include "fast_conjugacy_check.h"
 #include "fast_identity_check.h"
 #include "parallel.h"
+#include "phase_timer.h"
 #include "walnut.h"
+#include "walnut_candidates.h"
 
 namespace crag {
 namespace walnut {
@@ -69,7 +71,8 @@ Word getReplacement<StabilizerDoubleSquare>(int gen) {
 //! and w' is obtained from w by replacing w[i] with w[i]^{-1} or with w[i]^{-3}.
 template <typename Stabilizer>
 std::vector<std::pair<size_t, Word>> availableFlips(size_t n, size_t a, size_t b, const Word& w) {
-  static const crag::braidgroup::BraidHasher<FF> hasher(n);
+  // the flipped words share prefixes of w, their projections are reused
+  crag::braidgroup::IncrementalBraidHasher<FF> hasher(n);
 
   std::vector<std::pair<size_t, Word>> result;
 
@@ -127,19 +130,6 @@ size_t totalLength(const std::vector<Word>& v) {
   return result;
 }
 
-map<braid_hash_t, pair<Word, size_t>>::iterator findBest(map<braid_hash_t, pair<Word, size_t>>& m) {
-  size_t best_size = std::numeric_limits<size_t>::max();
-  map<braid_hash_t, pair<Word, size_t>>::iterator result;
-  for (auto it = m.begin(); it != m.end(); ++it) {
-    const auto s = std::get<size_t>(it->second);
-    if (best_size > s) {
-      result = it;
-      best_size = s;
-    }
-  }
-  return result;
-}
-
 pair<vector<Word>, Word> easyDescend(size_t n, const vector<Word>& v) {
   vector<Word> conjugators;
   for (int i = 1; i <= n; ++i) {
@@ -487,18 +477,9 @@ boost::optional<vector<Word>> pushToLowerRank(size_t n, const vector<Word>& word
 }
 
 void resetEnumeration(
-    const vector<Word>& v,
-    const Word& y,
-    map<braid_hash_t, vector<Word>>& hash_values,
-    map<braid_hash_t, pair<Word, size_t>>& checked_elts,
-    map<braid_hash_t, pair<Word, size_t>>& unchecked_elts,
-    const crag::braidgroup::BraidHasher<FF>& hasher) {
-  hash_values.clear();
-  checked_elts.clear();
-  unchecked_elts.clear();
-  const auto new_hash = hasher(v);
-  hash_values[new_hash] = v;
-  unchecked_elts[new_hash] = make_pair(y, totalLength(v));
+    const vector<Word>& v, const Word& y, CandidateStore& candidates, const crag::braidgroup::BraidHasher<FF>& hasher) {
+  candidates.clear();
+  candidates.insert(hasher(v), v, y);
 }
 
 // Returns fundamental braid for BKL form.
@@ -559,36 +540,40 @@ std::vector<std::vector<Word>> shortenTuplesParallel(size_t n, const std::vector
   const auto tuples_count = tuples.size();
   const auto tuple_size = tuples.front().size();
 
-  std::vector<std::vector<Word>> result(tuples_count, std::vector<Word>(tuple_size));
+  std::vector<Word> words;
+  words.reserve(tuples_count * tuple_size);
 
-  const auto words_count = tuples_count * tuple_size;
+  for (const auto& tuple : tuples) {
+    words.insert(words.end(), tuple.begin(), tuple.end());
+  }
 
-  parallel::forEach(words_count, [&](size_t i) {
-    const auto tuple_idx = i / tuple_size;
-    const auto word_idx = i % tuple_size;
+  auto short_words = shortenBraids(n, words);
 
-    result[tuple_idx][word_idx] = shortenBraid2(n, tuples[tuple_idx][word_idx]);
-  });
+  std::vector<std::vector<Word>> result(tuples_count);
+
+  for (size_t i = 0; i < tuples_count; ++i) {
+    const auto begin = short_words.begin() + i * tuple_size;
+    result[i].assign(std::make_move_iterator(begin), std::make_move_iterator(begin + tuple_size));
+  }
 
   return result;
 }
 
 boost::optional<braid_hash_t> generateNewElts(
     size_t n,
-    map<braid_hash_t, vector<Word>>& hash_values,
-    map<braid_hash_t, vector<Word>>& hash_values2,
-    map<braid_hash_t, pair<Word, size_t>>& checked_elts,
-    map<braid_hash_t, pair<Word, size_t>>& unchecked_elts,
+    CandidateStore& candidates,
+    const CandidateStore& candidates2,
     const crag::braidgroup::BraidHasher<FF>& hasher,
     bool init_segments_as_conjugators = false) {
   // 1. Take the best unchecked instance and its characteristics
-  const auto it = findBest(unchecked_elts);
-  const auto cur_hash = it->first;
-  const auto& cur_vec = hash_values[cur_hash];
-  const auto cur_len = std::get<size_t>(it->second);
-  const Word cur_y = std::get<Word>(it->second);
-  checked_elts[cur_hash] = it->second;
-  unchecked_elts.erase(it);
+  const auto best = candidates.popBest();
+  if (!best) {
+    return boost::none;
+  }
+
+  const auto cur_hash = best.get();
+  const auto cur_vec = candidates.tuple(cur_hash);
+  const auto cur_len = candidates.length(cur_hash);
 
   const auto r = range(cur_vec);
   cout << "Current |y| = " << cur_len << ", [" << r.first << "," << r.second << "]" << endl;
@@ -597,15 +582,14 @@ boost::optional<braid_hash_t> generateNewElts(
   if (size_t delta = r.first - 1) {
     cout << "Reducing range..." << endl;
     const auto c = smallDelta(n).power(delta);
-    resetEnumeration(
-        conjugateBySmallDelta(cur_vec, r.first - 1), cur_y * c, hash_values, checked_elts, unchecked_elts, hasher);
+    resetEnumeration(conjugateBySmallDelta(cur_vec, r.first - 1), candidates.conjugator(cur_hash) * c, candidates, hasher);
     return boost::none;
   }
 
   if (r.second > 4) {
     if (const auto new_vec = pushToLowerRank(n, cur_vec)) {
       cout << "Pushing to lower rank..." << endl;
-      resetEnumeration(new_vec.get(), cur_y, hash_values, checked_elts, unchecked_elts, hasher);
+      resetEnumeration(new_vec.get(), candidates.conjugator(cur_hash), candidates, hasher);
       return boost::none;
     }
   }
@@ -646,22 +630,19 @@ boost::optional<braid_hash_t> generateNewElts(
     const auto new_hash = hasher(new_vec);
     const auto new_vec2 = conjugateByDelta(new_vec, r.second);
     const auto new_hash2 = hasher(new_vec2);
-    const auto new_cur_y = cur_y * conj;
 
-    if (hash_values.find(new_hash) == hash_values.end() && hash_values.find(new_hash2) == hash_values.end()) {
-      hash_values[new_hash] = new_vec;
-      unchecked_elts[new_hash] = make_pair(new_cur_y, totalLength(new_vec));
+    if (!candidates.contains(new_hash) && !candidates.contains(new_hash2)) {
+      candidates.insert(new_hash, new_vec, cur_hash, conj);
 
-      if (hash_values2.find(new_hash) != hash_values2.end()) {
+      if (candidates2.contains(new_hash)) {
         cout << "We've done it 1!!!" << endl;
         return new_hash;
       }
 
-      if (hash_values2.find(new_hash2) != hash_values2.end()) {
+      if (candidates2.contains(new_hash2)) {
         cout << "We've done it 2!!!" << endl;
         Word delta_word = Word(Permutation::getHalfTwistPermutation(r.second + 1).geodesicWord());
-        hash_values[new_hash2] = new_vec2;
-        unchecked_elts[new_hash2] = make_pair(new_cur_y * delta_word, totalLength(new_vec2));
+        candidates.insert(new_hash2, new_vec2, new_hash, delta_word);
         return new_hash2;
       }
     }
@@ -676,18 +657,14 @@ bool drop_poor_performing_components(
     const crag::braidgroup::BraidHasher<FF>& hasher,
     vector<Word>& vec1,
     vector<Word>& vec2,
-    map<braid_hash_t, vector<Word>>& hash_values1,
-    map<braid_hash_t, pair<Word, size_t>>& checked_elts1,
-    map<braid_hash_t, pair<Word, size_t>>& unchecked_elts1,
-    map<braid_hash_t, vector<Word>>& hash_values2,
-    map<braid_hash_t, pair<Word, size_t>>& checked_elts2,
-    map<braid_hash_t, pair<Word, size_t>>& unchecked_elts2) {
-  const auto h1 = findBest(checked_elts1)->first;
-  const auto h2 = findBest(checked_elts2)->first;
-  auto v1 = hash_values1[h1];
-  auto v2 = hash_values2[h2];
-  auto t1 = checked_elts1[h1];
-  auto t2 = checked_elts2[h2];
+    CandidateStore& candidates1,
+    CandidateStore& candidates2) {
+  const auto h1 = candidates1.bestChecked().get();
+  const auto h2 = candidates2.bestChecked().get();
+  auto v1 = candidates1.tuple(h1);
+  auto v2 = candidates2.tuple(h2);
+  const auto y1 = candidates1.conjugator(h1);
+  const auto y2 = candidates2.conjugator(h2);
   vector<int> length_change;
   vector<int> length_diff;
   for (auto i = 0u; i < v1.size(); ++i) {
@@ -710,8 +687,8 @@ bool drop_poor_performing_components(
       vec1.erase(vec1.begin() + i);
       vec2.erase(vec2.begin() + i);
       cout << "    Drop component #" << i << endl;
-      resetEnumeration(v1, std::get<Word>(t1), hash_values1, checked_elts1, unchecked_elts1, hasher);
-      resetEnumeration(v2, std::get<Word>(t2), hash_values2, checked_elts2, unchecked_elts2, hasher);
+      resetEnumeration(v1, y1, candidates1, hasher);
+      resetEnumeration(v2, y2, candidates2, hasher);
       return true;
     }
   }
@@ -723,7 +700,8 @@ boost::optional<PrivateKey> attack(
     const Protocol<T, Obfuscator, Encoder, Stabilizer>& p,
     const PrivateKey& private_key,
     const PublicKey<T>& public_key,
-    URNG& g) {
+    URNG& g,
+    const CandidateStoreOptions& candidates_options = CandidateStoreOptions()) {
   const auto n = p.publicParameters().n();
   const auto hash_size = p.encoder().hashSize();
 
@@ -743,6 +721,7 @@ boost::optional<PrivateKey> attack(
 
   size_t uncloaked_pairs = 0;
   size_t pair_index = 0;
+  const auto uncloaking_start = std::chrono::steady_clock::now();
 
   while (uncloaked_pairs < signatures_pairs_count) {
     std::cout << "Uncloaking signatures pair #" << pair_index++;
@@ -766,6 +745,9 @@ boost::optional<PrivateKey> attack(
     }
   }
 
+  campaign::addPhaseTime(
+      "uncloaking", std::chrono::duration<double>(std::chrono::steady_clock::now() - uncloaking_start).count());
+
   // DIAGNOSTICS
   std::cout << "Cloaking elements success: ";
   for (const auto b : parallel::bmap(signatures_count, [&](size_t i) {
@@ -793,22 +775,20 @@ boost::optional<PrivateKey> attack(
   vec_lhs = parallel::map(vec_lhs, [&](const Word& w) { return shortenBraid2(n, w); });
   vec_rhs = parallel::map(vec_rhs, [&](const Word& w) { return shortenBraid2(n, w); });
 
-  std::map<braid_hash_t, std::vector<Word>> hash_values1;
-  std::map<braid_hash_t, std::pair<Word, size_t>> checked_elts1;
-  std::map<braid_hash_t, std::pair<Word, size_t>> unchecked_elts1;
-  const auto h1 = hasher(vec_lhs);
-  hash_values1[h1] = vec_lhs;
-  unchecked_elts1[h1] = std::make_pair(Word(), totalLength(vec_lhs));
+  CandidateStore candidates1(candidates_options);
+  candidates1.insert(hasher(vec_lhs), vec_lhs, Word());
+
+  auto candidates2_options = candidates_options;
+  if (!candidates2_options.spill_path.empty()) {
+    candidates2_options.spill_path += ".2";
+  }
+  CandidateStore candidates2(candidates2_options);
+  candidates2.insert(hasher(vec_rhs), vec_rhs, Word());
 
-  std::map<braid_hash_t, std::vector<Word>> hash_values2;
-  std::map<braid_hash_t, std::pair<Word, size_t>> checked_elts2;
-  std::map<braid_hash_t, std::pair<Word, size_t>> unchecked_elts2;
-  const auto h2 = hasher(vec_rhs);
-  hash_values2[h2] = vec_rhs;
-  unchecked_elts2[h2] = std::make_pair(Word(), totalLength(vec_rhs));
+  campaign::ScopedPhase enumeration_phase("enumeration");
 
   // One special iteration to drop the length
-  generateNewElts(n, hash_values1, hash_values2, checked_elts1, unchecked_elts1, hasher, true);
+  generateNewElts(n, candidates1, candidates2, hasher, true);
 
   // 5. Start enumeration
   for (int step = 0; step < 200; ++step) {
@@ -817,36 +797,24 @@ boost::optional<PrivateKey> attack(
 
     std::cout << ".................................................." << std::endl;
     std::cout << "Step #" << step << std::put_time(&tm, ",  tm = %H-%M-%S") << std::endl;
-    std::pair<Word, size_t> t1, t2;
-
-    if (const auto h = generateNewElts(n, hash_values1, hash_values2, checked_elts1, unchecked_elts1, hasher)) {
-      const auto hash = h.get();
-      t1 = unchecked_elts1[hash];
-      t2 = unchecked_elts2.find(hash) != unchecked_elts2.end() ? unchecked_elts2[hash] : checked_elts2[hash];
-    } else if (const auto h = generateNewElts(n, hash_values2, hash_values1, checked_elts2, unchecked_elts2, hasher)) {
-      const auto hash = h.get();
-      t1 = unchecked_elts1.find(hash) != unchecked_elts1.end() ? unchecked_elts1[hash] : checked_elts1[hash];
-      t2 = unchecked_elts2[hash];
+    Word y1, y2;
+
+    if (const auto h = generateNewElts(n, candidates1, candidates2, hasher)) {
+      y1 = candidates1.conjugator(h.get());
+      y2 = candidates2.conjugator(h.get());
+    } else if (const auto h = generateNewElts(n, candidates2, candidates1, hasher)) {
+      y1 = candidates1.conjugator(h.get());
+      y2 = candidates2.conjugator(h.get());
     } else {
       // Drop bad components. This eliminates signatures where we did poor job on removing cloaking elements
-      if (step >= 5 && step % 5 == 0 && vec_lhs.size() > 3 && !checked_elts1.empty() && !checked_elts2.empty()) {
-        drop_poor_performing_components(
-            n,
-            hasher,
-            vec_lhs,
-            vec_rhs,
-            hash_values1,
-            checked_elts1,
-            unchecked_elts1,
-            hash_values2,
-            checked_elts2,
-            unchecked_elts2);
+      if (step >= 5 && step % 5 == 0 && vec_lhs.size() > 3 && candidates1.checkedCount() && candidates2.checkedCount()) {
+        drop_poor_performing_components(n, hasher, vec_lhs, vec_rhs, candidates1, candidates2);
       }
       continue;
     }
 
     // Check correctness of the obtained keys
-    const Word w1_ = std::get<0>(t2) * -std::get<0>(t1);
+    const Word w1_ = y2 * -y1;
     const Word w2_ = -signatures[0].encodedMessageHash() * w1_ * reduced_signatures[0];
     const auto h1 = hasher(multiplyVectorByWordsOnBothSides_noreduction(vec_rhs, -w1_, w1_));
     const auto h2 = hasher(vec_lhs);
@@ -0,0 +1,183 @@
+#pragma once
+
+#ifndef CRAG_WALNUT_CANDIDATES_H
+#define CRAG_WALNUT_CANDIDATES_H
+
+#include <cstdio>
+#include <functional>
+#include <queue>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <boost/optional.hpp>
+
+#include "Word.h"
+
+namespace crag {
+namespace walnut {
+
+//! Open-addressing (linear probing) hash map from hash values of braid tuples to indices.
+class HashIndex {
+public:
+  using key_t = size_t;
+  using value_t = uint32_t;
+
+  //! Returns the value stored for the key or nullptr.
+  const value_t* find(key_t key) const;
+
+  //! Inserts the pair, returns false (and does nothing) if the key is already present.
+  bool insert(key_t key, value_t value);
+
+  size_t size() const {
+    return size_;
+  }
+
+  void clear();
+
+private:
+  static constexpr value_t EMPTY = static_cast<value_t>(-1);
+
+  struct Slot {
+    key_t key;
+    value_t value;
+  };
+
+  std::vector<Slot> slots_;
+  size_t size_ = 0;
+
+  size_t position_(key_t key) const;
+  void grow_();
+};
+
+//! Options of CandidateStore.
+struct CandidateStoreOptions {
+  //! Maximal number of bytes of encoded tuples kept in memory, 0 means no limit.
+  //! When the budget is exceeded the tuples of checked candidates, and then the oldest unchecked ones,
+  //! are moved to the spill file.
+  size_t memory_budget = 0;
+
+  //! File for spilled tuples. If empty, an anonymous temporary file is used.
+  std::string spill_path;
+
+  //! Maximal number of consecutive delta-encoded ancestors of a tuple, 0 disables delta encoding.
+  size_t max_delta_chain = 8;
+};
+
+//! Candidates (tuples of braid words) of the Walnut conjugacy search.
+/*!
+  A candidate is identified by the hash of its tuple and keeps the total length of the tuple and the conjugator
+  that transforms the initial tuple into it. Unchecked candidates are taken shortest first (ties are broken by
+  the smaller hash).
+  Candidates are stored compactly: the conjugator as the word appended to the conjugator of the parent candidate,
+  and the tuple as a byte string (letters of B_n with n < 128 as bytes), for non-root candidates as a difference
+  with the tuple of the parent (every word as a subword of the parent's word with letters added on both sides).
+ */
+class CandidateStore {
+public:
+  using hash_t = size_t;
+
+  explicit CandidateStore(CandidateStoreOptions options = CandidateStoreOptions());
+  ~CandidateStore();
+
+  CandidateStore(const CandidateStore&) = delete;
+  CandidateStore& operator=(const CandidateStore&) = delete;
+
+  //! Removes all candidates.
+  void clear();
+
+  //! Adds an unchecked candidate without a parent, returns false if the hash is already known.
+  bool insert(hash_t h, const std::vector<Word>& tuple, const Word& conjugator);
+
+  //! Adds an unchecked candidate obtained from the candidate parent, the conjugator of the new candidate is
+  //! conjugator(parent) * c. Returns false if the hash is already known.
+  bool insert(hash_t h, const std::vector<Word>& tuple, hash_t parent, const Word& c);
+
+  bool contains(hash_t h) const {
+    return index_.find(h) != nullptr;
+  }
+
+  //! Marks the shortest unchecked candidate as checked and returns its hash (none if all are checked).
+  boost::optional<hash_t> popBest();
+
+  //! The shortest checked candidate.
+  boost::optional<hash_t> bestChecked() const;
+
+  std::vector<Word> tuple(hash_t h) const;
+  Word conjugator(hash_t h) const;
+  size_t length(hash_t h) const;
+
+  size_t size() const {
+    return records_.size();
+  }
+
+  size_t checkedCount() const {
+    return checked_.size();
+  }
+
+  //! Number of bytes of encoded tuples kept in memory.
+  size_t memoryUsage() const {
+    return memory_usage_;
+  }
+
+  //! Number of bytes of encoded tuples moved to the spill file.
+  size_t spilledBytes() const {
+    return spilled_bytes_;
+  }
+
+private:
+  static constexpr uint32_t NO_PARENT = static_cast<uint32_t>(-1);
+
+  struct Record {
+    hash_t hash;
+    uint32_t parent;
+    uint32_t delta_depth;
+    size_t length;
+
+    //! conjugator of the candidate for roots, the word appended to the conjugator of the parent otherwise
+    std::string conjugator;
+
+    //! encoded tuple, empty if spilled
+    std::string tuple;
+    int64_t spill_offset;
+    size_t spill_size;
+  };
+
+  using heap_entry_t = std::pair<size_t, hash_t>;
+
+  CandidateStoreOptions options_;
+
+  std::vector<Record> records_;
+  HashIndex index_;
+  std::priority_queue<heap_entry_t, std::vector<heap_entry_t>, std::greater<heap_entry_t>> unchecked_;
+  std::vector<uint32_t> checked_;
+  boost::optional<heap_entry_t> best_checked_;
+
+  size_t memory_usage_ = 0;
+  size_t spilled_bytes_ = 0;
+
+  // positions in checked_ and records_ up to which the tuples were considered for spilling
+  size_t spilled_checked_ = 0;
+  size_t spilled_records_ = 0;
+
+  std::FILE* spill_file_ = nullptr;
+  int64_t spill_end_ = 0;
+
+  // the last decoded tuple, children of a candidate are inserted right after it is taken
+  mutable uint32_t cached_id_ = NO_PARENT;
+  mutable std::vector<Word> cached_tuple_;
+
+  bool add_(hash_t h, const std::vector<Word>& tuple, uint32_t parent, const Word& c);
+  uint32_t id_(hash_t h) const;
+
+  const std::vector<Word>& cachedTuple_(uint32_t id) const;
+  std::vector<Word> decode_(uint32_t id) const;
+  std::string encodedTuple_(uint32_t id) const;
+
+  void enforceBudget_();
+  void spill_(uint32_t id);
+};
+} // namespace walnut
+} // namespace crag
+
+#endif // CRAG_WALNUT_CANDIDATES_H
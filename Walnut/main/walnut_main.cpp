@@ -1,3 +1,4 @@
+#include "campaign.h"
 #include "walnut_attack.h"
 
 using namespace crag;
@@ -91,70 +92,73 @@ static void printTotalxNumbersSeq3(int N, const Word& w, size_t strand_a, size_t
   }
 }
 
-int main() {
-  size_t success_count = 0;
+//! Runs up to 10 attempts of the attack on the protocol instance with the given seed, returns true on success.
+static bool experiment(size_t e) {
+  std::cout << "========================================================" << std::endl;
+  std::cout << "Experiment #" << e << std::endl;
 
-  const size_t init_seed = 0;
-  const size_t experiments_count = 100;
+  // get random protocol instance with seed = e
+  const auto protocol = walnut::getProtocolFor128BitsSecurity<walnut::StabilizerSquare>(e);
+  // const auto protocol = walnut::getProtocolFor128BitsSecurity<walnut::StabilizerDoubleSquare>(e);
 
-  for (size_t e = init_seed; e < init_seed + experiments_count; ++e) {
-    std::cout << "========================================================" << std::endl;
-    std::cout << "Experiment #" << e << std::endl;
+  // const auto protocol = walnut::getProtocolFor256BitsSecurity<walnut::StabilizerSquare>(e);
+  // const auto protocol = walnut::getProtocolFor256BitsSecurity<walnut::StabilizerDoubleSquare>(e);
 
-    // get random protocol instance with seed = e
-    const auto protocol = walnut::getProtocolFor128BitsSecurity<walnut::StabilizerSquare>(e);
-    // const auto protocol = walnut::getProtocolFor128BitsSecurity<walnut::StabilizerDoubleSquare>(e);
+  //    const auto protocol = walnut::getProtocolFor256BitsSecurityN11<walnut::StabilizerSquare>(e);
+  //    const auto protocol = walnut::getProtocolFor256BitsSecurityN11<walnut::StabilizerDoubleSquare>(e);
 
-    // const auto protocol = walnut::getProtocolFor256BitsSecurity<walnut::StabilizerSquare>(e);
-    // const auto protocol = walnut::getProtocolFor256BitsSecurity<walnut::StabilizerDoubleSquare>(e);
+  const auto n = protocol.publicParameters().n();
 
-    //    const auto protocol = walnut::getProtocolFor256BitsSecurityN11<walnut::StabilizerSquare>(e);
-    //    const auto protocol = walnut::getProtocolFor256BitsSecurityN11<walnut::StabilizerDoubleSquare>(e);
+  // generate random private key using seed = e
+  const auto private_key = protocol.generatePrivateKey(e);
+  const auto public_key = protocol.computePublicKey(private_key);
 
-    const auto n = protocol.publicParameters().n();
+  std::cout << "|w1|  = " << private_key.w1().length() << ", ";
+  std::cout << "|w2|  = " << private_key.w2().length() << std::endl;
 
-    // generate random private key using seed = e
-    const auto private_key = protocol.generatePrivateKey(e);
-    const auto public_key = protocol.computePublicKey(private_key);
+  // We have several attempts to find the keys
+  bool success = false;
+  const size_t attempt_number = 10;
 
-    std::cout << "|w1|  = " << private_key.w1().length() << ", ";
-    std::cout << "|w2|  = " << private_key.w2().length() << std::endl;
+  for (size_t attempt = 0u; (attempt < attempt_number) && !success; ++attempt) {
+    std::cout << "Attempt #" << attempt << std::endl;
 
-    // We have several attempts to find the keys
-    int spent_time = time(0);
-    bool success = false;
-    const size_t attempt_number = 10;
+    std::mt19937_64 g(attempt);
 
-    for (size_t attempt = 0u; (attempt < attempt_number) && !success; ++attempt) {
-      std::cout << "Attempt #" << attempt << std::endl;
+    const auto fake_private_key = walnut::attack(protocol, private_key, public_key, g);
 
-      std::mt19937_64 g(attempt);
+    if (success = (fake_private_key != boost::none)) {
+      std::cout << "|fake w1|  = " << shortenBraid2(n, fake_private_key->w1()).length() << ", ";
+      std::cout << "|fake w2|  = " << shortenBraid2(n, fake_private_key->w2()).length() << std::endl;
 
-      const auto fake_private_key = walnut::attack(protocol, private_key, public_key, g);
-
-      if (success = (fake_private_key != boost::none)) {
-        std::cout << "|fake w1|  = " << shortenBraid2(n, fake_private_key->w1()).length() << ", ";
-        std::cout << "|fake w2|  = " << shortenBraid2(n, fake_private_key->w2()).length() << std::endl;
-
-        if (success &= walnut::checkFakePrivateKey(protocol, *fake_private_key, private_key, public_key, g)) {
-          std::cout << "Computed private key is GOOD." << std::endl;
-        } else {
-          std::cout << "Computed private key is BAD." << std::endl;
-        }
+      campaign::ScopedPhase phase("verification");
+      if (success &= walnut::checkFakePrivateKey(protocol, *fake_private_key, private_key, public_key, g)) {
+        std::cout << "Computed private key is GOOD." << std::endl;
+      } else {
+        std::cout << "Computed private key is BAD." << std::endl;
       }
     }
+  }
 
-    spent_time = time(0) - spent_time;
+  std::cout << "Experiment #" << e << (success ? " is successful" : " failed") << std::endl;
 
-    if (success) {
-      success_count++;
-      std::cout << "Experiment #" << e << " is successful" << std::endl;
-    } else {
-      std::cout << "Experiment #" << e << " failed" << std::endl;
-    }
+  return success;
+}
 
-    std::cout << "   Time = " << spent_time << std::endl;
-    std::cout << "Success: " << success_count << " out of " << (e + 1 - init_seed) << std::endl;
+//! Instances are distributed over worker processes and recorded in a log, see campaign.h and --help.
+int main(int argc, char** argv) {
+  campaign::CampaignOptions defaults;
+  defaults.first_seed = 0;
+  defaults.count = 100;
+  defaults.log_path = "walnut_campaign.log";
+
+  try {
+    if (const auto options = campaign::parseCommandLine(argc, argv, defaults)) {
+      campaign::run(options.get(), experiment);
+    }
+  } catch (const std::exception& e) {
+    std::cerr << e.what() << std::endl;
+    return 1;
   }
 
   return 0;
@@ -0,0 +1,408 @@
+#include "walnut_candidates.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace crag {
+namespace walnut {
+
+namespace {
+
+// splitmix64 finalizer, the hash values of tuples are not guaranteed to be uniform in lower bits
+size_t mix(size_t x) {
+  x ^= x >> 30;
+  x *= 0xbf58476d1ce4e5b9ULL;
+  x ^= x >> 27;
+  x *= 0x94d049bb133111ebULL;
+  x ^= x >> 31;
+  return x;
+}
+
+void putVarint(std::string& out, size_t value) {
+  while (value >= 0x80) {
+    out.push_back(static_cast<char>((value & 0x7f) | 0x80));
+    value >>= 7;
+  }
+  out.push_back(static_cast<char>(value));
+}
+
+size_t getVarint(const std::string& in, size_t& pos) {
+  size_t result = 0;
+  for (int shift = 0;; shift += 7) {
+    if (pos >= in.size()) {
+      throw std::runtime_error("Corrupted candidate record.");
+    }
+    const auto byte = static_cast<unsigned char>(in[pos++]);
+    result |= static_cast<size_t>(byte & 0x7f) << shift;
+    if (!(byte & 0x80)) {
+      return result;
+    }
+  }
+}
+
+void putLetters(std::string& out, std::vector<int>::const_iterator begin, std::vector<int>::const_iterator end) {
+  for (auto it = begin; it != end; ++it) {
+    if (*it < -127 || *it > 127) {
+      throw std::invalid_argument("Braid generator index is too large to be stored.");
+    }
+    out.push_back(static_cast<char>(static_cast<signed char>(*it)));
+  }
+}
+
+void getLetters(const std::string& in, size_t& pos, size_t count, std::vector<int>& out) {
+  if (pos + count > in.size()) {
+    throw std::runtime_error("Corrupted candidate record.");
+  }
+  for (size_t i = 0; i < count; ++i) {
+    out.push_back(static_cast<signed char>(in[pos++]));
+  }
+}
+
+std::string encodeWord(const Word& w) {
+  const auto v = w.toVector();
+  std::string result;
+  result.reserve(v.size());
+  putLetters(result, v.begin(), v.end());
+  return result;
+}
+
+Word decodeWord(const std::string& s) {
+  std::vector<int> v;
+  v.reserve(s.size());
+  size_t pos = 0;
+  getLetters(s, pos, s.size(), v);
+  return Word(std::move(v));
+}
+
+enum TupleEncoding : size_t { FULL = 0, DELTA = 1 };
+
+std::string encodeFull(const std::vector<Word>& tuple) {
+  std::string result;
+  putVarint(result, FULL);
+  putVarint(result, tuple.size());
+  for (const auto& w : tuple) {
+    const auto v = w.toVector();
+    putVarint(result, v.size());
+    putLetters(result, v.begin(), v.end());
+  }
+  return result;
+}
+
+// maximal number of letters added or removed at the beginning of a word which is looked for by encodeDelta
+constexpr size_t DELTA_WINDOW = 8;
+
+//! Every word is stored as a piece of the corresponding word of the parent with letters added on both sides:
+//! w = head * p[start, start + common) * tail. Conjugates by short words and their shortenings are usually of this form.
+std::string encodeDelta(const std::vector<Word>& tuple, const std::vector<Word>& parent) {
+  std::string result;
+  putVarint(result, DELTA);
+  for (size_t i = 0; i < tuple.size(); ++i) {
+    const auto v = tuple[i].toVector();
+    const auto p = parent[i].toVector();
+
+    size_t best_head = v.size();
+    size_t best_start = 0;
+    size_t best_common = 0;
+    for (size_t head = 0; head <= std::min(DELTA_WINDOW, v.size()); ++head) {
+      for (size_t start = 0; start <= std::min(DELTA_WINDOW, p.size()); ++start) {
+        size_t common = 0;
+        while (head + common < v.size() && start + common < p.size() && v[head + common] == p[start + common]) {
+          ++common;
+        }
+        if (common > best_common) {
+          best_head = head;
+          best_start = start;
+          best_common = common;
+        }
+      }
+    }
+
+    putVarint(result, best_head);
+    putLetters(result, v.begin(), v.begin() + best_head);
+    putVarint(result, best_start);
+    putVarint(result, best_common);
+    putVarint(result, v.size() - best_head - best_common);
+    putLetters(result, v.begin() + best_head + best_common, v.end());
+  }
+  return result;
+}
+} // namespace
+
+constexpr HashIndex::value_t HashIndex::EMPTY;
+constexpr uint32_t CandidateStore::NO_PARENT;
+
+size_t HashIndex::position_(key_t key) const {
+  const auto mask = slots_.size() - 1;
+  auto pos = mix(key) & mask;
+  while (slots_[pos].value != EMPTY && slots_[pos].key != key) {
+    pos = (pos + 1) & mask;
+  }
+  return pos;
+}
+
+const HashIndex::value_t* HashIndex::find(key_t key) const {
+  if (slots_.empty()) {
+    return nullptr;
+  }
+  const auto& slot = slots_[position_(key)];
+  return slot.value == EMPTY ? nullptr : &slot.value;
+}
+
+bool HashIndex::insert(key_t key, value_t value) {
+  if (2 * (size_ + 1) > slots_.size()) {
+    grow_();
+  }
+  auto& slot = slots_[position_(key)];
+  if (slot.value != EMPTY) {
+    return false;
+  }
+  slot = {key, value};
+  ++size_;
+  return true;
+}
+
+void HashIndex::clear() {
+  slots_.clear();
+  size_ = 0;
+}
+
+void HashIndex::grow_() {
+  std::vector<Slot> old_slots(std::max<size_t>(16, 2 * slots_.size()), Slot{0, EMPTY});
+  std::swap(old_slots, slots_);
+  for (const auto& slot : old_slots) {
+    if (slot.value != EMPTY) {
+      slots_[position_(slot.key)] = slot;
+    }
+  }
+}
+
+CandidateStore::CandidateStore(CandidateStoreOptions options)
+    : options_(std::move(options)) {
+}
+
+CandidateStore::~CandidateStore() {
+  if (spill_file_) {
+    std::fclose(spill_file_);
+  }
+}
+
+void CandidateStore::clear() {
+  records_.clear();
+  index_.clear();
+  unchecked_ = decltype(unchecked_)();
+  checked_.clear();
+  best_checked_ = boost::none;
+  memory_usage_ = 0;
+  spilled_bytes_ = 0;
+  spilled_checked_ = 0;
+  spilled_records_ = 0;
+  spill_end_ = 0;
+  cached_id_ = NO_PARENT;
+  cached_tuple_.clear();
+}
+
+bool CandidateStore::insert(hash_t h, const std::vector<Word>& tuple, const Word& conjugator) {
+  return add_(h, tuple, NO_PARENT, conjugator);
+}
+
+bool CandidateStore::insert(hash_t h, const std::vector<Word>& tuple, hash_t parent, const Word& c) {
+  return add_(h, tuple, id_(parent), c);
+}
+
+bool CandidateStore::add_(hash_t h, const std::vector<Word>& tuple, uint32_t parent, const Word& c) {
+  if (records_.size() >= NO_PARENT) {
+    throw std::length_error("Too many candidates.");
+  }
+
+  if (contains(h)) {
+    return false;
+  }
+
+  Record record;
+  record.hash = h;
+  record.parent = parent;
+  record.delta_depth = 0;
+  record.length = 0;
+  record.conjugator = encodeWord(c);
+  record.spill_offset = -1;
+  record.spill_size = 0;
+
+  for (const auto& w : tuple) {
+    record.length += w.length();
+  }
+
+  if (parent != NO_PARENT && records_[parent].delta_depth < options_.max_delta_chain) {
+    const auto& parent_tuple = cachedTuple_(parent);
+    if (parent_tuple.size() == tuple.size()) {
+      record.tuple = encodeDelta(tuple, parent_tuple);
+      record.delta_depth = records_[parent].delta_depth + 1;
+    }
+  }
+  if (record.delta_depth == 0) {
+    record.tuple = encodeFull(tuple);
+  }
+
+  index_.insert(h, static_cast<uint32_t>(records_.size()));
+  memory_usage_ += record.tuple.size();
+  unchecked_.emplace(record.length, h);
+  records_.push_back(std::move(record));
+
+  enforceBudget_();
+  return true;
+}
+
+uint32_t CandidateStore::id_(hash_t h) const {
+  const auto id = index_.find(h);
+  if (!id) {
+    throw std::invalid_argument("Unknown candidate.");
+  }
+  return *id;
+}
+
+boost::optional<CandidateStore::hash_t> CandidateStore::popBest() {
+  if (unchecked_.empty()) {
+    return boost::none;
+  }
+
+  const auto best = unchecked_.top();
+  unchecked_.pop();
+
+  checked_.push_back(id_(best.second));
+
+  if (!best_checked_ || best < best_checked_.get()) {
+    best_checked_ = best;
+  }
+
+  enforceBudget_();
+  return best.second;
+}
+
+boost::optional<CandidateStore::hash_t> CandidateStore::bestChecked() const {
+  if (!best_checked_) {
+    return boost::none;
+  }
+  return best_checked_->second;
+}
+
+std::vector<Word> CandidateStore::tuple(hash_t h) const {
+  return cachedTuple_(id_(h));
+}
+
+Word CandidateStore::conjugator(hash_t h) const {
+  std::vector<uint32_t> chain;
+  for (auto id = id_(h); id != NO_PARENT; id = records_[id].parent) {
+    chain.push_back(id);
+  }
+
+  Word result;
+  for (auto it = chain.rbegin(); it != chain.rend(); ++it) {
+    result *= decodeWord(records_[*it].conjugator);
+  }
+  return result;
+}
+
+size_t CandidateStore::length(hash_t h) const {
+  return records_[id_(h)].length;
+}
+
+const std::vector<Word>& CandidateStore::cachedTuple_(uint32_t id) const {
+  if (cached_id_ != id) {
+    cached_tuple_ = decode_(id);
+    cached_id_ = id;
+  }
+  return cached_tuple_;
+}
+
+std::vector<Word> CandidateStore::decode_(uint32_t id) const {
+  const auto data = encodedTuple_(id);
+  size_t pos = 0;
+
+  std::vector<Word> result;
+  std::vector<int> letters;
+
+  if (getVarint(data, pos) == FULL) {
+    const auto count = getVarint(data, pos);
+    result.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+      letters.clear();
+      getLetters(data, pos, getVarint(data, pos), letters);
+      result.push_back(Word(letters));
+    }
+    return result;
+  }
+
+  const auto parent = cached_id_ == records_[id].parent ? cached_tuple_ : decode_(records_[id].parent);
+  result.reserve(parent.size());
+  for (const auto& p : parent) {
+    const auto pv = p.toVector();
+
+    letters.clear();
+    getLetters(data, pos, getVarint(data, pos), letters);
+    const auto start = getVarint(data, pos);
+    const auto common = getVarint(data, pos);
+    if (start + common > pv.size()) {
+      throw std::runtime_error("Corrupted candidate record.");
+    }
+    letters.insert(letters.end(), pv.begin() + start, pv.begin() + start + common);
+    getLetters(data, pos, getVarint(data, pos), letters);
+    result.push_back(Word(letters));
+  }
+  return result;
+}
+
+std::string CandidateStore::encodedTuple_(uint32_t id) const {
+  const auto& record = records_[id];
+  if (record.spill_offset < 0) {
+    return record.tuple;
+  }
+
+  std::string result(record.spill_size, '\0');
+  if (std::fseek(spill_file_, record.spill_offset, SEEK_SET) != 0 ||
+      std::fread(&result[0], 1, result.size(), spill_file_) != result.size()) {
+    throw std::runtime_error("Cannot read the candidates spill file.");
+  }
+  return result;
+}
+
+void CandidateStore::enforceBudget_() {
+  if (options_.memory_budget == 0) {
+    return;
+  }
+
+  // checked candidates are needed only as parents and for the final conjugator, spill them first
+  while (memory_usage_ > options_.memory_budget && spilled_checked_ < checked_.size()) {
+    spill_(checked_[spilled_checked_++]);
+  }
+  while (memory_usage_ > options_.memory_budget && spilled_records_ < records_.size()) {
+    spill_(spilled_records_++);
+  }
+}
+
+void CandidateStore::spill_(uint32_t id) {
+  auto& record = records_[id];
+  if (record.spill_offset >= 0) {
+    return;
+  }
+
+  if (!spill_file_) {
+    spill_file_ = options_.spill_path.empty() ? std::tmpfile() : std::fopen(options_.spill_path.c_str(), "w+b");
+    if (!spill_file_) {
+      throw std::runtime_error("Cannot open the candidates spill file.");
+    }
+  }
+
+  if (std::fseek(spill_file_, spill_end_, SEEK_SET) != 0 ||
+      std::fwrite(record.tuple.data(), 1, record.tuple.size(), spill_file_) != record.tuple.size()) {
+    throw std::runtime_error("Cannot write the candidates spill file.");
+  }
+
+  record.spill_offset = spill_end_;
+  record.spill_size = record.tuple.size();
+  spill_end_ += record.tuple.size();
+
+  memory_usage_ -= record.tuple.size();
+  spilled_bytes_ += record.tuple.size();
+  std::string().swap(record.tuple);
+}
+} // namespace walnut
+} // namespace crag
@@ -0,0 +1,166 @@
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <random>
+
+#include "walnut_candidates.h"
+
+#include "random_word.h"
+
+namespace crag {
+namespace walnut {
+namespace {
+
+TEST(HashIndex, InsertFind) {
+  HashIndex index;
+  EXPECT_EQ(nullptr, index.find(0));
+
+  for (uint32_t i = 0; i < 1000; ++i) {
+    EXPECT_TRUE(index.insert(i * 1024, i));
+  }
+  EXPECT_FALSE(index.insert(1024, 0));
+  EXPECT_EQ(1000, index.size());
+
+  for (uint32_t i = 0; i < 1000; ++i) {
+    ASSERT_NE(nullptr, index.find(i * 1024));
+    EXPECT_EQ(i, *index.find(i * 1024));
+  }
+  EXPECT_EQ(nullptr, index.find(1));
+
+  index.clear();
+  EXPECT_EQ(0, index.size());
+  EXPECT_EQ(nullptr, index.find(0));
+}
+
+TEST(CandidateStore, Order) {
+  CandidateStore store;
+  EXPECT_FALSE(store.popBest());
+  EXPECT_FALSE(store.bestChecked());
+
+  EXPECT_TRUE(store.insert(5, {"x1 x2 x3"_w}, Word()));
+  EXPECT_TRUE(store.insert(7, {"x1"_w, "x2"_w}, 5, "x1"_w));
+  EXPECT_TRUE(store.insert(3, {"x2 x1"_w}, 5, "x2"_w));
+  EXPECT_FALSE(store.insert(3, {"x1"_w}, Word()));
+  EXPECT_TRUE(store.contains(7));
+  EXPECT_FALSE(store.contains(4));
+
+  // shortest first, the smaller hash on ties
+  EXPECT_EQ(3, store.popBest().get());
+  EXPECT_EQ(3, store.bestChecked().get());
+  EXPECT_EQ(7, store.popBest().get());
+  EXPECT_EQ(3, store.bestChecked().get());
+  EXPECT_EQ(5, store.popBest().get());
+  EXPECT_FALSE(store.popBest());
+  EXPECT_EQ(3, store.checkedCount());
+
+  store.clear();
+  EXPECT_EQ(0, store.size());
+  EXPECT_FALSE(store.contains(3));
+  EXPECT_FALSE(store.bestChecked());
+}
+
+TEST(CandidateStore, Conjugators) {
+  CandidateStore store;
+  store.insert(1, {"x1"_w}, "x3 x2"_w);
+  store.insert(2, {"x1"_w}, 1, "x2^-1 x1"_w);
+  store.insert(3, {"x1"_w}, 2, "x4"_w);
+
+  EXPECT_EQ("x3 x2"_w, store.conjugator(1));
+  EXPECT_EQ("x3 x1"_w, store.conjugator(2));
+  EXPECT_EQ("x3 x1 x4"_w, store.conjugator(3));
+  EXPECT_THROW(store.conjugator(4), std::invalid_argument);
+  EXPECT_THROW(store.insert(5, {"x1"_w}, 4, "x1"_w), std::invalid_argument);
+}
+
+class CandidateStoreTuples : public ::testing::TestWithParam<size_t> {};
+
+TEST_P(CandidateStoreTuples, Roundtrip) {
+  std::mt19937 g(0);
+  const int n = 8;
+
+  CandidateStoreOptions options;
+  options.memory_budget = GetParam();
+  options.max_delta_chain = 3;
+  CandidateStore store(options);
+
+  std::vector<std::vector<Word>> tuples;
+
+  for (size_t i = 0; i < 200; ++i) {
+    std::vector<Word> tuple;
+    if (i == 0) {
+      for (size_t j = 0; j < 4; ++j) {
+        tuple.push_back(random::randomWord(n - 1, 1, 100, g));
+      }
+      store.insert(i, tuple, Word());
+    } else {
+      // a modification of a random earlier tuple
+      const auto parent = std::uniform_int_distribution<size_t>(0, i - 1)(g);
+      for (const auto& w : tuples[parent]) {
+        const auto pos = std::uniform_int_distribution<size_t>(0, w.length())(g);
+        tuple.push_back(w.subword(0, pos) * random::randomWord(n - 1, 0, 5, g) * w.subword(pos, w.length()));
+      }
+      store.insert(i, tuple, parent, Word());
+    }
+    tuples.push_back(tuple);
+
+    if (i % 3 == 0) {
+      store.popBest();
+    }
+  }
+
+  for (size_t i = 0; i < tuples.size(); ++i) {
+    EXPECT_EQ(tuples[i], store.tuple(i));
+  }
+
+  if (options.memory_budget) {
+    EXPECT_LE(store.memoryUsage(), options.memory_budget);
+    EXPECT_GT(store.spilledBytes(), 0);
+  } else {
+    EXPECT_EQ(0, store.spilledBytes());
+  }
+}
+
+INSTANTIATE_TEST_CASE_P(MemoryBudget, CandidateStoreTuples, ::testing::Values(0, 1, 2000));
+
+TEST(CandidateStore, DeltaEncoding) {
+  const std::vector<Word> tuple = {"x1 x2 x3 x4 x5 x6 x7 x1 x2 x3"_w, "x7 x6 x5 x4 x3 x2 x1"_w};
+  const std::vector<Word> conjugated = {"x2^-1 x1 x2 x3 x4 x5 x6 x7 x1 x2 x3 x2"_w, "x2^-1 x7 x6 x5 x4 x3 x2 x1 x2"_w};
+
+  CandidateStoreOptions options;
+  options.max_delta_chain = 0;
+  CandidateStore full(options);
+  CandidateStore delta;
+
+  for (auto* store : {&full, &delta}) {
+    store->insert(1, tuple, Word());
+    store->insert(2, conjugated, 1, "x2"_w);
+    EXPECT_EQ(conjugated, store->tuple(2));
+  }
+  EXPECT_LT(delta.memoryUsage(), full.memoryUsage());
+}
+
+TEST(CandidateStore, SpillPath) {
+  const std::string path = "test_walnut_candidates.spill";
+
+  CandidateStoreOptions options;
+  options.memory_budget = 1;
+  options.spill_path = path;
+
+  {
+    CandidateStore store(options);
+    store.insert(1, {"x1 x2"_w, "x3^-1"_w}, Word());
+    EXPECT_EQ(0, store.memoryUsage());
+    EXPECT_EQ(std::vector<Word>({"x1 x2"_w, "x3^-1"_w}), store.tuple(1));
+  }
+
+  EXPECT_EQ(0, std::remove(path.c_str()));
+}
+
+TEST(CandidateStore, InvalidRank) {
+  CandidateStore store;
+  EXPECT_THROW(store.insert(1, {Word(200)}, Word()), std::invalid_argument);
+}
+
+} // namespace
+} // namespace walnut
+} // namespace crag
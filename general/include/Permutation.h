@@ -9,6 +9,7 @@
 #ifndef CRAG_PERMUTATION_H
 #define CRAG_PERMUTATION_H
 
+#include <cstdint>
 #include <map>
 #include <ostream>
 #include <vector>
@@ -17,9 +18,16 @@
 /*!
   We use the standard representation of a permutation on \f$n\f$ symbols - a sequence of distinct numbers
   \f$( x_0, \ldots, x_{n-1} )\f$ from 0 to n-1. Notice that indices start at 0.
+
+  Permutations on at most SMALL_SIZE symbols (braid permutations are usually of that size) are stored inline
+  as 16 bytes, the remaining bytes fix their positions. Such permutations are composed by a single byte shuffle
+  when SSSE3 is enabled (e.g., -mssse3 or -march=native). Larger permutations are stored in a std::vector.
 */
 class Permutation {
 public:
+  //! Maximal size of the permutations stored inline
+  static const size_t SMALL_SIZE = 16;
+
   Permutation() = default;
 
   //! Creates trivial permutation of specified length
@@ -29,22 +37,18 @@ public:
   explicit Permutation(std::vector<int> values);
 
   explicit Permutation(std::initializer_list<int> p)
-      : values_(p) {
-    validate_();
-  }
+      : Permutation(std::vector<int>(p)) {}
 
   //! Construct a permutation by a sequence of numbers
   template <class InputIterator>
   Permutation(InputIterator begin, InputIterator end)
-      : values_(begin, end) {
-    validate_();
-  }
+      : Permutation(std::vector<int>(begin, end)) {}
 
   std::string toString() const;
 
   //! Get the ith element of the permutation
   int operator[](size_t i) const {
-    return values_[i];
+    return isSmallIndex_(i) ? small_[i] : large_[i];
   }
 
   //! Check if 2 permutations are equal
@@ -81,20 +85,22 @@ public:
 
   //! Swap the values at uth and jth position (multiply this by a cycle (i,j) on the left)
   void change(size_t i, size_t j) {
-    std::swap(values_[i], values_[j]);
+    if (isSmallIndex_(i) && isSmallIndex_(j)) {
+      std::swap(small_[i], small_[j]);
+    } else {
+      std::swap(large_[i], large_[j]);
+    }
   }
 
   //! Get the vector of numbers which represents the permutation.
-  const std::vector<int>& getVector() const {
-    return values_;
-  }
+  std::vector<int> getVector() const;
 
   //! Raise the permutation into the power p.
   Permutation power(int p) const;
 
   //! Get the size of the permutation
   size_t size() const {
-    return values_.size();
+    return size_;
   }
 
   //! Increase the size of a permutation.
@@ -193,9 +199,37 @@ public:
   Permutation join2(const Permutation& p) const;
 
 private:
-  std::vector<int> values_;
+  bool isSmall_() const {
+    return size_ <= SMALL_SIZE;
+  }
+
+  //! Checks that the ith element is stored inline. The index is checked first, so that an index out of small_ never
+  //! reaches it, even if the compiler can't tell that i < size_.
+  bool isSmallIndex_(size_t i) const {
+    return i < SMALL_SIZE && isSmall_();
+  }
+
+  //! Set the ith element of the permutation
+  void set_(size_t i, int value) {
+    if (isSmallIndex_(i)) {
+      small_[i] = static_cast<uint8_t>(value);
+    } else {
+      large_[i] = value;
+    }
+  }
+
+  //! Construct a permutation by a vector of numbers without validation
+  static Permutation fromValues_(const std::vector<int>& values);
+
+  size_t size_ = 0;
+
+  //! The images if size_ <= SMALL_SIZE, the other bytes are equal to their indices
+  alignas(16) uint8_t small_[SMALL_SIZE] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15};
+
+  //! The images if size_ > SMALL_SIZE
+  std::vector<int> large_;
 
-  void validate_() const;
+  static void validate_(const std::vector<int>& permutation);
 
   //! (Aux) The main operation to compute RightGCD and all other lattice functions
   void _sub_meet(
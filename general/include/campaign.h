@@ -0,0 +1,116 @@
+#pragma once
+
+#ifndef CRAG_CAMPAIGN_H
+#define CRAG_CAMPAIGN_H
+
+#include <functional>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+#include <boost/optional.hpp>
+
+#include "phase_timer.h"
+
+namespace crag {
+namespace campaign {
+
+enum class Status { SUCCESS, FAILURE, TIMEOUT, CRASH };
+
+std::string toString(Status status);
+
+//! Result of the experiment for one seed, a line of a campaign log.
+struct InstanceRecord {
+  size_t seed = 0;
+  Status status = Status::FAILURE;
+
+  //! seconds
+  double wall_time = 0;
+
+  //! kilobytes
+  size_t peak_rss = 0;
+
+  std::vector<PhaseTime> phases;
+};
+
+//! Formats the record as a single line (without the line end) of the form
+//!     seed=3 status=success wall=12.5 rss_kb=40960 phases=uncloaking:1.5,enumeration:11
+std::string formatRecord(const InstanceRecord& record);
+
+//! Parses a line produced by formatRecord, returns none for a malformed (e.g. truncated) line.
+boost::optional<InstanceRecord> parseRecord(const std::string& line);
+
+//! Reads all well-formed records of the log, the log may not exist.
+std::vector<InstanceRecord> readLog(const std::string& path);
+
+//! Aggregated results of a campaign.
+struct Summary {
+  size_t instances = 0;
+  size_t successes = 0;
+  size_t failures = 0;
+  size_t timeouts = 0;
+  size_t crashes = 0;
+
+  //! total time of all instances, seconds
+  double instances_time = 0;
+
+  //! maximal peak RSS of an instance, kilobytes
+  size_t peak_rss = 0;
+
+  //! instances completed by the last run and its duration in seconds
+  size_t completed = 0;
+  double elapsed = 0;
+
+  void add(const InstanceRecord& record);
+
+  double successRate() const;
+
+  //! instances completed per hour by the last run
+  double throughput() const;
+};
+
+std::ostream& operator<<(std::ostream& out, const Summary& summary);
+
+struct CampaignOptions {
+  size_t first_seed = 0;
+  size_t count = 100;
+
+  //! number of instances run simultaneously
+  size_t workers = 1;
+
+  //! threads used by crag::parallel inside every instance, 0 keeps the default
+  size_t threads_per_instance = 0;
+
+  //! seconds, an instance running longer is killed and recorded as timed out (0 means no limit)
+  double time_limit = 0;
+
+  //! append-only log; the seeds recorded in it are not run again, so an interrupted campaign can be resumed
+  std::string log_path = "campaign.log";
+
+  //! if not empty, the output of the instance with seed i goes to the file <output_directory>/seed_<i>.log
+  std::string output_directory;
+
+  //! print a line to std::cout after every instance
+  bool verbose = true;
+};
+
+//! Reads the options from the command line, the values of defaults are used for the missing ones.
+//! Returns none if the help was requested (it is printed to std::cout). Throws std::invalid_argument on errors.
+boost::optional<CampaignOptions> parseCommandLine(int argc, char** argv, const CampaignOptions& defaults);
+
+//! Experiment for the instance with the given seed, returns true on success.
+using Experiment = std::function<bool(size_t seed)>;
+
+//! Runs the experiment for seeds first_seed, ..., first_seed + count - 1 which are not recorded in the log yet.
+/*!
+  Every instance is run in a separate child process (POSIX fork), at most options.workers at a time, so that an
+  instance can be stopped at the time limit and its peak memory usage is measured separately.
+  Results are appended to the log as soon as an instance is finished.
+  Returns the summary over all records of the log for the seeds of the campaign.
+ */
+Summary run(const CampaignOptions& options, const Experiment& experiment);
+
+} // namespace campaign
+} // namespace crag
+
+#endif // CRAG_CAMPAIGN_H
@@ -6,6 +6,7 @@
 #include <boost/container/vector.hpp>
 
 #include <atomic>
+#include <functional>
 #include <thread>
 #include <vector>
 
@@ -14,37 +15,36 @@ namespace parallel {
 
 size_t getHardwareConcurrency();
 
+//! Number of threads (including the calling one) used by forEach, map and bmap.
+//! Defaults to the value of the CRAG_NUM_THREADS environment variable if it is set,
+//! and to getHardwareConcurrency() otherwise.
+size_t getThreadsCount();
+
+//! Sets the number of threads used by forEach, map and bmap (0 means getHardwareConcurrency()).
+//! Restarts the process-wide thread pool, so it must not be called while a parallel loop is running.
+//! A forked child keeps the threads count, but forgets the workers of its parent and starts its own pool
+//! on first use, so a fork must not happen while a parallel loop is running either.
+void setThreadsCount(size_t threads_count);
+
+namespace details {
+//! Invokes range_fn(begin, end) for disjoint chunks [begin, end) covering [0, n).
+//! Chunks are executed by the calling thread together with the process-wide work-stealing pool.
+//! If the call is made from a pool thread (nested loops), no new threads are involved:
+//! the chunks are offered to idle pool threads and the caller keeps working on pending tasks.
+//! The first exception thrown by range_fn is rethrown in the calling thread.
+void forEachRange(size_t n, const std::function<void(size_t, size_t)>& range_fn);
+} // namespace details
+
 //! Parallel for-each invoking fn for each i = 0,...,n-1.
 //! Function is of type
 //!     void fn(size_t)
 template <typename Function>
 void forEach(size_t n, Function fn) {
-  std::atomic<size_t> index(0);
-
-  const auto thread_fn = [&]() {
-    while (true) {
-      const auto i = index.fetch_add(1);
-
-      if (i >= n) {
-        return;
-      }
-
+  details::forEachRange(n, [&fn](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i) {
       fn(i);
     }
-  };
-
-  const auto threads_count = std::min(n, getHardwareConcurrency());
-
-  std::vector<std::thread> threads;
-  threads.reserve(threads_count);
-
-  for (size_t i = 0; i < threads_count; ++i) {
-    threads.push_back(std::thread(thread_fn));
-  }
-
-  for (size_t i = 0; i < threads_count; ++i) {
-    threads[i].join();
-  }
+  });
 }
 
 //! Parallel for-each.
@@ -0,0 +1,48 @@
+#pragma once
+
+#ifndef CRAG_PHASE_TIMER_H
+#define CRAG_PHASE_TIMER_H
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+namespace crag {
+namespace campaign {
+
+//! Time spent by an instance in a named phase of an attack.
+struct PhaseTime {
+  std::string name;
+  double seconds;
+};
+
+//! Adds seconds to the phase of the instance run by the current process.
+//! Phase names must not contain whitespace, ',' or ':'.
+void addPhaseTime(const std::string& name, double seconds);
+
+//! Returns and resets the phase times collected by the current process.
+std::vector<PhaseTime> takePhaseTimes();
+
+//! Measures the time between its construction and destruction as a phase of the current instance.
+class ScopedPhase {
+public:
+  explicit ScopedPhase(std::string name)
+      : name_(std::move(name))
+      , start_(std::chrono::steady_clock::now()) {}
+
+  ~ScopedPhase() {
+    addPhaseTime(name_, std::chrono::duration<double>(std::chrono::steady_clock::now() - start_).count());
+  }
+
+  ScopedPhase(const ScopedPhase&) = delete;
+  ScopedPhase& operator=(const ScopedPhase&) = delete;
+
+private:
+  std::string name_;
+  std::chrono::steady_clock::time_point start_;
+};
+
+} // namespace campaign
+} // namespace crag
+
+#endif // CRAG_PHASE_TIMER_H
@@ -6,24 +6,56 @@
 
 #include "Permutation.h"
 
+#include <algorithm>
 #include <cassert>
+#include <cstring>
 #include <limits>
 #include <list>
 #include <set>
 #include <sstream>
 
+#ifdef __SSSE3__
+#include <tmmintrin.h>
+#endif
+
 #include "RanlibCPP.h"
 
 Permutation::Permutation(size_t l)
-    : values_(l) {
-  for (size_t i = 0; i < l; ++i) {
-    values_[i] = i;
+    : size_(l) {
+  if (!isSmall_()) {
+    large_.resize(l);
+    for (size_t i = 0; i < l; ++i) {
+      large_[i] = i;
+    }
   }
 }
 
-Permutation::Permutation(std::vector<int> values)
-    : values_(std::move(values)) {
-  validate_();
+Permutation::Permutation(std::vector<int> values) {
+  validate_(values);
+  *this = fromValues_(values);
+}
+
+Permutation Permutation::fromValues_(const std::vector<int>& values) {
+  Permutation result;
+  result.size_ = values.size();
+
+  if (result.isSmall_()) {
+    for (size_t i = 0; i < values.size(); ++i) {
+      result.small_[i] = static_cast<uint8_t>(values[i]);
+    }
+  } else {
+    result.large_ = values;
+  }
+
+  return result;
+}
+
+std::vector<int> Permutation::getVector() const {
+  if (!isSmall_()) {
+    return large_;
+  }
+
+  return std::vector<int>(small_, small_ + size_);
 }
 
 std::string Permutation::toString() const {
@@ -56,7 +88,7 @@ Permutation Permutation::power(int p) const {
 
 Permutation& Permutation::left_mult_by_cycle(const std::vector<int>& cycle) {
   for (size_t i = 1; i < cycle.size(); ++i)
-    std::swap(values_[cycle[i - 1]], values_[cycle[i]]);
+    change(cycle[i - 1], cycle[i]);
 
   return *this;
 }
@@ -66,43 +98,43 @@ void Permutation::lr_multiply_by_cycles(
   for (size_t i = 1; i < M1.size(); ++i) {
     int a = M1[i - 1];
     int b = M1[i];
-    int c = P.values_[a];
-    int d = P.values_[b];
-    std::swap(P.values_[a], P.values_[b]);
-    std::swap(I.values_[c], I.values_[d]);
+    int c = P[a];
+    int d = P[b];
+    P.change(a, b);
+    I.change(c, d);
   }
 
   for (int i = M2.size() - 1; i > 0; --i) {
     int a = M2[i - 1];
     int b = M2[i];
-    int c = I.values_[a];
-    int d = I.values_[b];
-    std::swap(I.values_[a], I.values_[b]);
-    std::swap(P.values_[c], P.values_[d]);
+    int c = I[a];
+    int d = I[b];
+    I.change(a, b);
+    P.change(c, d);
   }
 }
 
 Permutation Permutation::computeConjugacyClassRepresentative(Permutation& conj) const {
   int i;
-  int size = values_.size();
+  int size = this->size();
   Permutation p1(*this);
   conj = Permutation(size);
 
   // 1. arrange cycles
   std::set<std::pair<int, int>> cycles;
   for (i = 0; i < size; ++i) {
-    if (p1.values_[i] != i) {
+    if (p1[i] != i) {
       int r = i;
       do {
-        if (p1.values_[r] != r + 1) {
+        if (p1[r] != r + 1) {
           Permutation c(size);
-          c.change(r + 1, p1.values_[r]);
+          c.change(r + 1, p1[r]);
 
           p1 = c * p1 * c;
           conj *= c;
         }
-        r = p1.values_[r];
-      } while (p1.values_[r] != i);
+        r = p1[r];
+      } while (p1[r] != i);
       cycles.insert(std::pair<int, int>(r + 1 - i, i));
       i = r;
     } else
@@ -125,13 +157,13 @@ Permutation Permutation::computeConjugacyClassRepresentative(Permutation& conj)
       Permutation c3(size);
 
       for (i = pos; i < pt + len; ++i)
-        c1.values_[i] = pt + len - 1 - (i - pos);
+        c1.set_(i, pt + len - 1 - (i - pos));
 
       for (i = pos; i < pos + len; ++i)
-        c2.values_[i] = pos + len - 1 - (i - pos);
+        c2.set_(i, pos + len - 1 - (i - pos));
 
       for (i = pos + len; i < pt + len; ++i)
-        c3.values_[i] = pt + len - 1 - (i - pos - len);
+        c3.set_(i, pt + len - 1 - (i - pos - len));
 
       // 2.2. shift cycle to a position pos
       p1 = c1 * p1 * c1.inverse();
@@ -158,8 +190,8 @@ Permutation Permutation::computeConjugacyClassRepresentative(Permutation& conj)
 }
 
 Permutation Permutation::computeConjugator(const Permutation& p) const {
-  int size = values_.size();
-  assert(size == p.values_.size());
+  int size = this->size();
+  assert(size == p.size());
   //  if( size!=p.theValue.size( ) ) Do something with this!!!
   //    return false;
 
@@ -293,10 +325,10 @@ std::vector<int> Permutation::getWordPresentation() const {
 
 
   // second implementation
-  std::vector<int> val(values_);
+  std::vector<int> val(getVector());
   Permutation inv = inverse();
-  std::vector<int> inv_val(inv.values_);
-  for (int i = 0; i < values_.size(); ++i) {
+  std::vector<int> inv_val(inv.getVector());
+  for (int i = 0; i < size(); ++i) {
     if (val[i] != i) {
       int r = val[i];
       int t = inv_val[i];
@@ -323,11 +355,11 @@ std::vector<int> Permutation::geodesic() const {
   Permutation inv(size());
 
   for (int i = 0; i < size(); ++i) {
-    int pos = inv.values_[values_[i]];
+    int pos = inv[(*this)[i]];
 
     for (int j = pos - 1; j >= i; --j) {
       result.push_back(j);
-      inv.change(cur.values_[j], cur.values_[j + 1]);
+      inv.change(cur[j], cur[j + 1]);
       cur.change(j, j + 1);
     }
   }
@@ -350,8 +382,12 @@ std::vector<int> Permutation::geodesicWord() const {
 }
 
 bool Permutation::isTrivial() const {
-  for (size_t i = 0; i < values_.size(); ++i) {
-    if (values_[i] != i) {
+  if (isSmall_()) {
+    return std::memcmp(small_, Permutation().small_, SMALL_SIZE) == 0;
+  }
+
+  for (size_t i = 0; i < large_.size(); ++i) {
+    if (large_[i] != i) {
       return false;
     }
   }
@@ -360,11 +396,19 @@ bool Permutation::isTrivial() const {
 }
 
 bool Permutation::operator==(const Permutation& p) const {
-  return values_ == p.values_;
+  if (size_ != p.size_) {
+    return false;
+  }
+
+  if (isSmall_()) {
+    return std::memcmp(small_, p.small_, SMALL_SIZE) == 0;
+  }
+
+  return large_ == p.large_;
 }
 
 bool Permutation::operator!=(const Permutation& p) const {
-  return values_ != p.values_;
+  return !(*this == p);
 }
 
 bool Permutation::operator<(const Permutation& p) const {
@@ -372,17 +416,11 @@ bool Permutation::operator<(const Permutation& p) const {
     return size() < p.size();
   }
 
-  for (size_t t = 0; t < values_.size(); ++t) {
-    if (values_[t] < p.values_[t]) {
-      return true;
-    }
-
-    if (values_[t] > p.values_[t]) {
-      return false;
-    }
+  if (isSmall_()) {
+    return std::memcmp(small_, p.small_, size_) < 0;
   }
 
-  return false;
+  return large_ < p.large_;
 }
 
 Permutation Permutation::operator*(const Permutation& p) const {
@@ -390,29 +428,54 @@ Permutation Permutation::operator*(const Permutation& p) const {
 }
 
 Permutation& Permutation::operator*=(const Permutation& other) {
+  if (isSmall_() && other.isSmall_()) {
+    // the bytes after the images fix their positions, so permutations of different sizes are composed as well
+    size_ = std::max(size_, other.size_);
+#ifdef __SSSE3__
+    const __m128i indices = _mm_load_si128(reinterpret_cast<const __m128i*>(small_));
+    const __m128i images = _mm_load_si128(reinterpret_cast<const __m128i*>(other.small_));
+    _mm_store_si128(reinterpret_cast<__m128i*>(small_), _mm_shuffle_epi8(images, indices));
+#else
+    for (size_t t = 0; t < size_; ++t) {
+      small_[t] = other.small_[small_[t]];
+    }
+#endif
+    return *this;
+  }
+
+  std::vector<int> values = getVector();
+
   if (size() < other.size()) {
     for (size_t i = size(); i < other.size(); ++i) {
-      values_.push_back(i);
+      values.push_back(i);
     }
   }
 
-  for (size_t t = 0; t < size(); ++t) {
-    if (values_[t] < other.size()) {
-      values_[t] = other[values_[t]];
+  for (size_t t = 0; t < values.size(); ++t) {
+    if (values[t] < other.size()) {
+      values[t] = other[values[t]];
     }
   }
 
-  return *this;
+  return *this = fromValues_(values);
 }
 
 Permutation Permutation::inverse() const {
-  std::vector<int> result(size());
+  Permutation result;
+  result.size_ = size_;
 
-  for (size_t t = 0; t < size(); ++t) {
-    result[values_[t]] = t;
+  if (isSmall_()) {
+    for (size_t t = 0; t < SMALL_SIZE; ++t) {
+      result.small_[small_[t]] = t;
+    }
+  } else {
+    result.large_.resize(size_);
+    for (size_t t = 0; t < size_; ++t) {
+      result.large_[large_[t]] = t;
+    }
   }
 
-  return Permutation(std::move(result));
+  return result;
 }
 
 size_t Permutation::difference(const Permutation& p) const {
@@ -423,7 +486,7 @@ size_t Permutation::difference(const Permutation& p) const {
   size_t result = 0;
 
   for (size_t i = 0; i < size(); ++i) {
-    if (values_[i] != p[i]) {
+    if ((*this)[i] != p[i]) {
       ++result;
     }
   }
@@ -436,7 +499,7 @@ Permutation Permutation::random(size_t n) {
 
   for (size_t t = 0; t + 1 < n; ++t) {
     auto pos = RandLib::ur.irand(0, n - t - 1);
-    std::swap(res.values_[t], res.values_[t + pos]);
+    res.change(t, t + pos);
   }
 
   return res;
@@ -462,8 +525,8 @@ std::ostream& operator<<(std::ostream& os, const Permutation& p) {
 
 Permutation Permutation::join2(const Permutation& p) const {
   int i;
-  int l1 = values_.size();
-  int l2 = p.values_.size();
+  int l1 = size();
+  int l2 = p.size();
   if (l1 != l2) {
     std::cerr << "Check dimensions in join2 operation" << std::endl;
     exit(1);
@@ -496,8 +559,8 @@ Permutation Permutation::join2(const Permutation& p) const {
       toCheck.pop_front();
       cycleN[cur] = i;
 
-      int next1 = values_[cur];
-      int next2 = p.values_[cur];
+      int next1 = (*this)[cur];
+      int next2 = p[cur];
 
       if (foundPts[next1] != i) {
         foundPts[next1] = i;
@@ -530,8 +593,8 @@ Permutation Permutation::join2(const Permutation& p) const {
 
 Permutation Permutation::meet2(const Permutation& p) const {
   int i;
-  int l1 = values_.size();
-  int l2 = p.values_.size();
+  int l1 = size();
+  int l2 = p.size();
   if (l1 != l2) {
     std::cerr << "Check dimensions in meet2 operation" << std::endl;
     exit(1);
@@ -540,9 +603,9 @@ Permutation Permutation::meet2(const Permutation& p) const {
   // 1. extract cycles from the second permutation
   std::vector<int> cycle2N(l1, 0);
   for (i = 0; i < l1; ++i) {
-    if (p.values_[i] != i && cycle2N[i] == 0) {
+    if (p[i] != i && cycle2N[i] == 0) {
       cycle2N[i] = i + 1;
-      for (int t = p.values_[i]; t != i; t = p.values_[t])
+      for (int t = p[i]; t != i; t = p[t])
         cycle2N[t] = i + 1;
     }
     // cout << cycle2N[i] << ",";
@@ -555,12 +618,12 @@ Permutation Permutation::meet2(const Permutation& p) const {
   std::vector<int> cycle1N(l1, 0);
 
   for (i = 0; i < l1; ++i) {
-    if (values_[i] != i && cycle1N[i] == 0) {
+    if ((*this)[i] != i && cycle1N[i] == 0) {
       cycle1N[i] = i + 1;
       std::vector<std::pair<int, int>> pairs;
       if (cycle2N[i])
         pairs.push_back(std::pair<int, int>(cycle2N[i], i));
-      for (int t = values_[i]; t != i; t = values_[t]) {
+      for (int t = (*this)[i]; t != i; t = (*this)[t]) {
         cycle1N[t] = i + 1;
         if (cycle2N[t])
           pairs.push_back(std::pair<int, int>(cycle2N[t], t));
@@ -637,7 +700,7 @@ Permutation Permutation::getHalfTwistPermutation(size_t n) {
     result[i] = n - i - 1;
   }
 
-  return Permutation(result);
+  return fromValues_(result);
 }
 
 Permutation Permutation::RightGCD(const Permutation& p) const {
@@ -647,19 +710,23 @@ Permutation Permutation::RightGCD(const Permutation& p) const {
     throw std::invalid_argument("Cannot compute RightGCD of permutation of different sizes.");
   }
 
-  int* l_ind_a = new int[this_size];
-  int* l_ind_b = new int[this_size];
-  int* r_ind_a = new int[this_size];
-  int* r_ind_b = new int[this_size];
+  // small permutations do not need heap buffers
+  int small_indices[4 * SMALL_SIZE];
+  std::vector<int> large_indices;
+  int* l_ind_a = small_indices;
+
+  if (this_size > SMALL_SIZE) {
+    large_indices.resize(4 * this_size);
+    l_ind_a = large_indices.data();
+  }
+
+  int* l_ind_b = l_ind_a + this_size;
+  int* r_ind_a = l_ind_b + this_size;
+  int* r_ind_b = r_ind_a + this_size;
 
   Permutation result(this_size);
   _sub_meet(p, inverse(), p.inverse(), result, l_ind_a, l_ind_b, r_ind_a, r_ind_b, 0, this_size);
 
-  delete[] l_ind_a;
-  delete[] l_ind_b;
-  delete[] r_ind_a;
-  delete[] r_ind_b;
-
   return result;
 }
 
@@ -679,10 +746,10 @@ Permutation Permutation::LeftLCM(const Permutation& p) const {
   return (Delta * P3.RightGCD(P4)).inverse();
 }
 
-void Permutation::validate_() const {
-  std::set<int> values(values_.begin(), values_.end());
+void Permutation::validate_(const std::vector<int>& permutation) {
+  std::set<int> values(permutation.begin(), permutation.end());
 
-  if (values.size() != size()) {
+  if (values.size() != permutation.size()) {
     throw std::invalid_argument("Permutation contains duplicates.");
   }
 
@@ -690,7 +757,7 @@ void Permutation::validate_() const {
     return;
   }
 
-  if ((*values.begin() != 0) || *values.rbegin() + 1 != size()) {
+  if ((*values.begin() != 0) || *values.rbegin() + 1 != permutation.size()) {
     throw std::invalid_argument("Permutation must be indexed from 0 to n-1.");
   }
 }
@@ -721,8 +788,8 @@ void Permutation::_sub_meet(
 
   // 1. find left indices
   for (int i = middle - 1; i >= beg; --i) {
-    int a = ip1.values_[cur.values_[i]];
-    int b = ip2.values_[cur.values_[i]];
+    int a = ip1[cur[i]];
+    int b = ip2[cur[i]];
 
     if (i == middle - 1) {
       l_ind_a[i] = a;
@@ -735,8 +802,8 @@ void Permutation::_sub_meet(
 
   // 2. find right indices
   for (int i = middle; i < end; ++i) {
-    int a = ip1.values_[cur.values_[i]];
-    int b = ip2.values_[cur.values_[i]];
+    int a = ip1[cur[i]];
+    int b = ip2[cur[i]];
 
     if (i == middle) {
       r_ind_a[i] = a;
@@ -750,49 +817,54 @@ void Permutation::_sub_meet(
   // 3. merge lists
   int i1 = beg;
   int i2 = middle;
-  int* new_sublist = new int[end - beg];
+  int small_sublist[SMALL_SIZE];
+  std::vector<int> large_sublist;
+  int* new_sublist = small_sublist;
+
+  if (end - beg > SMALL_SIZE) {
+    large_sublist.resize(end - beg);
+    new_sublist = large_sublist.data();
+  }
 
   for (int i = 0; i < end - beg; ++i) {
     if (i1 == middle) {
-      new_sublist[i] = cur.values_[i2++];
+      new_sublist[i] = cur[i2++];
       continue;
     }
 
     if (i2 == end) {
-      new_sublist[i] = cur.values_[i1++];
+      new_sublist[i] = cur[i1++];
       continue;
     }
 
     if (l_ind_a[i1] > r_ind_a[i2] && l_ind_b[i1] > r_ind_b[i2]) {
-      new_sublist[i] = cur.values_[i2++];
+      new_sublist[i] = cur[i2++];
     } else {
-      new_sublist[i] = cur.values_[i1++];
+      new_sublist[i] = cur[i1++];
     }
   }
 
   for (int i = 0; i < end - beg; ++i) {
-    cur.values_[beg + i] = new_sublist[i];
+    cur.set_(beg + i, new_sublist[i]);
   }
-
-  delete[] new_sublist;
 }
 
 Permutation Permutation::tinyFlip(int sh) const {
-  int len = values_.size();
+  int len = size();
   Permutation result(len);
 
   if (sh < 0)
     sh = sh - (sh / len - 1) * len;
 
   for (int t = 0; t < len; ++t)
-    result.values_[(t + sh) % len] = (values_[t] + sh) % len;
+    result.set_((t + sh) % len, ((*this)[t] + sh) % len);
 
   return result;
 }
 
 bool Permutation::mixable(const Permutation& p1, const Permutation& p2) {
-  int l1 = p1.values_.size();
-  int l2 = p2.values_.size();
+  int l1 = p1.size();
+  int l2 = p2.size();
   if (l1 != l2) {
     std::cerr << "Check dimensions in mixable operation" << std::endl;
     exit(1);
@@ -800,7 +872,7 @@ bool Permutation::mixable(const Permutation& p1, const Permutation& p2) {
 
   Permutation ip1 = p1.inverse();
   for (int i = 1; i < l1; ++i)
-    if (ip1.values_[i - 1] > ip1.values_[i] && p2.values_[i - 1] < p2.values_[i])
+    if (ip1[i - 1] > ip1[i] && p2[i - 1] < p2[i])
       return false;
 
   return true;
@@ -811,7 +883,7 @@ Permutation Permutation::flip() const {
   Permutation result(sz);
 
   for (int i = 0; i < sz; ++i)
-    result.values_[sz - i - 1] = sz - values_[i] - 1;
+    result.set_(sz - i - 1, sz - (*this)[i] - 1);
 
   return result;
 }
@@ -825,14 +897,14 @@ Permutation Permutation::increaseSize(size_t n) const {
     return *this;
   }
 
-  auto result = values_;
+  auto result = getVector();
   result.resize(n);
 
   for (size_t i = size(); i < n; ++i) {
     result[i] = i;
   }
 
-  return Permutation(result);
+  return fromValues_(result);
 }
 
 Permutation Permutation::getCyclePermutation(size_t n) {
@@ -846,7 +918,7 @@ Permutation Permutation::getCyclePermutation(size_t n) {
     result[n - 1] = 0;
   }
 
-  return Permutation(result);
+  return fromValues_(result);
 }
 
 std::vector<std::vector<int>> toCycles(const Permutation& p) {
@@ -0,0 +1,444 @@
+#include "campaign.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <boost/program_options.hpp>
+
+#include "parallel.h"
+
+namespace crag {
+namespace campaign {
+
+namespace {
+
+const std::pair<Status, const char*> STATUS_NAMES[] = {
+    {Status::SUCCESS, "success"},
+    {Status::FAILURE, "failure"},
+    {Status::TIMEOUT, "timeout"},
+    {Status::CRASH, "crash"},
+};
+
+std::string formatPhases(const std::vector<PhaseTime>& phases) {
+  std::ostringstream out;
+  for (size_t i = 0; i < phases.size(); ++i) {
+    out << (i ? "," : "") << phases[i].name << ":" << phases[i].seconds;
+  }
+  return out.str();
+}
+
+boost::optional<std::vector<PhaseTime>> parsePhases(const std::string& s) {
+  std::vector<PhaseTime> result;
+  std::istringstream in(s);
+  for (std::string item; std::getline(in, item, ',');) {
+    const auto colon = item.find(':');
+    if (colon == std::string::npos || colon == 0) {
+      return boost::none;
+    }
+    try {
+      result.push_back({item.substr(0, colon), std::stod(item.substr(colon + 1))});
+    } catch (const std::exception&) {
+      return boost::none;
+    }
+  }
+  return result;
+}
+
+//! An instance running in a child process.
+struct Worker {
+  size_t seed;
+  int pipe_fd;
+  std::chrono::steady_clock::time_point start;
+  bool killed;
+};
+
+//! Body of the child process, never returns.
+void runChild(const CampaignOptions& options, const Experiment& experiment, size_t seed, int pipe_fd) {
+  if (!options.output_directory.empty()) {
+    const auto path = options.output_directory + "/seed_" + std::to_string(seed) + ".log";
+    const auto fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd >= 0) {
+      ::dup2(fd, STDOUT_FILENO);
+      ::dup2(fd, STDERR_FILENO);
+      ::close(fd);
+    }
+  }
+
+  if (options.threads_per_instance) {
+    parallel::setThreadsCount(options.threads_per_instance);
+  }
+
+  takePhaseTimes();
+
+  int exit_code = 0;
+  std::string message;
+
+  try {
+    message = experiment(seed) ? "1" : "0";
+    message += " " + formatPhases(takePhaseTimes()) + "\n";
+  } catch (const std::exception& e) {
+    std::cerr << "Instance " << seed << " failed with exception: " << e.what() << std::endl;
+    exit_code = 1;
+  }
+
+  std::cout.flush();
+  std::cerr.flush();
+
+  // a short message does not block, the parent reads the pipe after the child exits
+  if (!message.empty() && ::write(pipe_fd, message.data(), message.size()) < 0) {
+    exit_code = 1;
+  }
+
+  ::_exit(exit_code);
+}
+
+std::string readAll(int fd) {
+  std::string result;
+  char buffer[512];
+  for (ssize_t count; (count = ::read(fd, buffer, sizeof(buffer))) != 0;) {
+    if (count < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      break;
+    }
+    result.append(buffer, count);
+  }
+  return result;
+}
+
+InstanceRecord makeRecord(const Worker& worker, int wait_status, const rusage& usage) {
+  InstanceRecord record;
+  record.seed = worker.seed;
+  record.wall_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - worker.start).count();
+  record.peak_rss = usage.ru_maxrss;
+  record.status = Status::CRASH;
+
+  const auto message = readAll(worker.pipe_fd);
+  ::close(worker.pipe_fd);
+
+  if (worker.killed) {
+    record.status = Status::TIMEOUT;
+  } else if (
+      WIFEXITED(wait_status) && WEXITSTATUS(wait_status) == 0 && message.size() >= 2 && message.back() == '\n') {
+    if (const auto phases = parsePhases(message.substr(2, message.size() - 3))) {
+      record.status = message[0] == '1' ? Status::SUCCESS : Status::FAILURE;
+      record.phases = phases.get();
+    }
+  }
+
+  return record;
+}
+} // namespace
+
+std::string toString(Status status) {
+  for (const auto& p : STATUS_NAMES) {
+    if (p.first == status) {
+      return p.second;
+    }
+  }
+  throw std::invalid_argument("Unknown status.");
+}
+
+std::string formatRecord(const InstanceRecord& record) {
+  std::ostringstream out;
+  out << "seed=" << record.seed << " status=" << toString(record.status) << " wall=" << record.wall_time
+      << " rss_kb=" << record.peak_rss << " phases=" << formatPhases(record.phases);
+  return out.str();
+}
+
+boost::optional<InstanceRecord> parseRecord(const std::string& line) {
+  std::map<std::string, std::string> fields;
+
+  std::istringstream in(line);
+  for (std::string field; in >> field;) {
+    const auto eq = field.find('=');
+    if (eq == std::string::npos) {
+      return boost::none;
+    }
+    fields[field.substr(0, eq)] = field.substr(eq + 1);
+  }
+
+  for (const auto key : {"seed", "status", "wall", "rss_kb", "phases"}) {
+    if (fields.find(key) == fields.end()) {
+      return boost::none;
+    }
+  }
+
+  InstanceRecord record;
+
+  const auto status = std::find_if(
+      std::begin(STATUS_NAMES), std::end(STATUS_NAMES), [&](const std::pair<Status, const char*>& p) {
+        return fields["status"] == p.second;
+      });
+  if (status == std::end(STATUS_NAMES)) {
+    return boost::none;
+  }
+  record.status = status->first;
+
+  try {
+    record.seed = std::stoull(fields["seed"]);
+    record.wall_time = std::stod(fields["wall"]);
+    record.peak_rss = std::stoull(fields["rss_kb"]);
+  } catch (const std::exception&) {
+    return boost::none;
+  }
+
+  const auto phases = parsePhases(fields["phases"]);
+  if (!phases) {
+    return boost::none;
+  }
+  record.phases = phases.get();
+
+  return record;
+}
+
+std::vector<InstanceRecord> readLog(const std::string& path) {
+  std::vector<InstanceRecord> result;
+
+  std::ifstream in(path);
+  for (std::string line; std::getline(in, line);) {
+    // the last line without the line end was not written completely
+    if (in.eof()) {
+      break;
+    }
+    if (const auto record = parseRecord(line)) {
+      result.push_back(record.get());
+    }
+  }
+
+  return result;
+}
+
+void Summary::add(const InstanceRecord& record) {
+  ++instances;
+  switch (record.status) {
+    case Status::SUCCESS:
+      ++successes;
+      break;
+    case Status::FAILURE:
+      ++failures;
+      break;
+    case Status::TIMEOUT:
+      ++timeouts;
+      break;
+    case Status::CRASH:
+      ++crashes;
+      break;
+  }
+  instances_time += record.wall_time;
+  peak_rss = std::max(peak_rss, record.peak_rss);
+}
+
+double Summary::successRate() const {
+  return instances ? static_cast<double>(successes) / instances : 0;
+}
+
+double Summary::throughput() const {
+  return elapsed > 0 ? 3600 * completed / elapsed : 0;
+}
+
+std::ostream& operator<<(std::ostream& out, const Summary& summary) {
+  out << "Success: " << summary.successes << " out of " << summary.instances << " (" << std::fixed
+      << std::setprecision(1) << 100 * summary.successRate() << "%)";
+  out << ", failures: " << summary.failures << ", timeouts: " << summary.timeouts << ", crashes: " << summary.crashes
+      << std::endl;
+  out << "Mean instance time: " << (summary.instances ? summary.instances_time / summary.instances : 0)
+      << " s, max peak RSS: " << summary.peak_rss / 1024 << " MB" << std::endl;
+  out << "This run: " << summary.completed << " instances in " << summary.elapsed << " s, " << summary.throughput()
+      << " instances/hour" << std::endl;
+  out.unsetf(std::ios::floatfield);
+  return out;
+}
+
+boost::optional<CampaignOptions> parseCommandLine(int argc, char** argv, const CampaignOptions& defaults) {
+  namespace po = boost::program_options;
+
+  auto options = defaults;
+
+  po::options_description description("Campaign options");
+  auto add = description.add_options();
+  add("help,h", "print this message");
+  add("first-seed", po::value(&options.first_seed)->default_value(defaults.first_seed), "seed of the first instance");
+  add("count,n", po::value(&options.count)->default_value(defaults.count), "number of instances");
+  add("workers,j", po::value(&options.workers)->default_value(defaults.workers), "instances run simultaneously");
+  add("threads,t",
+      po::value(&options.threads_per_instance)->default_value(defaults.threads_per_instance),
+      "threads per instance, 0 for the default");
+  add("time-limit",
+      po::value(&options.time_limit)->default_value(defaults.time_limit),
+      "seconds per instance, 0 for no limit");
+  add("log", po::value(&options.log_path)->default_value(defaults.log_path), "results log, resumed if it exists");
+  add("output-dir",
+      po::value(&options.output_directory)->default_value(defaults.output_directory),
+      "directory for the output of instances, empty to keep it in the console");
+
+  po::variables_map vm;
+  try {
+    po::store(po::parse_command_line(argc, argv, description), vm);
+    po::notify(vm);
+  } catch (const po::error& e) {
+    throw std::invalid_argument(e.what());
+  }
+
+  if (vm.count("help")) {
+    std::cout << description << std::endl;
+    return boost::none;
+  }
+
+  if (options.workers == 0) {
+    throw std::invalid_argument("The number of workers must be positive.");
+  }
+
+  return options;
+}
+
+Summary run(const CampaignOptions& options, const Experiment& experiment) {
+  if (options.workers == 0) {
+    throw std::invalid_argument("The number of workers must be positive.");
+  }
+
+  const auto start = std::chrono::steady_clock::now();
+
+  Summary summary;
+  std::set<size_t> done;
+
+  for (const auto& record : readLog(options.log_path)) {
+    if (record.seed >= options.first_seed && record.seed < options.first_seed + options.count &&
+        done.insert(record.seed).second) {
+      summary.add(record);
+    }
+  }
+
+  bool unfinished_line = false;
+  {
+    std::ifstream in(options.log_path, std::ios::binary | std::ios::ate);
+    if (in && in.tellg() > 0) {
+      in.seekg(-1, std::ios::end);
+      unfinished_line = in.get() != '\n';
+    }
+  }
+
+  std::ofstream log(options.log_path, std::ios::app);
+  if (!log) {
+    throw std::runtime_error("Cannot open the campaign log " + options.log_path);
+  }
+  if (unfinished_line) {
+    log << std::endl;
+  }
+
+  if (options.verbose && !done.empty()) {
+    std::cout << "Resuming campaign, " << done.size() << " instances are already in " << options.log_path << std::endl;
+  }
+
+  std::map<pid_t, Worker> workers;
+  auto next_seed = options.first_seed;
+  const auto last_seed = options.first_seed + options.count;
+
+  // output buffered before fork would be written by every child
+  std::cout.flush();
+  std::cerr.flush();
+
+  while (next_seed < last_seed || !workers.empty()) {
+    // 1. Start new instances
+    while (workers.size() < options.workers && next_seed < last_seed) {
+      const auto seed = next_seed++;
+      if (done.count(seed)) {
+        continue;
+      }
+
+      int fds[2];
+      if (::pipe(fds) != 0) {
+        throw std::runtime_error("Cannot create a pipe: " + std::string(std::strerror(errno)));
+      }
+
+      const auto pid = ::fork();
+      if (pid < 0) {
+        throw std::runtime_error("Cannot start an instance: " + std::string(std::strerror(errno)));
+      }
+
+      if (pid == 0) {
+        ::close(fds[0]);
+        runChild(options, experiment, seed, fds[1]);
+      }
+
+      ::close(fds[1]);
+      workers[pid] = Worker{seed, fds[0], std::chrono::steady_clock::now(), false};
+    }
+
+    // all the remaining seeds are in the log
+    if (workers.empty()) {
+      continue;
+    }
+
+    // 2. Collect finished instances
+    int wait_status;
+    rusage usage;
+    const auto pid = ::wait4(-1, &wait_status, WNOHANG, &usage);
+
+    if (pid > 0) {
+      const auto it = workers.find(pid);
+      if (it == workers.end()) {
+        continue;
+      }
+
+      const auto record = makeRecord(it->second, wait_status, usage);
+      workers.erase(it);
+
+      log << formatRecord(record) << std::endl;
+      summary.add(record);
+      ++summary.completed;
+
+      if (options.verbose) {
+        std::cout << "Instance #" << record.seed << ": " << toString(record.status) << ", " << record.wall_time
+                  << " s, " << record.peak_rss / 1024 << " MB. Success: " << summary.successes << " out of "
+                  << summary.instances << std::endl;
+      }
+      continue;
+    }
+
+    if (pid < 0 && errno != EINTR) {
+      throw std::runtime_error("Cannot wait for instances: " + std::string(std::strerror(errno)));
+    }
+
+    // 3. Stop instances out of time
+    if (options.time_limit > 0) {
+      const auto now = std::chrono::steady_clock::now();
+      for (auto& p : workers) {
+        if (!p.second.killed && std::chrono::duration<double>(now - p.second.start).count() > options.time_limit) {
+          ::kill(p.first, SIGKILL);
+          p.second.killed = true;
+        }
+      }
+    }
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  }
+
+  summary.elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  if (options.verbose) {
+    std::cout << summary;
+  }
+
+  return summary;
+}
+
+} // namespace campaign
+} // namespace crag
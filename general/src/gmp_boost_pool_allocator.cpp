@@ -14,7 +14,7 @@ typedef boost::singleton_pool<
   GmpPoolTag,
   POOL_ALLOCATE_BOUNDARY,
   boost::default_user_allocator_malloc_free,
-  boost::details::pool::null_mutex
+  boost::details::pool::default_mutex //numbers are allocated by the threads of crag::parallel too
 > GmpPool;
 
 void* (*gmp_default_malloc) (size_t) = nullptr;
@@ -1,6 +1,14 @@
 #include "parallel.h"
 
 #include <algorithm>
+#include <condition_variable>
+#include <cstdlib>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+
+#include <pthread.h>
 
 namespace crag {
 namespace parallel {
@@ -8,5 +16,358 @@ namespace parallel {
 size_t getHardwareConcurrency() {
   return std::max(1u, std::thread::hardware_concurrency());
 }
+
+namespace {
+
+using RangeFunction = std::function<void(size_t, size_t)>;
+
+//! Every thread takes about that many chunks of a loop, so that uneven iterations are balanced.
+const size_t CHUNKS_PER_THREAD = 4;
+
+//! A single parallel loop over [0, n). Chunks are handed out through an atomic counter,
+//! so any number of threads may join the loop at any time.
+class Job {
+public:
+  Job(size_t n, size_t chunk_size, const RangeFunction& range_fn)
+    : n_(n)
+    , chunk_size_(chunk_size)
+    , range_fn_(range_fn)
+    , next_(0)
+    , done_(0)
+    , failed_(false) {}
+
+  //! Executes chunks while there are any left.
+  //! Returns true if this call completed the last chunk of the loop.
+  bool run() {
+    bool completed = false;
+
+    while (true) {
+      const auto begin = next_.fetch_add(chunk_size_);
+
+      if (begin >= n_) {
+        return completed;
+      }
+
+      const auto end = std::min(n_, begin + chunk_size_);
+
+      // after a failure the remaining chunks are skipped, but still counted as done
+      if (!failed_) {
+        try {
+          range_fn_(begin, end);
+        } catch (...) {
+          std::lock_guard<std::mutex> lock(exception_mutex_);
+
+          if (!exception_) {
+            exception_ = std::current_exception();
+          }
+
+          failed_ = true;
+        }
+      }
+
+      if (done_.fetch_add(end - begin) + (end - begin) == n_) {
+        completed = true;
+      }
+    }
+  }
+
+  bool isDone() const {
+    return done_ == n_;
+  }
+
+  void rethrowIfFailed() const {
+    if (exception_) {
+      std::rethrow_exception(exception_);
+    }
+  }
+
+private:
+  const size_t n_;
+  const size_t chunk_size_;
+  // is only invoked while the loop is not done, i.e., while the caller of forEachRange waits
+  const RangeFunction& range_fn_;
+
+  std::atomic<size_t> next_;
+  std::atomic<size_t> done_;
+  std::atomic<bool> failed_;
+
+  std::mutex exception_mutex_;
+  std::exception_ptr exception_;
+};
+
+using Task = std::shared_ptr<Job>;
+
+class ThreadPool;
+
+//! Pool and queue of the current thread if it is a pool worker.
+thread_local const ThreadPool* t_pool = nullptr;
+thread_local size_t t_queue_index = 0;
+
+//! Work-stealing pool. Every worker owns a deque of tasks, the last deque is shared by external threads.
+//! A thread pops tasks from the back of its own deque and steals from the front of the others.
+//! A task is an invitation to join a loop, so several copies of it may sit in different deques.
+class ThreadPool {
+public:
+  explicit ThreadPool(size_t workers_count)
+    : pending_(0)
+    , stop_(false) {
+    for (size_t i = 0; i <= workers_count; ++i) {
+      queues_.emplace_back(new Queue());
+    }
+
+    threads_.reserve(workers_count);
+
+    for (size_t i = 0; i < workers_count; ++i) {
+      threads_.emplace_back([this, i]() { workerLoop_(i); });
+    }
+  }
+
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+  ~ThreadPool() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stop_ = true;
+    }
+
+    wakeup_.notify_all();
+
+    for (auto& t : threads_) {
+      t.join();
+    }
+  }
+
+  size_t workersCount() const {
+    return threads_.size();
+  }
+
+  //! Puts copies of the task into the queue of the current thread.
+  void submit(const Task& task, size_t copies) {
+    if (copies == 0) {
+      return;
+    }
+
+    auto& queue = *queues_[ownQueueIndex_()];
+
+    {
+      std::lock_guard<std::mutex> lock(queue.mutex);
+      queue.tasks.insert(queue.tasks.end(), copies, task);
+    }
+
+    pending_ += copies;
+
+    notifyAll();
+  }
+
+  //! Waits until the job is done, executing pending tasks in the meantime.
+  void wait(const Job& job) {
+    const auto index = ownQueueIndex_();
+
+    while (!job.isDone()) {
+      Task task;
+
+      if (pop_(index, task)) {
+        execute_(task);
+        continue;
+      }
+
+      std::unique_lock<std::mutex> lock(mutex_);
+      wakeup_.wait(lock, [&]() { return job.isDone() || pending_ > 0; });
+    }
+  }
+
+  void notifyAll() {
+    // acquiring the mutex makes sure that waiters either see the new state or receive the notification
+    { std::lock_guard<std::mutex> lock(mutex_); }
+
+    wakeup_.notify_all();
+  }
+
+private:
+  struct Queue {
+    std::mutex mutex;
+    std::deque<Task> tasks;
+  };
+
+  size_t ownQueueIndex_() const {
+    return (t_pool == this) ? t_queue_index : queues_.size() - 1;
+  }
+
+  void workerLoop_(size_t index) {
+    t_pool = this;
+    t_queue_index = index;
+
+    while (true) {
+      Task task;
+
+      if (pop_(index, task)) {
+        execute_(task);
+        continue;
+      }
+
+      std::unique_lock<std::mutex> lock(mutex_);
+      wakeup_.wait(lock, [this]() { return stop_ || pending_ > 0; });
+
+      if (stop_) {
+        return;
+      }
+    }
+  }
+
+  void execute_(const Task& task) {
+    if (task->run()) {
+      notifyAll();
+    }
+  }
+
+  bool pop_(size_t index, Task& task) {
+    if (pending_ == 0) {
+      return false;
+    }
+
+    const auto count = queues_.size();
+
+    for (size_t k = 0; k < count; ++k) {
+      auto& queue = *queues_[(index + k) % count];
+      std::lock_guard<std::mutex> lock(queue.mutex);
+
+      if (queue.tasks.empty()) {
+        continue;
+      }
+
+      if (k == 0) {
+        task = std::move(queue.tasks.back());
+        queue.tasks.pop_back();
+      } else {
+        task = std::move(queue.tasks.front());
+        queue.tasks.pop_front();
+      }
+
+      --pending_;
+      return true;
+    }
+
+    return false;
+  }
+
+  std::vector<std::unique_ptr<Queue>> queues_;
+  std::vector<std::thread> threads_;
+
+  std::atomic<size_t> pending_;
+
+  std::mutex mutex_;
+  std::condition_variable wakeup_;
+  bool stop_;
+};
+
+size_t defaultThreadsCount() {
+  if (const char* value = std::getenv("CRAG_NUM_THREADS")) {
+    const auto threads_count = std::strtoul(value, nullptr, 10);
+
+    if (threads_count > 0) {
+      return threads_count;
+    }
+  }
+
+  return getHardwareConcurrency();
+}
+
+//! Process-wide pool, created on first use.
+struct PoolHolder {
+  std::mutex mutex;
+  size_t threads_count = 0;
+  std::unique_ptr<ThreadPool> pool;
+
+  size_t getThreadsCount() {
+    if (threads_count == 0) {
+      threads_count = defaultThreadsCount();
+    }
+
+    return threads_count;
+  }
+};
+
+PoolHolder& poolHolder();
+
+void lockPoolBeforeFork() {
+  poolHolder().mutex.lock();
+}
+
+void unlockPoolAfterFork() {
+  poolHolder().mutex.unlock();
+}
+
+//! Only the forking thread exists in the child, so the workers of the pool can't be joined there.
+//! The pool is dropped without its destructor and a new one is created on first use.
+void forgetPoolAfterFork() {
+  auto& holder = poolHolder();
+  holder.pool.release();
+  t_pool = nullptr;
+  holder.mutex.unlock();
+}
+
+PoolHolder& poolHolder() {
+  static PoolHolder holder;
+  static const int registered = ::pthread_atfork(&lockPoolBeforeFork, &unlockPoolAfterFork, &forgetPoolAfterFork);
+  static_cast<void>(registered);
+
+  return holder;
+}
+
+ThreadPool& getPool() {
+  auto& holder = poolHolder();
+  std::lock_guard<std::mutex> lock(holder.mutex);
+
+  if (!holder.pool) {
+    holder.pool.reset(new ThreadPool(holder.getThreadsCount() - 1));
+  }
+
+  return *holder.pool;
+}
+} // namespace
+
+size_t getThreadsCount() {
+  auto& holder = poolHolder();
+  std::lock_guard<std::mutex> lock(holder.mutex);
+
+  return holder.getThreadsCount();
 }
+
+void setThreadsCount(size_t threads_count) {
+  auto& holder = poolHolder();
+  std::lock_guard<std::mutex> lock(holder.mutex);
+
+  holder.threads_count = (threads_count == 0) ? getHardwareConcurrency() : threads_count;
+  holder.pool.reset();
+}
+
+namespace details {
+void forEachRange(size_t n, const std::function<void(size_t, size_t)>& range_fn) {
+  if (n == 0) {
+    return;
+  }
+
+  auto& pool = getPool();
+  const auto threads_count = pool.workersCount() + 1;
+
+  if (threads_count == 1 || n == 1) {
+    range_fn(0, n);
+    return;
+  }
+
+  const auto chunk_size = std::max<size_t>(1, n / (threads_count * CHUNKS_PER_THREAD));
+  const auto chunks_count = (n + chunk_size - 1) / chunk_size;
+
+  const auto job = std::make_shared<Job>(n, chunk_size, range_fn);
+
+  pool.submit(job, std::min(chunks_count, threads_count) - 1);
+
+  job->run();
+  pool.wait(*job);
+
+  job->rethrowIfFailed();
 }
+} // namespace details
+} // namespace parallel
+} // namespace crag
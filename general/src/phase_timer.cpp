@@ -0,0 +1,38 @@
+#include "phase_timer.h"
+
+#include <algorithm>
+#include <mutex>
+
+namespace crag {
+namespace campaign {
+
+namespace {
+
+std::mutex phases_mutex;
+std::vector<PhaseTime> current_phases;
+
+} // namespace
+
+void addPhaseTime(const std::string& name, double seconds) {
+  std::lock_guard<std::mutex> lock(phases_mutex);
+
+  const auto it = std::find_if(
+      current_phases.begin(), current_phases.end(), [&name](const PhaseTime& phase) { return phase.name == name; });
+
+  if (it == current_phases.end()) {
+    current_phases.push_back({name, seconds});
+  } else {
+    it->seconds += seconds;
+  }
+}
+
+std::vector<PhaseTime> takePhaseTimes() {
+  std::lock_guard<std::mutex> lock(phases_mutex);
+
+  std::vector<PhaseTime> result;
+  std::swap(result, current_phases);
+  return result;
+}
+
+} // namespace campaign
+} // namespace crag
@@ -0,0 +1,211 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <thread>
+
+#include "campaign.h"
+#include "parallel.h"
+
+namespace crag {
+namespace campaign {
+namespace {
+
+TEST(Campaign, FormatParse) {
+  InstanceRecord record;
+  record.seed = 17;
+  record.status = Status::TIMEOUT;
+  record.wall_time = 12.5;
+  record.peak_rss = 40960;
+  record.phases = {{"uncloaking", 1.5}, {"enumeration", 11}};
+
+  const auto line = formatRecord(record);
+  EXPECT_EQ("seed=17 status=timeout wall=12.5 rss_kb=40960 phases=uncloaking:1.5,enumeration:11", line);
+
+  const auto parsed = parseRecord(line);
+  ASSERT_TRUE(parsed);
+  EXPECT_EQ(17, parsed->seed);
+  EXPECT_EQ(Status::TIMEOUT, parsed->status);
+  EXPECT_EQ(12.5, parsed->wall_time);
+  EXPECT_EQ(40960, parsed->peak_rss);
+  ASSERT_EQ(2, parsed->phases.size());
+  EXPECT_EQ("enumeration", parsed->phases[1].name);
+  EXPECT_EQ(11, parsed->phases[1].seconds);
+
+  record.phases.clear();
+  ASSERT_TRUE(parseRecord(formatRecord(record)));
+  EXPECT_TRUE(parseRecord(formatRecord(record))->phases.empty());
+
+  EXPECT_FALSE(parseRecord(""));
+  EXPECT_FALSE(parseRecord("seed=1 status=success wall=1"));
+  EXPECT_FALSE(parseRecord("seed=1 status=done wall=1 rss_kb=1 phases="));
+  EXPECT_FALSE(parseRecord("seed=x status=success wall=1 rss_kb=1 phases="));
+  EXPECT_FALSE(parseRecord("seed=1 status=success wall=1 rss_kb=1 phases=a:"));
+}
+
+TEST(Campaign, PhaseTimes) {
+  takePhaseTimes();
+  addPhaseTime("a", 1);
+  addPhaseTime("b", 2);
+  addPhaseTime("a", 3);
+
+  const auto phases = takePhaseTimes();
+  ASSERT_EQ(2, phases.size());
+  EXPECT_EQ("a", phases[0].name);
+  EXPECT_EQ(4, phases[0].seconds);
+  EXPECT_TRUE(takePhaseTimes().empty());
+}
+
+class CampaignRun : public ::testing::Test {
+protected:
+  void SetUp() override {
+    std::remove(log_path.c_str());
+  }
+
+  void TearDown() override {
+    std::remove(log_path.c_str());
+  }
+
+  const std::string log_path = "test_campaign.log";
+};
+
+TEST_F(CampaignRun, UnfinishedLine) {
+  {
+    std::ofstream log(log_path);
+    log << "seed=0 status=success wall=1 rss_kb=1 phases=\n";
+    log << "seed=1 status=success wall=1 rss_kb=1 phases=a:1";
+  }
+
+  const auto records = readLog(log_path);
+  ASSERT_EQ(1, records.size());
+  EXPECT_EQ(0, records[0].seed);
+
+  EXPECT_TRUE(readLog("no_such_campaign.log").empty());
+}
+
+TEST_F(CampaignRun, StatusesAndResume) {
+  CampaignOptions options;
+  options.first_seed = 10;
+  options.count = 6;
+  options.workers = 3;
+  options.time_limit = 2;
+  options.log_path = log_path;
+  options.verbose = false;
+
+  const auto experiment = [](size_t seed) {
+    switch (seed) {
+      case 12:
+        std::abort();
+      case 13:
+        throw std::runtime_error("exception");
+      case 14:
+        std::this_thread::sleep_for(std::chrono::seconds(30));
+        return true;
+      default: {
+        ScopedPhase phase("work");
+        return seed % 2 == 0;
+      }
+    }
+  };
+
+  auto summary = run(options, experiment);
+  EXPECT_EQ(6, summary.instances);
+  EXPECT_EQ(6, summary.completed);
+  EXPECT_EQ(1, summary.successes);
+  EXPECT_EQ(2, summary.failures);
+  EXPECT_EQ(1, summary.timeouts);
+  EXPECT_EQ(2, summary.crashes);
+  EXPECT_GT(summary.peak_rss, 0);
+  EXPECT_GT(summary.throughput(), 0);
+  EXPECT_LT(summary.elapsed, 20);
+
+  const auto records = readLog(log_path);
+  ASSERT_EQ(6, records.size());
+  for (const auto& record : records) {
+    if (record.seed == 10) {
+      EXPECT_EQ(Status::SUCCESS, record.status);
+      ASSERT_EQ(1, record.phases.size());
+      EXPECT_EQ("work", record.phases[0].name);
+    } else if (record.seed == 14) {
+      EXPECT_EQ(Status::TIMEOUT, record.status);
+    }
+  }
+
+  // only the new seed is run, the rest is taken from the log
+  options.count = 7;
+  summary = run(options, experiment);
+  EXPECT_EQ(7, summary.instances);
+  EXPECT_EQ(1, summary.completed);
+  EXPECT_EQ(2, summary.successes);
+  EXPECT_EQ(7, readLog(log_path).size());
+
+  summary = run(options, experiment);
+  EXPECT_EQ(7, summary.instances);
+  EXPECT_EQ(0, summary.completed);
+}
+
+//! Runs a parallel loop, returns true if its result is right and several threads took part in it
+bool runParallelLoop() {
+  std::atomic<size_t> sum(0);
+  std::mutex mutex;
+  std::set<std::thread::id> threads;
+
+  parallel::forEach(100, [&](size_t i) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    sum += i;
+    std::lock_guard<std::mutex> lock(mutex);
+    threads.insert(std::this_thread::get_id());
+  });
+
+  return (sum == 4950) && (threads.size() > 1);
+}
+
+TEST_F(CampaignRun, ParallelInInstances) {
+  // the pool of the parent is running when the instances are forked
+  parallel::setThreadsCount(4);
+  runParallelLoop();
+
+  CampaignOptions options;
+  options.count = 2;
+  options.workers = 2;
+  options.time_limit = 10;
+  options.log_path = log_path;
+  options.verbose = false;
+
+  const auto inherited = run(options, [](size_t) { return (parallel::getThreadsCount() == 4) && runParallelLoop(); });
+  EXPECT_EQ(2, inherited.successes);
+
+  options.first_seed = 2;
+  options.threads_per_instance = 2;
+  const auto restarted = run(options, [](size_t) { return (parallel::getThreadsCount() == 2) && runParallelLoop(); });
+  EXPECT_EQ(2, restarted.successes);
+
+  EXPECT_EQ(4, parallel::getThreadsCount());
+  EXPECT_TRUE(runParallelLoop());
+}
+
+TEST(Campaign, CommandLine) {
+  CampaignOptions defaults;
+  defaults.count = 5;
+
+  const char* argv[] = {"main", "--first-seed", "3", "-j", "4", "--time-limit", "60", "--log", "a.log"};
+  const auto options = parseCommandLine(9, const_cast<char**>(argv), defaults);
+  ASSERT_TRUE(options);
+  EXPECT_EQ(3, options->first_seed);
+  EXPECT_EQ(5, options->count);
+  EXPECT_EQ(4, options->workers);
+  EXPECT_EQ(60, options->time_limit);
+  EXPECT_EQ("a.log", options->log_path);
+
+  const char* bad_argv[] = {"main", "--workers", "0"};
+  EXPECT_THROW(parseCommandLine(3, const_cast<char**>(bad_argv), defaults), std::invalid_argument);
+}
+
+} // namespace
+} // namespace campaign
+} // namespace crag
@@ -1,6 +1,8 @@
 #include <gtest/gtest.h>
 #include <random>
 #include <algorithm>
+#include <atomic>
+#include <stdexcept>
 #include "parallel.h"
 
 namespace crag {
@@ -46,6 +48,69 @@ TEST(ParallelMap, Ex_02) {
     return b;
   }));
 }
+
+TEST(ParallelForEach, EachIndexOnce) {
+  const size_t size = 100003;
+
+  std::vector<std::atomic<int>> visits(size);
+
+  forEach(size, [&](size_t i) { ++visits[i]; });
+
+  EXPECT_TRUE(std::all_of(visits.begin(), visits.end(), [](const std::atomic<int>& v) { return v == 1; }));
+}
+
+TEST(ParallelForEach, Nested) {
+  const size_t outer = 64;
+  const size_t inner = 1000;
+
+  const auto sums = map<size_t>(outer, [&](size_t i) {
+    const auto values = map<size_t>(inner, [&](size_t j) { return i * j; });
+
+    size_t sum = 0;
+
+    for (const auto v : values) {
+      sum += v;
+    }
+
+    return sum;
+  });
+
+  for (size_t i = 0; i < outer; ++i) {
+    EXPECT_EQ(i * inner * (inner - 1) / 2, sums[i]);
+  }
+}
+
+TEST(ParallelForEach, Exception) {
+  EXPECT_THROW(forEach(1000, [](size_t i) {
+    if (i == 500) {
+      throw std::runtime_error("failure");
+    }
+  }), std::runtime_error);
+
+  // the pool is still usable
+  const auto squares = map<size_t>(1000, [](size_t i) { return i * i; });
+  EXPECT_EQ(999 * 999, squares.back());
+}
+
+TEST(ParallelForEach, ThreadsCount) {
+  const auto default_count = getThreadsCount();
+
+  setThreadsCount(1);
+  EXPECT_EQ(1, getThreadsCount());
+
+  const auto main_id = std::this_thread::get_id();
+  const auto same_thread = bmap(100, [&](size_t) { return std::this_thread::get_id() == main_id; });
+
+  EXPECT_TRUE(std::all_of(same_thread.begin(), same_thread.end(), [](bool b) { return b; }));
+
+  setThreadsCount(3);
+  EXPECT_EQ(3, getThreadsCount());
+
+  const auto values = map<size_t>(1000, [](size_t i) { return i; });
+  EXPECT_EQ(999, values.back());
+
+  setThreadsCount(default_count);
+}
 }
 }
 }
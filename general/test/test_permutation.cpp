@@ -107,4 +107,37 @@ TEST(Permutation, ToCycles) {
   EXPECT_EQ(expected, toCycles(Permutation({6, 5, 9, 2, 7, 3, 4, 0, 8, 1})));
   EXPECT_TRUE(toCycles(Permutation(100)).empty());
 }
+
+TEST(Permutation, InlineAndVectorStorageAgree) {
+  // permutations of at most Permutation::SMALL_SIZE elements are stored inline, the extended ones are not
+  const size_t large_size = Permutation::SMALL_SIZE + 4;
+
+  for (size_t n = 1; n <= Permutation::SMALL_SIZE; ++n) {
+    for (int i = 0; i < 20; ++i) {
+      const auto p = Permutation::random(n);
+      const auto q = Permutation::random(n);
+      const auto large_p = p.increaseSize(large_size);
+      const auto large_q = q.increaseSize(large_size);
+
+      EXPECT_EQ((p * q).increaseSize(large_size), large_p * large_q);
+      EXPECT_EQ(p.inverse().increaseSize(large_size), large_p.inverse());
+      EXPECT_EQ(p.RightGCD(q).increaseSize(large_size), large_p.RightGCD(large_q));
+      EXPECT_EQ(p.LeftGCD(q).increaseSize(large_size), large_p.LeftGCD(large_q));
+      EXPECT_EQ(p.geodesic(), large_p.geodesic());
+      EXPECT_EQ(p.getVector() < q.getVector(), p < q);
+      EXPECT_EQ(p.getVector() == q.getVector(), p == q);
+      EXPECT_EQ(p.getVector(), Permutation(p.getVector()).getVector());
+    }
+  }
+}
+
+TEST(Permutation, MultiplicationOfInlineAndVectorStorage) {
+  const auto small = Permutation({1, 0, 2});
+  const auto large = Permutation::getHalfTwistPermutation(Permutation::SMALL_SIZE + 1);
+
+  EXPECT_EQ(small.increaseSize(large.size()) * large, small * large);
+  EXPECT_EQ(large * small.increaseSize(large.size()), large * small);
+  EXPECT_TRUE((large * large).isTrivial());
+  EXPECT_FALSE(large.isTrivial());
+}
 } // namespace